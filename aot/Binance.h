@@ -13,10 +13,13 @@
 #include "aot/bus/bus.h"
 #include "aot/client_request.h"
 #include "aot/client_response.h"
+#include "aot/common/json_parser.h"
 #include "aot/common/thread_utils.h"
 #include "aot/common/time_utils.h"
 #include "aot/common/types.h"
+#include "aot/hot_log.h"
 #include "aot/market_data/market_update.h"
+#include "aot/order_gw/signed_request.h"
 #include "aot/prometheus/event.h"
 #include "boost/asio.hpp"
 #include "boost/beast/http.hpp"
@@ -413,6 +416,7 @@ class FamilyBookEventGetter {
       private:
         common::TradingPairHashMap& pairs_;
         common::TradingPairReverseHashMap& pairs_reverse_;
+        common::JsonParser parser_;
     };
     class ArgsOrder : public ArgsQuery {
       public:
@@ -741,6 +745,7 @@ class FamilyLimitOrder {
       private:
         common::TradingPairHashMap& pairs_;
         common::TradingPairReverseHashMap& pairs_reverse_;
+        common::JsonParser parser_;
     };
     class ArgsOrder : public ArgsQuery {
       public:
@@ -836,6 +841,50 @@ class FamilyLimitOrder {
         ArgsOrder& storage = *this;
     };
 };
+
+/**
+ * @brief pre-rendered new limit order of one trading pair and side. It is cut
+ * from a probe order made by FactoryRequest, so Render() gives the bytes
+ * OrderNewLimit3 sends for the same order and timestamp
+ *
+ * @param endpoint spot or futures endpoint from EndpointManager
+ * @param hmac keyed with the secret of api_key, must outlive the template
+ */
+inline aot::SignedRequestTemplate MakeNewLimitOrderTemplate(
+    const Endpoint& endpoint, common::TradingPair trading_pair,
+    common::Side side, common::TradingPairHashMap& pairs,
+    std::string_view api_key, hmac_sha256::KeyedHmac& hmac) {
+    Exchange::RequestNewOrder probe;
+    probe.trading_pair = trading_pair;
+    probe.side         = side;
+    probe.price        = 0;
+    probe.qty          = 0;
+    probe.order_id     = 1;
+    FamilyLimitOrder::ArgsOrder args(&probe, pairs);
+    args["price"]            = aot::kPriceMarker;
+    args["quantity"]         = aot::kQtyMarker;
+    args["newClientOrderId"] = aot::kClientIdMarker;
+    hmac_sha256::TemplateSigner signer(api_key);
+    FactoryRequest factory{endpoint,
+                           FamilyLimitOrder::end_point,
+                           args,
+                           boost::beast::http::verb::post,
+                           &signer,
+                           true};
+    const auto request = aot::SerializeRequest(factory());
+    // timestamp=<ms> is signed, its value is cut out of the payload
+    constexpr std::string_view kTimestamp = "timestamp=";
+    std::string_view timestamp            = signer.Payload();
+    const auto start                      = timestamp.find(kTimestamp);
+    timestamp = start == std::string_view::npos
+                    ? std::string_view{}
+                    : timestamp.substr(start + kTimestamp.size());
+    timestamp = timestamp.substr(0, timestamp.find('&'));
+    const auto& info = pairs[trading_pair];
+    return aot::SignedRequestTemplate(signer.Payload(), request, timestamp,
+                                      hmac, info.price_precission,
+                                      info.qty_precission);
+}
 class FamilyCancelOrder {
   public:
     static constexpr std::string_view end_point = "/api/v3/order";
@@ -851,6 +900,7 @@ class FamilyCancelOrder {
 
       private:
         common::TradingPairReverseHashMap& pairs_reverse_;
+        common::JsonParser parser_;
     };
     class ArgsOrder : public ArgsQuery {
       public:
@@ -1229,7 +1279,11 @@ class OrderNewLimit3 : public detail::FamilyLimitOrder {
                 auto req = factory();
                 logd("End preparing new limit order request");
                 bus_event_request_new_order->Release();
-                auto session = session_pool_->AcquireConnection();
+                auto session = co_await session_pool_->AsyncAcquire();
+                if (!session) {
+                    loge("no https session to send new limit order request");
+                    co_return;
+                }
                 logd("Start sending new limit order request");
                 session->RegisterOnResponse(callback);
                 if (auto status =
@@ -1467,7 +1521,11 @@ class CancelOrder3 : public detail::FamilyCancelOrder {
 
                 bus_event_request_cancel_order->Release();
 
-                auto session = session_pool_->AcquireConnection();
+                auto session = co_await session_pool_->AsyncAcquire();
+                if (!session) {
+                    loge("no https session to send cancel request");
+                    co_return;
+                }
                 logd("start send cancel request");
                 session->RegisterOnResponse(callback);
 
@@ -1530,6 +1588,7 @@ class FamilyBookSnapshot {
     }
     class ParserResponse {
         common::TradingPairHashMap& trading_pairs_;
+        common::JsonParser parser_;
 
       public:
         explicit ParserResponse(common::TradingPairHashMap& trading_pairs)
@@ -1704,7 +1763,11 @@ class BookSnapshot2 : public inner::BookSnapshotI {
 
                 // bus_event_request_new_snapshot->Release();
                 // bus_event_request_new_snapshot->WrappedEvent()->Release();
-                auto session = session_pool_->AcquireConnection();
+                auto session = co_await session_pool_->AsyncAcquire();
+                if (!session) {
+                    loge("no https session to send new snapshot request");
+                    co_return;
+                }
                 logd("start send new snapshot request for {}", trading_pair);
                 OnHttpsResponce simple_callback =
                     [callback,
@@ -1835,8 +1898,7 @@ class BidAskGeneratorComponent : public bus::Component {
     Exchange::BusEventRequestDiffOrderBookPool request_bus_event_diff_mem_pool_;
     Exchange::RequestDiffOrderBookPool request_diff_mem_pool_;
 
-    Exchange::MEMarketUpdate2Pool out_diff_mem_pool_;
-    Exchange::BusEventMEMarketUpdate2Pool out_bus_event_diff_mem_pool_;
+    Exchange::MEMarketUpdate2EnvelopePool out_market_update_pool_;
     Exchange::BookSnapshot2Pool book_snapshot2_pool_;
     Exchange::BusEventResponseNewSnapshotPool
         bus_event_response_new_snapshot_pool_;
@@ -1861,9 +1923,8 @@ class BidAskGeneratorComponent : public bus::Component {
           request_snapshot_mem_pool_(number_snapshots),
           request_bus_event_diff_mem_pool_(number_diff),
           request_diff_mem_pool_(number_diff),
-          out_diff_mem_pool_(max_number_event_per_tick),
+          out_market_update_pool_(max_number_event_per_tick),
           book_snapshot2_pool_(max_number_event_per_tick),
-          out_bus_event_diff_mem_pool_(max_number_event_per_tick),
           bus_event_response_new_snapshot_pool_(max_number_event_per_tick) {
         cancel_signal_.slot().assign([this](
                                          boost::asio::cancellation_type type) {
@@ -2173,6 +2234,9 @@ class ParserManager {
     std::unordered_map<ResponseType,
                        std::function<ParsedData(simdjson::ondemand::document&)>>
         handlers_;
+    /// reused for every response, responses of one connection are parsed
+    /// sequentially
+    common::JsonParser parser_;
 
   public:
     /**
@@ -2207,13 +2271,26 @@ class ParserManager {
      * type or if parsing fails.
      */
     ParsedData Parse(std::string_view response) {
-        simdjson::ondemand::parser parser;
-        simdjson::padded_string padded_response(response);
-        simdjson::ondemand::document doc = parser.iterate(padded_response);
-        auto type                        = DetermineType(doc);
+        simdjson::ondemand::document doc = parser_.Iterate(response);
+        return Dispatch(doc);
+    }
+
+    /**
+     * @brief the same as Parse(std::string_view) but the response is parsed in
+     * place without copying, e.g. common::PaddedView of websocket buffer
+     *
+     */
+    ParsedData Parse(simdjson::padded_string_view response) {
+        simdjson::ondemand::document doc = parser_.Iterate(response);
+        return Dispatch(doc);
+    }
+
+  private:
+    ParsedData Dispatch(simdjson::ondemand::document& doc) {
+        auto type = DetermineType(doc);
 
         // Find the handler for the determined response type
-        auto it                          = handlers_.find(type);
+        auto it   = handlers_.find(type);
         if (it == handlers_.end()) {
             loge("No handler registered for this response type");
             return {};  // Return empty if no handler is registered
@@ -2223,7 +2300,6 @@ class ParserManager {
         return it->second(doc);
     }
 
-  private:
     ResponseType DetermineType(simdjson::ondemand::document& doc) {
         // Check if this is a depth update response
         if (doc["e"].error() == simdjson::SUCCESS && doc["e"].is_string() &&
@@ -2356,10 +2432,9 @@ class BookEventGetterComponentCallbackHandler {
 
     void HandleResponse(boost::beast::flat_buffer& fb,
                         common::TradingPair trading_pair) {
-        auto response = std::string_view(
-            static_cast<const char*>(fb.data().data()), fb.size());
-        auto answer = parser_manager_.Parse(response);
-        logi("{}", response);
+        const auto response = common::PaddedView(fb);
+        auto answer         = parser_manager_.Parse(response);
+        hlogd(kParser, "{}", std::string_view(response));
         std::visit(
             [&](auto&& snapshot) {
                 using T = std::decay_t<decltype(snapshot)>;
@@ -2374,7 +2449,7 @@ class BookEventGetterComponentCallbackHandler {
     void HandleResponse(std::string_view response,
                         common::TradingPair trading_pair) {
         auto answer = parser_manager_.Parse(response);
-        logi("{}", response);
+        hlogd(kParser, "{}", response);
         std::visit(
             [&](auto&& snapshot) {
                 using T = std::decay_t<decltype(snapshot)>;
@@ -2390,7 +2465,7 @@ class BookEventGetterComponentCallbackHandler {
   private:
     void ProcessBookDiffSnapshot(Exchange::BookDiffSnapshot& data,
                                  common::TradingPair trading_pair) {
-        logi("Received a BookDiffSnapshot!");
+        hlogd(kParser, "Received a BookDiffSnapshot!");
         Exchange::BookDiffSnapshot& result = data;
         auto request = event_getter_component_.book_diff_mem_pool_.Allocate(
             &event_getter_component_.book_diff_mem_pool_, result.exchange_id,
@@ -2438,20 +2513,14 @@ class BidAskGeneratorCallbackHandler {
                             common::TradingPair trading_pair,
                             common::Side side) {
         boost::for_each(entries, [&](const auto& bid) {
-            Exchange::MEMarketUpdate2* ptr =
-                bid_ask_generator_.out_diff_mem_pool_.Allocate(
-                    &bid_ask_generator_.out_diff_mem_pool_, exchange_id,
-                    trading_pair, Exchange::MarketUpdateType::DEFAULT,
-                    common::kOrderIdInvalid, side, bid.price, bid.qty);
-            auto intr_ptr =
-                boost::intrusive_ptr<Exchange::MEMarketUpdate2>(ptr);
-            auto bus_event =
-                bid_ask_generator_.out_bus_event_diff_mem_pool_.Allocate(
-                    &bid_ask_generator_.out_bus_event_diff_mem_pool_, intr_ptr);
-            auto intr_ptr_bus_event =
-                boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2>(
-                    bus_event);
-            bus_.AsyncSend(&bid_ask_generator_, intr_ptr_bus_event);
+            auto& pool = bid_ask_generator_.out_market_update_pool_;
+            Exchange::MEMarketUpdate2Envelope* ptr = pool.Allocate(
+                &pool, exchange_id, trading_pair,
+                Exchange::MarketUpdateType::DEFAULT, common::kOrderIdInvalid,
+                side, bid.price, bid.qty);
+            bus_.AsyncSend(
+                &bid_ask_generator_,
+                boost::intrusive_ptr<Exchange::MEMarketUpdate2Envelope>(ptr));
         });
     }
     // Register snapshot and diff callbacks
@@ -2504,13 +2573,13 @@ class BidAskGeneratorCallbackBatchHandler {
         bid_ask_generator_.RegisterSnapshotCallback(
             [this](const Exchange::BookSnapshot& snapshot) {
                 logi("[bidaskgenerator] invoke handler for snapshot");
-                auto copy_bids = snapshot.bids;
-                auto copy_asks = snapshot.asks;
-
+                // copies share the slab of the snapshot levels, levels are
+                // not duplicated
                 auto* ptr = bid_ask_generator_.book_snapshot2_pool_.Allocate(
                     &bid_ask_generator_.book_snapshot2_pool_,
                     snapshot.exchange_id, snapshot.trading_pair,
-                    std::move(copy_bids), std::move(copy_asks), 0);
+                    Exchange::BookLevels(snapshot.bids),
+                    Exchange::BookLevels(snapshot.asks), 0);
                 auto intr_ptr =
                     boost::intrusive_ptr<Exchange::BookSnapshot2>(ptr);
                 auto bus_event =
@@ -2532,6 +2601,7 @@ class BookSnapsotCallbackHandler {
     common::TradingPairHashMap& trading_pair_hash_map_;
 
     BookSnapshotComponent<ThreadPool1>& book_snapshot_component_;
+    binance::detail::FamilyBookSnapshot::ParserResponse parser_;
 
   public:
     BookSnapsotCallbackHandler(
@@ -2539,7 +2609,8 @@ class BookSnapsotCallbackHandler {
         BookSnapshotComponent<ThreadPool1>& book_snapshot_component)
         : bus_(bus),
           trading_pair_hash_map_(trading_pair_hash_map),
-          book_snapshot_component_(book_snapshot_component) {}
+          book_snapshot_component_(book_snapshot_component),
+          parser_(trading_pair_hash_map) {}
     OnHttpsResponseExtended GetCallback() {
         return
             [this](
@@ -2558,9 +2629,7 @@ class BookSnapsotCallbackHandler {
         logi("{}", result);
         logi("trading_pair:{}", trading_pair.ToString());
 
-        binance::detail::FamilyBookSnapshot::ParserResponse parser(
-            trading_pair_hash_map_);
-        auto snapshot = parser.Parse(result, trading_pair);
+        auto snapshot = parser_.Parse(result, trading_pair);
 
         auto ptr      = book_snapshot_component_.snapshot_mem_pool_.Allocate(
             &book_snapshot_component_.snapshot_mem_pool_, snapshot.exchange_id,
@@ -13,10 +13,14 @@
 #include "aot/bus/bus.h"
 #include "aot/client_request.h"
 #include "aot/client_response.h"
+#include "aot/common/fixed_point.h"
+#include "aot/common/json_parser.h"
 #include "aot/common/thread_utils.h"
 #include "aot/common/time_utils.h"
 #include "aot/common/types.h"
+#include "aot/hot_log.h"
 #include "aot/market_data/market_update.h"
+#include "aot/order_gw/signed_request.h"
 #include "aot/prometheus/event.h"
 #include "boost/asio.hpp"
 #include "boost/beast/http.hpp"
@@ -291,6 +295,7 @@ class FamilyBookEventGetter {
     class ParserResponse {
         common::TradingPairHashMap& pairs_;
         common::TradingPairReverseHashMap& pairs_reverse_;
+        common::JsonParser parser_;
 
       public:
         using ResponseVariant =
@@ -614,6 +619,140 @@ class FactoryRequestJson {
     SignerI* signer_;
     bool need_sign_;
 };
+
+class FamilyLimitOrder {
+  public:
+    static constexpr std::string_view end_point = "/v5/order/create";
+    explicit FamilyLimitOrder()                 = default;
+    virtual ~FamilyLimitOrder()                 = default;
+
+    /**
+     * @brief body of /v5/order/create. ArgsBody::Body() keeps only quoted
+     * values, all of them are strings for the exchange
+     */
+    class ArgsOrder : public ArgsBody {
+      public:
+        using SymbolType = std::string_view;
+        explicit ArgsOrder(const Exchange::RequestNewOrder* new_order,
+                           common::TradingPairHashMap& pairs,
+                           common::MarketType market_type)
+            : ArgsBody() {
+            SetCategory(market_type);
+            SetSymbol(pairs[new_order->trading_pair].https_json_request);
+            SetSide(new_order->side);
+            SetType(Type::LIMIT);
+            SetQuantity(new_order->qty,
+                        pairs[new_order->trading_pair].qty_precission);
+            SetPrice(new_order->price,
+                     pairs[new_order->trading_pair].price_precission);
+            SetTimeInForce(TimeInForce::GTC);
+            SetOrderId(new_order->order_id);
+        };
+
+      private:
+        void SetCategory(common::MarketType market_type) {
+            storage["category"] = market_type == common::MarketType::kFutures
+                                      ? "\"linear\""
+                                      : "\"spot\"";
+        };
+        void SetSymbol(SymbolType symbol) {
+            storage["symbol"] = fmt::format("\"{}\"", symbol);
+        };
+        void SetSide(common::Side side) {
+            switch (side) {
+                using enum common::Side;
+                case kAsk:
+                    storage["side"] = "\"Buy\"";
+                    break;
+                case kBid:
+                    storage["side"] = "\"Sell\"";
+                    break;
+                default:
+                    loge("side is not Sell or Buy");
+            }
+        };
+        void SetType(Type type) {
+            switch (type) {
+                case Type::LIMIT:
+                    storage["orderType"] = "\"Limit\"";
+                    break;
+                case Type::MARKET:
+                    storage["orderType"] = "\"Market\"";
+                    break;
+            }
+        };
+        /// qty and price are fixed point with the precision of the pair
+        void SetQuantity(common::Qty qty, uint8_t qty_prec) {
+            storage["qty"] =
+                fmt::format("\"{}\"", common::FormatFixedPoint(qty, qty_prec));
+        };
+        void SetPrice(common::Price price, uint8_t price_prec) {
+            storage["price"] = fmt::format(
+                "\"{}\"", common::FormatFixedPoint(price, price_prec));
+        };
+        void SetTimeInForce(TimeInForce time_in_force) {
+            switch (time_in_force) {
+                case TimeInForce::FOK:
+                    storage["timeInForce"] = "\"FOK\"";
+                    break;
+                case TimeInForce::GTC:
+                    storage["timeInForce"] = "\"GTC\"";
+                    break;
+                case TimeInForce::IOC:
+                    storage["timeInForce"] = "\"IOC\"";
+                    break;
+                case TimeInForce::POST_ONLY:
+                    storage["timeInForce"] = "\"PostOnly\"";
+                    break;
+            }
+        };
+        void SetOrderId(common::OrderId order_id) {
+            if (order_id != common::kOrderIdInvalid) [[likely]]
+                storage["orderLinkId"] = fmt::format(
+                    "\"{}\"", common::orderIdToString(order_id));
+        };
+
+      private:
+        ArgsOrder& storage = *this;
+    };
+};
+
+/**
+ * @brief pre-rendered new limit order of one trading pair and side. It is cut
+ * from a probe order made by FactoryRequestJson, so Render() gives the bytes
+ * the factory gives for the same order and timestamp
+ *
+ * @param hmac keyed with the secret of api_key, must outlive the template
+ */
+inline aot::SignedRequestTemplate MakeNewLimitOrderTemplate(
+    const https::ExchangeI* exchange, common::MarketType market_type,
+    common::TradingPair trading_pair, common::Side side,
+    common::TradingPairHashMap& pairs, std::string_view api_key,
+    hmac_sha256::KeyedHmac& hmac) {
+    Exchange::RequestNewOrder probe;
+    probe.trading_pair = trading_pair;
+    probe.side         = side;
+    probe.price        = 0;
+    probe.qty          = 0;
+    probe.order_id     = 1;
+    FamilyLimitOrder::ArgsOrder args(&probe, pairs, market_type);
+    args["price"]       = fmt::format("\"{}\"", aot::kPriceMarker);
+    args["qty"]         = fmt::format("\"{}\"", aot::kQtyMarker);
+    args["orderLinkId"] = fmt::format("\"{}\"", aot::kClientIdMarker);
+    hmac_sha256::TemplateSigner signer(api_key);
+    FactoryRequestJson factory{exchange,
+                               FamilyLimitOrder::end_point,
+                               args,
+                               boost::beast::http::verb::post,
+                               &signer,
+                               true};
+    const auto probe_request = factory();
+    const std::string timestamp(probe_request["X-BAPI-TIMESTAMP"]);
+    const auto& info = pairs[trading_pair];
+    return aot::SignedRequestTemplate(
+        signer.Payload(), aot::SerializeRequest(probe_request), timestamp,
+        hmac, info.price_precission, info.qty_precission);
+}
 };  // namespace detail
 // class OrderNewLimit : public inner::OrderNewI {
 //     static constexpr std::string_view end_point = "/v5/order/create";
@@ -1239,6 +1378,7 @@ class FamilyBookSnapshot {
     static constexpr std::string_view end_point = "/api/v3/depth";
     class ParserResponse {
         const common::TradingPairInfo& pair_info_;
+        common::JsonParser parser_;
 
       public:
         explicit ParserResponse(const common::TradingPairInfo& pair_info)
@@ -1401,7 +1541,11 @@ class BookSnapshot2 : public inner::BookSnapshotI {
 
                 // bus_event_request_new_snapshot->Release();
                 // bus_event_request_new_snapshot->WrappedEvent()->Release();
-                auto session = session_pool_->AcquireConnection();
+                auto session = co_await session_pool_->AsyncAcquire();
+                if (!session) {
+                    loge("no https session to send new snapshot request");
+                    co_return;
+                }
                 logd("start send new snapshot request");
                 session->RegisterOnResponse(*callback);
                 if (auto status =
@@ -1822,6 +1966,9 @@ class ParserManager {
     std::unordered_map<ResponseType,
                        std::function<ParsedData(simdjson::ondemand::document&)>>
         handlers_;
+    /// reused for every response, responses of one connection are parsed
+    /// sequentially
+    common::JsonParser parser_;
 
   public:
     /**
@@ -1856,13 +2003,26 @@ class ParserManager {
      * type or if parsing fails.
      */
     ParsedData Parse(std::string_view response) {
-        simdjson::ondemand::parser parser;
-        simdjson::padded_string padded_response(response);
-        simdjson::ondemand::document doc = parser.iterate(padded_response);
-        auto type                        = DetermineType(doc);
+        simdjson::ondemand::document doc = parser_.Iterate(response);
+        return Dispatch(doc);
+    }
+
+    /**
+     * @brief the same as Parse(std::string_view) but the response is parsed in
+     * place without copying, e.g. common::PaddedView of websocket buffer
+     *
+     */
+    ParsedData Parse(simdjson::padded_string_view response) {
+        simdjson::ondemand::document doc = parser_.Iterate(response);
+        return Dispatch(doc);
+    }
+
+  private:
+    ParsedData Dispatch(simdjson::ondemand::document& doc) {
+        auto type = DetermineType(doc);
 
         // Find the handler for the determined response type
-        auto it                          = handlers_.find(type);
+        auto it   = handlers_.find(type);
         if (it == handlers_.end()) {
             loge("No handler registered for this response type");
             return {};  // Return empty if no handler is registered
@@ -1872,7 +2032,6 @@ class ParserManager {
         return it->second(doc);
     }
 
-  private:
     ResponseType DetermineType(simdjson::ondemand::document& doc) {
         // Check if this is a depth update response
         if (doc["type"].error() == simdjson::SUCCESS &&
@@ -2000,10 +2159,9 @@ class OrderBookWebSocketResponseHandler {
 
     void HandleResponse(boost::beast::flat_buffer& fb,
                         common::TradingPair trading_pair) {
-        auto response = std::string_view(
-            static_cast<const char*>(fb.data().data()), fb.size());
-        auto answer = parser_manager_.Parse(response);
-        logi("{}", response);
+        const auto response = common::PaddedView(fb);
+        auto answer         = parser_manager_.Parse(response);
+        hlogd(kParser, "{}", std::string_view(response));
         std::visit(
             [&](auto&& snapshot) {
                 using T = std::decay_t<decltype(snapshot)>;
@@ -2021,7 +2179,7 @@ class OrderBookWebSocketResponseHandler {
     void HandleResponse(std::string_view response,
                         common::TradingPair trading_pair) {
         auto answer = parser_manager_.Parse(response);
-        logi("{}", response);
+        hlogd(kParser, "{}", response);
         std::visit(
             [&](auto&& snapshot) {
                 using T = std::decay_t<decltype(snapshot)>;
@@ -2040,7 +2198,7 @@ class OrderBookWebSocketResponseHandler {
   private:
     void ProcessBookDiffSnapshot(Exchange::BookDiffSnapshot& data,
                                  common::TradingPair trading_pair) {
-        logi("Received a BookDiffSnapshot!");
+        hlogd(kParser, "Received a BookDiffSnapshot!");
         auto request = component_.book_diff_mem_pool_.Allocate(
             &component_.book_diff_mem_pool_, data.exchange_id,
             data.trading_pair, std::move(data.bids), std::move(data.asks),
@@ -2114,13 +2272,13 @@ class BidAskGeneratorCallbackHandler {
         bid_ask_generator_.RegisterSnapshotCallback(
             [this](const Exchange::BookSnapshot& snapshot) {
                 logi("[bidaskgenerator] invoke handler for snapshot");
-                auto copy_bids = snapshot.bids;
-                auto copy_asks = snapshot.asks;
-
+                // copies share the slab of the snapshot levels, levels are
+                // not duplicated
                 auto* ptr = bid_ask_generator_.book_snapshot2_pool_.Allocate(
                     &bid_ask_generator_.book_snapshot2_pool_,
                     snapshot.exchange_id, snapshot.trading_pair,
-                    std::move(copy_bids), std::move(copy_asks), 0);
+                    Exchange::BookLevels(snapshot.bids),
+                    Exchange::BookLevels(snapshot.asks), 0);
                 auto intr_ptr =
                     boost::intrusive_ptr<Exchange::BookSnapshot2>(ptr);
                 auto bus_event =
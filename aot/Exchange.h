@@ -15,6 +15,7 @@
 #include "aot/client_response.h"
 #include "aot/common/types.h"
 #include "aot/market_data/market_update.h"
+#include "aot/order_gw/signed_request.h"
 #include "aot/third_party/emhash/hash_table7.hpp"
 #include "boost/algorithm/string.hpp"
 #include "boost/asio/awaitable.hpp"
@@ -112,8 +113,7 @@ struct EndpointKey {
      */
     constexpr bool operator==(const EndpointKey &other) const {
         return exchange == other.exchange && network == other.network &&
-                   market_type == other.market_type,
-               protocol == other.protocol;
+               market_type == other.market_type && protocol == other.protocol;
     }
 };
 
@@ -160,6 +160,22 @@ class EndpointManager {
         return std::nullopt;  // If not found, return empty value
     }
 
+    /**
+     * Replaces or adds the endpoint, e.g. to point clients at a local
+     * exchange simulator.
+     * @param exchange The exchange identifier.
+     * @param network The network type (mainnet or testnet).
+     * @param protocol The protocol type (HTTPS or WebSocket).
+     * @param endpoint The new endpoint.
+     */
+    void SetEndpoint(common::ExchangeId exchange, Network network,
+                     common::MarketType market_type, Protocol protocol,
+                     Endpoint endpoint) {
+        endpoints_.insert_or_assign(
+            EndpointKey{exchange, network, market_type, protocol},
+            std::move(endpoint));
+    }
+
   private:
     // The unordered_map that stores the endpoints with keys of type
     // EndpointKey.
@@ -340,6 +356,29 @@ class Signer : public SignerI {
     std::string_view secret_key_;
     std::string_view api_key_;
 };
+/**
+ * @brief signer of a probe request for aot::SignedRequestTemplate. Keeps the
+ * signed payload and puts aot::kSignatureMarker instead of the signature
+ */
+class TemplateSigner : public SignerI {
+  public:
+    explicit TemplateSigner(std::string_view api_key) : api_key_(api_key) {};
+    std::string Sign(std::string_view data) override {
+        payload_ = data;
+        return std::string(aot::kSignatureMarker);
+    };
+    std::string SignByLowerCase(std::string_view data) override {
+        return Sign(data);
+    }
+    std::string_view ApiKey() override { return api_key_; }
+    /// what the factory signed
+    std::string_view Payload() const { return payload_; }
+    ~TemplateSigner() override = default;
+
+  private:
+    std::string_view api_key_;
+    std::string payload_;
+};
 };  // namespace hmac_sha256
 struct TickerInfo {
     uint8_t price_precission;
@@ -22,6 +22,7 @@
 // #include "aot/Exchange.h"
 #include "aot/Logger.h"
 #include "aot/Types.h"
+#include "aot/common/awaitable_queue.h"
 #include "aot/common/mem_pool.h"
 #include "aot/root_certificates.hpp"
 #include "aot/session_status.h"
@@ -971,15 +972,21 @@ class HttpsSession3 {
  * @class ConnectionPool
  * @brief Manages a pool of reusable HTTPSessionType connections.
  *
+ * AsyncAcquire() and TryAcquire() check a ready session out to one caller at a
+ * time and Release() gives back a session that was not used, for one-shot
+ * sessions that close after their response and are replaced by the pool.
+ * AcquireConnection() leaves the session in the pool to be shared, for
+ * long-lived sessions like websockets. A pool is used one way or the other.
+ *
  * @tparam HTTPSessionType The type of session managed by the pool.
  * @tparam Args Additional arguments required to construct sessions.
  */
 template <typename HTTPSessionType, typename... Args>
 class ConnectionPool {
     /**
-     * @brief Queue of available connections.
+     * @brief Ready connections, coroutines wait for them in FIFO order.
      */
-    moodycamel::ConcurrentQueue<HTTPSessionType*> awaiable_connections_;
+    common::AwaitableQueue<HTTPSessionType*> ready_connections_;
 
     /**
      * @brief Queue of connections marked as useless or expired.
@@ -1031,8 +1038,6 @@ class ConnectionPool {
      */
     std::tuple<std::decay_t<Args>...> ctor_args_;
 
-    std::atomic_flag is_handling_session = ATOMIC_FLAG_INIT;
-
   public:
     /**
      * @brief Constructor for the connection pool.
@@ -1048,89 +1053,90 @@ class ConnectionPool {
                    HTTPSessionType::Timeout timeout, size_t pool_size,
                    const std::string_view host, const std::string_view port,
                    Args&&... args)
-        : ioc_(ioc),
+        : ready_connections_(ioc.get_executor()),
+          ioc_(ioc),
           host_(host),
           port_(port),
           pool_size_(pool_size),
           session_pool_(pool_size),
           timeout_(timeout),
           ctor_args_(std::forward<Args>(args)...) {
-        for (std::size_t i = 0; i < pool_size; ++i) {
-            try {
-                auto session = CreateSession();
-                session->RegisterOnReady([this, session]() {
-                    if (!awaiable_connections_.try_enqueue(session)) {
-                        logi("can't enqueu new session");
-                        // Лог или обработка ошибки
-                    }
-                });
-
-                session->RegisterOnSystemClosed([this, session]() {
-                    if (!is_handling_session
-                             .test_and_set()) {  // Проверка и установка флага
-                        session_pool_.Deallocate(session);
-                        TryCreateNewSession();
-                        is_handling_session.clear();  // Сброс флага
-                    }
-                });
-
-                session->RegisterOnExpired([this, session]() {
-                    if (!is_handling_session.test_and_set()) {
-                        session_pool_.Deallocate(session);
-                        TryCreateNewSession();
-                        is_handling_session.clear();
-                    }
-                });
-
-            } catch (const std::exception& e) {
-                logi("some exception here");
-                // Обработка исключений при создании сессии
-                // Например, лог ошибки
-            }
-        }
+        for (std::size_t i = 0; i < pool_size; ++i) TryCreateNewSession();
     }
 
     /**
      * @brief Acquire a connection from the pool.
      *
-     * Blocks until a ready connection is available.
+     * Blocks until a ready connection is available. The connection stays in
+     * the pool and may be returned to other callers too.
      *
      * @return Pointer to the acquired connection.
      */
     HTTPSessionType* AcquireConnection() {
-        HTTPSessionType* session = nullptr;
+        while (true) {
+            auto session = ready_connections_.TryPop();
+            if (!session) continue;
+            ready_connections_.Push(*session);
+            if ((*session)->GetStatus() == aot::StatusSession::Ready)
+                return *session;
+        }
+    }
 
-        // Block until we get a ready session
+    /**
+     * @brief Waits for a ready connection without blocking the thread.
+     *
+     * The caller is parked behind the coroutines that asked before it and is
+     * resumed when a session becomes ready or is released.
+     *
+     * @param timeout How long to wait for a session.
+     * @return Pointer to the acquired connection, nullptr on timeout.
+     */
+    net::awaitable<HTTPSessionType*> AsyncAcquire(
+        std::chrono::steady_clock::duration timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
         while (true) {
-            // Try to dequeue a session from the available connections
-            while (!awaiable_connections_.try_dequeue(session)) {
-                // Block until a ready session is available
+            auto session = co_await ready_connections_.AsyncPop(
+                deadline - std::chrono::steady_clock::now(),
+                net::use_awaitable);
+            if (!session) {
+                logw("[Connection pool] no session ready in time");
+                co_return nullptr;
             }
-            awaiable_connections_.try_enqueue(session);
-            // Check the status of the session
-            auto status = session->GetStatus();
-            if (status == aot::StatusSession::Ready) {
-                // logd("[Connection pool] session is ready");
-                break;
-            } else {
-                // logd("[Connection pool] session is not ready {}
-                // size_pool:{}", status, awaiable_connections_.size_approx());
-            }
-            // // If the session is expired or closing, release it and try
-            // another one if (status == aot::StatusSession::Expired ||
-            //     status == aot::StatusSession::Closing) {
-            //     useless_connections_.try_enqueue(session);
-            //     session = nullptr;  // Try to get a new session
-            // } else if (status != aot::StatusSession::Ready) {
-            //     // If the session is not ready, enqueue it back to the queue
-            //     for a retry awaiable_connections_.try_enqueue(session);
-            //     session = nullptr;  // Try to get another session
-            // } else {
-            //     // Copy the session
-            //     copy_ready_connections_.try_enqueue(session);
-            // }
+            if ((*session)->GetStatus() == aot::StatusSession::Ready)
+                co_return *session;
         }
-        return session;
+    }
+
+    /**
+     * @brief Checks out a ready connection if there is one, never waits.
+     *
+     * @return Pointer to the acquired connection, nullptr if none is ready.
+     */
+    HTTPSessionType* TryAcquire() {
+        while (auto session = ready_connections_.TryPop())
+            if ((*session)->GetStatus() == aot::StatusSession::Ready)
+                return *session;
+        return nullptr;
+    }
+
+    /**
+     * @brief Waits for a ready connection at most the session timeout.
+     */
+    net::awaitable<HTTPSessionType*> AsyncAcquire() {
+        return AsyncAcquire(timeout_);
+    }
+
+    /**
+     * @brief Returns a connection that was acquired but not used.
+     *
+     * A session that sent a request closes by itself and is replaced, so only
+     * a ready one goes back to the pool.
+     *
+     * @param session Connection got from AsyncAcquire().
+     */
+    void Release(HTTPSessionType* session) {
+        if (session && session->GetStatus() == aot::StatusSession::Ready)
+            ready_connections_.Push(session);
     }
 
     /**
@@ -1142,15 +1148,11 @@ class ConnectionPool {
      * @brief Close all sessions in the pool.
      */
     void CloseAllSessions() {
-        HTTPSessionType* session = nullptr;
+        ready_connections_.CancelWaiters();
+        while (auto session = ready_connections_.TryPop())
+            (*session)->AsyncCloseSessionGracefully();
 
-        // Disable callbacks and close available sessions from the queue
-        while (awaiable_connections_.try_dequeue(session)) {
-            if (session) {
-                session->AsyncCloseSessionGracefully();
-                // session_pool_.Deallocate(session);
-            }
-        }
+        HTTPSessionType* session = nullptr;
         while (useless_connections_.try_dequeue(session)) {
             if (session) {
                 session->AsyncCloseSessionGracefully();
@@ -1187,41 +1189,29 @@ class ConnectionPool {
     void TryCreateNewSession() {
         try {
             logi("[Connection pool] create new session");
-            // Создаем новую сессию
             auto session = CreateSession();
-            // auto shared_session = std::shared_ptr<HTTPSessionType>(session);
 
-            // Обработка события "готовности"
             session->RegisterOnReady([this, session]() {
-                if (!awaiable_connections_.try_enqueue(session)) {
-                    logi("Can't enqueue session in available_connections");
-                    // Логирование ошибки или другая обработка
-                }
+                ready_connections_.Push(session);
                 logd("[Connection pool] finished execute on ready");
             });
 
-            // Обработка события "системное закрытие"
+            // every session reports closing or expiring once, so each one
+            // is replaced by exactly one new session
             session->RegisterOnSystemClosed([this, session]() {
-                if (!is_handling_session
-                         .test_and_set()) {  // Проверка и установка флага
-                    session_pool_.Deallocate(session);
-                    logi("Session system closed. Recreating session...");
-                    TryCreateNewSession();  // Рекурсивное создание новой сессии
-                    is_handling_session.clear();  // Сброс флага
-                    logd("[Connection pool] finished execute on system closed");
-                }
+                ready_connections_.Remove(session);
+                session_pool_.Deallocate(session);
+                logi("Session system closed. Recreating session...");
+                TryCreateNewSession();
+                logd("[Connection pool] finished execute on system closed");
             });
 
-            // Обработка события "истечение срока действия"
             session->RegisterOnExpired([this, session]() {
-                if (!is_handling_session
-                         .test_and_set()) {  // Проверка и установка флага
-                    session_pool_.Deallocate(session);
-                    logi("Session expired. Recreating session...");
-                    TryCreateNewSession();  // Рекурсивное создание новой сессии
-                    is_handling_session.clear();  // Сброс флага
-                    logd("[Connection pool] finished execute on expired");
-                }
+                ready_connections_.Remove(session);
+                session_pool_.Deallocate(session);
+                logi("Session expired. Recreating session...");
+                TryCreateNewSession();
+                logd("[Connection pool] finished execute on expired");
             });
 
         } catch (const std::exception& e) {
@@ -1,8 +1,19 @@
 #pragma once
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <memory>
+#include <mutex>
+#include <stop_token>
 #include <string_view>
 #include <iostream>
+#include <thread>
 
 #define FMT_HEADER_ONLY
 #include "aot/third_party/fmt/core.h"
@@ -17,6 +28,7 @@
 #include "aot/third_party/fmtlog.h"
 #include "boost/asio.hpp"
 #include "boost/asio/awaitable.hpp"
+#include "aot/common/thread_utils.h"
 
 struct LogPolling {
     std::shared_ptr<boost::asio::steady_timer> timer;
@@ -61,4 +73,73 @@ struct LogPolling {
             timer->expires_after(interval);
         }
     }
-};
\ No newline at end of file
+};
+
+struct LogPollingOptions {
+    /// interval while there are messages in the queues of fmtlog
+    std::chrono::microseconds min_interval{50};
+    /// the interval doubles after every idle poll up to max_interval
+    std::chrono::microseconds max_interval{10'000};
+    /// -1 means any core
+    int core_id = -1;
+    /// nice of the poller thread, it must not take cores of hot threads
+    int nice    = 19;
+};
+
+/**
+ * @brief polls fmtlog on a dedicated low priority thread.
+ *
+ * Unlike LogPolling it does not take turns on the thread pool of the
+ * exchanges. The interval adapts: it drops to min_interval once a poll finds
+ * messages and backs off exponentially while the queues are empty. The last
+ * poll on Stop() flushes the log file.
+ */
+class LogPollingThread {
+  public:
+    explicit LogPollingThread(const LogPollingOptions& options = {})
+        : options_(options),
+          thread_([this](std::stop_token stop) { Run(stop); }) {}
+    ~LogPollingThread() { Stop(); }
+
+    void Stop() {
+        if (!thread_.joinable()) return;
+        thread_.request_stop();
+        thread_.join();
+    }
+
+    LogPollingThread(const LogPollingThread&)            = delete;
+    LogPollingThread& operator=(const LogPollingThread&) = delete;
+
+  private:
+    /// Only the poller thread reads the queues, so it may peek at them.
+    static bool HasPending() {
+        for (auto& node : fmtlogDetailWrapper<>::impl.bgThreadBuffers)
+            if (node.header || node.tb->varq.front()) return true;
+        return false;
+    }
+
+    void Run(std::stop_token stop) {
+        pthread_setname_np(pthread_self(), "log_poller");
+        if (options_.core_id >= 0 && !common::setThreadCore(options_.core_id))
+            logw("can't pin log poller to core {}", options_.core_id);
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)),
+                        options_.nice) != 0)
+            logw("can't set nice {} for log poller", options_.nice);
+
+        std::mutex mutex;
+        std::condition_variable_any cv;
+        auto interval = options_.min_interval;
+        while (!stop.stop_requested()) {
+            const bool busy = HasPending();
+            fmtlog::poll();
+            interval        = busy ? options_.min_interval
+                                   : std::min(interval * 2, options_.max_interval);
+            std::unique_lock lock(mutex);
+            cv.wait_for(lock, stop, interval, [] { return false; });
+        }
+        fmtlog::poll(true);
+    }
+
+    LogPollingOptions options_;
+    std::jthread thread_;
+};
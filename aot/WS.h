@@ -22,7 +22,10 @@
 #include "aot/Logger.h"
 #include "aot/Types.h"
 #include "aot/cb_manager.h"
+#include "aot/common/json_parser.h"
+#include "aot/hot_log.h"
 #include "aot/session_status.h"
+#include "aot/ws_read_pipeline.h"
 #include "boost/asio.hpp"
 #include "boost/asio/awaitable.hpp"
 #include "boost/asio/this_coro.hpp"
@@ -417,17 +420,29 @@ class WssSession3 {
     aot::StatusSession status_ = aot::StatusSession::Resolving;
     boost::asio::strand<boost::asio::io_context::executor_type> strand_;
     boost::asio::strand<boost::asio::io_context::executor_type> write_strand_;
-    boost::asio::thread_pool thread_pool_;
     moodycamel::ConcurrentQueue<std::string> message_queue_;
     bool is_writing_ = false;
+    /**
+     * @brief hand-off of frames to the parser, nullptr for
+     * aot::WsParseMode::kInline
+     *
+     */
+    std::unique_ptr<aot::WsReadPipeline> read_pipeline_;
     // boost::asio::strand<boost::asio::thread_pool::executor_type>
     // write_strand_;
   public:
     virtual ~WssSession3() = default;
+    /**
+     * @param read_pipeline where frames are parsed. By default on the
+     * io_context before the next async_read, with kPinnedThread or
+     * kThreadPool the reader only hands frames to the parser, callbacks on
+     * response are invoked on the parser thread
+     */
     explicit WssSession3(boost::asio::io_context& ioc, ssl::context& ctx,
                          _Timeout timeout, const std::string_view host,
                          const std::string_view port,
-                         const std::string_view default_endpoint)
+                         const std::string_view default_endpoint,
+                         const aot::WsReadPipelineOptions& read_pipeline = {})
         : resolver_(net::make_strand(ioc)),
           stream_(net::make_strand(ioc), ctx),
           ioc_(ioc),
@@ -440,6 +455,13 @@ class WssSession3 {
           default_endpoint_(default_endpoint),
           timer_(ioc)  // Initialize the timer
     {
+        // depth messages fit the buffer, it is not reallocated on the hot path
+        buffer_.reserve(common::kJsonReadBufferCapacity);
+        if (read_pipeline.mode != aot::WsParseMode::kInline)
+            read_pipeline_ = std::make_unique<aot::WsReadPipeline>(
+                read_pipeline, [this](beast::flat_buffer& frame) {
+                    cb_on_response_manager_.InvokeAll(frame);
+                });
         // Register cancellation handler for the entire session
         cancel_signal_.slot().assign(
             [this](boost::asio::cancellation_type type) {
@@ -502,6 +524,11 @@ class WssSession3 {
     inline bool IsConnected() const { return is_connected_; }
     inline bool IsExpired() const { return is_expired_; }
     inline bool IsUsed() const { return is_used_; }
+    /// Depth and latency of the read -> parse hand-off, empty in kInline mode.
+    aot::WsReadPipelineStats ReadPipelineStats() const {
+        return read_pipeline_ ? read_pipeline_->Stats()
+                              : aot::WsReadPipelineStats{};
+    }
     void AsyncCloseSessionGracefully() {
         cancel_signal_.emit(boost::asio::cancellation_type::all);
     }
@@ -655,9 +682,13 @@ class WssSession3 {
     }
 
     net::awaitable<void> ReadLoop() {
+        if (read_pipeline_) {
+            co_await PipelinedReadLoop();
+            co_return;
+        }
         // beast::flat_buffer buffer;
         while (need_read_) {
-            logi("start async read");
+            hlogd(kWs, "start async read");
 
             boost::system::error_code read_ec;
             std::size_t n = 0;
@@ -665,7 +696,7 @@ class WssSession3 {
             // Создаём корутину для чтения, гарантируя последовательность
             // операций
             try {
-                logi("try async_read");
+                hlogd(kWs, "try async_read");
                 // Выполняем чтение данных
                 auto result = co_await stream_.async_read(
                     buffer_,
@@ -688,15 +719,15 @@ class WssSession3 {
                 }
             }
 
-            logi("invoke callback received_bytes:{}", n);
+            hlogd(kWs, "invoke callback received_bytes:{}", n);
 
             // Выполняем коллбеки только если есть данные
             if (n > 0) {
-                //std::span<const char> data_span(static_cast<const char*>(buffer_.data().data()), buffer_.size());
-                //co_await HandleDataInThreadPool(data_span);
+                // parsers read the message in place with simdjson
+                common::ReserveJsonPadding(buffer_);
                 cb_on_response_manager_.InvokeAll(buffer_);
             } else {
-                logd("No data was read");
+                hlogd(kWs, "No data was read");
             }
 
                 // Освобождаем потребленные данные из буфера
@@ -708,6 +739,42 @@ class WssSession3 {
         logd("start execute cb when close session");
     }
 
+    /**
+     * @brief read loop of kPinnedThread and kThreadPool modes. Frames are read
+     * straight into the ring of the pipeline, the next async_read is issued
+     * as soon as a frame is published. If the parser is a whole ring behind
+     * the reader backs off for kReadBackoff
+     */
+    net::awaitable<void> PipelinedReadLoop() {
+        static constexpr auto kReadBackoff = std::chrono::microseconds(50);
+        net::steady_timer backoff(co_await net::this_coro::executor);
+        while (need_read_) {
+            auto* frame = read_pipeline_->AcquireWrite();
+            if (!frame) [[unlikely]] {
+                backoff.expires_after(kReadBackoff);
+                co_await backoff.async_wait(
+                    boost::asio::as_tuple(boost::asio::use_awaitable));
+                continue;
+            }
+            auto [read_ec, n] = co_await stream_.async_read(
+                *frame, boost::asio::as_tuple(boost::asio::use_awaitable));
+            if (read_ec) {
+                if (read_ec != boost::asio::error::operation_aborted)
+                    loge("Read error: {}", read_ec.message());
+                frame->consume(frame->size());
+                break;
+            }
+            if (n == 0) [[unlikely]] {
+                hlogd(kWs, "No data was read");
+                continue;
+            }
+            read_pipeline_->Publish();
+        }
+        logi("finished read");
+        read_pipeline_->Stop();
+        CloseSessionFast();
+    }
+
     void TransitionTo(aot::StatusSession new_state) {
         if (status_ == new_state) return;
 
@@ -726,22 +793,6 @@ class WssSession3 {
                 break;
         }
     }
-
-    // net::awaitable<void> HandleDataInThreadPool(std::span<const char> data_span) {
-    //     // Используем boost::asio::co_spawn для работы с пулом потоков
-    //     co_await boost::asio::co_spawn(thread_pool_, [this, data_span]() -> net::awaitable<void> {
-    //         logi("Processing data in thread pool");
-    //         std::string_view data_view(data_span.data(), data_span.size());
-    //         // Здесь происходит обработка данных
-    //         // Например, можно передать данные в обработчик коллбеков
-    //         // cb_on_response_manager_.InvokeAll(data_span);
-    //         cb_on_response_manager_.InvokeAll(data_view);
-    //         // Эмулируем задержку обработки
-    //         co_return;
-    //     }, boost::asio::detached);
-
-    //     co_return;
-    // }
 };
 
 // template <typename _Timeout>
@@ -0,0 +1,835 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/backtesting/replay.h"
+#include "aot/common/time_utils.h"
+#include "aot/common/types.h"
+#include "aot/market_data/market_update.h"
+
+namespace backtesting {
+static_assert(std::endian::native == std::endian::little,
+              "tick captures are written in little endian");
+
+/**
+ * Tick capture file, append-only:
+ *
+ *   CaptureFileHeader
+ *   CaptureBlockHeader + payload   (repeated)
+ *   CaptureBlockHeader + index     (written by Close())
+ *   CaptureFooter                  (written by Close())
+ *
+ * A block holds either new entries of the instrument dictionary of the file
+ * or records of whole events. Dictionary blocks come before the first record
+ * of their instruments. Records are stored as they are (kRecords, read
+ * without copying from the mapping) or packed (kPackedRecords): every field
+ * is a zigzag varint of the delta to the previous record of the block, so a
+ * block is decoded on its own. The index lists all blocks with their times.
+ * A file of a crashed writer has no index and no footer, the reader rebuilds
+ * the index from the block headers and drops an incomplete last block.
+ */
+enum class TickType : uint8_t { kSnapshot, kDiff, kMarketUpdate, kBBO, kKline };
+
+/// the value of a kline record, the volume is the qty of kClose
+enum class KlineField : uint8_t { kOpen, kHigh, kLow, kClose };
+
+/**
+ * @brief fixed layout record. A snapshot or a diff has a record per level, a
+ * BBO a record per side, a kline a record per KlineField and a market update
+ * one record. The last record of an event has kEventEnd set, an event
+ * without levels has one record with side kInvalid
+ */
+struct TickRecord {
+    static constexpr uint8_t kEventEnd = 1;
+    common::Nanos time                 = 0;
+    common::Price price                = common::kPriceInvalid;
+    common::Qty qty                    = common::kQtyInvalid;
+    /// first update id of a diff, order id of a market update
+    uint64_t first_id                  = 0;
+    /// last update id of a diff or a snapshot
+    uint64_t last_id                   = 0;
+    /// index in the instrument dictionary of the file
+    uint32_t instrument                = 0;
+    TickType type                      = TickType::kDiff;
+    common::Side side                  = common::Side::kInvalid;
+    uint8_t flags                      = 0;
+    /// KlineField of a kline, Exchange::MarketUpdateType of a market update
+    uint8_t field                      = 0;
+    bool EventEnd() const { return flags & kEventEnd; }
+};
+static_assert(std::is_trivially_copyable_v<TickRecord>);
+static_assert(sizeof(TickRecord) == 48);
+
+/// entry of the instrument dictionary
+struct CaptureInstrument {
+    uint32_t base;   ///< common::TradingPair::first
+    uint32_t quote;  ///< common::TradingPair::second
+    uint8_t exchange_id;
+    uint8_t market_type;
+    uint8_t price_precision;
+    uint8_t qty_precision;
+    uint32_t reserved = 0;
+    common::ExchangeId ExchangeId() const {
+        return static_cast<common::ExchangeId>(exchange_id);
+    }
+    common::MarketType MarketType() const {
+        return static_cast<common::MarketType>(market_type);
+    }
+    common::TradingPair TradingPair() const { return {base, quote}; }
+};
+static_assert(sizeof(CaptureInstrument) == 16);
+
+struct CaptureFileHeader {
+    static constexpr uint32_t kMagic   = 0x314b4354;  // "TCK1"
+    static constexpr uint16_t kVersion = 1;
+    uint32_t magic                     = kMagic;
+    uint16_t version                   = kVersion;
+    uint16_t record_size               = sizeof(TickRecord);
+    common::Nanos created              = 0;
+};
+static_assert(sizeof(CaptureFileHeader) == 16);
+
+enum class CaptureBlockType : uint32_t {
+    kInstruments,
+    kRecords,
+    kPackedRecords,
+    kIndex
+};
+
+/// payloads are padded to 8 bytes, records of the mapping stay aligned
+struct CaptureBlockHeader {
+    CaptureBlockType type    = CaptureBlockType::kRecords;
+    /// instruments, records or index entries
+    uint32_t count           = 0;
+    /// bytes of the payload with the padding
+    uint64_t size            = 0;
+    common::Nanos first_time = 0;
+    common::Nanos last_time  = 0;
+};
+static_assert(sizeof(CaptureBlockHeader) == 32);
+
+struct CaptureIndexEntry {
+    common::Nanos first_time = 0;
+    common::Nanos last_time  = 0;
+    /// offset of CaptureBlockHeader in the file
+    uint64_t offset          = 0;
+    uint32_t count           = 0;
+    CaptureBlockType type    = CaptureBlockType::kRecords;
+};
+static_assert(sizeof(CaptureIndexEntry) == 32);
+
+struct CaptureFooter {
+    static constexpr uint32_t kMagic = 0x58444e49;  // "INDX"
+    uint64_t index_offset            = 0;
+    uint32_t magic                   = kMagic;
+    uint32_t reserved                = 0;
+};
+static_assert(sizeof(CaptureFooter) == 16);
+
+namespace detail {
+inline uint64_t ZigZag(uint64_t delta) {
+    return (delta << 1) ^
+           static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
+inline uint64_t UnZigZag(uint64_t value) {
+    return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+inline void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+/// false if the varint runs out of [it, end)
+inline bool GetVarint(const uint8_t*& it, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && it != end; shift += 7) {
+        const uint8_t byte  = *it++;
+        value              |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+inline void PutDelta(std::vector<uint8_t>& out, uint64_t value,
+                     uint64_t previous) {
+    PutVarint(out, ZigZag(value - previous));
+}
+inline bool GetDelta(const uint8_t*& it, const uint8_t* end, uint64_t& value) {
+    uint64_t delta;
+    if (!GetVarint(it, end, delta)) return false;
+    value += UnZigZag(delta);
+    return true;
+}
+inline uint64_t Padded(uint64_t size) { return (size + 7) & ~uint64_t{7}; }
+}  // namespace detail
+
+struct CaptureOptions {
+    /// records of a block, a block ends on the first event end after it
+    size_t block_records = 4096;
+    /// delta and varint compression of records
+    bool packed          = false;
+};
+
+/**
+ * @brief writes a tick capture file. Not thread safe, times of the events
+ * must not go back. The file stays readable after a crash up to the last
+ * flushed block
+ */
+class CaptureWriter {
+  public:
+    explicit CaptureWriter(CaptureOptions options = {})
+        : options_(options) {
+        options_.block_records = std::max<size_t>(options_.block_records, 1);
+        block_.reserve(options_.block_records + Exchange::kInlineBookLevels);
+    }
+    ~CaptureWriter() { Close(); }
+    CaptureWriter(const CaptureWriter&)            = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /// creates the file or truncates an existing one
+    bool Open(std::string_view path) {
+        Close();
+        file_ = std::fopen(std::string(path).c_str(), "wb");
+        if (!file_) {
+            loge("can't open capture {}: {}", path, std::strerror(errno));
+            return false;
+        }
+        std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+        offset_ = 0;
+        index_.clear();
+        instruments_.clear();
+        keys_.clear();
+        new_instruments_ = 0;
+        records_         = 0;
+        CaptureFileHeader header;
+        header.created = common::getCurrentNanoS();
+        return WriteBytes(&header, sizeof(header));
+    }
+    bool IsOpen() const { return file_ != nullptr; }
+
+    /**
+     * @brief id of the instrument in the dictionary of the file, added on the
+     * first call
+     *
+     * @param info precisions of the pair, nullptr leaves them 0
+     */
+    uint32_t Instrument(common::ExchangeId exchange_id,
+                        common::MarketType market_type,
+                        common::TradingPair trading_pair,
+                        const common::TradingPairInfo* info = nullptr) {
+        const Key key{trading_pair.first, trading_pair.second,
+                      static_cast<uint8_t>(exchange_id),
+                      static_cast<uint8_t>(market_type)};
+        auto [it, inserted] = keys_.try_emplace(
+            key, static_cast<uint32_t>(instruments_.size()));
+        if (inserted) {
+            instruments_.push_back(
+                {.base            = trading_pair.first,
+                 .quote           = trading_pair.second,
+                 .exchange_id     = key.exchange_id,
+                 .market_type     = key.market_type,
+                 .price_precision = info ? info->price_precission : uint8_t{0},
+                 .qty_precision   = info ? info->qty_precission : uint8_t{0}});
+            ++new_instruments_;
+        }
+        return it->second;
+    }
+
+    void Write(common::Nanos time, uint32_t instrument,
+               const Exchange::BookSnapshot2& snapshot) {
+        WriteLevels(time, instrument, TickType::kSnapshot, snapshot.bids,
+                    snapshot.asks, 0, snapshot.lastUpdateId);
+    }
+    void Write(common::Nanos time, uint32_t instrument,
+               const Exchange::BookDiffSnapshot2& diff) {
+        WriteLevels(time, instrument, TickType::kDiff, diff.bids, diff.asks,
+                    diff.first_id, diff.last_id);
+    }
+    void Write(common::Nanos time, uint32_t instrument,
+               const Exchange::MEMarketUpdate2& update) {
+        Add({.time       = time,
+             .price      = update.price,
+             .qty        = update.qty,
+             .first_id   = update.order_id,
+             .instrument = instrument,
+             .type       = TickType::kMarketUpdate,
+             .side       = update.side,
+             .flags      = TickRecord::kEventEnd,
+             .field      = static_cast<uint8_t>(update.type)});
+        EndEvent();
+    }
+    void WriteBBO(common::Nanos time, uint32_t instrument,
+                  common::Price bid_price, common::Qty bid_qty,
+                  common::Price ask_price, common::Qty ask_qty) {
+        Add({.time       = time,
+             .price      = bid_price,
+             .qty        = bid_qty,
+             .instrument = instrument,
+             .type       = TickType::kBBO,
+             .side       = common::Side::kBid});
+        Add({.time       = time,
+             .price      = ask_price,
+             .qty        = ask_qty,
+             .instrument = instrument,
+             .type       = TickType::kBBO,
+             .side       = common::Side::kAsk,
+             .flags      = TickRecord::kEventEnd});
+        EndEvent();
+    }
+    void WriteKline(common::Nanos time, uint32_t instrument, common::Price open,
+                    common::Price high, common::Price low, common::Price close,
+                    common::Qty volume) {
+        const common::Price prices[] = {open, high, low, close};
+        for (uint8_t field = 0; field < 4; ++field)
+            Add({.time       = time,
+                 .price      = prices[field],
+                 .qty        = field == 3 ? volume : 0,
+                 .instrument = instrument,
+                 .type       = TickType::kKline,
+                 .flags      = field == 3 ? TickRecord::kEventEnd : uint8_t{0},
+                 .field      = field});
+        EndEvent();
+    }
+
+    /// writes the started block and flushes the file
+    bool Flush() {
+        if (!file_) return false;
+        bool status = WriteBlock();
+        status      = std::fflush(file_) == 0 && status;
+        return status;
+    }
+    /// writes the index and the footer, the file can't be appended after it
+    bool Close() {
+        if (!file_) return true;
+        bool status = WriteBlock();
+        CaptureFooter footer{.index_offset = offset_};
+        CaptureBlockHeader header{
+            .type  = CaptureBlockType::kIndex,
+            .count = static_cast<uint32_t>(index_.size()),
+            .size  = index_.size() * sizeof(CaptureIndexEntry)};
+        if (!index_.empty()) {
+            header.first_time = index_.front().first_time;
+            header.last_time  = index_.back().last_time;
+        }
+        status = WriteBytes(&header, sizeof(header)) && status;
+        status = WriteBytes(index_.data(), header.size) && status;
+        status = WriteBytes(&footer, sizeof(footer)) && status;
+        status = std::fclose(file_) == 0 && status;
+        file_  = nullptr;
+        if (!status) loge("can't close capture");
+        return status;
+    }
+
+    uint64_t Records() const { return records_; }
+    size_t Instruments() const { return instruments_.size(); }
+
+  private:
+    struct Key {
+        uint32_t base;
+        uint32_t quote;
+        uint8_t exchange_id;
+        uint8_t market_type;
+        bool operator==(const Key&) const = default;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>{}(
+                (static_cast<uint64_t>(key.base) << 32 | key.quote) ^
+                (static_cast<uint64_t>(key.exchange_id) << 56 |
+                 static_cast<uint64_t>(key.market_type) << 48));
+        }
+    };
+
+    void WriteLevels(common::Nanos time, uint32_t instrument, TickType type,
+                     const Exchange::BookLevels& bids,
+                     const Exchange::BookLevels& asks, uint64_t first_id,
+                     uint64_t last_id) {
+        TickRecord record{.time       = time,
+                          .first_id   = first_id,
+                          .last_id    = last_id,
+                          .instrument = instrument,
+                          .type       = type};
+        const size_t first = block_.size();
+        record.side        = common::Side::kBid;
+        for (const auto& level : bids) {
+            record.price = level.price;
+            record.qty   = level.qty;
+            Add(record);
+        }
+        record.side = common::Side::kAsk;
+        for (const auto& level : asks) {
+            record.price = level.price;
+            record.qty   = level.qty;
+            Add(record);
+        }
+        if (block_.size() == first) {
+            record.side = common::Side::kInvalid;
+            Add(record);
+        }
+        block_.back().flags |= TickRecord::kEventEnd;
+        EndEvent();
+    }
+    void Add(const TickRecord& record) {
+        block_.push_back(record);
+        ++records_;
+    }
+    void EndEvent() {
+        if (block_.size() >= options_.block_records) WriteBlock();
+    }
+
+    bool WriteBlock() {
+        if (!file_) return false;
+        bool status = true;
+        if (new_instruments_) {
+            const auto* first =
+                instruments_.data() + instruments_.size() - new_instruments_;
+            CaptureBlockHeader header{
+                .type  = CaptureBlockType::kInstruments,
+                .count = static_cast<uint32_t>(new_instruments_),
+                .size  = new_instruments_ * sizeof(CaptureInstrument)};
+            index_.push_back({.offset = offset_,
+                              .count  = header.count,
+                              .type   = header.type});
+            status           = WriteBytes(&header, sizeof(header)) &&
+                               WriteBytes(first, header.size);
+            new_instruments_ = 0;
+        }
+        if (block_.empty()) return status;
+        CaptureBlockHeader header{
+            .count      = static_cast<uint32_t>(block_.size()),
+            .first_time = block_.front().time,
+            .last_time  = block_.back().time};
+        const void* payload = block_.data();
+        if (options_.packed) {
+            Pack();
+            header.type = CaptureBlockType::kPackedRecords;
+            header.size = detail::Padded(packed_.size());
+            packed_.resize(header.size, 0);
+            payload = packed_.data();
+        } else {
+            header.type = CaptureBlockType::kRecords;
+            header.size = block_.size() * sizeof(TickRecord);
+        }
+        index_.push_back({.first_time = header.first_time,
+                          .last_time  = header.last_time,
+                          .offset     = offset_,
+                          .count      = header.count,
+                          .type       = header.type});
+        status = WriteBytes(&header, sizeof(header)) &&
+                 WriteBytes(payload, header.size) && status;
+        block_.clear();
+        return status;
+    }
+    void Pack() {
+        packed_.clear();
+        TickRecord previous{.time = 0, .price = 0, .qty = 0};
+        for (const auto& record : block_) {
+            detail::PutDelta(packed_, record.time, previous.time);
+            detail::PutVarint(packed_, record.instrument);
+            packed_.push_back(static_cast<uint8_t>(record.type));
+            packed_.push_back(static_cast<uint8_t>(record.side));
+            packed_.push_back(record.flags);
+            packed_.push_back(record.field);
+            detail::PutDelta(packed_, record.price, previous.price);
+            detail::PutDelta(packed_, record.qty, previous.qty);
+            detail::PutDelta(packed_, record.first_id, previous.first_id);
+            detail::PutDelta(packed_, record.last_id, previous.last_id);
+            previous = record;
+        }
+    }
+    bool WriteBytes(const void* data, size_t size) {
+        if (std::fwrite(data, 1, size, file_) != size) {
+            loge("can't write capture: {}", std::strerror(errno));
+            return false;
+        }
+        offset_ += size;
+        return true;
+    }
+
+    CaptureOptions options_;
+    std::FILE* file_ = nullptr;
+    uint64_t offset_ = 0;
+    std::vector<TickRecord> block_;
+    std::vector<uint8_t> packed_;
+    std::vector<CaptureIndexEntry> index_;
+    std::vector<CaptureInstrument> instruments_;
+    std::unordered_map<Key, uint32_t, KeyHash> keys_;
+    size_t new_instruments_ = 0;
+    uint64_t records_       = 0;
+};
+
+/**
+ * @brief read-only mapping of a tick capture file. Raw blocks are read in
+ * place, nothing is copied; packed blocks are decoded into a buffer of the
+ * caller. The reader is immutable after Open(), any number of threads may
+ * read it
+ */
+class CaptureReader {
+  public:
+    CaptureReader() = default;
+    ~CaptureReader() { Close(); }
+    CaptureReader(const CaptureReader&)            = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool Open(std::string_view path) {
+        Close();
+        const std::string name(path);
+        const int fd = ::open(name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            loge("can't open capture {}: {}", path, std::strerror(errno));
+            return false;
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) != 0 ||
+            static_cast<size_t>(info.st_size) < sizeof(CaptureFileHeader)) {
+            loge("capture {} is too short", path);
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            loge("can't map capture {}: {}", path, std::strerror(errno));
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(data);
+        // blocks are read once from the beginning to the end
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+        CaptureFileHeader header;
+        std::memcpy(&header, data_, sizeof(header));
+        if (header.magic != CaptureFileHeader::kMagic ||
+            header.version != CaptureFileHeader::kVersion ||
+            header.record_size != sizeof(TickRecord)) {
+            loge("{} is not a tick capture of version {}", path,
+                 CaptureFileHeader::kVersion);
+            Close();
+            return false;
+        }
+        if (!ReadIndex()) {
+            logw("capture {} has no index, it is rebuilt from the blocks",
+                 path);
+            ScanBlocks();
+        }
+        logi("opened capture {}: {} instruments, {} blocks, {} records", path,
+             instruments_.size(), blocks_.size(), records_);
+        return true;
+    }
+    void Close() {
+        if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+        data_    = nullptr;
+        size_    = 0;
+        records_ = 0;
+        blocks_.clear();
+        instruments_.clear();
+    }
+    bool IsOpen() const { return data_ != nullptr; }
+
+    const std::vector<CaptureInstrument>& Instruments() const {
+        return instruments_;
+    }
+    /// record blocks in the order of the file
+    const std::vector<CaptureIndexEntry>& Blocks() const { return blocks_; }
+    uint64_t Records() const { return records_; }
+
+    /**
+     * @brief records of the block. The span points into the mapping for raw
+     * blocks and into buffer for packed ones, it is valid until the next call
+     * with the same buffer or Close()
+     */
+    std::span<const TickRecord> ReadBlock(
+        size_t block, std::vector<TickRecord>& buffer) const {
+        const auto& entry   = blocks_[block];
+        const auto* payload = data_ + entry.offset + sizeof(CaptureBlockHeader);
+        if (entry.type == CaptureBlockType::kRecords)
+            return {reinterpret_cast<const TickRecord*>(payload), entry.count};
+        CaptureBlockHeader header;
+        std::memcpy(&header, data_ + entry.offset, sizeof(header));
+        buffer.resize(entry.count);
+        const uint8_t* it  = payload;
+        const uint8_t* end = payload + header.size;
+        TickRecord record{.time = 0, .price = 0, .qty = 0};
+        for (uint32_t i = 0; i < entry.count; ++i) {
+            uint64_t time = static_cast<uint64_t>(record.time);
+            uint64_t instrument;
+            if (!detail::GetDelta(it, end, time) ||
+                !detail::GetVarint(it, end, instrument) || end - it < 4)
+                [[unlikely]]
+                return Corrupted(block, buffer, i);
+            record.time       = static_cast<common::Nanos>(time);
+            record.instrument = static_cast<uint32_t>(instrument);
+            record.type       = static_cast<TickType>(*it++);
+            record.side       = static_cast<common::Side>(*it++);
+            record.flags      = *it++;
+            record.field      = *it++;
+            if (!detail::GetDelta(it, end, record.price) ||
+                !detail::GetDelta(it, end, record.qty) ||
+                !detail::GetDelta(it, end, record.first_id) ||
+                !detail::GetDelta(it, end, record.last_id)) [[unlikely]]
+                return Corrupted(block, buffer, i);
+            buffer[i] = record;
+        }
+        return {buffer.data(), buffer.size()};
+    }
+
+    /// first block which may have records at time or later
+    size_t FindBlock(common::Nanos time) const {
+        return static_cast<size_t>(
+            std::partition_point(blocks_.begin(), blocks_.end(),
+                                 [time](const CaptureIndexEntry& entry) {
+                                     return entry.last_time < time;
+                                 }) -
+            blocks_.begin());
+    }
+
+  private:
+    std::span<const TickRecord> Corrupted(size_t block,
+                                          std::vector<TickRecord>& buffer,
+                                          size_t decoded) const {
+        loge("packed block {} of capture is corrupted after {} records", block,
+             decoded);
+        buffer.resize(decoded);
+        while (!buffer.empty() && !buffer.back().EventEnd()) buffer.pop_back();
+        return {buffer.data(), buffer.size()};
+    }
+
+    bool ReadIndex() {
+        if (size_ < sizeof(CaptureFileHeader) + sizeof(CaptureFooter))
+            return false;
+        CaptureFooter footer;
+        std::memcpy(&footer, data_ + size_ - sizeof(footer), sizeof(footer));
+        CaptureBlockHeader header;
+        if (footer.magic != CaptureFooter::kMagic ||
+            !ReadHeader(footer.index_offset, header) ||
+            header.type != CaptureBlockType::kIndex ||
+            header.size != header.count * sizeof(CaptureIndexEntry))
+            return false;
+        std::vector<CaptureIndexEntry> entries(header.count);
+        std::memcpy(entries.data(),
+                    data_ + footer.index_offset + sizeof(header), header.size);
+        for (const auto& entry : entries) {
+            CaptureBlockHeader block;
+            if (!ReadHeader(entry.offset, block) || block.type != entry.type) {
+                blocks_.clear();
+                instruments_.clear();
+                records_ = 0;
+                return false;
+            }
+            AddBlock(entry.offset, block);
+        }
+        return true;
+    }
+    void ScanBlocks() {
+        uint64_t offset = sizeof(CaptureFileHeader);
+        CaptureBlockHeader header;
+        while (ReadHeader(offset, header) &&
+               header.type != CaptureBlockType::kIndex) {
+            AddBlock(offset, header);
+            offset += sizeof(header) + header.size;
+        }
+        if (offset != size_)
+            logw("capture ends with {} bytes of an incomplete block",
+                 size_ - offset);
+    }
+    /// false if the header or its payload are out of the file
+    bool ReadHeader(uint64_t offset, CaptureBlockHeader& header) const {
+        if (offset % 8 || offset + sizeof(header) > size_) return false;
+        std::memcpy(&header, data_ + offset, sizeof(header));
+        return header.size <= size_ - offset - sizeof(header) &&
+               header.type <= CaptureBlockType::kIndex;
+    }
+    void AddBlock(uint64_t offset, const CaptureBlockHeader& header) {
+        const auto* payload = data_ + offset + sizeof(header);
+        switch (header.type) {
+            case CaptureBlockType::kInstruments: {
+                const size_t count = std::min<size_t>(
+                    header.count, header.size / sizeof(CaptureInstrument));
+                const size_t first = instruments_.size();
+                instruments_.resize(first + count);
+                std::memcpy(instruments_.data() + first, payload,
+                            count * sizeof(CaptureInstrument));
+                break;
+            }
+            case CaptureBlockType::kRecords:
+            case CaptureBlockType::kPackedRecords: {
+                if (header.type == CaptureBlockType::kRecords &&
+                    header.size < header.count * sizeof(TickRecord))
+                    [[unlikely]] {
+                    logw("record block at {} is too short, skipped", offset);
+                    return;
+                }
+                blocks_.push_back({.first_time = header.first_time,
+                                   .last_time  = header.last_time,
+                                   .offset     = offset,
+                                   .count      = header.count,
+                                   .type       = header.type});
+                records_ += header.count;
+                break;
+            }
+            case CaptureBlockType::kIndex:
+                break;
+        }
+    }
+
+    const uint8_t* data_ = nullptr;
+    size_t size_         = 0;
+    uint64_t records_    = 0;
+    std::vector<CaptureIndexEntry> blocks_;
+    std::vector<CaptureInstrument> instruments_;
+};
+
+/**
+ * @brief forward iterator over the records of a reader, e.g. for benchmarks
+ * which feed records straight into an order book
+ */
+class CaptureCursor {
+  public:
+    explicit CaptureCursor(const CaptureReader& reader) : reader_(reader) {
+        Load();
+    }
+
+    /// the next record is the first one at time or later
+    void Seek(common::Nanos time) {
+        block_ = reader_.FindBlock(time);
+        Load();
+        while (next_ < records_.size() && records_[next_].time < time) ++next_;
+        if (next_ == records_.size()) NextBlock();
+    }
+    void Rewind() {
+        block_ = 0;
+        Load();
+    }
+    /// nullptr at the end, the record is valid until the next block is read
+    const TickRecord* Next() {
+        if (next_ == records_.size()) [[unlikely]] {
+            if (block_ >= reader_.Blocks().size()) return nullptr;
+            NextBlock();
+            if (next_ == records_.size()) return nullptr;
+        }
+        return &records_[next_++];
+    }
+
+  private:
+    void Load() {
+        next_    = 0;
+        records_ = block_ < reader_.Blocks().size()
+                       ? reader_.ReadBlock(block_, buffer_)
+                       : std::span<const TickRecord>{};
+    }
+    void NextBlock() {
+        do {
+            ++block_;
+            Load();
+        } while (records_.empty() && block_ < reader_.Blocks().size());
+    }
+
+    const CaptureReader& reader_;
+    size_t block_ = 0;
+    size_t next_  = 0;
+    std::span<const TickRecord> records_;
+    std::vector<TickRecord> buffer_;
+};
+
+/**
+ * @brief ReplaySource of the snapshots, diffs and market updates of a
+ * capture. BBO and klines are derived data and are skipped, order books of
+ * the replay compute them again
+ */
+class CaptureReplaySource : public ReplaySource {
+  public:
+    /**
+     * @param pool_size events of each kind alive at once, the engine releases
+     * an event once its handlers are done
+     * @param from replay starts at this time
+     */
+    CaptureReplaySource(const CaptureReader& reader, size_t pool_size = 1024,
+                        common::Nanos from = 0)
+        : reader_(reader),
+          cursor_(reader),
+          snapshot_pool_(pool_size),
+          diff_pool_(pool_size),
+          market_update_pool_(pool_size) {
+        cursor_.Seek(from);
+    }
+
+    bool Next(ReplayEvent& event) override {
+        Exchange::BookLevels bids;
+        Exchange::BookLevels asks;
+        while (const auto* record = cursor_.Next()) {
+            if (record->type == TickType::kBBO ||
+                record->type == TickType::kKline ||
+                record->instrument >= reader_.Instruments().size())
+                continue;
+            if (record->type != TickType::kMarketUpdate) {
+                if (record->side == common::Side::kBid)
+                    bids.emplace_back(record->price, record->qty);
+                else if (record->side == common::Side::kAsk)
+                    asks.emplace_back(record->price, record->qty);
+            }
+            if (!record->EventEnd()) continue;
+            const auto& instrument = reader_.Instruments()[record->instrument];
+            event.time             = record->time;
+            switch (record->type) {
+                case TickType::kSnapshot:
+                    event.payload =
+                        boost::intrusive_ptr<Exchange::BookSnapshot2>(
+                            snapshot_pool_.Allocate(
+                                &snapshot_pool_, instrument.ExchangeId(),
+                                instrument.TradingPair(), std::move(bids),
+                                std::move(asks), record->last_id));
+                    break;
+                case TickType::kDiff:
+                    event.payload =
+                        boost::intrusive_ptr<Exchange::BookDiffSnapshot2>(
+                            diff_pool_.Allocate(
+                                &diff_pool_, instrument.ExchangeId(),
+                                instrument.TradingPair(), std::move(bids),
+                                std::move(asks), record->first_id,
+                                record->last_id));
+                    break;
+                default:
+                    event.payload =
+                        boost::intrusive_ptr<Exchange::MEMarketUpdate2>(
+                            market_update_pool_.Allocate(
+                                &market_update_pool_, instrument.ExchangeId(),
+                                instrument.TradingPair(),
+                                static_cast<Exchange::MarketUpdateType>(
+                                    record->field),
+                                record->first_id, record->side, record->price,
+                                record->qty));
+                    break;
+            }
+            return true;
+        }
+        return false;
+    }
+
+  private:
+    const CaptureReader& reader_;
+    CaptureCursor cursor_;
+    Exchange::BookSnapshot2Pool snapshot_pool_;
+    Exchange::BookDiff2SnapshotPool diff_pool_;
+    Exchange::MEMarketUpdate2Pool market_update_pool_;
+};
+}  // namespace backtesting
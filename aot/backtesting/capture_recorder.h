@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+
+#include "aot/Logger.h"
+#include "aot/backtesting/capture.h"
+#include "aot/bus/bus_component.h"
+#include "aot/common/exchange_trading_pair.h"
+#include "aot/common/time_utils.h"
+#include "aot/common/types.h"
+#include "aot/market_data/market_update.h"
+#include "aot/strategy/market_order.h"
+#include "boost/asio/any_io_executor.hpp"
+#include "boost/asio/post.hpp"
+
+namespace backtesting {
+/**
+ * @brief records live market data of the bus into a CaptureWriter.
+ *
+ * Subscribe the recorder to the components which publish snapshots and diffs
+ * (the bid ask generator or the replay feed) and to OrderBookComponent for
+ * BBO. An event is stamped with getCurrentNanoS() when the bus delivers it,
+ * the writer runs on executor so disk writes don't hold the publisher. The
+ * executor must not run two handlers at once, e.g. a strand or a thread of
+ * its own. Publishers on several threads may post events out of the order of
+ * their stamps, a stamp older than the last written one is raised to it, as
+ * CaptureWriter needs non-decreasing times. Depth events don't carry their market type, it is given to the
+ * recorder like to OrderBookComponent.
+ *
+ * @code
+ * backtesting::CaptureWriter writer;
+ * writer.Open("btcusdt-2024-06-01.tck");
+ * backtesting::CaptureRecorder recorder(strand, writer,
+ *                                       common::MarketType::kSpot, &pairs);
+ * bus.Subscribe(&generator, &recorder);
+ * bus.Subscribe(&order_book, &recorder);
+ * @endcode
+ */
+class CaptureRecorder : public bus::Component {
+  public:
+    /**
+     * @param pairs precisions of the instrument dictionary, may be nullptr
+     */
+    CaptureRecorder(boost::asio::any_io_executor executor,
+                    CaptureWriter& writer, common::MarketType market_type,
+                    const aot::ExchangeTradingPairs* pairs = nullptr)
+        : executor_(std::move(executor)),
+          writer_(writer),
+          market_type_(market_type),
+          pairs_(pairs) {}
+    ~CaptureRecorder() override = default;
+
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot> event)
+        override {
+        if (!event || !event->WrappedEvent()) [[unlikely]]
+            return;
+        Record(std::move(event));
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot> event)
+        override {
+        if (!event || !event->WrappedEvent()) [[unlikely]]
+            return;
+        Record(std::move(event));
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2> event)
+        override {
+        if (!event || !event->WrappedEvent()) [[unlikely]]
+            return;
+        Record(std::move(event));
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::MEMarketUpdate2Envelope> event)
+        override {
+        if (!event) [[unlikely]]
+            return;
+        Record(std::move(event));
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope> event) override {
+        if (!event) [[unlikely]]
+            return;
+        Record(std::move(event));
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::BusEventNewBBO> event) override {
+        if (!event || !event->WrappedEvent()) [[unlikely]]
+            return;
+        Record(std::move(event));
+    }
+
+    /// flushes the started block of the writer on the executor
+    void AsyncFlush() {
+        boost::asio::post(executor_, [this]() { writer_.Flush(); });
+    }
+
+  private:
+    /// event is kept alive until it is written
+    template <class Event>
+    void Record(boost::intrusive_ptr<Event> event) {
+        const auto time = common::getCurrentNanoS();
+        boost::asio::post(executor_, [this, time, event = std::move(event)]() {
+            last_time_ = std::max(last_time_, time);
+            Write(last_time_, *event->WrappedEvent());
+        });
+    }
+
+    template <class Event>
+    uint32_t Instrument(const Event& event, common::MarketType market_type) {
+        return writer_.Instrument(
+            event.exchange_id, market_type, event.trading_pair,
+            pairs_ ? pairs_->GetPairInfo(event.exchange_id, event.trading_pair)
+                   : nullptr);
+    }
+    void Write(common::Nanos time, const Exchange::BookSnapshot2& event) {
+        writer_.Write(time, Instrument(event, market_type_), event);
+    }
+    void Write(common::Nanos time, const Exchange::BookDiffSnapshot2& event) {
+        writer_.Write(time, Instrument(event, market_type_), event);
+    }
+    void Write(common::Nanos time, const Exchange::MEMarketUpdate2& event) {
+        writer_.Write(time, Instrument(event, market_type_), event);
+    }
+    void Write(common::Nanos time, const Trading::NewBBO& event) {
+        writer_.WriteBBO(time, Instrument(event, event.market_type),
+                         event.bbo.bid_price, event.bbo.bid_qty,
+                         event.bbo.ask_price, event.bbo.ask_qty);
+    }
+
+    boost::asio::any_io_executor executor_;
+    CaptureWriter& writer_;
+    common::MarketType market_type_;
+    const aot::ExchangeTradingPairs* pairs_;
+    /// stamp of the last written event, only the executor touches it
+    common::Nanos last_time_ = 0;
+};
+}  // namespace backtesting
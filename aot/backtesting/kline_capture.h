@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include "aot/Exchange.h"
+#include "aot/Logger.h"
+#include "aot/backtesting/capture.h"
+
+namespace backtesting {
+/**
+ * @brief OHLCVGetter of the klines of one instrument of a tick capture. Klines
+ * are read from the mapping of the file one by one, unlike OHLCVI nothing is
+ * parsed and the history is not copied
+ */
+class OHLCVICapture : public OHLCVGetter {
+  public:
+    /**
+     * @param instrument index in reader.Instruments()
+     */
+    OHLCVICapture(const CaptureReader& reader, uint32_t instrument)
+        : reader_(reader), cursor_(reader), instrument_(instrument) {}
+    void Init(OHLCVILFQueue& lf_queue) override {
+        lf_queue_ = &lf_queue;
+        cursor_.Rewind();
+        pending_ = false;
+    }
+    bool LaunchOne() override {
+        if (lf_queue_ == nullptr) [[unlikely]]
+            return false;
+        if (!pending_) pending_ = ReadKline();
+        if (!pending_) [[unlikely]] {
+            logw("no more klines in capture");
+            return false;
+        }
+        if (lf_queue_->try_enqueue(kline_)) [[likely]]
+            pending_ = false;
+        else
+            logw("can't push data to queue. probably queue is full");
+        return true;
+    }
+
+  private:
+    bool ReadKline() {
+        if (instrument_ >= reader_.Instruments().size()) [[unlikely]]
+            return false;
+        kline_.trading_pair = reader_.Instruments()[instrument_].TradingPair();
+        while (const auto* record = cursor_.Next()) {
+            if (record->type != TickType::kKline ||
+                record->instrument != instrument_)
+                continue;
+            switch (static_cast<KlineField>(record->field)) {
+                case KlineField::kOpen:
+                    kline_.ohlcv.open = record->price;
+                    break;
+                case KlineField::kHigh:
+                    kline_.ohlcv.high = record->price;
+                    break;
+                case KlineField::kLow:
+                    kline_.ohlcv.low = record->price;
+                    break;
+                case KlineField::kClose:
+                    kline_.ohlcv.close  = record->price;
+                    kline_.ohlcv.volume = record->qty;
+                    break;
+            }
+            if (record->EventEnd()) return true;
+        }
+        return false;
+    }
+
+    const CaptureReader& reader_;
+    CaptureCursor cursor_;
+    uint32_t instrument_;
+    OHLCVILFQueue* lf_queue_ = nullptr;
+    OHLCVExt kline_{};
+    /// kline_ was read and is not in the queue yet
+    bool pending_            = false;
+};
+}  // namespace backtesting
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/bus/bus.h"
+#include "aot/bus/bus_component.h"
+#include "aot/common/thread_utils.h"
+#include "aot/common/time_utils.h"
+#include "aot/market_data/market_update.h"
+#include "boost/asio/io_context.hpp"
+#include "boost/intrusive_ptr.hpp"
+
+namespace backtesting {
+using ReplayPayload =
+    std::variant<boost::intrusive_ptr<Exchange::BookSnapshot2>,
+                 boost::intrusive_ptr<Exchange::BookDiffSnapshot2>,
+                 boost::intrusive_ptr<Exchange::MEMarketUpdate2>>;
+
+/// recorded market data event and the time it was received
+struct ReplayEvent {
+    common::Nanos time = 0;
+    ReplayPayload payload;
+};
+
+/**
+ * @brief recorded stream, e.g. depth of one exchange for one day
+ *
+ */
+class ReplaySource {
+  public:
+    virtual ~ReplaySource() = default;
+    /// next event of the stream, times must not go back. false at the end
+    virtual bool Next(ReplayEvent& event) = 0;
+};
+
+/// stream kept in memory
+class ReplayTape : public ReplaySource {
+  public:
+    void Add(common::Nanos time, ReplayPayload payload) {
+        events_.push_back({time, std::move(payload)});
+    }
+    bool Next(ReplayEvent& event) override {
+        if (next_ == events_.size()) return false;
+        event = events_[next_++];
+        return true;
+    }
+    /// replay the tape from the beginning once more
+    void Rewind() { next_ = 0; }
+    size_t Size() const { return events_.size(); }
+
+  private:
+    std::vector<ReplayEvent> events_;
+    size_t next_ = 0;
+};
+
+/**
+ * @brief publisher of one recorded stream on aot::CoBus.
+ *
+ * It takes the place of the components which bring market data from the
+ * exchange: snapshots come as BusEventResponseNewSnapshot, diffs as
+ * BusEventBookDiffSnapshot, updates as BusEventMEMarketUpdate2. Subscribe
+ * BidAskGeneratorComponent or OrderBookComponent to the feed and the feed to
+ * the generator. Snapshot and diff requests of the generator are left
+ * unanswered, the snapshot recorded after the live request comes in its time.
+ */
+class ReplayFeed : public bus::Component {
+  public:
+    ReplayFeed(aot::CoBus& bus, ReplaySource& source, size_t pool_size)
+        : bus_(bus),
+          source_(source),
+          snapshot_pool_(pool_size),
+          diff_pool_(pool_size),
+          market_update_pool_(pool_size) {}
+    std::string_view GetName() const override { return "ReplayFeed"; }
+    ReplaySource& Source() { return source_; }
+
+    void Publish(const ReplayPayload& payload) {
+        std::visit([this](const auto& event) { Publish(event); }, payload);
+    }
+
+  private:
+    void Publish(const boost::intrusive_ptr<Exchange::BookSnapshot2>& event) {
+        bus_.AsyncSend(
+            this, boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot>(
+                      snapshot_pool_.Allocate(&snapshot_pool_, event)));
+    }
+    void Publish(
+        const boost::intrusive_ptr<Exchange::BookDiffSnapshot2>& event) {
+        bus_.AsyncSend(
+            this, boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>(
+                      diff_pool_.Allocate(&diff_pool_, event)));
+    }
+    void Publish(const boost::intrusive_ptr<Exchange::MEMarketUpdate2>& event) {
+        bus_.AsyncSend(
+            this, boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2>(
+                      market_update_pool_.Allocate(&market_update_pool_,
+                                                   event)));
+    }
+
+    aot::CoBus& bus_;
+    ReplaySource& source_;
+    Exchange::BusEventResponseNewSnapshotPool snapshot_pool_;
+    Exchange::BusEventBookDiffSnapshotPool diff_pool_;
+    Exchange::BusEventMEMarketUpdate2Pool market_update_pool_;
+};
+
+struct ReplayOptions {
+    /// 0 replays as fast as possible, 1 in real time, 10 ten times faster
+    double speed = 0;
+};
+
+struct ReplayStats {
+    uint64_t events          = 0;
+    /// virtual time of the first and the last event
+    common::Nanos first_time = 0;
+    common::Nanos last_time  = 0;
+    /// wall time of Run()
+    common::Nanos wall_time  = 0;
+};
+
+/**
+ * @brief replays recorded streams into the real bus components on a virtual
+ * clock.
+ *
+ * Events of all feeds are merged by time, equal times go in the order the
+ * feeds were added. Components must run their handlers on the io_context of
+ * the engine (their strands or the context itself) and nothing else must run
+ * it: every event is published and then all handlers it caused are run on the
+ * thread of Run() before the next event, so the result of a replay does not
+ * depend on timing. getCurrentNanoS() of the thread returns the time of the
+ * current event.
+ */
+class ReplayEngine {
+  public:
+    ReplayEngine(boost::asio::io_context& context, aot::CoBus& bus,
+                 ReplayOptions options = {})
+        : context_(context), bus_(bus), options_(options) {}
+
+    /// publisher of source, subscribe components to it with the bus
+    ReplayFeed& AddFeed(ReplaySource& source, size_t pool_size = 1024) {
+        return *feeds_.emplace_back(
+            std::make_unique<ReplayFeed>(bus_, source, pool_size));
+    }
+
+    /// replays all feeds to the end or until Stop()
+    ReplayStats Run() {
+        using Head = std::pair<common::Nanos, size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<>> queue;
+        std::vector<ReplayEvent> heads(feeds_.size());
+        for (size_t i = 0; i < feeds_.size(); ++i)
+            if (feeds_[i]->Source().Next(heads[i]))
+                queue.emplace(heads[i].time, i);
+
+        ReplayStats stats;
+        const auto wall_start = std::chrono::steady_clock::now();
+        if (!queue.empty()) now_ = queue.top().first;
+        stats.first_time = now_;
+        common::ScopedVirtualClock clock(now_);
+        stopped_.store(false, std::memory_order_relaxed);
+        // handlers posted before the replay, e.g. subscriptions
+        Drain();
+        while (!queue.empty() && !stopped_.load(std::memory_order_relaxed)) {
+            const auto [time, feed] = queue.top();
+            queue.pop();
+            now_ = std::max(now_, time);
+            if (options_.speed > 0) Pace(stats.first_time, wall_start);
+            feeds_[feed]->Publish(heads[feed].payload);
+            heads[feed].payload = {};
+            ++stats.events;
+            Drain();
+            if (feeds_[feed]->Source().Next(heads[feed]))
+                queue.emplace(heads[feed].time, feed);
+        }
+        stats.last_time = now_;
+        stats.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - wall_start)
+                              .count();
+        logi("replayed {} events of {} ns in {} ns", stats.events,
+             stats.last_time - stats.first_time, stats.wall_time);
+        return stats;
+    }
+
+    /// Run() returns after the current event, may be called from a handler
+    void Stop() { stopped_.store(true, std::memory_order_relaxed); }
+    common::Nanos Now() const { return now_; }
+
+  private:
+    void Drain() {
+        context_.restart();
+        context_.poll();
+    }
+    void Pace(common::Nanos first_time,
+              std::chrono::steady_clock::time_point wall_start) const {
+        const auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+            static_cast<double>(now_ - first_time) / options_.speed));
+        std::this_thread::sleep_until(wall_start + offset);
+    }
+
+    boost::asio::io_context& context_;
+    aot::CoBus& bus_;
+    ReplayOptions options_;
+    std::vector<std::unique_ptr<ReplayFeed>> feeds_;
+    common::Nanos now_ = 0;
+    std::atomic<bool> stopped_{false};
+};
+
+/**
+ * @brief calls replay(run) for every run in [0, runs) on threads threads,
+ * e.g. one day of recordings per run. A run builds its own io_context, bus,
+ * components and ReplayEngine inside replay(), runs share nothing and stay
+ * deterministic. Returns when all runs are done
+ *
+ * @param first_core thread i is pinned to first_core + i, -1 does not pin
+ */
+inline void RunReplays(size_t runs, size_t threads,
+                       const std::function<void(size_t run)>& replay,
+                       int first_core = -1) {
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(runs, 1));
+    std::atomic<size_t> next_run{0};
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back([&, i] {
+            if (first_core >= 0 &&
+                !common::setThreadCore(first_core + static_cast<int>(i)))
+                logw("can't pin replay thread {} to core {}", i,
+                     first_core + static_cast<int>(i));
+            for (size_t run = next_run.fetch_add(1); run < runs;
+                 run         = next_run.fetch_add(1)) {
+                try {
+                    replay(run);
+                } catch (const std::exception& ex) {
+                    loge("replay run {} failed: {}", run, ex.what());
+                }
+            }
+        });
+}
+}  // namespace backtesting
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <memory>
+#include <ranges>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -177,6 +178,42 @@ class CoBus {
                  static_cast<void*>(publisher));
         }
     }
+
+    /**
+     * @brief send several events of the same publisher with one lookup of
+     * subscribers. Subscribers still get events one by one through Accept(),
+     * aot::StaticBus delivers the whole batch to subscribers that can take it
+     *
+     * @tparam Events contiguous range of boost::intrusive_ptr
+     */
+    template <std::ranges::contiguous_range Events>
+    void AsyncSendBatch(bus::Component* publisher, const Events& events) {
+        auto it = subscribers_.find(publisher);
+        if (it == subscribers_.end()) {
+            logd("No subscribers found for publisher {}",
+                 static_cast<void*>(publisher));
+            return;
+        }
+        for (auto* component : it->second) {
+            if (!component) {
+                logw("Subscriber is nullptr, skipping.");
+                continue;
+            }
+            for (const auto& event : events) {
+                if (!event) [[unlikely]] {
+                    loge("event is nullptr");
+                    continue;
+                }
+                try {
+                    event->Accept(component);
+                } catch (const std::exception& ex) {
+                    loge("Exception while handling event: {}", ex.what());
+                } catch (...) {
+                    loge("Unknown error occurred while handling event.");
+                }
+            }
+        }
+    }
     // template <class T>
     // void AsyncSend(bus::Component* publisher, T event) {
     //     if (!event) {
@@ -13,6 +13,9 @@ namespace aot {
 struct ArbitrageReport;
 struct BusEventArbitrageReport;
 class TradeDictionary;
+template <class T>
+class BusEnvelope;
+using ArbitrageReportEnvelope = BusEnvelope<ArbitrageReport>;
 }  // namespace aot
 
 namespace position_keeper {
@@ -38,11 +41,14 @@ struct BusEventResponseNewSnapshot;
 struct BusEventRequestDiffOrderBook;
 struct BusEventBookDiffSnapshot;
 struct BusEventMEMarketUpdate2;
+struct MEMarketUpdate2;
+using MEMarketUpdate2Envelope = aot::BusEnvelope<MEMarketUpdate2>;
 }  // namespace Exchange
 
 namespace Trading {
 struct NewBBO;
 struct BusEventNewBBO;
+using NewBBOEnvelope = aot::BusEnvelope<NewBBO>;
 }  // namespace Trading
 
 namespace bus {
@@ -155,6 +161,14 @@ class Component {
         boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2>){
         // it is empty class
     };
+    /**
+     * @brief the same diff as BusEventMEMarketUpdate2 in one pooled block
+     *
+     */
+    virtual void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::MEMarketUpdate2Envelope>){
+        // it is empty class
+    };
     /**
      * @brief this event when new bbo occure
      *
@@ -163,6 +177,14 @@ class Component {
         boost::intrusive_ptr<Trading::BusEventNewBBO>){
         // it is empty class
     };
+    /**
+     * @brief this event when new bbo occure, NewBBO in one pooled block
+     *
+     */
+    virtual void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope>){
+        // it is empty class
+    };
     /**
      * @brief this event when new bbo occure
      *
@@ -178,6 +200,14 @@ class Component {
         boost::intrusive_ptr<aot::BusEventArbitrageReport>){
         // it is empty class
     };
+    /**
+     * @brief arbitrage report in one pooled block
+     *
+     */
+    virtual void AsyncHandleEvent(
+        boost::intrusive_ptr<aot::ArbitrageReportEnvelope>){
+        // it is empty class
+    };
     virtual void AsyncHandleEvent(const aot::TradeDictionary&) {
         // it is empty class
     };
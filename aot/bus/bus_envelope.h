@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "aot/bus/bus_component.h"
+#include "aot/common/mem_pool.h"
+#include "boost/intrusive_ptr.hpp"
+
+namespace aot {
+/**
+ * @brief bus event and its payload in one pooled block.
+ *
+ * A classic bus event is two objects: payload (aot::Event, e.g.
+ * Trading::NewBBO) and its bus::Event2 wrapper, each one with its own pool,
+ * atomic counter and intrusive_ptr. BusEnvelope keeps the payload inline, so
+ * an event costs one Allocate() and one counter.
+ *
+ * Migration of a producer: replace the pair of pools with one
+ * BusEnvelope<T>::Pool and allocate the envelope with arguments of T.
+ * Migration of a consumer: override AsyncHandleEvent() of the envelope,
+ * WrappedEvent() returns the payload as the old wrappers do. To keep the
+ * payload alive keep intrusive_ptr of the envelope, intrusive_ptr of the
+ * payload does not extend life of the envelope.
+ *
+ * @tparam T payload. If it takes a pool as the first constructor argument,
+ * nullptr is passed: the envelope returns to its pool, not the payload
+ */
+template <class T>
+class BusEnvelope {
+  public:
+    using Pool        = common::MemoryPool<BusEnvelope>;
+    using PayloadType = T;
+
+    template <class... Args>
+    explicit BusEnvelope(Pool *pool, Args &&...args)
+        : pool_(pool), payload_(MakePayload(std::forward<Args>(args)...)) {}
+    BusEnvelope(const BusEnvelope &)            = delete;
+    BusEnvelope &operator=(const BusEnvelope &) = delete;
+
+    T *WrappedEvent() { return &payload_; }
+    const T *WrappedEvent() const { return &payload_; }
+    T *operator->() { return &payload_; }
+    const T *operator->() const { return &payload_; }
+
+    /// Used by CoBus, the component must override AsyncHandleEvent() of the
+    /// envelope. aot::StaticBus calls subscribers directly.
+    void Accept(bus::Component *component) {
+        component->AsyncHandleEvent(boost::intrusive_ptr<BusEnvelope>(this));
+    }
+
+    friend void intrusive_ptr_add_ref(BusEnvelope *ptr) {
+        ptr->ref_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    friend void intrusive_ptr_release(BusEnvelope *ptr) {
+        if (ptr->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+            ptr->pool_)
+            ptr->pool_->Deallocate(ptr);
+    }
+
+  private:
+    template <class... Args>
+    static T MakePayload(Args &&...args) {
+        if constexpr (std::is_constructible_v<T, std::nullptr_t, Args...>)
+            return T(nullptr, std::forward<Args>(args)...);
+        else
+            return T(std::forward<Args>(args)...);
+    }
+
+    Pool *pool_;
+    std::atomic<uint32_t> ref_count_{0};
+    T payload_;
+};
+}  // namespace aot
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "aot/Logger.h"
+#include "boost/intrusive_ptr.hpp"
+
+namespace aot {
+/**
+ * @brief compile time wired route of events T from publishers of type
+ * Publisher to a fixed list of subscribers.
+ *
+ * Subscribers are called directly by a qualified call
+ * Subscriber::AsyncHandleEvent(), so there is neither lookup of subscribers
+ * in a map nor double dispatch Event::Accept() -> bus::Component::
+ * AsyncHandleEvent() through two vtables. The exact type of every subscriber
+ * must be used, an override of a further derived class is not called.
+ *
+ * A batch is given to Subscriber::AsyncHandleBatch(std::span<const
+ * boost::intrusive_ptr<T>>) if the subscriber has it, otherwise events are
+ * delivered one by one.
+ */
+template <class Publisher, class T, class... Subscribers>
+class Route {
+  public:
+    using publisher_type = Publisher;
+    using event_type     = T;
+    using pointer        = boost::intrusive_ptr<T>;
+
+    explicit Route(Subscribers &...subscribers)
+        : subscribers_(&subscribers...) {}
+
+    void AsyncSend(const pointer &event) const {
+        std::apply(
+            [&event](auto *...subscribers) { (Deliver(subscribers, event), ...); },
+            subscribers_);
+    }
+
+    void AsyncSendBatch(std::span<const pointer> events) const {
+        std::apply(
+            [events](auto *...subscribers) {
+                (DeliverBatch(subscribers, events), ...);
+            },
+            subscribers_);
+    }
+
+  private:
+    std::tuple<Subscribers *...> subscribers_;
+
+    template <class Subscriber>
+    static void Deliver(Subscriber *subscriber, const pointer &event) {
+        try {
+            subscriber->Subscriber::AsyncHandleEvent(event);
+        } catch (const std::exception &ex) {
+            loge("Exception while handling event: {}", ex.what());
+        } catch (...) {
+            loge("Unknown error occurred while handling event.");
+        }
+    }
+
+    template <class Subscriber>
+    static void DeliverBatch(Subscriber *subscriber,
+                             std::span<const pointer> events) {
+        if constexpr (requires {
+                          subscriber->Subscriber::AsyncHandleBatch(events);
+                      }) {
+            try {
+                subscriber->Subscriber::AsyncHandleBatch(events);
+            } catch (const std::exception &ex) {
+                loge("Exception while handling batch: {}", ex.what());
+            } catch (...) {
+                loge("Unknown error occurred while handling batch.");
+            }
+        } else {
+            for (const auto &event : events) Deliver(subscriber, event);
+        }
+    }
+};
+
+/**
+ * @brief bus whose topology is known at compile time.
+ *
+ * It is a drop-in replacement of CoBus::AsyncSend() for publishers on the hot
+ * path: AsyncSend(this, event) selects the Route by the static type of the
+ * publisher and the event, the selection costs nothing at runtime. If there
+ * is no route for the pair the event is dropped, as CoBus does for publisher
+ * without subscribers.
+ *
+ * All publishers of the same type share the route. The bus is immutable after
+ * construction, so it is safe to send from any thread.
+ *
+ * @code
+ * using DiffRoute = aot::Route<Getter, Exchange::BusEventBookDiffSnapshot,
+ *                              OrderBookComponent>;
+ * aot::StaticBus<DiffRoute> bus{DiffRoute{order_book}};
+ * bus.AsyncSend(&getter, diff);
+ * @endcode
+ */
+template <class... Routes>
+class StaticBus {
+    std::tuple<Routes...> routes_;
+
+    template <class Publisher, class T>
+    static constexpr size_t kRouteIndex = [] {
+        constexpr bool kMatches[] = {
+            (std::is_same_v<typename Routes::publisher_type, Publisher> &&
+             std::is_same_v<typename Routes::event_type, T>)...,
+            true};
+        size_t i = 0;
+        while (!kMatches[i]) ++i;
+        return i;
+    }();
+
+  public:
+    explicit StaticBus(Routes... routes) : routes_(std::move(routes)...) {}
+
+    /**
+     * @tparam Publisher static type of the sender, usually type of this
+     */
+    template <class Publisher, class T>
+    void AsyncSend(Publisher *, const boost::intrusive_ptr<T> &event) const {
+        if (!event) [[unlikely]] {
+            loge("event is nullptr");
+            return;
+        }
+        constexpr auto kIndex = kRouteIndex<std::remove_cv_t<Publisher>, T>;
+        if constexpr (kIndex < sizeof...(Routes))
+            std::get<kIndex>(routes_).AsyncSend(event);
+    }
+
+    /**
+     * @brief deliver several events with one call per subscriber
+     *
+     * @tparam Events contiguous range of boost::intrusive_ptr, e.g. std::vector
+     * or std::array
+     */
+    template <class Publisher, std::ranges::contiguous_range Events>
+    void AsyncSendBatch(Publisher *, const Events &events) const {
+        using Pointer = std::ranges::range_value_t<Events>;
+        using T       = typename Pointer::element_type;
+        constexpr auto kIndex = kRouteIndex<std::remove_cv_t<Publisher>, T>;
+        if constexpr (kIndex < sizeof...(Routes)) {
+            if (std::ranges::empty(events)) return;
+            std::get<kIndex>(routes_).AsyncSendBatch(std::span<const Pointer>(
+                std::ranges::data(events), std::ranges::size(events)));
+        }
+    }
+
+    /// True if events T of Publisher are delivered somewhere.
+    template <class Publisher, class T>
+    static constexpr bool HasRoute() {
+        return kRouteIndex<Publisher, T> < sizeof...(Routes);
+    }
+};
+}  // namespace aot
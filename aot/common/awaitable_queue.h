@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace common {
+/**
+ * @brief FIFO of idle objects whose consumers can co_await the next one.
+ *
+ * Push() hands the object to the longest waiting AsyncPop() if there is one
+ * and parks it otherwise, so an object is owned by one consumer at a time and
+ * consumers are served in the order they came. A waiter that gets nothing
+ * within its timeout completes with std::nullopt.
+ *
+ * Thread safe. Waiters complete on the executors associated with their
+ * handlers, never inside Push().
+ */
+template <typename T>
+class AwaitableQueue {
+  public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    /// @param executor runs the timers of waiters
+    explicit AwaitableQueue(boost::asio::any_io_executor executor)
+        : executor_(std::move(executor)) {}
+
+    AwaitableQueue(const AwaitableQueue&)            = delete;
+    AwaitableQueue& operator=(const AwaitableQueue&) = delete;
+
+    /// waiters still parked complete with std::nullopt
+    ~AwaitableQueue() { CancelWaiters(); }
+
+    /// gives value to the first waiter or parks it as idle
+    void Push(T value) {
+        Completion complete;
+        {
+            std::lock_guard lock(state_->mutex);
+            if (state_->waiters.empty()) {
+                state_->idle.push_back(std::move(value));
+                return;
+            }
+            complete = Detach(*state_, state_->waiters.front());
+        }
+        complete(std::move(value));
+    }
+
+    /// takes an idle value without waiting
+    std::optional<T> TryPop() {
+        std::lock_guard lock(state_->mutex);
+        if (state_->idle.empty()) return std::nullopt;
+        auto value = std::move(state_->idle.front());
+        state_->idle.pop_front();
+        return value;
+    }
+
+    /// drops an idle value, false if nobody parked it
+    bool Remove(const T& value) {
+        std::lock_guard lock(state_->mutex);
+        auto it = std::find(state_->idle.begin(), state_->idle.end(), value);
+        if (it == state_->idle.end()) return false;
+        state_->idle.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief waits for a value for at most timeout.
+     *
+     * Completion signature is void(std::optional<T>), e.g.
+     * @code
+     * auto value = co_await queue.AsyncPop(1s, boost::asio::use_awaitable);
+     * @endcode
+     * An idle value completes it at once, otherwise the caller is parked
+     * behind the waiters that came before it.
+     */
+    template <typename CompletionToken>
+    auto AsyncPop(Duration timeout, CompletionToken&& token) {
+        return boost::asio::async_initiate<CompletionToken,
+                                           void(std::optional<T>)>(
+            [state = state_, executor = executor_, timeout](auto handler) {
+                auto handler_executor =
+                    boost::asio::get_associated_executor(handler, executor);
+                Completion complete =
+                    [handler_executor, handler = std::move(handler)](
+                        std::optional<T> value) mutable {
+                        boost::asio::post(
+                            handler_executor,
+                            [handler = std::move(handler),
+                             value   = std::move(value)]() mutable {
+                                handler(std::move(value));
+                            });
+                    };
+                std::lock_guard lock(state->mutex);
+                if (!state->idle.empty()) {
+                    auto value = std::move(state->idle.front());
+                    state->idle.pop_front();
+                    complete(std::move(value));
+                    return;
+                }
+                auto waiter      = std::make_shared<Waiter>(executor);
+                waiter->complete = std::move(complete);
+                waiter->position =
+                    state->waiters.insert(state->waiters.end(), waiter);
+                waiter->timer.expires_after(timeout);
+                waiter->timer.async_wait(
+                    [state, waiter](boost::system::error_code) {
+                        Completion complete;
+                        {
+                            std::lock_guard lock(state->mutex);
+                            if (!waiter->complete) return;
+                            complete = Detach(*state, waiter);
+                        }
+                        complete(std::nullopt);
+                    });
+            },
+            token);
+    }
+
+    /// completes every parked waiter with std::nullopt
+    void CancelWaiters() {
+        std::list<Completion> completions;
+        {
+            std::lock_guard lock(state_->mutex);
+            while (!state_->waiters.empty())
+                completions.push_back(
+                    Detach(*state_, state_->waiters.front()));
+        }
+        for (auto& complete : completions) complete(std::nullopt);
+    }
+
+    size_t Idle() const {
+        std::lock_guard lock(state_->mutex);
+        return state_->idle.size();
+    }
+    size_t Waiters() const {
+        std::lock_guard lock(state_->mutex);
+        return state_->waiters.size();
+    }
+
+  private:
+    using Completion = std::move_only_function<void(std::optional<T>)>;
+
+    struct Waiter {
+        explicit Waiter(const boost::asio::any_io_executor& executor)
+            : timer(executor) {}
+        boost::asio::steady_timer timer;
+        /// empty once the waiter got a value or timed out
+        Completion complete;
+        typename std::list<std::shared_ptr<Waiter>>::iterator position;
+    };
+
+    /// timers of waiters may fire after the queue is gone
+    struct State {
+        mutable std::mutex mutex;
+        std::deque<T> idle;
+        std::list<std::shared_ptr<Waiter>> waiters;
+    };
+
+    /// unlinks the waiter, the caller holds the mutex
+    static Completion Detach(State& state, std::shared_ptr<Waiter> waiter) {
+        state.waiters.erase(waiter->position);
+        waiter->timer.cancel();
+        Completion complete = std::move(waiter->complete);
+        waiter->complete    = nullptr;
+        return complete;
+    }
+
+    boost::asio::any_io_executor executor_;
+    std::shared_ptr<State> state_ = std::make_shared<State>();
+};
+}  // namespace common
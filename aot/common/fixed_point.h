@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace common {
+/**
+ * @brief max precision supported by ParseFixedPoint. 10^19 still fits uint64_t
+ *
+ */
+constexpr uint8_t kMaxFixedPointPrecision = 19;
+
+/**
+ * @brief longest number string accepted by ParseFixedPointLevel. Exchanges send
+ * at most 8-10 fraction digits
+ *
+ */
+constexpr size_t kMaxNumberLength         = 64;
+
+/**
+ * @brief kPow10[n] == 10^n. Used instead of std::pow(10, precission) on the
+ * parsing hot path
+ *
+ */
+constexpr std::array<uint64_t, kMaxFixedPointPrecision + 1> kPow10 = [] {
+    std::array<uint64_t, kMaxFixedPointPrecision + 1> table{};
+    uint64_t value = 1;
+    for (auto &item : table) {
+        item   = value;
+        value *= 10;
+    }
+    return table;
+}();
+
+/**
+ * @brief largest scale of a product of a price and a qty, each scaled by at
+ * most kMaxFixedPointPrecision
+ *
+ */
+constexpr size_t kMaxScalePrecision       = 2 * kMaxFixedPointPrecision;
+
+/**
+ * @brief kPow10Inverse[n] == 10^-n, the same value as std::pow(10, -n) for n up
+ * to kMaxFixedPointPrecision. Converts fixed point to double by one
+ * multiplication
+ *
+ */
+constexpr std::array<double, kMaxScalePrecision + 1> kPow10Inverse = [] {
+    std::array<double, kMaxScalePrecision + 1> table{};
+    // powers of 10 are exact doubles up to 10^22
+    double power = 1;
+    for (auto &item : table) {
+        item   = 1 / power;
+        power *= 10;
+    }
+    return table;
+}();
+
+/**
+ * @brief signed product of a price and a qty, scaled by the sum of their
+ * precisions. 64 bits overflow already for a price 10^5 and a qty 10^3 with
+ * precision 8 each
+ *
+ */
+using PnlFixed = __int128;
+
+/// 10^-precision, std::pow() only for scales which exchanges do not use
+inline double Pow10Inverse(size_t precision) noexcept {
+    if (precision <= kMaxScalePrecision) [[likely]]
+        return kPow10Inverse[precision];
+    return std::pow(10.0, -static_cast<double>(precision));
+}
+
+namespace detail {
+static_assert(std::endian::native == std::endian::little,
+              "fixed point parser loads digits as little endian words");
+
+/**
+ * @brief load up to 8 bytes of str starting at pos. Bytes behind the end of str
+ * are zero
+ *
+ * @tparam kPadded true if at least 8 bytes behind the end of str are readable
+ * (simdjson buffers have SIMDJSON_PADDING), then one unaligned load is used
+ */
+template <bool kPadded>
+inline uint64_t LoadWord(std::string_view str, size_t pos) noexcept {
+    uint64_t word  = 0;
+    const size_t n = str.size() - pos;
+    if (kPadded || n >= sizeof(word)) [[likely]] {
+        std::memcpy(&word, str.data() + pos, sizeof(word));
+        if (n < sizeof(word)) word &= (1ULL << (8 * n)) - 1;
+    } else {
+        for (size_t i = 0; i < n; ++i)
+            word |= static_cast<uint64_t>(static_cast<uint8_t>(str[pos + i]))
+                    << (8 * i);
+    }
+    return word;
+}
+
+/// Amount of leading ascii digits in the word, 0..8.
+constexpr size_t CountDigits(uint64_t word) noexcept {
+    const uint64_t x         = word ^ 0x3030303030303030ULL;
+    // high bit of a byte is set if the byte is not in '0'..'9'
+    const uint64_t non_digit = (((x & 0x7F7F7F7F7F7F7F7FULL) +
+                                 0x7676767676767676ULL) |
+                                x) &
+                               0x8080808080808080ULL;
+    return non_digit ? static_cast<size_t>(std::countr_zero(non_digit)) / 8
+                     : 8;
+}
+
+/**
+ * @brief convert the first n (1..8) ascii digits of the word to integer. All
+ * digits are processed at once inside one register (SWAR), 3 multiplications
+ * instead of 8
+ *
+ */
+constexpr uint64_t ParseDigits(uint64_t word, size_t n) noexcept {
+    // move digits to the high bytes, the freed low bytes become leading zeros
+    word <<= 8 * (8 - n);
+    word   = (word & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    word   = (word & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (word & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32;
+}
+
+/**
+ * @brief accumulate a run of digits starting at pos into value
+ *
+ * @param max_digits the run is stopped after max_digits digits
+ * @return amount of consumed digits
+ */
+template <bool kPadded>
+inline size_t AccumulateDigits(std::string_view str, size_t pos,
+                               size_t max_digits, uint64_t &value) noexcept {
+    size_t consumed = 0;
+    while (pos < str.size() && consumed < max_digits) {
+        const uint64_t word = LoadWord<kPadded>(str, pos);
+        const size_t taken =
+            std::min(CountDigits(word), max_digits - consumed);
+        if (taken == 0) break;
+        value     = value * kPow10[taken] + ParseDigits(word, taken);
+        consumed += taken;
+        pos      += taken;
+        if (taken != 8) break;
+    }
+    return consumed;
+}
+
+/// Return position of the first non digit starting from pos.
+template <bool kPadded>
+inline size_t SkipDigits(std::string_view str, size_t pos) noexcept {
+    while (pos < str.size()) {
+        const size_t digits = CountDigits(LoadWord<kPadded>(str, pos));
+        pos                += digits;
+        if (digits != 8) break;
+    }
+    return std::min(pos, str.size());
+}
+
+/**
+ * @brief parse number at the beginning of str
+ *
+ * @return position behind the number, 0 if there is no valid number
+ */
+template <bool kPadded>
+inline size_t ParseFixedPoint(std::string_view str, uint8_t precision,
+                              uint64_t &out) noexcept {
+    if (precision > kMaxFixedPointPrecision) [[unlikely]]
+        return 0;
+    uint64_t integer = 0;
+    size_t pos       = AccumulateDigits<kPadded>(str, 0,
+                                                 kMaxFixedPointPrecision, integer);
+    // json number always has at least one digit before the dot
+    if (pos == 0) [[unlikely]]
+        return 0;
+    uint64_t fraction  = 0;
+    size_t frac_digits = 0;
+    if (pos < str.size() && str[pos] == '.') {
+        const size_t frac_begin = ++pos;
+        frac_digits =
+            AccumulateDigits<kPadded>(str, pos, precision, fraction);
+        // digits beyond precision are truncated but must still be digits
+        pos = SkipDigits<kPadded>(str, pos + frac_digits);
+        if (pos == frac_begin) [[unlikely]]
+            return 0;
+    }
+    uint64_t scaled;
+    if (__builtin_mul_overflow(integer, kPow10[precision], &scaled) ||
+        __builtin_add_overflow(
+            scaled, fraction * kPow10[precision - frac_digits], &scaled))
+        [[unlikely]]
+        return 0;
+    out = scaled;
+    return pos;
+}
+}  // namespace detail
+
+/**
+ * @brief convert decimal string like "123.45" to integer scaled by
+ * 10^precision: ParseFixedPoint("123.45", 3, out) sets out to 123450.
+ *
+ * The conversion is exact, digits beyond precision are truncated. It never
+ * allocates and never touches floating point, so 0.29 with precision 2 is 29,
+ * not 28 as `static_cast<int>(0.29 * std::pow(10, 2))`.
+ *
+ * @return false if the string is not a plain non negative decimal number or
+ * the result does not fit uint64_t. out is not changed in this case
+ */
+inline bool ParseFixedPoint(std::string_view str, uint8_t precision,
+                            uint64_t &out) noexcept {
+    uint64_t value;
+    const size_t end = detail::ParseFixedPoint<false>(str, precision, value);
+    if (end == 0 || end != str.size()) [[unlikely]]
+        return false;
+    out = value;
+    return true;
+}
+
+/**
+ * @brief parse number which is followed by the closing quote of json string.
+ * str must point into a padded buffer, e.g. simdjson::padded_string, so words
+ * can be loaded behind the quote
+ *
+ */
+inline bool ParseQuotedFixedPoint(const char *str, uint8_t precision,
+                                  uint64_t &out) noexcept {
+    const size_t end = detail::ParseFixedPoint<true>(
+        {str, kMaxNumberLength}, precision, out);
+    return end != 0 && str[end] == '"';
+}
+
+/**
+ * @brief parse exchange level ["price","qty"] to common::Price and
+ * common::Qty scaled by precisions of the trading pair.
+ *
+ * Numbers are read in place from the padded input buffer of simdjson, they
+ * have no escapes so there is no need to unescape them into the string buffer
+ * of the parser.
+ *
+ * @tparam Array simdjson::ondemand::array or simdjson_result of it
+ * @return false if the level has not exactly two valid numbers
+ */
+template <class Array, class Price, class Qty>
+bool ParseFixedPointLevel(Array &&level, uint8_t price_precision,
+                          uint8_t qty_precision, Price &price, Qty &qty) {
+    const uint8_t precision[2] = {price_precision, qty_precision};
+    uint64_t values[2];
+    size_t i = 0;
+    for (auto number : level) {
+        std::remove_cvref_t<
+            decltype(number.get_raw_json_string().value_unsafe())>
+            raw;
+        if (i >= 2 || number.get_raw_json_string().get(raw)) [[unlikely]]
+            return false;
+        if (!ParseQuotedFixedPoint(raw.raw(), precision[i], values[i]))
+            [[unlikely]]
+            return false;
+        ++i;
+    }
+    if (i != 2) [[unlikely]]
+        return false;
+    price = values[0];
+    qty   = values[1];
+    return true;
+}
+
+/**
+ * @brief inverse of ParseFixedPoint: 123450 with precision 3 is "123.450".
+ *
+ * Exact and without floating point, unlike std::to_string(double) which
+ * rounds to 6 fraction digits
+ */
+inline std::string FormatFixedPoint(uint64_t value, uint8_t precision) {
+    char digits[20];
+    const auto length = static_cast<size_t>(
+        std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+    std::string out;
+    if (precision == 0) {
+        out.assign(digits, length);
+        return out;
+    }
+    if (length <= precision) {
+        out.reserve(precision + 2);
+        out.append("0.");
+        out.append(precision - length, '0');
+        out.append(digits, length);
+        return out;
+    }
+    const size_t integer = length - precision;
+    out.reserve(length + 1);
+    out.append(digits, integer);
+    out.push_back('.');
+    out.append(digits + integer, precision);
+    return out;
+}
+}  // namespace common
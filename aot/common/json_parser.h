@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "aot/Logger.h"
+#include "boost/beast/core/flat_buffer.hpp"
+#include "simdjson.h"
+
+namespace common {
+/**
+ * @brief initial read buffer capacity of websocket sessions. It is enough for
+ * depth messages of all supported exchanges, so the buffer is not grown on the
+ * hot path
+ *
+ */
+constexpr size_t kJsonReadBufferCapacity = 1 << 16;
+
+/**
+ * @brief simdjson ondemand parser that is reused for every message.
+ *
+ * simdjson::ondemand::parser allocates its internal buffers on the first
+ * iterate() and keeps them, so the owner of JsonParser pays for allocation
+ * once per connection instead of once per message. Messages that are not
+ * padded are copied into the scratch buffer that also grows only if the
+ * message is longer than all previous ones.
+ *
+ * The parser is movable but not copyable and not thread safe. Keep one
+ * instance per connection (strand).
+ * A document returned by Iterate() is valid until the next call of Iterate().
+ */
+class JsonParser {
+    simdjson::ondemand::parser parser_;
+    std::string scratch_;
+
+  public:
+    /**
+     * @param capacity if it is not zero, buffers for messages of this size are
+     * allocated in the constructor
+     */
+    explicit JsonParser(size_t capacity = 0) {
+        if (!capacity) return;
+        if (auto error = parser_.allocate(capacity); error) [[unlikely]]
+            loge("can't allocate json parser: {}",
+                 simdjson::error_message(error));
+        scratch_.reserve(capacity + simdjson::SIMDJSON_PADDING);
+    }
+
+    /// Parse json in place, padding bytes behind json must be readable.
+    simdjson::simdjson_result<simdjson::ondemand::document> Iterate(
+        simdjson::padded_string_view json) {
+        return parser_.iterate(json);
+    }
+
+    /// Copy json to the padded scratch buffer and parse it there.
+    simdjson::simdjson_result<simdjson::ondemand::document> Iterate(
+        std::string_view json) {
+        scratch_.reserve(json.size() + simdjson::SIMDJSON_PADDING);
+        scratch_.assign(json);
+        return parser_.iterate(simdjson::padded_string_view(
+            scratch_.data(), scratch_.size(), scratch_.capacity()));
+    }
+};
+
+/**
+ * @brief make sure simdjson padding bytes behind the readable bytes of fb are
+ * allocated. flat_buffer reallocates only if it has no spare capacity
+ *
+ */
+inline void ReserveJsonPadding(boost::beast::flat_buffer &fb) {
+    fb.prepare(simdjson::SIMDJSON_PADDING);
+}
+
+/// Readable bytes of fb as padded view which can be parsed in place.
+inline simdjson::padded_string_view PaddedView(boost::beast::flat_buffer &fb) {
+    ReserveJsonPadding(fb);
+    return simdjson::padded_string_view(
+        static_cast<const char *>(fb.data().data()), fb.size(),
+        fb.size() + simdjson::SIMDJSON_PADDING);
+}
+}  // namespace common
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace common {
+namespace detail {
+/**
+ * @brief header of a heap block, capacity elements are placed right behind it
+ *
+ */
+struct alignas(16) LevelSlab {
+    std::atomic<uint32_t> ref_count{1};
+    uint32_t size_class = 0;
+    size_t capacity     = 0;
+};
+
+/**
+ * @brief process wide cache of LevelSlab blocks of elements T.
+ *
+ * Capacities are rounded up to kMinCapacity << size_class. Released slabs are
+ * kept in the free list of its size class and are given out again, so after
+ * the first resync snapshots of the same depth do not touch the heap. Slabs
+ * larger than the biggest size class are not cached.
+ *
+ * Slabs are released by the thread which drops the last reference, that is
+ * usually not the thread of the parser, so free lists are guarded by mutex.
+ * Spilling happens only for big diffs and snapshots.
+ */
+template <class T>
+class LevelSlabPool {
+  public:
+    static constexpr size_t kMinCapacity = 128;
+    static constexpr size_t kSizeClasses = 8;
+    static_assert(alignof(T) <= alignof(LevelSlab));
+
+    static LevelSlabPool& Instance() {
+        static LevelSlabPool pool;
+        return pool;
+    }
+
+    LevelSlab* Allocate(size_t capacity) {
+        uint32_t size_class = 0;
+        while (size_class < kSizeClasses &&
+               (kMinCapacity << size_class) < capacity)
+            ++size_class;
+        if (size_class < kSizeClasses) {
+            capacity     = kMinCapacity << size_class;
+            auto& bucket = buckets_[size_class];
+            std::lock_guard lock(bucket.mutex);
+            if (!bucket.free.empty()) {
+                auto* slab = bucket.free.back();
+                bucket.free.pop_back();
+                slab->ref_count.store(1, std::memory_order_relaxed);
+                return slab;
+            }
+        }
+        void* memory = ::operator new(sizeof(LevelSlab) + capacity * sizeof(T));
+        auto* slab   = new (memory) LevelSlab;
+        slab->size_class = size_class;
+        slab->capacity   = capacity;
+        return slab;
+    }
+
+    /// Drop one reference, the last one returns slab to the free list.
+    void Release(LevelSlab* slab) {
+        if (slab->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (slab->size_class < kSizeClasses) [[likely]] {
+            auto& bucket = buckets_[slab->size_class];
+            std::lock_guard lock(bucket.mutex);
+            bucket.free.push_back(slab);
+            return;
+        }
+        ::operator delete(slab);
+    }
+
+    static T* Data(LevelSlab* slab) {
+        return reinterpret_cast<T*>(slab + 1);
+    }
+
+    /// Amount of cached slabs, for tests.
+    size_t CachedSlabs() {
+        size_t count = 0;
+        for (auto& bucket : buckets_) {
+            std::lock_guard lock(bucket.mutex);
+            count += bucket.free.size();
+        }
+        return count;
+    }
+
+    ~LevelSlabPool() {
+        for (auto& bucket : buckets_)
+            for (auto* slab : bucket.free) ::operator delete(slab);
+    }
+
+  private:
+    LevelSlabPool() = default;
+    struct Bucket {
+        std::mutex mutex;
+        std::vector<LevelSlab*> free;
+    };
+    std::array<Bucket, kSizeClasses> buckets_;
+};
+}  // namespace detail
+
+/**
+ * @brief contiguous container of book levels with small buffer optimisation.
+ *
+ * Up to kInlineCapacity elements are stored inside the object, so a typical
+ * diff of 1-50 levels is parsed, sent by the bus and applied to the book
+ * without heap allocations. Bigger diffs and snapshots spill into a
+ * ref-counted slab of detail::LevelSlabPool.
+ *
+ * Levels are immutable once they are published: there is no mutable access to
+ * elements. Copy of a spilled vector shares the slab and only increments the
+ * ref counter, emplace_back() into a shared vector detaches it first. Copy of
+ * an inline vector copies size() elements.
+ *
+ * @tparam T trivially copyable level, e.g. Exchange::BookSnapshotElem
+ */
+template <class T, size_t kInlineCapacity>
+class LevelVector {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                  std::is_trivially_destructible_v<T>);
+    using Pool = detail::LevelSlabPool<T>;
+
+  public:
+    using value_type     = T;
+    using size_type      = size_t;
+    using const_iterator = const T*;
+    using iterator       = const T*;
+
+    LevelVector()        = default;
+    LevelVector(std::initializer_list<T> levels) { Assign(levels); }
+    LevelVector(const LevelVector& other) { CopyFrom(other); }
+    LevelVector(LevelVector&& other) noexcept { MoveFrom(other); }
+    ~LevelVector() { ReleaseSlab(); }
+
+    LevelVector& operator=(const LevelVector& other) {
+        if (this == &other) return *this;
+        ReleaseSlab();
+        CopyFrom(other);
+        return *this;
+    }
+    LevelVector& operator=(LevelVector&& other) noexcept {
+        if (this == &other) return *this;
+        ReleaseSlab();
+        MoveFrom(other);
+        return *this;
+    }
+    LevelVector& operator=(std::initializer_list<T> levels) {
+        Assign(levels);
+        return *this;
+    }
+
+    const T* data() const { return slab_ ? Pool::Data(slab_) : Inline(); }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size_; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T& front() const { return data()[0]; }
+    const T& back() const { return data()[size_ - 1]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const {
+        return slab_ ? slab_->capacity : kInlineCapacity;
+    }
+    /// True if elements live in a slab and not inside the object.
+    bool Spilled() const { return slab_ != nullptr; }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        if (size_ == capacity() || IsShared()) [[unlikely]]
+            Grow(std::max(size_ + 1, capacity() * 2));
+        new (MutableData() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+    }
+    void push_back(const T& level) { emplace_back(level); }
+
+    void reserve(size_t capacity) {
+        if (capacity > this->capacity() || IsShared()) Grow(capacity);
+    }
+
+    /// Keep own slab for the next levels, drop a shared one.
+    void clear() {
+        if (IsShared()) ReleaseSlab();
+        size_ = 0;
+    }
+
+  private:
+    size_t size_              = 0;
+    detail::LevelSlab* slab_  = nullptr;
+    alignas(T) std::byte inline_[kInlineCapacity * sizeof(T)];
+
+    const T* Inline() const { return reinterpret_cast<const T*>(inline_); }
+    T* MutableData() {
+        return slab_ ? Pool::Data(slab_) : reinterpret_cast<T*>(inline_);
+    }
+    bool IsShared() const {
+        return slab_ && slab_->ref_count.load(std::memory_order_acquire) != 1;
+    }
+
+    /// Move elements to a private slab with at least capacity elements.
+    void Grow(size_t capacity) {
+        if (capacity <= kInlineCapacity && !slab_) return;
+        auto* slab = Pool::Instance().Allocate(
+            std::max({capacity, size_, kInlineCapacity + 1}));
+        if (size_) std::memcpy(Pool::Data(slab), data(), size_ * sizeof(T));
+        ReleaseSlab();
+        slab_ = slab;
+    }
+    void ReleaseSlab() {
+        if (!slab_) return;
+        Pool::Instance().Release(slab_);
+        slab_ = nullptr;
+    }
+    void CopyFrom(const LevelVector& other) {
+        size_ = other.size_;
+        if (other.slab_) {
+            other.slab_->ref_count.fetch_add(1, std::memory_order_relaxed);
+            slab_ = other.slab_;
+        } else if (size_) {
+            std::memcpy(inline_, other.inline_, size_ * sizeof(T));
+        }
+    }
+    void MoveFrom(LevelVector& other) {
+        size_ = other.size_;
+        if (other.slab_) {
+            slab_       = other.slab_;
+            other.slab_ = nullptr;
+        } else if (size_) {
+            std::memcpy(inline_, other.inline_, size_ * sizeof(T));
+        }
+        other.size_ = 0;
+    }
+    void Assign(std::initializer_list<T> levels) {
+        clear();
+        reserve(levels.size());
+        for (const auto& level : levels) emplace_back(level);
+    }
+};
+}  // namespace common
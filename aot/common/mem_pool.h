@@ -1,9 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <boost/pool/pool_alloc.hpp>  // Include Boost Pool header
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <new>  // For placement new
 #include <string>
@@ -157,73 +162,319 @@ class MemoryPoolNotThreadSafety {
 };
 
 /**
- * @brief it is thread safety version
+ * @brief what MemoryPoolThreadSafety does when all blocks are in use
+ *
+ */
+enum class PoolOverflow {
+    kHeap,       ///< object is allocated from the heap and counted in stats
+    kReturnNull  ///< Allocate() returns nullptr
+};
+
+struct MemoryPoolStats {
+    size_t capacity           = 0;
+    uint64_t allocations      = 0;
+    uint64_t deallocations    = 0;
+    /// allocations served by the heap because the pool was exhausted
+    uint64_t heap_allocations = 0;
+    /// allocations refused because the pool was exhausted
+    uint64_t failed_allocations = 0;
+    uint64_t InUse() const { return allocations - deallocations; }
+};
+
+namespace detail {
+/// Index of the magazine of the calling thread, fixed for the thread lifetime.
+inline size_t ThreadSlot() {
+    static std::atomic<size_t> next_slot{0};
+    static thread_local const size_t slot =
+        next_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+}  // namespace detail
+
+/**
+ * @brief it is thread safety version with fixed capacity.
+ *
+ * All pool_size blocks are allocated in the constructor. Free blocks are kept
+ * in a lock-free stack of block indices. Its head holds the index together
+ * with a version that grows on every change, so a pop can't succeed after
+ * the head was popped and pushed back by other threads (ABA). Links of the
+ * stack live outside of the blocks, a freed object is never read.
+ *
+ * Threads are mapped to kMagazines magazines, each caches up to
+ * kMagazineSize free blocks. Allocate() and Deallocate() take a block from or
+ * give it to the magazine of the calling thread and touch the shared stack
+ * only to refill or to flush half of a magazine. A magazine is guarded by a
+ * try-lock: if two threads share it at the same moment, the loser works with
+ * the shared stack directly, it never waits. Blocks may be freed by any
+ * thread, e.g. in intrusive_ptr_release() of an event.
+ *
+ * When no block is left Allocate() follows PoolOverflow. Objects of the heap
+ * may be deallocated by the pool as well.
  *
  * @tparam T
  */
 template <typename T>
 class MemoryPoolThreadSafety {
   public:
-    // Constructor
-    explicit MemoryPoolThreadSafety(std::size_t poolSize)
-        : pool_(sizeof(T), poolSize), head_(nullptr), pool_size_(poolSize) {}
+    static constexpr size_t kMagazines    = 16;
+    static constexpr size_t kMagazineSize = 32;
+
+    explicit MemoryPoolThreadSafety(std::size_t poolSize,
+                                    PoolOverflow overflow = PoolOverflow::kHeap)
+        : overflow_(overflow),
+          pool_size_(std::min<size_t>(poolSize, kNil)),
+          blocks_(std::make_unique<Block[]>(pool_size_)),
+          next_(std::make_unique<std::atomic<uint32_t>[]>(pool_size_)) {
+        BuildFreeList();
+    }
+
+    MemoryPoolThreadSafety(const MemoryPoolThreadSafety &)            = delete;
+    MemoryPoolThreadSafety &operator=(const MemoryPoolThreadSafety &) = delete;
 
     // Allocates memory for an object of type T
     template <typename... Args>
     T *Allocate(Args &&...args) {
         if (pool_size_ == 0) return nullptr;
-
-        // Try to pop from the free list first
-        void *block = head_.load(std::memory_order_acquire);
-        if (block) {
-            // Atomically remove from the free list
-            void *next = *static_cast<void **>(block);
-            if (head_.compare_exchange_strong(block, next,
-                                              std::memory_order_release,
-                                              std::memory_order_acquire)) {
-                return new (block) T(std::forward<Args>(args)...);
-            }
+        auto &magazine = magazines_[detail::ThreadSlot() % kMagazines];
+
+        uint32_t index = kNil;
+        if (magazine.TryLock()) [[likely]] {
+            if (magazine.size == 0) Refill(magazine);
+            if (magazine.size) index = magazine.blocks[--magazine.size];
+            Increment(magazine.allocations);
+            magazine.Unlock();
+        } else {
+            shared_allocations_.fetch_add(1, std::memory_order_relaxed);
+            index = Pop();
         }
-
-        // If free list is empty, allocate from the pool
-        void *obj = pool_.malloc();
-        if (obj) {
-            return new (obj) T(std::forward<Args>(args)...);
+        if (index == kNil) [[unlikely]] index = Steal();
+
+        void *memory = nullptr;
+        if (index != kNil) [[likely]] {
+            memory = &blocks_[index];
+        } else if (overflow_ == PoolOverflow::kHeap) {
+            heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+            memory = ::operator new(sizeof(T), std::align_val_t{alignof(T)});
+        } else {
+            failed_allocations_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        try {
+            return new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Free(memory);
+            throw;
         }
-        return nullptr;  // Allocation failed
     }
 
-    // Deallocates memory for an object of type T
+    // Deallocates memory for an object of type T, may be called by any thread
     void Deallocate(T *obj) {
         if (!obj) return;
-
-        // Call the destructor of the object
         obj->~T();
+        Free(obj);
+    }
+
+    ~MemoryPoolThreadSafety() = default;
+
+    /**
+     * @brief return all blocks to the pool. Destructors are not called. The
+     * pool gets new storage, so objects allocated before Reset() must not be
+     * used or deallocated. Not thread safe
+     *
+     */
+    void Reset() {
+        auto blocks = std::make_unique<Block[]>(pool_size_);
+        blocks_.swap(blocks);
+        BuildFreeList();
+    }
+
+    // Clear the pool by marking all objects as free
+    void Clear() { Reset(); }
+
+    size_t Capacity() const { return pool_size_; }
+
+    /// Counters are updated with relaxed atomics, the sum is approximate while
+    /// other threads work with the pool.
+    MemoryPoolStats Stats() const {
+        MemoryPoolStats stats;
+        stats.capacity = pool_size_;
+        stats.allocations =
+            shared_allocations_.load(std::memory_order_relaxed);
+        stats.deallocations =
+            shared_deallocations_.load(std::memory_order_relaxed);
+        for (const auto &magazine : magazines_) {
+            stats.allocations +=
+                magazine.allocations.load(std::memory_order_relaxed);
+            stats.deallocations +=
+                magazine.deallocations.load(std::memory_order_relaxed);
+        }
+        stats.heap_allocations =
+            heap_allocations_.load(std::memory_order_relaxed);
+        stats.failed_allocations =
+            failed_allocations_.load(std::memory_order_relaxed);
+        stats.allocations -= stats.failed_allocations;
+        return stats;
+    }
+
+  private:
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
 
-        // Add the block to the free list
-        void *head = head_.load(std::memory_order_acquire);
+    struct alignas(T) Block {
+        std::byte storage[sizeof(T)];
+    };
+
+    struct alignas(64) Magazine {
+        std::atomic<bool> busy{false};
+        uint32_t size = 0;
+        std::array<uint32_t, kMagazineSize> blocks;
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> deallocations{0};
+
+        bool TryLock() {
+            return !busy.load(std::memory_order_relaxed) &&
+                   !busy.exchange(true, std::memory_order_acquire);
+        }
+        void Unlock() { busy.store(false, std::memory_order_release); }
+    };
+
+    /// Counters of a magazine are written only under its lock, so they need
+    /// no read-modify-write.
+    static void Increment(std::atomic<uint64_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    }
+
+    /// Head of the free stack: version in the high half, index in the low.
+    static uint64_t MakeHead(uint64_t old_head, uint32_t index) {
+        return (((old_head >> 32) + 1) << 32) | index;
+    }
+
+    uint32_t Pop() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            const auto index = static_cast<uint32_t>(head);
+            if (index == kNil) return kNil;
+            // next_ is never freed, a stale value is rejected by the version
+            const auto next = next_[index].load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, MakeHead(head, next),
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire))
+                return index;
+        }
+    }
+
+    /// Push the chain first -> ... -> last linked through next_.
+    void Push(uint32_t first, uint32_t last) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
         do {
-            // Here we cast obj to a void* and then set the next pointer to the
-            // current head
-            *reinterpret_cast<void **>(obj) = head;
-        } while (!head_.compare_exchange_strong(
-            head, obj, std::memory_order_release, std::memory_order_acquire));
+            next_[last].store(static_cast<uint32_t>(head),
+                              std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, MakeHead(head, first),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
     }
 
-    ~MemoryPoolThreadSafety() { Clear(); }
+    /**
+     * @brief pop up to half of a magazine with one CAS. If the version of the
+     * head did not change, nobody touched the stack while the chain was
+     * walked, so the links read are consistent
+     *
+     */
+    void Refill(Magazine &magazine) {
+        constexpr size_t kTake = kMagazineSize / 2;
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            size_t taken = 0;
+            auto index   = static_cast<uint32_t>(head);
+            while (taken < kTake && index != kNil) {
+                magazine.blocks[taken++] = index;
+                index = next_[index].load(std::memory_order_relaxed);
+            }
+            if (!taken) return;
+            if (head_.compare_exchange_weak(head, MakeHead(head, index),
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+                // the top of the stack is given out first
+                std::reverse(magazine.blocks.begin(),
+                             magazine.blocks.begin() + taken);
+                magazine.size = taken;
+                return;
+            }
+        }
+    }
 
-    // Reset the pool by marking all allocated memory as free (without actually
-    // purging memory)
-    void Reset() { pool_.release_memory(); }
+    /// Move the older half of the magazine to the shared stack in one push.
+    void Flush(Magazine &magazine) {
+        constexpr size_t kKeep = kMagazineSize / 2;
+        for (size_t i = 1; i < kKeep; ++i)
+            next_[magazine.blocks[i - 1]].store(magazine.blocks[i],
+                                                std::memory_order_relaxed);
+        Push(magazine.blocks[0], magazine.blocks[kKeep - 1]);
+        std::copy(magazine.blocks.begin() + kKeep,
+                  magazine.blocks.begin() + magazine.size,
+                  magazine.blocks.begin());
+        magazine.size -= kKeep;
+    }
 
-    // Clear the pool by marking all objects as free and returning memory to the
-    // pool
-    void Clear() { pool_.purge_memory(); }
+    /// Take a block parked in the magazine of another thread.
+    uint32_t Steal() {
+        for (auto &magazine : magazines_) {
+            if (!magazine.TryLock()) continue;
+            uint32_t index = kNil;
+            if (magazine.size) index = magazine.blocks[--magazine.size];
+            magazine.Unlock();
+            if (index != kNil) return index;
+        }
+        return kNil;
+    }
 
-  private:
-    boost::pool<> pool_;        // Boost pool for memory management
-    std::atomic<void *> head_;  // Atomic head of the free list
+    bool Owns(const void *ptr) const {
+        const auto address = reinterpret_cast<uintptr_t>(ptr);
+        const auto begin   = reinterpret_cast<uintptr_t>(blocks_.get());
+        return address >= begin && address < begin + pool_size_ * sizeof(Block);
+    }
+
+    void Free(void *memory) {
+        if (!Owns(memory)) [[unlikely]] {
+            shared_deallocations_.fetch_add(1, std::memory_order_relaxed);
+            ::operator delete(memory, std::align_val_t{alignof(T)});
+            return;
+        }
+        const auto index = static_cast<uint32_t>(
+            static_cast<Block *>(memory) - blocks_.get());
+        auto &magazine = magazines_[detail::ThreadSlot() % kMagazines];
+        if (magazine.TryLock()) [[likely]] {
+            if (magazine.size == kMagazineSize) Flush(magazine);
+            magazine.blocks[magazine.size++] = index;
+            Increment(magazine.deallocations);
+            magazine.Unlock();
+            return;
+        }
+        shared_deallocations_.fetch_add(1, std::memory_order_relaxed);
+        Push(index, index);
+    }
+
+    void BuildFreeList() {
+        for (auto &magazine : magazines_) magazine.size = 0;
+        for (size_t i = 0; i < pool_size_; ++i)
+            next_[i].store(i + 1 < pool_size_ ? static_cast<uint32_t>(i + 1)
+                                              : kNil,
+                           std::memory_order_relaxed);
+        head_.store(MakeHead(head_.load(std::memory_order_relaxed),
+                             pool_size_ ? 0 : kNil),
+                    std::memory_order_release);
+    }
+
+    const PoolOverflow overflow_;
     const std::size_t pool_size_;
+    std::unique_ptr<Block[]> blocks_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    std::array<Magazine, kMagazines> magazines_;
+    alignas(64) std::atomic<uint64_t> heap_allocations_{0};
+    std::atomic<uint64_t> failed_allocations_{0};
+    std::atomic<uint64_t> shared_allocations_{0};
+    std::atomic<uint64_t> shared_deallocations_{0};
 };
 
 template <typename T>
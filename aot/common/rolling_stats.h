@@ -0,0 +1,171 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "aot/common/time_utils.h"
+
+namespace common {
+/**
+ * @brief rolling statistics of many series, O(1) per sample.
+ *
+ * Every series keeps its samples in a fixed ring of an arena shared by all
+ * series, with running sums for mean and variance, and EWMA of mean and
+ * variance. A sample drops the samples older than its time - window and the
+ * oldest one when the ring is full. Times are the caller's clock, e.g. times of
+ * the exchange, and must not go back within a series.
+ *
+ * Memory is allocated by AddSeries() only, Add() allocates nothing.
+ */
+class RollingStats {
+  public:
+    using SeriesId = uint32_t;
+
+    struct Options {
+        /// samples kept per series, rounded up to a power of two
+        size_t capacity   = 1024;
+        /// samples older than the newest by more than window are dropped,
+        /// 0 keeps samples by capacity only
+        Nanos window      = 10 * NANOS_TO_SECS;
+        /// weight of a new sample in EWMA, in (0, 1]
+        double ewma_alpha = 0.1;
+    };
+
+    explicit RollingStats(Options options)
+        : options_(options),
+          capacity_(std::bit_ceil(options.capacity ? options.capacity : 1)) {}
+
+    /// new empty series, allocates its ring
+    SeriesId AddSeries() {
+        const auto id = static_cast<SeriesId>(series_.size());
+        series_.emplace_back();
+        times_.resize(series_.size() * capacity_);
+        values_.resize(series_.size() * capacity_);
+        return id;
+    }
+    size_t Series() const { return series_.size(); }
+
+    void Add(SeriesId id, Nanos time, double value) {
+        auto& series = series_[id];
+        if (options_.window > 0)
+            while (series.count && times_[Slot(id, series.head)] <
+                                       time - options_.window)
+                Evict(id, series);
+        if (series.count == capacity_) Evict(id, series);
+        if (series.count == 0) {
+            // shifting by a sample keeps sums small against cancellation
+            series.shift  = value;
+            series.sum    = 0;
+            series.sum_sq = 0;
+        }
+        const size_t slot = Slot(id, series.head + series.count);
+        times_[slot]      = time;
+        values_[slot]     = value;
+        ++series.count;
+        const double shifted = value - series.shift;
+        series.sum += shifted;
+        series.sum_sq += shifted * shifted;
+
+        if (!series.has_ewma) {
+            series.has_ewma     = true;
+            series.ewma         = value;
+            series.ewm_variance = 0;
+        } else {
+            const double diff      = value - series.ewma;
+            const double increment = options_.ewma_alpha * diff;
+            series.ewma += increment;
+            series.ewm_variance = (1 - options_.ewma_alpha) *
+                                  (series.ewm_variance + diff * increment);
+        }
+    }
+
+    /**
+     * @brief z-score of every value against its series, then adds the values.
+     * A value is scored against the samples before it, as a signal would be
+     *
+     * @param z_scores receives ZScore() of every value, same size as ids
+     */
+    void AddBatch(std::span<const SeriesId> ids, std::span<const double> values,
+                  Nanos time, std::span<double> z_scores) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            z_scores[i] = ZScore(ids[i], values[i]);
+            Add(ids[i], time, values[i]);
+        }
+    }
+
+    size_t Count(SeriesId id) const { return series_[id].count; }
+    double Mean(SeriesId id) const {
+        const auto& series = series_[id];
+        if (!series.count) return 0.0;
+        return series.shift + series.sum / series.count;
+    }
+    /// sample variance of the window, 0 for less than two samples
+    double Variance(SeriesId id) const {
+        const auto& series = series_[id];
+        if (series.count < 2) return 0.0;
+        const double variance =
+            (series.sum_sq - series.sum * series.sum / series.count) /
+            (series.count - 1);
+        return variance > 0 ? variance : 0.0;
+    }
+    double StdDev(SeriesId id) const { return std::sqrt(Variance(id)); }
+    double Ewma(SeriesId id) const { return series_[id].ewma; }
+    double EwmVariance(SeriesId id) const { return series_[id].ewm_variance; }
+    /// deviation of value from the mean in standard deviations, 0 while the
+    /// window has no spread
+    double ZScore(SeriesId id, double value) const {
+        const double std_dev = StdDev(id);
+        if (std_dev == 0) return 0.0;
+        return (value - Mean(id)) / std_dev;
+    }
+
+  private:
+    struct State {
+        size_t head         = 0;
+        size_t count        = 0;
+        /// evictions since sums were recomputed
+        size_t evicted      = 0;
+        double shift        = 0;
+        double sum          = 0;
+        double sum_sq       = 0;
+        double ewma         = 0;
+        double ewm_variance = 0;
+        bool has_ewma       = false;
+    };
+
+    size_t Slot(SeriesId id, size_t index) const {
+        return id * capacity_ + (index & (capacity_ - 1));
+    }
+    void Evict(SeriesId id, State& series) {
+        const double shifted = values_[Slot(id, series.head)] - series.shift;
+        series.sum -= shifted;
+        series.sum_sq -= shifted * shifted;
+        series.head = (series.head + 1) & (capacity_ - 1);
+        --series.count;
+        // rounding of subtractions adds up, once per ring is amortized O(1)
+        if (++series.evicted == capacity_) Recompute(id, series);
+    }
+    void Recompute(SeriesId id, State& series) {
+        series.evicted = 0;
+        series.sum     = 0;
+        series.sum_sq  = 0;
+        for (size_t i = 0; i < series.count; ++i) {
+            const double shifted =
+                values_[Slot(id, series.head + i)] - series.shift;
+            series.sum += shifted;
+            series.sum_sq += shifted * shifted;
+        }
+    }
+
+    Options options_;
+    size_t capacity_;
+    std::vector<State> series_;
+    /// ring of series i is [i * capacity_, (i + 1) * capacity_)
+    std::vector<Nanos> times_;
+    std::vector<double> values_;
+};
+}  // namespace common
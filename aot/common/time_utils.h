@@ -5,6 +5,8 @@
 #include <string>
 #include <stdexcept>
 
+#include "aot/Logger.h"
+
 namespace common {
 using Nanos = int64_t;
 using Delta = int64_t;
@@ -14,12 +16,39 @@ constexpr Nanos MILLIS_TO_SECS   = 1000;
 constexpr Nanos NANOS_TO_MILLIS  = NANOS_TO_MICROS * MICROS_TO_MILLIS;
 constexpr Nanos NANOS_TO_SECS    = NANOS_TO_MILLIS * MILLIS_TO_SECS;
 
-inline auto getCurrentNanoS() noexcept {
+namespace detail {
+/// time of the virtual clock of the thread, nullptr for the system clock
+inline thread_local const Nanos* virtual_now = nullptr;
+}  // namespace detail
+
+inline Nanos getCurrentNanoS() noexcept {
+    if (detail::virtual_now) [[unlikely]]
+        return *detail::virtual_now;
     return std::chrono::duration_cast<std::chrono::nanoseconds>(
                std::chrono::system_clock::now().time_since_epoch())
         .count();
 }
 
+/**
+ * @brief makes getCurrentNanoS() of the calling thread return now, e.g. the
+ * time of a replayed event, while the object lives. Other threads keep the
+ * system clock
+ *
+ */
+class ScopedVirtualClock {
+  public:
+    explicit ScopedVirtualClock(const Nanos& now)
+        : previous_(detail::virtual_now) {
+        detail::virtual_now = &now;
+    }
+    ~ScopedVirtualClock() { detail::virtual_now = previous_; }
+    ScopedVirtualClock(const ScopedVirtualClock&)            = delete;
+    ScopedVirtualClock& operator=(const ScopedVirtualClock&) = delete;
+
+  private:
+    const Nanos* previous_;
+};
+
 inline uint64_t getCurNano() noexcept {
     struct timespec timestamp = { 0 };
     if (clock_gettime(CLOCK_MONOTONIC, &timestamp) != 0)[[likely]]
@@ -9,6 +9,7 @@
 #include <string_view>
 
 #include "aot/Logger.h"
+#include "aot/common/fixed_point.h"
 #include "aot/common/macros.h"
 #include "aot/third_party/emhash/hash_table7.hpp"
 #include "magic_enum/magic_enum.hpp"
@@ -359,14 +360,19 @@ struct TradingPairInfo {
      */
     common::TradingPairS https_query_response;
     double GetPriceDouble(const common::Price& price) const {
-        return price * std::pow(10, -price_precission);
+        return price * Pow10Inverse(price_precission);
     }
     double GetQtyDouble(const common::Qty& qty) const {
-        return qty * std::pow(10, -qty_precission);
+        return qty * Pow10Inverse(qty_precission);
     }
-    double GetPnlDouble(uint64_t pnl) const {
-        return pnl * std::pow(10, -qty_precission) *
-               std::pow(10, -price_precission);
+    /**
+     * @brief pnl is a product of a price and a qty of the pair, e.g.
+     * (exit_price - entry_price) * qty
+     *
+     */
+    double GetPnlDouble(PnlFixed pnl) const {
+        return static_cast<double>(pnl) *
+               Pow10Inverse(price_precission + qty_precission);
     }
 };
 
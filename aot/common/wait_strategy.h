@@ -0,0 +1,142 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace common {
+/// How a service thread waits when its queues are empty.
+enum class WaitPolicy : uint8_t {
+    /// polls without a break, lowest latency, one core at 100%
+    kBusySpin,
+    /// spins, then pauses the core between polls
+    kSpinPause,
+    /// spins, then yields the core to other threads between polls
+    kSpinYield,
+    /// spins, then sleeps on a futex until a producer calls Notify()
+    kSpinPark
+};
+
+/// policy by its name in configs: busy_spin, spin_pause, spin_yield, spin_park
+inline std::optional<WaitPolicy> WaitPolicyFromString(std::string_view name) {
+    if (name == "busy_spin") return WaitPolicy::kBusySpin;
+    if (name == "spin_pause") return WaitPolicy::kSpinPause;
+    if (name == "spin_yield") return WaitPolicy::kSpinYield;
+    if (name == "spin_park") return WaitPolicy::kSpinPark;
+    return std::nullopt;
+}
+
+/**
+ * @brief waits of a thread that polls lock free queues.
+ *
+ * The loop of the service calls Busy() after a poll that found work and
+ * Idle(has_work) after a poll that found nothing. The first spins empty polls
+ * return at once, then the policy pauses, yields or parks the thread.
+ *
+ * A parked thread sleeps until a producer calls Notify() after it enqueues, or
+ * until park_timeout, so producers that never notify are served too, with a
+ * latency up to park_timeout. Notify() costs a fence and a load while the
+ * consumer is awake and a futex wake only when it is asleep.
+ */
+class WaitStrategy {
+  public:
+    struct Options {
+        WaitPolicy policy = WaitPolicy::kBusySpin;
+        /// empty polls before the thread pauses, yields or parks
+        uint32_t spins    = 1024;
+        /// longest sleep of a parked thread
+        std::chrono::microseconds park_timeout{1000};
+    };
+
+    WaitStrategy() = default;
+    explicit WaitStrategy(Options options) : options_(options) {}
+
+    void SetOptions(Options options) { options_ = options; }
+    const Options& GetOptions() const { return options_; }
+
+    /// consumer: the last poll found work
+    void Busy() { idle_polls_ = 0; }
+
+    /// consumer: the last poll found nothing, has_work() checks the queues
+    /// again before the thread parks
+    template <typename HasWork>
+    void Idle(HasWork&& has_work) {
+        if (options_.policy == WaitPolicy::kBusySpin) return;
+        if (idle_polls_ < options_.spins) {
+            ++idle_polls_;
+            return;
+        }
+        switch (options_.policy) {
+            case WaitPolicy::kSpinPause:
+                Pause();
+                break;
+            case WaitPolicy::kSpinYield:
+                std::this_thread::yield();
+                break;
+            case WaitPolicy::kSpinPark:
+                Park(has_work);
+                break;
+            case WaitPolicy::kBusySpin:
+                break;
+        }
+    }
+
+    /// producers: wakes the consumer if it is parked, call after enqueue
+    void Notify() {
+        if (options_.policy != WaitPolicy::kSpinPark) return;
+        // pairs with the fence in Park(): either the consumer sees the item or
+        // the producer sees the consumer asleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!sleeping_.load(std::memory_order_relaxed)) return;
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        Futex(FUTEX_WAKE_PRIVATE, 1, nullptr);
+    }
+
+    /// times the consumer parked
+    uint64_t Parks() const { return parks_; }
+
+  private:
+    static void Pause() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    template <typename HasWork>
+    void Park(HasWork& has_work) {
+        const auto epoch = epoch_.load(std::memory_order_relaxed);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_work()) {
+            const auto timeout = options_.park_timeout.count();
+            timespec until{.tv_sec  = timeout / 1'000'000,
+                           .tv_nsec = timeout % 1'000'000 * 1'000};
+            Futex(FUTEX_WAIT_PRIVATE, epoch, &until);
+            ++parks_;
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    long Futex(int op, uint32_t value, const timespec* timeout) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), op,
+                       value, timeout, nullptr, 0);
+    }
+
+    Options options_;
+    uint32_t idle_polls_ = 0;
+    uint64_t parks_      = 0;
+    /// written by producers, apart from the fields of the consumer
+    alignas(64) std::atomic<bool> sleeping_{false};
+    std::atomic<uint32_t> epoch_{0};
+};
+}  // namespace common
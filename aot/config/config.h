@@ -5,6 +5,7 @@
 
 #include "aot/Logger.h" 
 #include "aot/common/types.h"
+#include "aot/common/wait_strategy.h"
 
 using namespace std::string_view_literals;
 namespace config {
@@ -98,6 +99,44 @@ class ApiSecretKey : public IApiKey,
     ApiSecretKey operator=(const BackTesting& other) = delete;
 };
 
+class IWaitStrategy {
+  public:
+    /**
+     * @brief wait strategy of the service thread, busy spin if the service
+     * has no section in the config
+     */
+    virtual common::WaitStrategy::Options WaitStrategy(
+        std::string_view service) = 0;
+    virtual ~IWaitStrategy() = default;
+};
+
+/**
+ * @brief reads wait strategies of service threads, one section per service:
+ *
+ * [wait_strategy.order_gateway]
+ * policy = "spin_park"   # busy_spin, spin_pause, spin_yield or spin_park
+ * spins = 1024           # empty polls before the thread pauses/yields/parks
+ * park_timeout_us = 1000 # longest sleep of a parked thread
+ */
+class WaitStrategies : public IWaitStrategy {
+    static constexpr std::string_view kWaitStrategyField = "wait_strategy";
+    static constexpr std::string_view kPolicy            = "policy";
+    static constexpr std::string_view kSpins             = "spins";
+    static constexpr std::string_view kParkTimeoutUs     = "park_timeout_us";
+
+    toml::table config;
+
+  public:
+    explicit WaitStrategies(std::string_view path_to_toml);
+    common::WaitStrategy::Options WaitStrategy(
+        std::string_view service) override;
+    ~WaitStrategies() override = default;
+  private:
+    WaitStrategies()                                      = delete;
+    WaitStrategies(const WaitStrategies& other)           = delete;
+    WaitStrategies operator=(const WaitStrategies& other) = delete;
+};
+
 /**
  * @class TickerManager
  * @brief A class responsible for managing tickers and their mappings.
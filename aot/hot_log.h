@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "aot/Logger.h"
+
+/**
+ * @brief logging of hot paths with a level per subsystem.
+ *
+ * A site below the compile time level of its subsystem is discarded by
+ * if constexpr, its arguments are neither formatted nor evaluated and no code
+ * is emitted. Sites above it are checked against the runtime level of the
+ * subsystem, then against the global level of fmtlog.
+ *
+ * Compile time levels are FMTLOG_LEVEL_* values. AOT_HOT_LOG_LEVEL sets all
+ * subsystems, AOT_LOG_LEVEL_<SUBSYSTEM> overrides one of them:
+ * @code
+ * -DAOT_HOT_LOG_LEVEL=FMTLOG_LEVEL_WRN -DAOT_LOG_LEVEL_ORDER_BOOK=FMTLOG_LEVEL_DBG
+ * @endcode
+ *
+ * hlogd/hlogi/hlogw log every call, hlogdl/hlogil/hlogwl at most once per
+ * min_interval nanoseconds per site, hlogdn/hlogin/hlogwn one of n calls per
+ * site and thread. Errors are not hot, use loge.
+ */
+#ifndef AOT_HOT_LOG_LEVEL
+#define AOT_HOT_LOG_LEVEL FMTLOG_LEVEL_WRN
+#endif
+#ifndef AOT_LOG_LEVEL_ORDER_BOOK
+#define AOT_LOG_LEVEL_ORDER_BOOK AOT_HOT_LOG_LEVEL
+#endif
+#ifndef AOT_LOG_LEVEL_WS
+#define AOT_LOG_LEVEL_WS AOT_HOT_LOG_LEVEL
+#endif
+#ifndef AOT_LOG_LEVEL_PARSER
+#define AOT_LOG_LEVEL_PARSER AOT_HOT_LOG_LEVEL
+#endif
+#ifndef AOT_LOG_LEVEL_STRATEGY
+#define AOT_LOG_LEVEL_STRATEGY AOT_HOT_LOG_LEVEL
+#endif
+
+namespace aot::log {
+enum class Subsystem : uint8_t {
+    kOrderBook,  ///< MarketOrderBook2 and OrderBookComponent
+    kWs,         ///< read loops of websocket sessions
+    kParser,     ///< handlers of exchange responses
+    kStrategy,   ///< handlers of BBO in strategies
+    kCount
+};
+
+/// min_interval of hlog*l for a message at most once a second
+inline constexpr int64_t kSecondNs = 1'000'000'000;
+
+inline constexpr std::array<int, static_cast<size_t>(Subsystem::kCount)>
+    kCompiledLevels{AOT_LOG_LEVEL_ORDER_BOOK, AOT_LOG_LEVEL_WS,
+                    AOT_LOG_LEVEL_PARSER, AOT_LOG_LEVEL_STRATEGY};
+
+/// true if sites of the level are compiled in for the subsystem
+constexpr bool IsCompiled(Subsystem subsystem, fmtlog::LogLevel level) {
+    return level >= FMTLOG_ACTIVE_LEVEL &&
+           level >= kCompiledLevels[static_cast<size_t>(subsystem)];
+}
+
+namespace detail {
+inline std::array<std::atomic<uint8_t>, static_cast<size_t>(Subsystem::kCount)>
+    runtime_levels{};
+}  // namespace detail
+
+/// Runtime level of the subsystem, it can't enable compiled out sites.
+inline void SetLevel(Subsystem subsystem, fmtlog::LogLevel level) {
+    detail::runtime_levels[static_cast<size_t>(subsystem)].store(
+        level, std::memory_order_relaxed);
+}
+inline fmtlog::LogLevel GetLevel(Subsystem subsystem) {
+    return static_cast<fmtlog::LogLevel>(
+        detail::runtime_levels[static_cast<size_t>(subsystem)].load(
+            std::memory_order_relaxed));
+}
+inline bool IsEnabled(Subsystem subsystem, fmtlog::LogLevel level) {
+    return level >= GetLevel(subsystem);
+}
+}  // namespace aot::log
+
+#define AOT_HOT_LOG(subsystem, level, format, ...)                          \
+    do {                                                                    \
+        if constexpr (::aot::log::IsCompiled(                               \
+                          ::aot::log::Subsystem::subsystem, level)) {       \
+            if (::aot::log::IsEnabled(::aot::log::Subsystem::subsystem,     \
+                                      level))                               \
+                FMTLOG(level, format, ##__VA_ARGS__);                       \
+        }                                                                   \
+    } while (0)
+
+#define AOT_HOT_LOG_LIMIT(subsystem, min_interval, level, format, ...)      \
+    do {                                                                    \
+        if constexpr (::aot::log::IsCompiled(                               \
+                          ::aot::log::Subsystem::subsystem, level)) {       \
+            if (::aot::log::IsEnabled(::aot::log::Subsystem::subsystem,     \
+                                      level))                               \
+                FMTLOG_LIMIT(min_interval, level, format, ##__VA_ARGS__);   \
+        }                                                                   \
+    } while (0)
+
+#define AOT_HOT_LOG_EVERY_N(subsystem, n, level, format, ...)               \
+    do {                                                                    \
+        if constexpr (::aot::log::IsCompiled(                               \
+                          ::aot::log::Subsystem::subsystem, level)) {       \
+            static thread_local uint64_t aot_hot_log_calls = 0;             \
+            if (::aot::log::IsEnabled(::aot::log::Subsystem::subsystem,     \
+                                      level) &&                             \
+                aot_hot_log_calls++ % (n) == 0)                             \
+                FMTLOG(level, format, ##__VA_ARGS__);                       \
+        }                                                                   \
+    } while (0)
+
+#define hlogd(subsystem, format, ...) \
+    AOT_HOT_LOG(subsystem, fmtlog::DBG, format, ##__VA_ARGS__)
+#define hlogi(subsystem, format, ...) \
+    AOT_HOT_LOG(subsystem, fmtlog::INF, format, ##__VA_ARGS__)
+#define hlogw(subsystem, format, ...) \
+    AOT_HOT_LOG(subsystem, fmtlog::WRN, format, ##__VA_ARGS__)
+
+#define hlogdl(subsystem, min_interval, format, ...) \
+    AOT_HOT_LOG_LIMIT(subsystem, min_interval, fmtlog::DBG, format, ##__VA_ARGS__)
+#define hlogil(subsystem, min_interval, format, ...) \
+    AOT_HOT_LOG_LIMIT(subsystem, min_interval, fmtlog::INF, format, ##__VA_ARGS__)
+#define hlogwl(subsystem, min_interval, format, ...) \
+    AOT_HOT_LOG_LIMIT(subsystem, min_interval, fmtlog::WRN, format, ##__VA_ARGS__)
+
+#define hlogdn(subsystem, n, format, ...) \
+    AOT_HOT_LOG_EVERY_N(subsystem, n, fmtlog::DBG, format, ##__VA_ARGS__)
+#define hlogin(subsystem, n, format, ...) \
+    AOT_HOT_LOG_EVERY_N(subsystem, n, fmtlog::INF, format, ##__VA_ARGS__)
+#define hlogwn(subsystem, n, format, ...) \
+    AOT_HOT_LOG_EVERY_N(subsystem, n, fmtlog::WRN, format, ##__VA_ARGS__)
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <variant>
 
 #include "aot/Logger.h"
 #include "aot/bus/bus_component.h"
+#include "aot/bus/bus_envelope.h"
 #include "aot/bus/bus_event.h"
+#include "aot/common/level_vector.h"
 #include "aot/common/mem_pool.h"
 #include "aot/common/types.h"
 #include "aot/event/general_event.h"
@@ -132,6 +133,9 @@ struct BusEventMEMarketUpdate2
     boost::intrusive_ptr<Exchange::MEMarketUpdate2> wrapped_event_;
 };
 
+/// MEMarketUpdate2 and its bus event in one block, see aot::BusEnvelope
+using MEMarketUpdate2EnvelopePool = MEMarketUpdate2Envelope::Pool;
+
 using EventLFQueue = moodycamel::ConcurrentQueue<MEMarketUpdate>;
 
 struct BookSnapshotElem {
@@ -144,21 +148,29 @@ struct BookSnapshotElem {
     };
 };
 
+/**
+ * @brief levels of diffs up to this depth are stored inside the event, deeper
+ * diffs and snapshots spill into a pooled slab
+ *
+ */
+constexpr size_t kInlineBookLevels = 64;
+using BookLevels = common::LevelVector<BookSnapshotElem, kInlineBookLevels>;
+
 struct BookSnapshot2;
 using BookSnapshot2Pool = common::MemoryPool<BookSnapshot2>;
 
 struct BookSnapshot2 : public aot::Event<BookSnapshot2Pool> {
     common::ExchangeId exchange_id = common::kExchangeIdInvalid;
     common::TradingPair trading_pair;
-    std::list<BookSnapshotElem> bids;
-    std::list<BookSnapshotElem> asks;
+    BookLevels bids;
+    BookLevels asks;
     uint64_t lastUpdateId = std::numeric_limits<uint64_t>::max();
     BookSnapshot2() : aot::Event<BookSnapshot2Pool>(nullptr) {};
 
     BookSnapshot2(BookSnapshot2Pool* mem_pool, common::ExchangeId _exchange_id,
                   common::TradingPair _trading_pair,
-                  std::list<BookSnapshotElem>&& _bids,
-                  std::list<BookSnapshotElem>&& _asks, uint64_t _lastUpdateId)
+                  BookLevels&& _bids,
+                  BookLevels&& _asks, uint64_t _lastUpdateId)
         : aot::Event<BookSnapshot2Pool>(mem_pool),
           exchange_id(_exchange_id),
           trading_pair(_trading_pair),
@@ -189,8 +201,8 @@ using BookSnapshotPool = common::MemoryPool<BookSnapshot>;
 struct BookSnapshot {
     common::ExchangeId exchange_id = common::kExchangeIdInvalid;
     common::TradingPair trading_pair;
-    std::list<BookSnapshotElem> bids;
-    std::list<BookSnapshotElem> asks;
+    BookLevels bids;
+    BookLevels asks;
     // i think lastUpdateId must negotiate number
     uint64_t lastUpdateId = 0;
 
@@ -340,8 +352,8 @@ struct BookDiffSnapshot;
 struct BookDiffSnapshot2 : public aot::Event<BookDiff2SnapshotPool> {
     common::ExchangeId exchange_id = common::kExchangeIdInvalid;
     common::TradingPair trading_pair;
-    std::list<BookSnapshotElem> bids;
-    std::list<BookSnapshotElem> asks;
+    BookLevels bids;
+    BookLevels asks;
     uint64_t first_id = std::numeric_limits<uint64_t>::max();
     uint64_t last_id  = std::numeric_limits<uint64_t>::max();
     /**
@@ -353,8 +365,8 @@ struct BookDiffSnapshot2 : public aot::Event<BookDiff2SnapshotPool> {
     BookDiffSnapshot2(BookDiff2SnapshotPool* mem_pool,
                       common::ExchangeId _exchange_id,
                       common::TradingPair _trading_pair,
-                      std::list<BookSnapshotElem>&& _bids,
-                      std::list<BookSnapshotElem>&& _asks, uint64_t _first_id,
+                      BookLevels&& _bids,
+                      BookLevels&& _asks, uint64_t _first_id,
                       uint64_t _last_id)
         : aot::Event<BookDiff2SnapshotPool>(mem_pool),
           exchange_id(_exchange_id),
@@ -366,8 +378,8 @@ struct BookDiffSnapshot2 : public aot::Event<BookDiff2SnapshotPool> {
     BookDiffSnapshot2(BookDiff2SnapshotPool* mem_pool,
                       common::ExchangeId _exchange_id,
                       common::TradingPair _trading_pair,
-                      std::list<BookSnapshotElem>&& _bids,
-                      std::list<BookSnapshotElem>&& _asks, uint64_t _first_id,
+                      BookLevels&& _bids,
+                      BookLevels&& _asks, uint64_t _first_id,
                       uint64_t _last_id, uint64_t _prev_id)
         : aot::Event<BookDiff2SnapshotPool>(mem_pool),
           exchange_id(_exchange_id),
@@ -399,8 +411,8 @@ using BookDiffSnapshotPool = common::MemoryPool<BookDiffSnapshot>;
 struct BookDiffSnapshot {
     common::ExchangeId exchange_id = common::kExchangeIdInvalid;
     common::TradingPair trading_pair;
-    std::list<BookSnapshotElem> bids;
-    std::list<BookSnapshotElem> asks;
+    BookLevels bids;
+    BookLevels asks;
     uint64_t first_id = std::numeric_limits<uint64_t>::max();
     uint64_t last_id  = std::numeric_limits<uint64_t>::max();
     /**
@@ -7,6 +7,7 @@
 #include "aot/common/macros.h"
 #include "aot/common/thread_utils.h"
 #include "aot/common/time_utils.h"
+#include "aot/common/wait_strategy.h"
 #include "aot/Exchange.h"
 
 namespace inner {
@@ -102,7 +103,18 @@ class OrderGateway2 {
         ASSERT(thread_ != nullptr, "Failed to start OrderGateway thread.");
     }
     common::Delta GetDownTimeInS() { return time_manager_.GetDeltaInS(); }
-    auto Stop() -> void { run_ = false; }
+    auto Stop() -> void {
+        run_ = false;
+        wait_.Notify();
+    }
+    /// how the thread waits for requests, set it before Start()
+    auto SetWaitStrategy(common::WaitStrategy::Options options) -> void {
+        wait_.SetOptions(options);
+    }
+    /// producers of requests call Notify() of it after enqueue
+    common::WaitStrategy *Waiter() { return &wait_; }
+    /// name of the service in the [wait_strategy] table of a config
+    static constexpr std::string_view kServiceName = "order_gateway";
 
     /// Deleted default, copy & move constructors and assignment-operators.
     OrderGateway2()                                 = delete;
@@ -126,6 +138,7 @@ class OrderGateway2 {
     Exchange::ClientResponseLFQueue *incoming_responses_        = nullptr;
 
     volatile bool run_                                          = false;
+    common::WaitStrategy wait_;
 
   private:
     std::unique_ptr<std::thread> thread_;
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/common/types.h"
+#include "boost/asio/buffer.hpp"
+#include "boost/beast/http.hpp"
+
+namespace hmac_sha256 {
+/// lower case hex of a sha256 digest, as Signer::Sign() returns it
+constexpr size_t kHexDigestSize = 64;
+
+/**
+ * @brief HMAC-SHA256 keyed once. Unlike Signer::Sign() the key is not hashed
+ * into the inner and outer pads for every message and the hex digest is
+ * written into the buffer of the caller.
+ *
+ * Not thread safe, a signer serves one strand.
+ */
+class KeyedHmac {
+  public:
+    explicit KeyedHmac(std::string_view secret_key) {
+        mac_ = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+        ctx_ = mac_ ? EVP_MAC_CTX_new(mac_) : nullptr;
+        char digest[]       = "SHA256";
+        OSSL_PARAM params[] = {
+            OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest,
+                                             0),
+            OSSL_PARAM_construct_end()};
+        keyed_ = ctx_ &&
+                 EVP_MAC_init(ctx_,
+                              reinterpret_cast<const unsigned char *>(
+                                  secret_key.data()),
+                              secret_key.size(), params) == 1;
+        if (!keyed_) loge("can't init hmac sha256");
+    }
+    ~KeyedHmac() {
+        EVP_MAC_CTX_free(ctx_);
+        EVP_MAC_free(mac_);
+    }
+
+    /**
+     * @brief hex digest of data
+     *
+     * @return false if openssl failed, out is not valid then
+     */
+    bool Sign(std::string_view data, std::span<char, kHexDigestSize> out) {
+        static constexpr char kHex[] = "0123456789abcdef";
+        std::array<unsigned char, EVP_MAX_MD_SIZE> digest;
+        size_t size = 0;
+        // init without a key restarts from the pads of the key given once
+        if (!keyed_ || EVP_MAC_init(ctx_, nullptr, 0, nullptr) != 1 ||
+            EVP_MAC_update(ctx_,
+                           reinterpret_cast<const unsigned char *>(data.data()),
+                           data.size()) != 1 ||
+            EVP_MAC_final(ctx_, digest.data(), &size, digest.size()) != 1 ||
+            size * 2 != kHexDigestSize) [[unlikely]] {
+            loge("can't sign {} bytes", data.size());
+            return false;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            out[2 * i]     = kHex[digest[i] >> 4];
+            out[2 * i + 1] = kHex[digest[i] & 0x0F];
+        }
+        return true;
+    }
+    bool Valid() const { return keyed_; }
+
+    KeyedHmac(const KeyedHmac &)            = delete;
+    KeyedHmac &operator=(const KeyedHmac &) = delete;
+
+  private:
+    EVP_MAC *mac_     = nullptr;
+    EVP_MAC_CTX *ctx_ = nullptr;
+    bool keyed_       = false;
+};
+};  // namespace hmac_sha256
+
+namespace aot {
+/// values which change from order to order of one template
+enum class RequestField : uint8_t {
+    kPrice,
+    kQty,
+    kClientId,
+    kTimestamp,
+    kSignature,
+    kContentLength
+};
+constexpr size_t kRequestFields = 6;
+using RequestValues             = std::array<std::string_view, kRequestFields>;
+
+/**
+ * @brief placeholders put into a probe order instead of the values, they pass
+ * unchanged through query strings, json and headers
+ */
+constexpr std::string_view kPriceMarker     = "@price@";
+constexpr std::string_view kQtyMarker       = "@qty@";
+constexpr std::string_view kClientIdMarker  = "@client_id@";
+constexpr std::string_view kSignatureMarker = "@signature@";
+
+struct RequestMarker {
+    std::string_view text;
+    RequestField field;
+};
+
+/**
+ * @brief text with holes for RequestField values. Rendering is a sequence of
+ * memcpy into the buffer of the caller
+ */
+class RequestLayout {
+  public:
+    RequestLayout() = default;
+    /// splits rendered at every occurrence of the markers
+    RequestLayout(std::string_view rendered,
+                  std::span<const RequestMarker> markers) {
+        text_.reserve(rendered.size());
+        while (!rendered.empty()) {
+            size_t position              = std::string_view::npos;
+            const RequestMarker *nearest = nullptr;
+            for (const auto &marker : markers) {
+                if (marker.text.empty()) continue;
+                const auto found = rendered.find(marker.text);
+                if (found < position) {
+                    position = found;
+                    nearest  = &marker;
+                }
+            }
+            AddText(rendered.substr(0, position));
+            if (!nearest) break;
+            parts_.push_back({0, 0, nearest->field, true});
+            rendered.remove_prefix(position + nearest->text.size());
+        }
+    }
+
+    bool Has(RequestField field) const {
+        for (const auto &part : parts_)
+            if (part.is_field && part.field == field) return true;
+        return false;
+    }
+    size_t Size(const RequestValues &values) const {
+        size_t size = 0;
+        for (const auto &part : parts_)
+            size += part.is_field
+                        ? values[static_cast<size_t>(part.field)].size()
+                        : part.size;
+        return size;
+    }
+    /**
+     * @return bytes written to out, 0 if they don't fit
+     */
+    size_t Render(std::span<char> out, const RequestValues &values) const {
+        size_t used = 0;
+        for (const auto &part : parts_) {
+            const std::string_view source =
+                part.is_field
+                    ? values[static_cast<size_t>(part.field)]
+                    : std::string_view(text_.data() + part.offset, part.size);
+            if (used + source.size() > out.size()) [[unlikely]]
+                return 0;
+            std::memcpy(out.data() + used, source.data(), source.size());
+            used += source.size();
+        }
+        return used;
+    }
+
+  private:
+    void AddText(std::string_view text) {
+        if (text.empty()) return;
+        parts_.push_back({static_cast<uint32_t>(text_.size()),
+                          static_cast<uint32_t>(text.size()),
+                          RequestField::kPrice, false});
+        text_.append(text);
+    }
+
+    struct Part {
+        uint32_t offset;
+        uint32_t size;
+        RequestField field;
+        bool is_field;
+    };
+    std::string text_;
+    std::vector<Part> parts_;
+};
+
+/// bytes of a beast request as http::write() sends them
+template <class Body>
+std::string SerializeRequest(
+    const boost::beast::http::request<Body> &request) {
+    std::ostringstream out;
+    out << request;
+    return out.str();
+}
+
+/**
+ * @brief signed new order request of one symbol and side rendered once.
+ *
+ * The template is cut from a probe order which went through the usual
+ * FactoryRequest path with markers instead of price, qty, client id and
+ * signature, so the bytes of an order are those the factory would give for
+ * it. An order only copies the pieces into a fixed buffer, signs the payload
+ * with a pre-keyed hmac and patches the signature and Content-Length in.
+ * Nothing is allocated.
+ *
+ * The rendered request is valid until the next Render(), send it with
+ * boost::asio::async_write(stream, request.Buffer()), these are the bytes
+ * beast's serializer would write for the message.
+ */
+class SignedRequestTemplate {
+  public:
+    static constexpr size_t kMaxPayloadSize = 1024;
+    static constexpr size_t kMaxRequestSize = 2048;
+
+    SignedRequestTemplate() = default;
+    /**
+     * @param payload what the probe signer got
+     * @param request serialized probe request
+     * @param timestamp the time in the probe, text of the request
+     * @param hmac keyed with the secret of the account, must outlive the
+     * template
+     */
+    SignedRequestTemplate(std::string_view payload, std::string_view request,
+                          std::string_view timestamp,
+                          hmac_sha256::KeyedHmac &hmac,
+                          uint8_t price_precision, uint8_t qty_precision)
+        : hmac_(&hmac),
+          price_precision_(price_precision),
+          qty_precision_(qty_precision) {
+        const RequestMarker markers[] = {
+            {kPriceMarker, RequestField::kPrice},
+            {kQtyMarker, RequestField::kQty},
+            {kClientIdMarker, RequestField::kClientId},
+            {kSignatureMarker, RequestField::kSignature},
+            {timestamp, RequestField::kTimestamp}};
+        payload_ = RequestLayout(payload, markers);
+
+        const auto header_end = request.find("\r\n\r\n");
+        if (header_end == std::string_view::npos) {
+            loge("probe request has no header");
+            return;
+        }
+        auto header = std::string(request.substr(0, header_end + 4));
+        // the probe body has markers, the length is counted for every order
+        constexpr std::string_view kContentLength       = "Content-Length: ";
+        constexpr std::string_view kContentLengthMarker = "@content_length@";
+        if (const auto start = header.find(kContentLength);
+            start != std::string::npos) {
+            const auto digits = start + kContentLength.size();
+            header.replace(digits, header.find("\r\n", digits) - digits,
+                           kContentLengthMarker);
+        }
+        const RequestMarker header_markers[] = {
+            {kSignatureMarker, RequestField::kSignature},
+            {timestamp, RequestField::kTimestamp},
+            {kContentLengthMarker, RequestField::kContentLength},
+            {kPriceMarker, RequestField::kPrice},
+            {kQtyMarker, RequestField::kQty},
+            {kClientIdMarker, RequestField::kClientId}};
+        header_ = RequestLayout(header, header_markers);
+        body_   = RequestLayout(request.substr(header_end + 4), markers);
+        valid_  = !payload_.Has(RequestField::kSignature) &&
+                 (header_.Has(RequestField::kSignature) ||
+                  body_.Has(RequestField::kSignature));
+        if (!valid_) loge("probe request is not signed");
+    }
+
+    /**
+     * @param price fixed point with the precision of the trading pair
+     * @param qty fixed point with the precision of the trading pair
+     * @param timestamp ms since epoch, as CurrentTime gives it
+     * @return the request, empty if it can't be rendered
+     */
+    std::string_view Render(common::Price price, common::Qty qty,
+                            common::OrderId order_id, uint64_t timestamp) {
+        if (!valid_ || order_id == common::kOrderIdInvalid) [[unlikely]] {
+            loge("can't render order {}", order_id);
+            return {};
+        }
+        RequestValues values;
+        values[Index(RequestField::kPrice)] =
+            Decimal(price, price_precision_, price_);
+        values[Index(RequestField::kQty)] = Decimal(qty, qty_precision_, qty_);
+        values[Index(RequestField::kClientId)]  = Integer(order_id, client_id_);
+        values[Index(RequestField::kTimestamp)] = Integer(timestamp, time_);
+
+        const auto payload_size = payload_.Render(payload_buffer_, values);
+        if (!payload_size ||
+            !hmac_->Sign({payload_buffer_.data(), payload_size}, signature_))
+            [[unlikely]]
+            return {};
+        values[Index(RequestField::kSignature)] = {signature_.data(),
+                                                   signature_.size()};
+        values[Index(RequestField::kContentLength)] =
+            Integer(body_.Size(values), content_length_);
+
+        const auto header_size = header_.Render(request_buffer_, values);
+        const auto body_size   = header_size ? body_.Render(
+                                                 std::span(request_buffer_)
+                                                     .subspan(header_size),
+                                                 values)
+                                             : 0;
+        if (!header_size || (!body_size && body_.Size(values))) [[unlikely]] {
+            loge("order {} doesn't fit into {} bytes", order_id,
+                 kMaxRequestSize);
+            return {};
+        }
+        size_ = header_size + body_size;
+        return {request_buffer_.data(), size_};
+    }
+    /// the last rendered request
+    boost::asio::const_buffer Buffer() const {
+        return boost::asio::buffer(request_buffer_.data(), size_);
+    }
+    bool Valid() const { return valid_; }
+
+  private:
+    static constexpr size_t Index(RequestField field) {
+        return static_cast<size_t>(field);
+    }
+    /// fixed point as fmt::format("{:.{}f}") prints value * 10^-precision
+    template <size_t N>
+    static std::string_view Decimal(uint64_t value, uint8_t precision,
+                                    std::array<char, N> &buffer) {
+        uint64_t scale = 1;
+        for (uint8_t i = 0; i < precision; ++i) scale *= 10;
+        auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + N,
+                                       value / scale);
+        if (precision) {
+            *end++ = '.';
+            auto fraction = value % scale;
+            for (auto digit = end + precision; digit != end; fraction /= 10)
+                *--digit = static_cast<char>('0' + fraction % 10);
+            end += precision;
+        }
+        return {buffer.data(), static_cast<size_t>(end - buffer.data())};
+    }
+    template <size_t N>
+    static std::string_view Integer(uint64_t value,
+                                    std::array<char, N> &buffer) {
+        auto [end, ec] =
+            std::to_chars(buffer.data(), buffer.data() + N, value);
+        return {buffer.data(), static_cast<size_t>(end - buffer.data())};
+    }
+
+    RequestLayout payload_;
+    RequestLayout header_;
+    RequestLayout body_;
+    hmac_sha256::KeyedHmac *hmac_ = nullptr;
+    uint8_t price_precision_      = 0;
+    uint8_t qty_precision_        = 0;
+    bool valid_                   = false;
+    size_t size_                  = 0;
+    /// 20 digits of uint64_t, a point and up to 19 digits of precision
+    std::array<char, 48> price_;
+    std::array<char, 48> qty_;
+    std::array<char, 24> client_id_;
+    std::array<char, 24> time_;
+    std::array<char, 24> content_length_;
+    std::array<char, hmac_sha256::kHexDigestSize> signature_;
+    std::array<char, kMaxPayloadSize> payload_buffer_;
+    std::array<char, kMaxRequestSize> request_buffer_;
+};
+}  // namespace aot
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "aot/common/fixed_point.h"
+#include "aot/common/types.h"
+
+namespace aot {
+/**
+ * @brief positions and P&L of many instruments in fixed point.
+ *
+ * Prices and qty stay integers of their trading pair, P&L is PnlFixed in units
+ * of 10^-(price_precission + qty_precission). Fills and BBO updates are exact
+ * and O(1) per instrument, double appears only in the *Double() getters for
+ * reporting.
+ *
+ * An open position keeps the cost of its lots at the average price. Closing a
+ * part of it moves the share of the cost to realised P&L rounded to a unit,
+ * the remainder stays in the cost: realised + unrealised is always exact and a
+ * flat position has no rounding at all. Unrealised P&L is marked to the mid of
+ * the last BBO, or to the price of the last fill as Trading::PositionInfo does.
+ *
+ * Ids are dense and go from 0, e.g. InstrumentId of InstrumentRegistry when
+ * instruments are added in the order of registration.
+ */
+class PnlBook {
+  public:
+    using Id = uint32_t;
+
+    /// new flat instrument, scale of its P&L is cached from info
+    Id AddInstrument(const common::TradingPairInfo& info) {
+        const auto id = static_cast<Id>(instruments_.size());
+        instruments_.push_back(
+            {.scale = common::Pow10Inverse(info.price_precission +
+                                           info.qty_precission)});
+        return id;
+    }
+    size_t Size() const { return instruments_.size(); }
+
+    /**
+     * @brief process an execution of qty at price
+     *
+     * @param side as in Trading::PositionInfo::addFill(), sideToValue(side) is
+     * the sign of the change of the position
+     */
+    void AddFill(Id id, common::Side side, common::Price price,
+                 common::Qty qty) noexcept {
+        auto& instrument       = instruments_[id];
+        const int64_t sign     = common::sideToValue(side);
+        const auto fill_price  = static_cast<common::PnlFixed>(price);
+        auto remaining         = static_cast<int64_t>(qty);
+        const int64_t position = instrument.position;
+        if (position * sign < 0) {
+            // decreased position, cost of the closed lots is realised
+            const int64_t open   = std::abs(position);
+            const int64_t closed = std::min(remaining, open);
+            const common::PnlFixed closed_cost =
+                closed == open ? instrument.cost
+                               : instrument.cost * closed / open;
+            instrument.real_pnl -= sign * closed * fill_price + closed_cost;
+            instrument.cost     -= closed_cost;
+            instrument.position += sign * closed;
+            remaining           -= closed;
+        }
+        // opened, increased or flipped position
+        instrument.position += sign * remaining;
+        instrument.cost     += sign * remaining * fill_price;
+        instrument.mark_x2   = 2 * fill_price;
+        Mark(instrument);
+    }
+
+    /// mark the position to the mid, invalid prices keep the previous mark
+    void UpdateBBO(Id id, common::Price bid, common::Price ask) noexcept {
+        if (bid == common::kPriceInvalid || ask == common::kPriceInvalid)
+            [[unlikely]]
+            return;
+        auto& instrument   = instruments_[id];
+        instrument.mark_x2 = static_cast<common::PnlFixed>(bid) + ask;
+        Mark(instrument);
+    }
+
+    /// signed qty of the position, positive after fills of common::Side::kAsk
+    int64_t Position(Id id) const { return instruments_[id].position; }
+    common::PnlFixed RealPnl(Id id) const { return instruments_[id].real_pnl; }
+    /// truncated to a unit, the mid may be a half of the price step
+    common::PnlFixed UnrealPnl(Id id) const {
+        return instruments_[id].unreal_pnl_x2 / 2;
+    }
+
+    double RealPnlDouble(Id id) const {
+        const auto& instrument = instruments_[id];
+        return static_cast<double>(instrument.real_pnl) * instrument.scale;
+    }
+    double UnrealPnlDouble(Id id) const {
+        const auto& instrument = instruments_[id];
+        return static_cast<double>(instrument.unreal_pnl_x2) *
+               (instrument.scale * 0.5);
+    }
+    double TotalPnlDouble(Id id) const {
+        const auto& instrument = instruments_[id];
+        return static_cast<double>(2 * instrument.real_pnl +
+                                   instrument.unreal_pnl_x2) *
+               (instrument.scale * 0.5);
+    }
+    /// sum over all instruments, e.g. for a report of the position keeper
+    double TotalPnlDouble() const {
+        double total = 0;
+        for (Id id = 0; id < instruments_.size(); ++id)
+            total += TotalPnlDouble(id);
+        return total;
+    }
+
+  private:
+    struct Instrument {
+        /// price * qty of the open lots, signed as the position
+        common::PnlFixed cost          = 0;
+        common::PnlFixed real_pnl      = 0;
+        /// doubled to keep the mid an integer
+        common::PnlFixed unreal_pnl_x2 = 0;
+        common::PnlFixed mark_x2       = 0;
+        int64_t position               = 0;
+        /// 10^-(price_precission + qty_precission)
+        double scale                   = 1;
+    };
+
+    static void Mark(Instrument& instrument) noexcept {
+        instrument.unreal_pnl_x2 = instrument.position * instrument.mark_x2 -
+                                   2 * instrument.cost;
+    }
+
+    std::vector<Instrument> instruments_;
+};
+};  // namespace aot
@@ -29,18 +29,16 @@ class PnlCalculator {
             return {false, 0.0};
         }
 
-        auto min_qty = std::min(transaction.entry_qty, transaction.exit_qty);
-        auto min_qty_double = pair_info->GetQtyDouble(min_qty);
-        auto price_exit_double =
-            pair_info->GetPriceDouble(transaction.exit_price);
-        auto price_enter_double =
-            pair_info->GetPriceDouble(transaction.entry_price);
-
-        double pnl =
-            (transaction.operation == aot::Operation::kSell)
-                ? (price_enter_double - price_exit_double) * min_qty_double
-                : (price_exit_double - price_enter_double) * min_qty_double;
-        transaction.pnl = pnl;
+        // prices and qty stay integers, the product is converted once
+        const auto min_qty =
+            std::min(transaction.entry_qty, transaction.exit_qty);
+        common::PnlFixed price_diff =
+            static_cast<common::PnlFixed>(transaction.exit_price) -
+            static_cast<common::PnlFixed>(transaction.entry_price);
+        if (transaction.operation == aot::Operation::kSell)
+            price_diff = -price_diff;
+        const double pnl = pair_info->GetPnlDouble(price_diff * min_qty);
+        transaction.pnl  = pnl;
         return {true, pnl};
     };
     std::pair<bool, double> CalculatePnl(aot::TradeState& trade_state) const {
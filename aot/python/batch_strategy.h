@@ -0,0 +1,184 @@
+#pragma once
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include <stdlib.h>
+
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "aot/Logger.h"
+#include "aot/strategy/inference.h"
+
+namespace base_strategy {
+/**
+ * @brief python predictor scored in batches on the inference thread.
+ *
+ * Unlike Strategy::Predict() there is one python call per batch: the feature
+ * matrix is handed over as a rows x columns memoryview of float64 over the
+ * buffer of InferenceService, numpy.asarray() of it does not copy. The method
+ * returns any buffer of rows float64 scores (a numpy array, array('d')), they
+ * are copied out with the buffer protocol. No PyFloat per value, no dict and
+ * no strings.
+ *
+ * The method must not keep its argument after it returns, the memory is
+ * reused by the next batch.
+ *
+ * The interpreter is initialised on the inference thread if nobody did it
+ * before, and the GIL is released between batches, so other threads may use
+ * python with PyGILState_Ensure().
+ *
+ * @code
+ * class Predictor:
+ *     def predict_batch(self, candles):
+ *         rows = numpy.asarray(candles)  # rows x 5: open high low close volume
+ *         return self.model.predict(rows)
+ * @endcode
+ */
+class BatchStrategy : public inference::BatchModel {
+  public:
+    /**
+     * @param python_path PYTHONPATH environment variable, path where need
+     * search python modules
+     * @param path_where_models the only argument of the constructor of the
+     * predictor class
+     * @param file_predictor name of the file of the predictor class
+     * @param class_predictor name of the python predictor class
+     * @param method_predictor method which takes a batch and returns scores
+     */
+    BatchStrategy(std::string_view python_path,
+                  std::string_view path_where_models,
+                  std::string_view file_predictor,
+                  std::string_view class_predictor,
+                  std::string_view method_predictor = "predict_batch",
+                  size_t columns = inference::kOhlcvFeatures)
+        : python_path_(python_path),
+          path_where_models_(path_where_models),
+          file_predictor_(file_predictor),
+          class_predictor_(class_predictor),
+          method_predictor_(method_predictor),
+          columns_(columns) {}
+    ~BatchStrategy() override = default;
+
+    bool Init() override {
+        owns_interpreter_ = !Py_IsInitialized();
+        if (owns_interpreter_) {
+            setenv("PYTHONPATH", python_path_.c_str(), 1);
+            Py_InitializeEx(0);
+        }
+        auto gil    = PyGILState_Ensure();
+        bool status = LoadPredictor();
+        PyGILState_Release(gil);
+        // the thread keeps the GIL after Py_InitializeEx(), let it go until
+        // the first batch
+        if (owns_interpreter_) thread_state_ = PyEval_SaveThread();
+        return status;
+    }
+
+    bool Predict(std::span<const double> features, size_t rows,
+                 std::span<double> scores) override {
+        auto gil    = PyGILState_Ensure();
+        bool status = CallPredictor(features, rows, scores);
+        PyGILState_Release(gil);
+        return status;
+    }
+
+    size_t Columns() const override { return columns_; }
+
+    void Shutdown() override {
+        auto gil = PyGILState_Ensure();
+        Py_CLEAR(method_name_);
+        Py_CLEAR(predictor_instance_);
+        PyGILState_Release(gil);
+        if (owns_interpreter_ && thread_state_) {
+            PyEval_RestoreThread(thread_state_);
+            thread_state_ = nullptr;
+            Py_FinalizeEx();
+        }
+    }
+
+  private:
+    bool LoadPredictor() {
+        const auto module_name =
+            file_predictor_.substr(0, file_predictor_.find_last_of('.'));
+        PyObject *module = PyImport_ImportModule(module_name.c_str());
+        if (!module) return Failed("can't import module");
+        PyObject *predictor_class =
+            PyObject_GetAttrString(module, class_predictor_.c_str());
+        Py_DECREF(module);
+        if (!predictor_class) return Failed("can't find predictor class");
+        predictor_instance_ = PyObject_CallFunction(
+            predictor_class, "s", path_where_models_.c_str());
+        Py_DECREF(predictor_class);
+        if (!predictor_instance_) return Failed("can't create predictor");
+        method_name_ = PyUnicode_FromString(method_predictor_.c_str());
+        if (!method_name_ ||
+            !PyObject_HasAttr(predictor_instance_, method_name_))
+            return Failed("predictor has no batch method");
+        return true;
+    }
+
+    bool CallPredictor(std::span<const double> features, size_t rows,
+                       std::span<double> scores) {
+        PyObject *memory = PyMemoryView_FromMemory(
+            const_cast<char *>(reinterpret_cast<const char *>(features.data())),
+            static_cast<Py_ssize_t>(features.size_bytes()), PyBUF_READ);
+        if (!memory) return Failed("can't wrap features");
+        PyObject *candles =
+            PyObject_CallMethod(memory, "cast", "s(nn)", "d",
+                                static_cast<Py_ssize_t>(rows),
+                                static_cast<Py_ssize_t>(columns_));
+        Py_DECREF(memory);
+        if (!candles) return Failed("can't shape features");
+        PyObject *result = PyObject_CallMethodOneArg(predictor_instance_,
+                                                     method_name_, candles);
+        // a predictor which kept the view would read the next batch
+        PyObject *released = PyObject_CallMethod(candles, "release", nullptr);
+        Py_DECREF(candles);
+        if (!released) {
+            Py_XDECREF(result);
+            return Failed("predictor kept the batch");
+        }
+        Py_DECREF(released);
+        if (!result) return Failed("predict failed");
+        Py_buffer buffer;
+        if (PyObject_GetBuffer(result, &buffer,
+                               PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+            Py_DECREF(result);
+            return Failed("scores don't support the buffer protocol");
+        }
+        const size_t bytes = rows * sizeof(double);
+        const bool valid   = buffer.itemsize == sizeof(double) &&
+                           buffer.format &&
+                           std::strcmp(buffer.format, "d") == 0 &&
+                           buffer.len == static_cast<Py_ssize_t>(bytes);
+        if (valid) std::memcpy(scores.data(), buffer.buf, bytes);
+        PyBuffer_Release(&buffer);
+        Py_DECREF(result);
+        if (!valid) {
+            loge("predictor must return {} float64 scores", rows);
+            return false;
+        }
+        return true;
+    }
+
+    bool Failed(std::string_view what) {
+        if (PyErr_Occurred()) PyErr_Print();
+        loge("{} of {}.{}", what, file_predictor_, class_predictor_);
+        return false;
+    }
+
+    std::string python_path_;
+    std::string path_where_models_;
+    std::string file_predictor_;
+    std::string class_predictor_;
+    std::string method_predictor_;
+    size_t columns_;
+    bool owns_interpreter_        = false;
+    PyThreadState *thread_state_  = nullptr;
+    PyObject *predictor_instance_ = nullptr;
+    PyObject *method_name_        = nullptr;
+};
+}  // namespace base_strategy
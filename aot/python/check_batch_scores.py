@@ -0,0 +1,41 @@
+"""checks that BaseStrategy.get_scores gives the scores of get_score row by row
+
+usage: python check_batch_scores.py path_where_models [klines.csv] [rows]
+
+klines.csv is a recorded kline series with open high low close volume
+columns, tab separated as downloader.py writes it. Without it the last rows of
+the history of the models are scored. Exits with 1 if a score differs.
+"""
+import sys
+
+import numpy as np
+import pandas as pd
+
+import prepare_model_for_bot as my_strategy
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 2
+    strategy = my_strategy.BaseStrategy(sys.argv[1])
+    rows = int(sys.argv[3]) if len(sys.argv) > 3 else 200
+    if len(sys.argv) > 2:
+        klines = pd.read_csv(sys.argv[2], sep='\t')
+    else:
+        klines = strategy.__data__
+    candles = (klines[['open', 'high', 'low', 'close', 'volume']]
+               .tail(rows)
+               .to_numpy(dtype=np.float64))
+
+    batch = strategy.get_scores(candles)
+    single = np.array([strategy.get_score(*candle) for candle in candles])
+    mismatch = np.flatnonzero(~np.isclose(batch, single, rtol=1e-9, atol=1e-12))
+    for row in mismatch:
+        print(f'row {row}: get_scores {batch[row]} get_score {single[row]}')
+    print(f'{len(candles) - len(mismatch)} of {len(candles)} rows match')
+    return 1 if len(mismatch) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -3,7 +3,6 @@ import pandas as pd
 import numpy as np
 from talib import RSI, BBANDS, MACD, ATR, NATR, PPO
 import lightgbm as lgb
-import statistics
 import my_types as ksignals
 
 class BaseStrategy:
@@ -21,6 +20,7 @@ class BaseStrategy:
         self.__min_period__ = 1
         self.__T__ = [1, 5, 10, 21, 42, 63]
         self.__data__ = pd.DataFrame()
+        self.__history__ = None
         self.__load_trained_subset__(path_where_models)
         self.__load_prediction_models__(path_where_models)
 
@@ -37,6 +37,19 @@ class BaseStrategy:
         Returns:
             tuple: return action: enter_long, enter_short, exit_long, exit_short or nothing with confidence?? 0 or 1
         """
+        predicted_value = self.get_score(open, high, low, close, volume)
+        action = self.__generate_action__(predicted_value)
+        # print('calculate action is SUCCESS')
+        return {action:1}
+
+    def get_score(self, open, high, low, close, volume):
+        """function that transformate raw data to predicted value of the models.
+        The action for it is chosen by __generate_action__, the bot uses the
+        same thresholds when it gets scores of a batch
+
+        Returns:
+            float: mean of the predictions of the models
+        """
         date = pd.Timestamp.utcnow()
         dict_with_new_data = {'date':date, 'open':open, 'high':high, 'low':low, 'close':close, 'volume':volume}
         new_row = pd.DataFrame([dict_with_new_data])
@@ -44,11 +57,219 @@ class BaseStrategy:
         data_with_new_row = pd.concat([self.__data__, new_row], ignore_index=False)
         self.__calculate_features__(data_with_new_row, date)
         # print('calculate features is SUCCESS')
-        predicted_value = self.__predict__(data_with_new_row.loc[date, self.__name_features_for_model__])
+        predicted_value = self.__predict__(data_with_new_row.loc[[date], self.__name_features_for_model__])[0]
         # print('calculate predicted values is SUCCESS')
-        action = self.__generate_action__(predicted_value)
-        # print('calculate action is SUCCESS')
-        return {action:1}
+        return predicted_value
+
+    def get_scores(self, rows):
+        """predicted values of many candles with one prediction call per model.
+        Like get_score every candle is scored as the next one after the
+        history, not after the other candles of the batch.
+
+        The history part of every feature is computed once and cached, the
+        candles only add their own term. Recursive indicators (RSI, ATR, NATR,
+        MACD) continue their Wilder or exponential average from the end of the
+        history, seeded as talib does. check_batch_scores.py compares it with
+        get_score row by row.
+
+        Args:
+            rows (numpy.ndarray): n x 5 float64, open high low close volume
+
+        Returns:
+            numpy.ndarray: float64 predicted value of each row
+        """
+        rows = np.asarray(rows, dtype=np.float64).reshape(-1, 5)
+        if len(rows) == 0:
+            return np.empty(0, dtype=np.float64)
+        if self.__history__ is None:
+            self.__history__ = self.__history_state__()
+        features = self.__batch_features__(rows, pd.Timestamp.utcnow())
+        return self.__predict__(features)
+
+    def __history_state__(self):
+        """values of the history the features of the next candle depend on
+        """
+        data = self.__data__
+        close = data['close'].to_numpy(dtype=np.float64)
+        high = data['high'].to_numpy(dtype=np.float64)
+        low = data['low'].to_numpy(dtype=np.float64)
+        if 'dollar_vol' in data:
+            dollar_vol = data['dollar_vol'].to_numpy(dtype=np.float64)
+        else:
+            dollar_vol = close * data['volume'].to_numpy(dtype=np.float64) / 1e3
+        state = {'close': close[-1], 'high': high[-1], 'low': low[-1]}
+
+        dollar_vol_ma = (pd.Series(dollar_vol)
+                         .rolling(window=self.__window__, min_periods=self.__min_period__)
+                         .mean()
+                         .to_numpy())
+        state['dollar_vol_ma'] = np.sort(dollar_vol_ma[~np.isnan(dollar_vol_ma)])
+        tail = dollar_vol[len(dollar_vol) - (self.__window__ - 1):]
+        state['dollar_vol_sum'] = np.nansum(tail)
+        state['dollar_vol_count'] = np.count_nonzero(~np.isnan(tail))
+
+        # Wilder averages of talib RSI and ATR, seeded as talib does with the
+        # mean of the first 14 values
+        delta = np.diff(close)
+        state['rsi_gain'] = self.__talib_wilder__(np.clip(delta, 0, None), 14)[-1]
+        state['rsi_loss'] = self.__talib_wilder__(np.clip(-delta, 0, None), 14)[-1]
+        true_range = np.maximum(high[1:] - low[1:],
+                                np.maximum(np.abs(high[1:] - close[:-1]),
+                                           np.abs(low[1:] - close[:-1])))
+        atr = self.__talib_wilder__(true_range, 14)
+        state['atr'] = atr[-1]
+        state['atr_sum'] = atr.sum()
+        state['atr_sum_sq'] = np.square(atr).sum()
+        state['atr_count'] = len(atr)
+
+        # talib MACD 12 26 9 starts both EMAs at index 25, the slow one seeded
+        # with the mean of close[0:26] and the fast one with close[14:26]. Its
+        # first value is at index 33
+        fast = self.__talib_ema__(close, 12, 25)
+        slow = self.__talib_ema__(close, 26, 25)
+        macd = (fast - slow)[33 - 25:]
+        state['ema_fast'] = fast[-1]
+        state['ema_slow'] = slow[-1]
+        state['macd_sum'] = macd.sum()
+        state['macd_sum_sq'] = np.square(macd).sum()
+        state['macd_count'] = len(macd)
+
+        # sums of the last closes for BBANDS 20 and the SMA of PPO 12 26
+        state['close_sum'] = {n: close[-(n - 1):].sum() for n in (12, 20, 26)}
+        state['close_sum_sq_20'] = np.square(close[-19:]).sum()
+
+        state['returns'] = {}
+        for t in self.__T__:
+            returns = close[t:] / close[:-t] - 1
+            state['returns'][t] = (close[-t],
+                                   np.sort(returns[np.isfinite(returns)]))
+        return state
+
+    def __batch_features__(self, rows, date):
+        """features of every candle as if it was appended to the history alone,
+        the same as __calculate_features__ computes for one candle
+        """
+        state = self.__history__
+        open, high, low, close, volume = rows.T
+        features = {'open': open, 'high': high, 'low': low, 'close': close,
+                    'volume': volume}
+
+        dollar_vol = close * volume / 1e3
+        features['dollar_vol'] = dollar_vol
+        dollar_vol_ma = ((state['dollar_vol_sum'] + dollar_vol) /
+                         (state['dollar_vol_count'] + 1))
+        # average rank in descending order among the history and the candle
+        history_ma = state['dollar_vol_ma']
+        greater = len(history_ma) - np.searchsorted(history_ma, dollar_vol_ma, side='right')
+        equal = (np.searchsorted(history_ma, dollar_vol_ma, side='right') -
+                 np.searchsorted(history_ma, dollar_vol_ma, side='left'))
+        features['dollar_vol_rank'] = greater + 1 + equal / 2
+
+        delta = close - state['close']
+        gain = (state['rsi_gain'] * 13 + np.clip(delta, 0, None)) / 14
+        loss = (state['rsi_loss'] * 13 + np.clip(-delta, 0, None)) / 14
+        total = gain + loss
+        features['rsi'] = np.divide(100 * gain, total,
+                                    out=np.zeros_like(total), where=total != 0)
+
+        mean_20 = (state['close_sum'][20] + close) / 20
+        var_20 = (state['close_sum_sq_20'] + close * close) / 20 - mean_20 * mean_20
+        std_20 = np.sqrt(np.clip(var_20, 0, None))
+        bb_high = mean_20 + 2 * std_20
+        bb_low = mean_20 - 2 * std_20
+        features['bb_high'] = np.log1p((bb_high - close) / bb_high)
+        features['bb_low'] = np.log1p((close - bb_low) / close)
+
+        true_range = np.maximum(high - low,
+                                np.maximum(np.abs(high - state['close']),
+                                           np.abs(low - state['close'])))
+        atr = (state['atr'] * 13 + true_range) / 14
+        features['NATR'] = atr / close * 100
+        features['ATR'] = self.__standardize__(atr, state['atr_sum'],
+                                               state['atr_sum_sq'],
+                                               state['atr_count'], ddof=1)
+
+        sma_fast = (state['close_sum'][12] + close) / 12
+        sma_slow = (state['close_sum'][26] + close) / 26
+        features['PPO'] = (sma_fast - sma_slow) / sma_slow * 100
+
+        ema_fast = state['ema_fast'] + (close - state['ema_fast']) * 2 / 13
+        ema_slow = state['ema_slow'] + (close - state['ema_slow']) * 2 / 27
+        features['MACD'] = self.__standardize__(ema_fast - ema_slow,
+                                                state['macd_sum'],
+                                                state['macd_sum_sq'],
+                                                state['macd_count'], ddof=0)
+
+        for t in self.__T__:
+            base, history = state['returns'][t]
+            returns = close / base - 1
+            features[f'r{t:02}'] = returns
+            features[f'r{t:02}dec'] = self.__decile__(history, returns)
+
+        features['year'] = np.full(len(rows), date.year)
+        features['month'] = np.full(len(rows), date.month)
+        features['day'] = np.full(len(rows), date.day)
+        features['weekday'] = np.full(len(rows), date.weekday())
+        return pd.DataFrame(features).reindex(columns=self.__name_features_for_model__)
+
+    @staticmethod
+    def __talib_wilder__(values, period):
+        """talib Wilder average of values: the mean of the first period values,
+        then (previous * (period - 1) + value) / period. One value per input
+        from index period - 1
+        """
+        result = np.empty(len(values) - period + 1)
+        result[0] = values[:period].mean()
+        for i, value in enumerate(values[period:], start=1):
+            result[i] = (result[i - 1] * (period - 1) + value) / period
+        return result
+
+    @staticmethod
+    def __talib_ema__(values, period, start):
+        """talib EMA which gives its first value at index start, seeded with the
+        mean of the period values up to it. One value per input from start
+        """
+        k = 2 / (period + 1)
+        result = np.empty(len(values) - start)
+        result[0] = values[start - period + 1:start + 1].mean()
+        for i, value in enumerate(values[start + 1:], start=1):
+            result[i] = result[i - 1] + (value - result[i - 1]) * k
+        return result
+
+    @staticmethod
+    def __standardize__(values, history_sum, history_sum_sq, history_count, ddof):
+        """(value - mean) / std over the history and the value
+        """
+        count = history_count + 1
+        mean = (history_sum + values) / count
+        var = (history_sum_sq + values * values - count * mean * mean) / (count - ddof)
+        return (values - mean) / np.sqrt(np.clip(var, 0, None))
+
+    @staticmethod
+    def __decile__(history, values):
+        """label of pd.qcut(q=10, labels=False, duplicates='drop') for each
+        value over the sorted history with the value inserted
+        """
+        n = len(history)
+        position = np.searchsorted(history, values)[:, None]
+        values = values[:, None]
+
+        def at(index):
+            # element index of the history with the value inserted at position
+            before = history[np.clip(index, 0, n - 1)]
+            after = history[np.clip(index - 1, 0, n - 1)]
+            return np.where(index < position, before,
+                            np.where(index == position, values, after))
+
+        # linear interpolation of Series.quantile over n + 1 elements
+        h = np.linspace(0, 1, 11) * n
+        lo = np.floor(h).astype(np.int64)
+        hi = np.minimum(lo + 1, n)
+        edges = at(lo) + (h - lo) * (at(hi) - at(lo))
+        distinct = np.ones_like(edges, dtype=bool)
+        distinct[:, 1:] = edges[:, 1:] != edges[:, :-1]
+        below = np.count_nonzero((edges < values) & distinct, axis=1)
+        return np.maximum(below - 1, 0)
     
     def __calculate_features__(self, data, date):
         self.__calculate_dol_vol__(data, date)
@@ -147,8 +368,10 @@ class BaseStrategy:
                 self.__data__ = store[key]
 
     def __predict__(self, new_features):
-        predicted_value = [ model.predict(new_features)[0] for model in self.__list_model__]
-        return statistics.mean(predicted_value)
+        """mean of the predictions of the models for each row of new_features
+        """
+        predicted_values = [model.predict(new_features) for model in self.__list_model__]
+        return np.mean(predicted_values, axis=0)
 
     def __generate_action__(self, predicted_value):
         # print(f'start calculate action for predicted_value={predicted_value}')
@@ -1,3 +1,4 @@
+import numpy as np
 import prepare_model_for_bot as my_strategy
 
 # sys.path.append(os.getcwd())
@@ -15,6 +16,21 @@ class Predictor:
     def predict(self, open, high, low, close, volume):
         return self.__strategy__.get_action(open, high, low, close, volume)
 
+    def predict_batch(self, candles):
+        """scores of many candles for one call from the bot
+
+        Args:
+            candles (memoryview): rows x 5 float64, open high low close volume.
+                Valid only during the call
+
+        Returns:
+            numpy.ndarray: float64 score of each row
+        """
+        # get_scores computes the whole batch at once, it is used once
+        # check_batch_scores.py shows it gives the scores of get_score
+        return np.array([self.__strategy__.get_score(*row)
+                         for row in np.asarray(candles)], dtype=np.float64)
+
 def main():
     predictor = Predictor("./")
     result = predictor.predict(50000.0,70000.0,40000.0,560000.0, 10000)
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/common/types.h"
+#include "aot/strategy/market_order.h"
+
+namespace aot {
+static_assert(std::endian::native == std::endian::little,
+              "BBO batches are written in little endian");
+
+/**
+ * @brief fixed layout record of one BBO in a batch. Prices and quantities
+ * are the raw fixed point values of the book, price = price_raw *
+ * 10^-price_precision
+ */
+struct BBORecord {
+    int64_t timestamp_ns;  ///< wall clock when the record was made
+    uint64_t bid_price;
+    uint64_t ask_price;
+    uint64_t bid_qty;
+    uint64_t ask_qty;
+    uint32_t base;   ///< common::TradingPair::first
+    uint32_t quote;  ///< common::TradingPair::second
+    uint8_t exchange_id;
+    uint8_t market_type;
+    uint8_t price_precision;
+    uint8_t qty_precision;
+    uint32_t reserved = 0;
+};
+static_assert(std::is_trivially_copyable_v<BBORecord>);
+static_assert(sizeof(BBORecord) == 56);
+
+/**
+ * @brief header of a batch, followed by count BBORecord
+ */
+struct BBOBatchHeader {
+    static constexpr uint32_t kMagic   = 0x314f4242;  // "BBO1"
+    static constexpr uint16_t kVersion = 1;
+    uint32_t magic        = kMagic;
+    uint16_t version      = kVersion;
+    uint16_t record_size  = sizeof(BBORecord);
+    uint32_t count        = 0;
+    uint32_t reserved     = 0;
+};
+static_assert(sizeof(BBOBatchHeader) == 16);
+
+inline BBORecord MakeBBORecord(const Trading::NewBBO &bbo,
+                               const common::TradingPairInfo &info,
+                               int64_t timestamp_ns) {
+    return BBORecord{
+        .timestamp_ns    = timestamp_ns,
+        .bid_price       = bbo.bbo.bid_price,
+        .ask_price       = bbo.bbo.ask_price,
+        .bid_qty         = bbo.bbo.bid_qty,
+        .ask_qty         = bbo.bbo.ask_qty,
+        .base            = bbo.trading_pair.first,
+        .quote           = bbo.trading_pair.second,
+        .exchange_id     = static_cast<uint8_t>(bbo.exchange_id),
+        .market_type     = static_cast<uint8_t>(bbo.market_type),
+        .price_precision = info.price_precission,
+        .qty_precision   = info.qty_precission};
+}
+
+struct BBOBatchOptions {
+    /// records in one message, a full batch is sent at once
+    size_t max_records               = 256;
+    /// the longest time the first record of a batch waits for the others
+    std::chrono::microseconds linger = std::chrono::milliseconds(2);
+    /// arenas allocated up front, more are allocated if all are in flight
+    size_t arenas                    = 8;
+};
+
+/**
+ * @brief arena of one batch. The memory is allocated once and reused for
+ * every batch, Finish() returns the encoded batch without copying
+ */
+class BBOBatchEncoder {
+  public:
+    explicit BBOBatchEncoder(size_t max_records)
+        : max_records_(max_records),
+          arena_(std::make_unique<std::byte[]>(sizeof(BBOBatchHeader) +
+                                               max_records *
+                                                   sizeof(BBORecord))) {}
+
+    void Append(const BBORecord &record) {
+        std::memcpy(arena_.get() + sizeof(BBOBatchHeader) +
+                        count_ * sizeof(BBORecord),
+                    &record, sizeof(BBORecord));
+        ++count_;
+    }
+    /// Writes the header, the span is valid until Clear().
+    std::span<const std::byte> Finish() {
+        BBOBatchHeader header;
+        header.count = static_cast<uint32_t>(count_);
+        std::memcpy(arena_.get(), &header, sizeof(header));
+        return {arena_.get(),
+                sizeof(BBOBatchHeader) + count_ * sizeof(BBORecord)};
+    }
+    void Clear() { count_ = 0; }
+    size_t Count() const { return count_; }
+    bool Empty() const { return count_ == 0; }
+    bool Full() const { return count_ == max_records_; }
+
+  private:
+    size_t max_records_;
+    size_t count_ = 0;
+    std::unique_ptr<std::byte[]> arena_;
+};
+
+/**
+ * @brief coalesces BBO records into batches and hands every batch to Sink
+ * without copying.
+ *
+ * Sink must have Produce(std::span<const std::byte>, BBOBatchEncoder*) and
+ * call Release() with the encoder once the payload is not needed, e.g. from
+ * a delivery report of kafka. It may do it inside Produce().
+ *
+ * The batcher is not thread safe, all calls must come from one thread. The
+ * owner arms a linger timer when Add() opens a batch and calls Flush() when
+ * the timer fires.
+ */
+template <class Sink>
+class BBOBatcher {
+  public:
+    BBOBatcher(const BBOBatchOptions &options, Sink &sink)
+        : max_records_(std::max<size_t>(options.max_records, 1)),
+          sink_(sink) {
+        for (size_t i = 0; i < options.arenas; ++i) Grow();
+    }
+
+    /**
+     * @return true if the record opened a new batch
+     */
+    bool Add(const BBORecord &record) {
+        const bool opened = !current_;
+        if (opened) [[unlikely]]
+            current_ = TakeArena();
+        current_->Append(record);
+        ++records_;
+        if (current_->Full()) Flush();
+        return opened;
+    }
+
+    void Flush() {
+        if (!current_) return;
+        auto *arena = current_;
+        current_    = nullptr;
+        ++batches_;
+        sink_.Produce(arena->Finish(), arena);
+    }
+
+    void Release(BBOBatchEncoder *arena) {
+        if (!arena) [[unlikely]]
+            return;
+        arena->Clear();
+        free_.push_back(arena);
+    }
+
+    uint64_t Records() const { return records_; }
+    uint64_t Batches() const { return batches_; }
+    /// batches handed to the sink and not released yet
+    size_t InFlight() const {
+        return arenas_.size() - free_.size() - (current_ ? 1 : 0);
+    }
+
+  private:
+    BBOBatchEncoder *TakeArena() {
+        if (free_.empty()) [[unlikely]] {
+            logw("all {} bbo batches are in flight, allocate one more",
+                 arenas_.size());
+            Grow();
+        }
+        auto *arena = free_.back();
+        free_.pop_back();
+        return arena;
+    }
+    void Grow() {
+        arenas_.push_back(std::make_unique<BBOBatchEncoder>(max_records_));
+        free_.push_back(arenas_.back().get());
+    }
+
+    size_t max_records_;
+    Sink &sink_;
+    std::vector<std::unique_ptr<BBOBatchEncoder>> arenas_;
+    std::vector<BBOBatchEncoder *> free_;
+    BBOBatchEncoder *current_ = nullptr;
+    uint64_t records_         = 0;
+    uint64_t batches_         = 0;
+};
+}  // namespace aot
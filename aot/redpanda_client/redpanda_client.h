@@ -1,16 +1,20 @@
 #pragma once
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 #include "aot/Logger.h"
 #include "aot/bus/bus_component.h"
 #include "aot/common/exchange_trading_pair.h"
+#include "aot/common/time_utils.h"
 #include "aot/common/types.h"
 #include "aot/proto/classes/proto_orderbook.h"
 #include "aot/proto/classes/proto_pnl.h"
 #include "aot/proto/classes/proto_trades.h"
 #include "aot/proto/classes/proto_wallet.h"
+#include "aot/redpanda_client/bbo_batch.h"
 #include "aot/strategy/arbitrage/arbitrage_strategy.h"
 #include "aot/strategy/arbitrage/trade_dictionary.h"
 #include "aot/strategy/market_order.h"
@@ -19,6 +23,12 @@
 #include "google/protobuf/message.h"
 #include "nlohmann/json.hpp"
 namespace aot {
+/**
+ * @brief how RedPandaComponent publishes BBO. kJson sends one
+ * aot::models::OrderBook json per BBO to "orderbook", kBinaryBatch sends
+ * batches of BBORecord to "orderbook_batch"
+ */
+enum class OrderBookEncoding { kJson, kBinaryBatch };
 
 class KafkaClient {
   public:
@@ -33,17 +43,36 @@ class KafkaClient {
             : cppkafka::MessageBuilder(static_cast<std::string>(topic)) {}
     };
 
-    explicit KafkaClient(std::string_view brokers)
+    /**
+     * @param bbo_batch if set, SendBBO() coalesces BBO into binary batches
+     */
+    explicit KafkaClient(
+        std::string_view brokers,
+        const std::optional<BBOBatchOptions>& bbo_batch = std::nullopt)
         : io_context_(),
           work_guard_(boost::asio::make_work_guard(io_context_)),
-          producer_thread_([this] { io_context_.run(); }) {
+          linger_timer_(io_context_) {
         cppkafka::Configuration config = {
             {"metadata.broker.list", brokers.data()}};
 
         producer_ = std::make_unique<cppkafka::Producer>(config);
+        if (bbo_batch) {
+            bbo_batch_options_ = *bbo_batch;
+            batch_sink_        = std::make_unique<BatchSink>(brokers, *this);
+            bbo_batcher_       = std::make_unique<BBOBatcher<BatchSink>>(
+                *bbo_batch, *batch_sink_);
+        }
+        // the thread starts last, handlers use the members above
+        producer_thread_ = std::thread([this] { io_context_.run(); });
     }
 
     ~KafkaClient() {
+        if (bbo_batcher_)
+            boost::asio::post(io_context_, [this]() {
+                linger_timer_.cancel();
+                bbo_batcher_->Flush();
+                batch_sink_->Flush();
+            });
         work_guard_.reset();
         if (producer_thread_.joinable()) {
             producer_thread_.join();
@@ -136,18 +165,101 @@ class KafkaClient {
         });
     }
 
+    /**
+     * @brief add BBO to the current batch. Only 56 bytes are posted to the
+     * producer thread, the batch is sent when it is full or the linger time
+     * of its first record is over. No-op if batches are not enabled
+     */
+    void SendBBO(const BBORecord& record) {
+        if (!bbo_batcher_) [[unlikely]] {
+            logw("bbo batches are not enabled");
+            return;
+        }
+        boost::asio::post(io_context_, [this, record]() {
+            if (bbo_batcher_->Add(record)) ArmLinger();
+        });
+    }
+
     void WaitUntilFinished() {
         if (!producer_) {
             logw("cppkafka::Producer not initialized");
             return;
         }
-        boost::asio::post(io_context_, [this]() { producer_->flush(); });
+        boost::asio::post(io_context_, [this]() {
+            producer_->flush();
+            if (bbo_batcher_) {
+                bbo_batcher_->Flush();
+                batch_sink_->Flush();
+            }
+        });
     }
 
   private:
+    /**
+     * @brief producer of batches which passes arenas to librdkafka without
+     * copying. An arena is returned to the batcher by the delivery report,
+     * reports are served on the producer thread by Poll()
+     */
+    class BatchSink {
+      public:
+        BatchSink(std::string_view brokers, KafkaClient& client)
+            : client_(client) {
+            cppkafka::Configuration config = {
+                {"metadata.broker.list", brokers.data()}};
+            config.set_delivery_report_callback(
+                [this](cppkafka::Producer&, const cppkafka::Message& message) {
+                    if (message.get_error())
+                        loge("bbo batch is not delivered: {}",
+                             message.get_error().to_string());
+                    client_.bbo_batcher_->Release(
+                        static_cast<BBOBatchEncoder*>(message.get_user_data()));
+                });
+            producer_ = std::make_unique<cppkafka::Producer>(config);
+            producer_->set_payload_policy(
+                cppkafka::Producer::PayloadPolicy::PASSTHROUGH_PAYLOAD);
+        }
+
+        void Produce(std::span<const std::byte> payload,
+                     BBOBatchEncoder* arena) {
+            builder_.payload(cppkafka::Buffer(payload.data(), payload.size()));
+            builder_.user_data(arena);
+            try {
+                producer_->produce(builder_);
+            } catch (const std::exception& ex) {
+                loge("Error producing bbo batch: {}", std::string(ex.what()));
+                client_.bbo_batcher_->Release(arena);
+            }
+            Poll();
+        }
+        /// Serves delivery reports without blocking.
+        void Poll() { producer_->poll(std::chrono::milliseconds(0)); }
+        void Flush() { producer_->flush(); }
+
+      private:
+        KafkaClient& client_;
+        std::unique_ptr<cppkafka::Producer> producer_;
+        Topic topic_{"orderbook_batch"};
+        MessageBuilder builder_{topic_};
+    };
+
+    void ArmLinger() {
+        linger_timer_.expires_after(bbo_batch_options_.linger);
+        linger_timer_.async_wait([this](const boost::system::error_code& ec) {
+            if (ec) return;
+            bbo_batcher_->Flush();
+            batch_sink_->Poll();
+        });
+    }
+
     boost::asio::io_context io_context_;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
         work_guard_;
+    boost::asio::steady_timer linger_timer_;
+    BBOBatchOptions bbo_batch_options_;
+    /// batcher outlives the sink, delivery reports may come until the sink
+    /// is destroyed
+    std::unique_ptr<BBOBatcher<BatchSink>> bbo_batcher_;
+    std::unique_ptr<BatchSink> batch_sink_;
     std::thread producer_thread_;
     std::unique_ptr<cppkafka::Producer> producer_;
 
@@ -171,14 +283,25 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
     common::MarketTypePrinter market_type_printer_;
     Executor& executor_;
     aot::ExchangeTradingPairs& exchange_trading_pairs_;
+    OrderBookEncoding order_book_encoding_;
 
   public:
+    /**
+     * @param order_book_encoding kBinaryBatch publishes BBO as batches of
+     * BBORecord configured by bbo_batch, kJson keeps one json per BBO
+     */
     explicit RedPandaComponent(
         Executor& executor, std::string_view broker,
-        aot::ExchangeTradingPairs& exchange_trading_pairs)
-        : KafkaClient(broker),
+        aot::ExchangeTradingPairs& exchange_trading_pairs,
+        OrderBookEncoding order_book_encoding = OrderBookEncoding::kJson,
+        const BBOBatchOptions& bbo_batch      = {})
+        : KafkaClient(broker,
+                      order_book_encoding == OrderBookEncoding::kBinaryBatch
+                          ? std::optional<BBOBatchOptions>(bbo_batch)
+                          : std::nullopt),
           executor_(executor),
-          exchange_trading_pairs_(exchange_trading_pairs) {}
+          exchange_trading_pairs_(exchange_trading_pairs),
+          order_book_encoding_(order_book_encoding) {}
 
     ~RedPandaComponent() override = default;
 
@@ -194,11 +317,15 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
             logw("Wrapped event is nullptr in AsyncHandleEvent");
             return;
         }
+        if (order_book_encoding_ == OrderBookEncoding::kBinaryBatch) {
+            SendBBOBatched(*wrapped_event);
+            return;
+        }
 
         boost::asio::co_spawn(
             executor_,
             [this, wrapped_event]() -> boost::asio::awaitable<void> {
-                co_await HandleEventAsync(wrapped_event);
+                co_await HandleEventAsync(wrapped_event.get());
             },
             boost::asio::detached);
     }
@@ -218,7 +345,37 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
         boost::asio::co_spawn(
             executor_,
             [this, wrapped_event]() -> boost::asio::awaitable<void> {
-                co_await HandleEventAsync(wrapped_event);
+                co_await HandleEventAsync(wrapped_event.get());
+            },
+            boost::asio::detached);
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope> event) override {
+        if (!event) {
+            logw("Received nullptr event in AsyncHandleEvent");
+            return;
+        }
+        if (order_book_encoding_ == OrderBookEncoding::kBinaryBatch) {
+            SendBBOBatched(*event->WrappedEvent());
+            return;
+        }
+        boost::asio::co_spawn(
+            executor_,
+            [this, event]() -> boost::asio::awaitable<void> {
+                co_await HandleEventAsync(event->WrappedEvent());
+            },
+            boost::asio::detached);
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<aot::ArbitrageReportEnvelope> event) override {
+        if (!event) {
+            logw("Received nullptr event in AsyncHandleEvent");
+            return;
+        }
+        boost::asio::co_spawn(
+            executor_,
+            [this, event]() -> boost::asio::awaitable<void> {
+                co_await HandleEventAsync(event->WrappedEvent());
             },
             boost::asio::detached);
     }
@@ -233,8 +390,23 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
     void AsyncStop() override {}
 
   private:
+    /**
+     * @brief binary path: the record is made on the thread of the bus, there
+     * is neither coroutine nor string per BBO
+     */
+    void SendBBOBatched(const Trading::NewBBO& bbo) {
+        if (!ValidatePrices(&bbo)) return;
+        auto* info = exchange_trading_pairs_.GetPairInfo(bbo.exchange_id,
+                                                         bbo.trading_pair);
+        if (!info) {
+            logw("No info for {} {}", bbo.exchange_id,
+                 bbo.trading_pair.ToString());
+            return;
+        }
+        SendBBO(MakeBBORecord(bbo, *info, common::getCurrentNanoS()));
+    }
     boost::asio::awaitable<void> HandleEventAsync(
-        boost::intrusive_ptr<Trading::NewBBO> wrapped_event) {
+        const Trading::NewBBO* wrapped_event) {
         if (!wrapped_event) {
             logw("Received nullptr wrapped_event in HandleEventAsync");
             co_return;
@@ -260,13 +432,13 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
         co_return;
     }
     boost::asio::awaitable<void> HandleEventAsync(
-        boost::intrusive_ptr<aot::ArbitrageReport> wrapped_event) {
+        const aot::ArbitrageReport* wrapped_event) {
         if (!wrapped_event) {
             logw("Received nullptr wrapped_event in HandleEventAsync");
             co_return;
         }
 
-        auto& ob = *wrapped_event.get();
+        auto& ob = *wrapped_event;
         aot::ArbitrageReportString report_as_string(ob,
                                                     exchange_trading_pairs_);
         SendMessageAsJson(report_as_string);
@@ -278,7 +450,7 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
         SendMessage(trades);
         co_return;
     }
-    bool ValidatePrices(boost::intrusive_ptr<Trading::NewBBO> event) {
+    bool ValidatePrices(const Trading::NewBBO* event) {
         if (!event) {
             logw("Received nullptr event in ValidatePrices");
             return false;
@@ -298,7 +470,7 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
     }
 
     aot::models::OrderBook PrepareOrderBook(
-        boost::intrusive_ptr<Trading::NewBBO> event,
+        const Trading::NewBBO* event,
         const common::TradingPairInfo& info) {
         if (!event) {
             logw("PrepareOrderBook received nullptr event");
@@ -328,7 +500,7 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
 
     template <bool need_bid>
     std::pair<bool, double> GetFormattedPrice(
-        boost::intrusive_ptr<Trading::NewBBO> event) {
+        const Trading::NewBBO* event) {
         if (!event) {
             logw("Received nullptr event in GetFormattedPrice");
             return std::make_pair(false, 0.0);
@@ -358,7 +530,7 @@ class RedPandaComponent : public bus::Component, public KafkaClient {
     }
     template <bool need_bid>
     std::pair<bool, double> GetFormattedQty(
-        boost::intrusive_ptr<Trading::NewBBO> event) {
+        const Trading::NewBBO* event) {
         if (!event) {
             logw("Received nullptr event in GetFormattedQty");
             return std::make_pair(false, 0.0);
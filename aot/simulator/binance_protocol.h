@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aot/simulator/protocol.h"
+
+namespace simulator {
+/**
+ * @brief spot api of binance: GET /api/v3/depth, signed POST and DELETE
+ * /api/v3/order and the <symbol>@depth diff stream, subscribed by the stream
+ * path /ws/<stream> or by a SUBSCRIBE message on /ws.
+ */
+class BinanceProtocol : public ProtocolI {
+  public:
+    explicit BinanceProtocol(Keys keys) : keys_(std::move(keys)) {}
+
+    Response OnRequest(const Request& request, Markets& markets,
+                       int64_t now_ms) override {
+        namespace http           = boost::beast::http;
+        const auto [path, query] = SplitTarget(View(request.target()));
+        if (path == "/api/v3/depth" && request.method() == http::verb::get)
+            return Snapshot(request, ParseQuery(query), markets);
+        if (path != "/api/v3/order")
+            return Error(request, http::status::not_found, -1000,
+                         "Unknown path.");
+        if (request.method() != http::verb::post &&
+            request.method() != http::verb::delete_)
+            return Error(request, http::status::method_not_allowed, -1000,
+                         "Unsupported method.");
+
+        std::string params_string(query);
+        params_string += request.body();
+        if (auto error = Authenticate(request, params_string, now_ms))
+            return *error;
+        auto params = ParseQuery(query);
+        params.merge(ParseQuery(request.body()));
+        if (request.method() == http::verb::post)
+            return NewOrder(request, params, markets, now_ms);
+        return CancelOrder(request, params, markets, now_ms);
+    }
+
+    std::vector<Subscription> OnConnect(std::string_view target,
+                                        const Markets& markets) override {
+        std::vector<Subscription> subscriptions;
+        auto [path, _] = SplitTarget(target);
+        if (!path.starts_with("/ws/")) return subscriptions;
+        path.remove_prefix(4);
+        while (!path.empty()) {
+            const auto end = path.find('/');
+            if (auto subscription = Stream(path.substr(0, end), markets))
+                subscriptions.push_back(std::move(*subscription));
+            if (end == std::string_view::npos) break;
+            path.remove_prefix(end + 1);
+        }
+        return subscriptions;
+    }
+
+    WsReply OnMessage(std::string_view text, const Markets& markets) override {
+        WsReply reply;
+        auto message = nlohmann::json::parse(text, nullptr, false);
+        if (message.is_discarded() || !message.is_object() ||
+            !message.contains("method")) {
+            reply.text = R"({"error":{"code":2,"msg":"Invalid request"},)"
+                         R"("id":null})";
+            return reply;
+        }
+        const auto id     = message.value("id", nlohmann::json()).dump();
+        const auto method = message.value("method", std::string());
+        const auto params = message.value("params", nlohmann::json::array());
+        if (method == "SUBSCRIBE" || method == "UNSUBSCRIBE") {
+            for (const auto& param : params) {
+                if (!param.is_string()) continue;
+                auto subscription =
+                    Stream(param.get<std::string>(), markets);
+                if (!subscription) {
+                    reply.text = fmt::format(
+                        R"({{"error":{{"code":2,"msg":"Invalid request: )"
+                        R"(unknown stream"}},"id":{}}})",
+                        id);
+                    reply.subscribe.clear();
+                    reply.unsubscribe.clear();
+                    return reply;
+                }
+                if (method == "SUBSCRIBE")
+                    reply.subscribe.push_back(std::move(*subscription));
+                else
+                    reply.unsubscribe.push_back(subscription->topic);
+            }
+            reply.text = fmt::format(R"({{"result":null,"id":{}}})", id);
+            return reply;
+        }
+        reply.text = fmt::format(
+            R"({{"error":{{"code":2,"msg":"Invalid request: unknown )"
+            R"(method"}},"id":{}}})",
+            id);
+        return reply;
+    }
+
+    /// binance has no snapshot in the stream, clients take it over https
+    std::string RenderSubscribed(const Subscription&, const Market&,
+                                 int64_t) override {
+        return {};
+    }
+
+    std::string RenderDiff(const Subscription&, const Market& market,
+                           const DepthDiff& diff, int64_t now_ms) override {
+        std::string out = fmt::format(
+            R"({{"e":"depthUpdate","E":{},"s":"{}","U":{},"u":{},"b":)",
+            now_ms, market.engine.Symbol(), diff.first_id, diff.last_id);
+        AppendLevels(out, diff.bids, market);
+        out += R"(,"a":)";
+        AppendLevels(out, diff.asks, market);
+        out.push_back('}');
+        return out;
+    }
+
+    /// body of GET /api/v3/depth, also served by the bybit simulator
+    static std::string RenderSnapshot(const Market& market, size_t limit) {
+        std::string out = fmt::format(R"({{"lastUpdateId":{},"bids":)",
+                                      market.engine.UpdateId());
+        AppendLevels(out, market.engine.Levels(Side::kBuy, limit), market);
+        out += R"(,"asks":)";
+        AppendLevels(out, market.engine.Levels(Side::kSell, limit), market);
+        out.push_back('}');
+        return out;
+    }
+
+    static Response Snapshot(const Request& request, const Params& params,
+                             const Markets& markets) {
+        auto market = Find(params, markets);
+        if (!market)
+            return Error(request, boost::beast::http::status::bad_request,
+                         -1121, "Invalid symbol.");
+        size_t limit = 100;
+        if (auto it = params.find("limit"); it != params.end())
+            std::from_chars(it->second.data(),
+                            it->second.data() + it->second.size(), limit);
+        limit = std::clamp<size_t>(limit, 1, 5000);
+        return MakeResponse(request, boost::beast::http::status::ok,
+                            RenderSnapshot(*market, limit));
+    }
+
+  private:
+    static Response Error(const Request& request,
+                          boost::beast::http::status status, int code,
+                          std::string_view message) {
+        return MakeResponse(
+            request, status,
+            fmt::format(R"({{"code":{},"msg":{}}})", code, Quote(message)));
+    }
+
+    template <typename MarketsT>
+    static auto Find(const Params& params, MarketsT& markets)
+        -> decltype(&markets.begin()->second) {
+        auto symbol = params.find("symbol");
+        if (symbol == params.end()) return nullptr;
+        auto market = markets.find(symbol->second);
+        return market == markets.end() ? nullptr : &market->second;
+    }
+
+    /// <symbol>@depth or <symbol>@depth@100ms
+    static std::optional<Subscription> Stream(std::string_view stream,
+                                              const Markets& markets) {
+        const auto at = stream.find('@');
+        if (at == std::string_view::npos) return std::nullopt;
+        const auto kind = stream.substr(at + 1);
+        if (kind != "depth" && !kind.starts_with("depth@"))
+            return std::nullopt;
+        std::string symbol(stream.substr(0, at));
+        std::ranges::transform(symbol, symbol.begin(), [](unsigned char c) {
+            return static_cast<char>(std::toupper(c));
+        });
+        if (!markets.contains(symbol)) return std::nullopt;
+        return Subscription{std::move(symbol), std::string(stream), 0};
+    }
+
+    /**
+     * @brief checks X-MBX-APIKEY, the signature of the query string
+     * concatenated with the body and the recvWindow of the timestamp
+     */
+    std::optional<Response> Authenticate(const Request& request,
+                                         std::string_view params_string,
+                                         int64_t now_ms) const {
+        namespace http = boost::beast::http;
+        if (View(request["X-MBX-APIKEY"]) != keys_.api_key)
+            return Error(request, http::status::unauthorized, -2015,
+                         "Invalid API-key, IP, or permissions for action.");
+
+        const auto position = params_string.find("signature=");
+        if (position == std::string_view::npos)
+            return Error(request, http::status::bad_request, -1102,
+                         "Mandatory parameter 'signature' was not sent, was "
+                         "empty/null, or malformed.");
+        auto end = params_string.find('&', position);
+        if (end == std::string_view::npos) end = params_string.size();
+        const auto signature =
+            params_string.substr(position + 10, end - position - 10);
+        std::string payload(params_string.substr(0, position));
+        if (end < params_string.size())
+            payload += params_string.substr(end + 1);
+        else if (!payload.empty() && payload.back() == '&')
+            payload.pop_back();
+        if (!EqualsIgnoreCase(signature,
+                              HmacSha256Hex(keys_.secret_key, payload)))
+            return Error(request, http::status::bad_request, -1022,
+                         "Signature for this request is not valid.");
+
+        const auto params    = ParseQuery(payload);
+        int64_t timestamp    = 0;
+        int64_t recv_window  = 5000;
+        auto read = [&params](std::string_view name, int64_t& value) {
+            auto it = params.find(name);
+            if (it == params.end()) return false;
+            std::from_chars(it->second.data(),
+                            it->second.data() + it->second.size(), value);
+            return true;
+        };
+        if (!read("timestamp", timestamp))
+            return Error(request, http::status::bad_request, -1102,
+                         "Mandatory parameter 'timestamp' was not sent, was "
+                         "empty/null, or malformed.");
+        read("recvWindow", recv_window);
+        if (timestamp > now_ms + 1000 || now_ms - timestamp > recv_window)
+            return Error(request, http::status::bad_request, -1021,
+                         "Timestamp for this request is outside of the "
+                         "recvWindow.");
+        return std::nullopt;
+    }
+
+    Response NewOrder(const Request& request, const Params& params,
+                      Markets& markets, int64_t now_ms) {
+        namespace http = boost::beast::http;
+        auto market    = Find(params, markets);
+        if (!market)
+            return Error(request, http::status::bad_request, -1121,
+                         "Invalid symbol.");
+        auto get = [&params](std::string_view name) -> std::string_view {
+            auto it = params.find(name);
+            return it == params.end() ? std::string_view{} : it->second;
+        };
+        const auto side_name = get("side");
+        if (side_name != "BUY" && side_name != "SELL")
+            return Error(request, http::status::bad_request, -1117,
+                         "Invalid side.");
+        const auto type = get("type");
+        if (type != "LIMIT" && type != "LIMIT_MAKER")
+            return Error(request, http::status::bad_request, -1116,
+                         "Invalid orderType.");
+        auto time_in_force = TimeInForce::kPostOnly;
+        if (type == "LIMIT") {
+            const auto name = get("timeInForce");
+            if (name == "GTC")
+                time_in_force = TimeInForce::kGtc;
+            else if (name == "IOC")
+                time_in_force = TimeInForce::kIoc;
+            else
+                return Error(request, http::status::bad_request, -1115,
+                             "Invalid timeInForce.");
+        }
+        common::Price price = 0;
+        common::Qty qty     = 0;
+        if (!common::ParseFixedPoint(get("price"), market->price_precision,
+                                     price) ||
+            !price)
+            return Error(request, http::status::bad_request, -1013,
+                         "Filter failure: PRICE_FILTER");
+        if (!common::ParseFixedPoint(get("quantity"), market->qty_precision,
+                                     qty) ||
+            !qty)
+            return Error(request, http::status::bad_request, -1013,
+                         "Filter failure: LOT_SIZE");
+
+        std::string client_id(get("newClientOrderId"));
+        if (client_id.empty())
+            client_id = fmt::format("sim{}", next_client_id_++);
+        const auto side = side_name == "BUY" ? Side::kBuy : Side::kSell;
+        auto order      = market->engine.Place(side, price, qty,
+                                               std::move(client_id),
+                                               time_in_force);
+        if (time_in_force == TimeInForce::kPostOnly &&
+            order.status == OrderStatus::kExpired)
+            return Error(request, http::status::bad_request, -2010,
+                         "Order would immediately match and take.");
+
+        std::string out = RenderOrder(*market, order, now_ms);
+        out.pop_back();
+        out += R"(,"workingTime":)" + std::to_string(now_ms) +
+               R"(,"fills":[)";
+        for (size_t i = 0; i < order.fills.size(); ++i) {
+            const auto& fill = order.fills[i];
+            if (i) out.push_back(',');
+            fmt::format_to(
+                std::back_inserter(out),
+                R"({{"price":"{}","qty":"{}","commission":"0",)"
+                R"("commissionAsset":"","tradeId":{}}})",
+                common::FormatFixedPoint(fill.price, market->price_precision),
+                common::FormatFixedPoint(fill.qty, market->qty_precision),
+                fill.trade_id);
+        }
+        out += "]}";
+        return MakeResponse(request, http::status::ok, std::move(out));
+    }
+
+    Response CancelOrder(const Request& request, const Params& params,
+                         Markets& markets, int64_t now_ms) {
+        namespace http = boost::beast::http;
+        auto market    = Find(params, markets);
+        if (!market)
+            return Error(request, http::status::bad_request, -1121,
+                         "Invalid symbol.");
+        std::optional<OrderState> order;
+        if (auto it = params.find("orderId"); it != params.end()) {
+            uint64_t order_id = 0;
+            std::from_chars(it->second.data(),
+                            it->second.data() + it->second.size(), order_id);
+            order = market->engine.Cancel(order_id);
+        } else if (auto it = params.find("origClientOrderId");
+                   it != params.end()) {
+            order = market->engine.CancelByClientId(it->second);
+        } else {
+            return Error(request, http::status::bad_request, -1102,
+                         "Param 'origClientOrderId' or 'orderId' must be "
+                         "sent, but both were empty/null!");
+        }
+        if (!order)
+            return Error(request, http::status::bad_request, -2011,
+                         "Unknown order sent.");
+
+        std::string out = RenderOrder(*market, *order, now_ms);
+        out.insert(1, fmt::format(R"("origClientOrderId":{},)",
+                                  Quote(order->client_id)));
+        return MakeResponse(request, http::status::ok, std::move(out));
+    }
+
+    static std::string_view StatusName(OrderStatus status) {
+        switch (status) {
+            case OrderStatus::kNew:
+                return "NEW";
+            case OrderStatus::kPartiallyFilled:
+                return "PARTIALLY_FILLED";
+            case OrderStatus::kFilled:
+                return "FILLED";
+            case OrderStatus::kCanceled:
+                return "CANCELED";
+            case OrderStatus::kExpired:
+                return "EXPIRED";
+        }
+        return "NEW";
+    }
+
+    static std::string_view TimeInForceName(TimeInForce time_in_force) {
+        return time_in_force == TimeInForce::kIoc ? "IOC" : "GTC";
+    }
+
+    /// order fields shared by the answers of new order and cancel
+    static std::string RenderOrder(const Market& market,
+                                   const OrderState& order, int64_t now_ms) {
+        return fmt::format(
+            R"({{"symbol":"{}","orderId":{},"orderListId":-1,)"
+            R"("clientOrderId":{},"transactTime":{},"price":"{}",)"
+            R"("origQty":"{}","executedQty":"{}","cummulativeQuoteQty":"{}",)"
+            R"("status":"{}","timeInForce":"{}","type":"{}","side":"{}",)"
+            R"("selfTradePreventionMode":"NONE"}})",
+            market.engine.Symbol(), order.order_id, Quote(order.client_id),
+            now_ms,
+            common::FormatFixedPoint(order.price, market.price_precision),
+            common::FormatFixedPoint(order.qty, market.qty_precision),
+            common::FormatFixedPoint(order.executed, market.qty_precision),
+            FormatQuote(order.quote, market), StatusName(order.status),
+            TimeInForceName(order.time_in_force),
+            order.time_in_force == TimeInForce::kPostOnly ? "LIMIT_MAKER"
+                                                          : "LIMIT",
+            order.side == Side::kBuy ? "BUY" : "SELL");
+    }
+
+    Keys keys_;
+    uint64_t next_client_id_ = 1;
+};
+}  // namespace simulator
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aot/simulator/binance_protocol.h"
+#include "aot/simulator/protocol.h"
+
+namespace simulator {
+/**
+ * @brief v5 api of bybit: GET /v5/market/orderbook, signed POST
+ * /v5/order/create and /v5/order/cancel and orderbook.<depth>.<symbol> topics
+ * of the public stream. Every reply has http status 200, errors are in
+ * retCode as bybit does.
+ *
+ * GET /api/v3/depth is answered in the binance format too, because the bybit
+ * snapshot getter of this tree asks for it.
+ */
+class BybitProtocol : public ProtocolI {
+  public:
+    explicit BybitProtocol(Keys keys) : keys_(std::move(keys)) {}
+
+    Response OnRequest(const Request& request, Markets& markets,
+                       int64_t now_ms) override {
+        namespace http           = boost::beast::http;
+        const auto [path, query] = SplitTarget(View(request.target()));
+        if (request.method() == http::verb::get) {
+            if (path == "/v5/market/orderbook")
+                return Snapshot(request, ParseQuery(query), markets, now_ms);
+            if (path == "/api/v3/depth")
+                return BinanceProtocol::Snapshot(request, ParseQuery(query),
+                                                 markets);
+        }
+        if (request.method() != http::verb::post ||
+            (path != "/v5/order/create" && path != "/v5/order/cancel"))
+            return MakeResponse(request, http::status::not_found,
+                                R"({"retCode":404,"retMsg":"Not Found"})");
+
+        if (auto error = Authenticate(request, now_ms)) return *error;
+        auto body = nlohmann::json::parse(request.body(), nullptr, false);
+        if (body.is_discarded() || !body.is_object())
+            return Error(request, 10001, "params error: body is not json",
+                         now_ms);
+        if (path == "/v5/order/create")
+            return NewOrder(request, body, markets, now_ms);
+        return CancelOrder(request, body, markets, now_ms);
+    }
+
+    /// bybit streams are subscribed by messages only
+    std::vector<Subscription> OnConnect(std::string_view,
+                                        const Markets&) override {
+        return {};
+    }
+
+    WsReply OnMessage(std::string_view text, const Markets& markets) override {
+        WsReply reply;
+        auto message = nlohmann::json::parse(text, nullptr, false);
+        if (message.is_discarded() || !message.is_object()) {
+            reply.text = R"({"success":false,"ret_msg":"invalid json",)"
+                         R"("conn_id":"simulator","op":""})";
+            return reply;
+        }
+        const auto op     = message.value("op", std::string());
+        const auto req_id = message.contains("req_id")
+                                ? fmt::format(R"("req_id":{},)",
+                                              message["req_id"].dump())
+                                : std::string();
+        auto answer = [&](bool success, std::string_view ret_msg) {
+            return fmt::format(
+                R"({{"success":{},"ret_msg":{},"conn_id":"simulator",{})"
+                R"("op":{}}})",
+                success, Quote(ret_msg), req_id, Quote(op));
+        };
+        if (op == "ping") {
+            reply.text = answer(true, "pong");
+            return reply;
+        }
+        if (op != "subscribe" && op != "unsubscribe") {
+            reply.text = answer(false, "error:unsupported op");
+            return reply;
+        }
+        for (const auto& arg :
+             message.value("args", nlohmann::json::array())) {
+            auto subscription =
+                arg.is_string() ? Topic(arg.get<std::string>(), markets)
+                                : std::nullopt;
+            if (!subscription) {
+                reply.text = answer(
+                    false, fmt::format("error:handler not found,topic:{}",
+                                       arg.is_string() ? arg.get<std::string>()
+                                                       : arg.dump()));
+                reply.subscribe.clear();
+                reply.unsubscribe.clear();
+                return reply;
+            }
+            if (op == "subscribe")
+                reply.subscribe.push_back(std::move(*subscription));
+            else
+                reply.unsubscribe.push_back(subscription->topic);
+        }
+        reply.text = answer(true, "");
+        return reply;
+    }
+
+    /// a new subscriber gets a snapshot of depth levels first
+    std::string RenderSubscribed(const Subscription& subscription,
+                                 const Market& market,
+                                 int64_t now_ms) override {
+        const auto& engine = market.engine;
+        return Render(subscription, market, "snapshot",
+                      engine.Levels(Side::kBuy, subscription.depth),
+                      engine.Levels(Side::kSell, subscription.depth),
+                      engine.DiffSeq(), engine.UpdateId(), now_ms);
+    }
+
+    std::string RenderDiff(const Subscription& subscription,
+                           const Market& market, const DepthDiff& diff,
+                           int64_t now_ms) override {
+        return Render(subscription, market, "delta", diff.bids, diff.asks,
+                      diff.seq, diff.last_id, now_ms);
+    }
+
+  private:
+    static Response Error(const Request& request, int code,
+                          std::string_view message, int64_t now_ms) {
+        return MakeResponse(
+            request, boost::beast::http::status::ok,
+            fmt::format(R"({{"retCode":{},"retMsg":{},"result":{{}},)"
+                        R"("retExtInfo":{{}},"time":{}}})",
+                        code, Quote(message), now_ms));
+    }
+
+    static Response Ok(const Request& request, std::string_view result,
+                       int64_t now_ms) {
+        return MakeResponse(
+            request, boost::beast::http::status::ok,
+            fmt::format(R"({{"retCode":0,"retMsg":"OK","result":{},)"
+                        R"("retExtInfo":{{}},"time":{}}})",
+                        result, now_ms));
+    }
+
+    /// orderbook.<depth>.<symbol>
+    static std::optional<Subscription> Topic(std::string_view topic,
+                                             const Markets& markets) {
+        static constexpr std::string_view kPrefix = "orderbook.";
+        if (!topic.starts_with(kPrefix)) return std::nullopt;
+        const auto dot = topic.find('.', kPrefix.size());
+        if (dot == std::string_view::npos) return std::nullopt;
+        size_t depth         = 0;
+        const auto depth_str = topic.substr(kPrefix.size(),
+                                            dot - kPrefix.size());
+        std::from_chars(depth_str.data(), depth_str.data() + depth_str.size(),
+                        depth);
+        const auto symbol = topic.substr(dot + 1);
+        if (!depth || !markets.contains(symbol)) return std::nullopt;
+        return Subscription{std::string(symbol), std::string(topic), depth};
+    }
+
+    static std::string Render(const Subscription& subscription,
+                              const Market& market, std::string_view type,
+                              const std::vector<Level>& bids,
+                              const std::vector<Level>& asks, uint64_t u,
+                              uint64_t seq, int64_t now_ms) {
+        std::string out = fmt::format(
+            R"({{"topic":"{}","type":"{}","ts":{},"data":{{"s":"{}","b":)",
+            subscription.topic, type, now_ms, subscription.symbol);
+        AppendLevels(out, bids, market);
+        out += R"(,"a":)";
+        AppendLevels(out, asks, market);
+        fmt::format_to(std::back_inserter(out),
+                       R"(,"u":{},"seq":{}}},"cts":{}}})", u, seq, now_ms);
+        return out;
+    }
+
+    static Response Snapshot(const Request& request, const Params& params,
+                             const Markets& markets, int64_t now_ms) {
+        auto symbol = params.find("symbol");
+        auto market = symbol == params.end() ? markets.end()
+                                             : markets.find(symbol->second);
+        if (market == markets.end())
+            return Error(request, 10001, "params error: symbol invalid",
+                         now_ms);
+        size_t limit = 1;
+        if (auto it = params.find("limit"); it != params.end())
+            std::from_chars(it->second.data(),
+                            it->second.data() + it->second.size(), limit);
+        limit              = std::clamp<size_t>(limit, 1, 200);
+        const auto& engine = market->second.engine;
+        std::string result = fmt::format(R"({{"s":"{}","b":)", market->first);
+        AppendLevels(result, engine.Levels(Side::kBuy, limit), market->second);
+        result += R"(,"a":)";
+        AppendLevels(result, engine.Levels(Side::kSell, limit),
+                     market->second);
+        fmt::format_to(std::back_inserter(result),
+                       R"(,"ts":{},"u":{},"seq":{},"cts":{}}})", now_ms,
+                       engine.DiffSeq(), engine.UpdateId(), now_ms);
+        return Ok(request, result, now_ms);
+    }
+
+    /**
+     * @brief checks X-BAPI-API-KEY, X-BAPI-SIGN over timestamp + api key +
+     * recv window + body and the recv window of the timestamp
+     */
+    std::optional<Response> Authenticate(const Request& request,
+                                         int64_t now_ms) const {
+        if (View(request["X-BAPI-API-KEY"]) != keys_.api_key)
+            return Error(request, 10003, "API key is invalid.", now_ms);
+        const auto timestamp_str   = View(request["X-BAPI-TIMESTAMP"]);
+        const auto recv_window_str = View(request["X-BAPI-RECV-WINDOW"]);
+        const auto payload =
+            fmt::format("{}{}{}{}", timestamp_str, keys_.api_key,
+                        recv_window_str, request.body());
+        if (!EqualsIgnoreCase(View(request["X-BAPI-SIGN"]),
+                              HmacSha256Hex(keys_.secret_key, payload)))
+            return Error(request, 10004,
+                         fmt::format("error sign! origin_string[{}]",
+                                     payload),
+                         now_ms);
+        int64_t timestamp   = 0;
+        int64_t recv_window = 5000;
+        std::from_chars(timestamp_str.data(),
+                        timestamp_str.data() + timestamp_str.size(),
+                        timestamp);
+        std::from_chars(recv_window_str.data(),
+                        recv_window_str.data() + recv_window_str.size(),
+                        recv_window);
+        if (timestamp > now_ms + 1000 || now_ms - timestamp > recv_window)
+            return Error(request, 10002,
+                         "invalid request, please check your server "
+                         "timestamp or recv_window param",
+                         now_ms);
+        return std::nullopt;
+    }
+
+    static std::string String(const nlohmann::json& body,
+                              std::string_view name) {
+        auto it = body.find(name);
+        return it != body.end() && it->is_string() ? it->get<std::string>()
+                                                   : std::string();
+    }
+
+    Response NewOrder(const Request& request, const nlohmann::json& body,
+                      Markets& markets, int64_t now_ms) {
+        auto market = markets.find(String(body, "symbol"));
+        if (market == markets.end())
+            return Error(request, 10001, "params error: symbol invalid",
+                         now_ms);
+        const auto side_name = String(body, "side");
+        if (side_name != "Buy" && side_name != "Sell")
+            return Error(request, 10001, "params error: side invalid",
+                         now_ms);
+        if (String(body, "orderType") != "Limit")
+            return Error(request, 10001,
+                         "params error: only Limit orders are simulated",
+                         now_ms);
+        const auto time_in_force_name = String(body, "timeInForce");
+        auto time_in_force            = TimeInForce::kGtc;
+        if (time_in_force_name == "IOC")
+            time_in_force = TimeInForce::kIoc;
+        else if (time_in_force_name == "PostOnly")
+            time_in_force = TimeInForce::kPostOnly;
+        else if (!time_in_force_name.empty() && time_in_force_name != "GTC")
+            return Error(request, 10001, "params error: timeInForce invalid",
+                         now_ms);
+        const auto& info    = market->second;
+        common::Price price = 0;
+        common::Qty qty     = 0;
+        if (!common::ParseFixedPoint(String(body, "price"),
+                                     info.price_precision, price) ||
+            !price)
+            return Error(request, 170134, "Order price has too many decimals.",
+                         now_ms);
+        if (!common::ParseFixedPoint(String(body, "qty"), info.qty_precision,
+                                     qty) ||
+            !qty)
+            return Error(request, 170137,
+                         "Order quantity has too many decimals.", now_ms);
+
+        auto order = market->second.engine.Place(
+            side_name == "Buy" ? Side::kBuy : Side::kSell, price, qty,
+            String(body, "orderLinkId"), time_in_force);
+        return Ok(request,
+                  fmt::format(R"({{"orderId":"{}","orderLinkId":{}}})",
+                              order.order_id, Quote(order.client_id)),
+                  now_ms);
+    }
+
+    Response CancelOrder(const Request& request, const nlohmann::json& body,
+                         Markets& markets, int64_t now_ms) {
+        auto market = markets.find(String(body, "symbol"));
+        if (market == markets.end())
+            return Error(request, 10001, "params error: symbol invalid",
+                         now_ms);
+        auto& engine = market->second.engine;
+        std::optional<OrderState> order;
+        if (const auto order_id = String(body, "orderId"); !order_id.empty()) {
+            uint64_t id = 0;
+            std::from_chars(order_id.data(), order_id.data() + order_id.size(),
+                            id);
+            order = engine.Cancel(id);
+        } else if (const auto link_id = String(body, "orderLinkId");
+                   !link_id.empty()) {
+            order = engine.CancelByClientId(link_id);
+        } else {
+            return Error(request, 10001,
+                         "params error: orderId or orderLinkId is required",
+                         now_ms);
+        }
+        if (!order)
+            return Error(request, 170213, "Order does not exist.", now_ms);
+        return Ok(request,
+                  fmt::format(R"({{"orderId":"{}","orderLinkId":{}}})",
+                              order->order_id, Quote(order->client_id)),
+                  now_ms);
+    }
+
+    Keys keys_;
+};
+}  // namespace simulator
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace simulator {
+/**
+ * @brief network faults of the simulator. All decisions come from one seeded
+ * generator, so a run with the same seed and the same order of calls drops
+ * and delays the same messages.
+ */
+class FaultInjector {
+  public:
+    struct Options {
+        /// delay of every reply and stream message
+        std::chrono::microseconds latency{0};
+        /// extra delay, uniform in [0, jitter]
+        std::chrono::microseconds jitter{0};
+        /// probability that a stream message is not sent to a client
+        double loss      = 0;
+        /// probability that update ids jump after a diff, as if diffs were
+        /// lost before they reached any client
+        double gap       = 0;
+        /// ids skipped by a gap
+        uint64_t gap_ids = 10;
+        uint64_t seed    = 1;
+    };
+
+    FaultInjector() : FaultInjector(Options{}) {}
+    explicit FaultInjector(Options options)
+        : options_(options), random_(options.seed) {}
+
+    std::chrono::microseconds Delay() {
+        if (options_.jitter.count() <= 0) return options_.latency;
+        return options_.latency +
+               std::chrono::microseconds(random_() %
+                                         (options_.jitter.count() + 1));
+    }
+
+    bool Lose() { return options_.loss > 0 && Uniform() < options_.loss; }
+
+    /// ids to skip after a diff, 0 if no gap
+    uint64_t Gap() {
+        return options_.gap > 0 && Uniform() < options_.gap ? options_.gap_ids
+                                                            : 0;
+    }
+
+    const Options& GetOptions() const { return options_; }
+
+  private:
+    double Uniform() { return (random_() >> 11) * 0x1.0p-53; }
+
+    Options options_;
+    std::mt19937_64 random_;
+};
+}  // namespace simulator
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "aot/common/types.h"
+
+namespace simulator {
+/// side in terms of the exchange: a buy order rests on the bid side
+enum class Side : uint8_t { kBuy, kSell };
+
+enum class TimeInForce : uint8_t {
+    kGtc,
+    /// the rest of the order is canceled after matching
+    kIoc,
+    /// the order is canceled instead of taking liquidity
+    kPostOnly
+};
+
+enum class OrderStatus : uint8_t {
+    kNew,
+    kPartiallyFilled,
+    kFilled,
+    kCanceled,
+    /// the rest of an ioc order or a post only order that would take
+    kExpired
+};
+
+struct Fill {
+    common::Price price = 0;
+    common::Qty qty     = 0;
+    uint64_t trade_id   = 0;
+};
+
+/// state of an order after the last event of it
+struct OrderState {
+    uint64_t order_id = 0;
+    std::string client_id;
+    Side side                 = Side::kBuy;
+    TimeInForce time_in_force = TimeInForce::kGtc;
+    common::Price price       = 0;
+    common::Qty qty           = 0;
+    common::Qty executed      = 0;
+    /// sum of price * qty of fills, scaled by both precisions
+    uint64_t quote            = 0;
+    OrderStatus status        = OrderStatus::kNew;
+    /// fills of the last call only
+    std::vector<Fill> fills;
+};
+
+using Level = std::pair<common::Price, common::Qty>;
+
+/**
+ * @brief changed levels since the previous diff. Qty 0 means the level is
+ * gone. first_id and last_id are the update ids of the first and the last
+ * change, as U and u of a binance depth stream, seq counts diffs
+ */
+struct DepthDiff {
+    uint64_t first_id = 0;
+    uint64_t last_id  = 0;
+    uint64_t seq      = 0;
+    std::vector<Level> bids;
+    std::vector<Level> asks;
+    bool Empty() const { return bids.empty() && asks.empty(); }
+};
+
+/**
+ * @brief price-time priority limit order book of one symbol.
+ *
+ * Every change of the quantity of a level takes the next update id, so depth
+ * diffs and snapshots of the book follow the sequence rules of the exchanges:
+ * a snapshot has lastUpdateId = UpdateId() and the first diff to apply after
+ * it has first_id <= lastUpdateId + 1 <= last_id.
+ */
+class MatchingEngine {
+  public:
+    explicit MatchingEngine(std::string symbol) : symbol_(std::move(symbol)) {}
+
+    /**
+     * @brief matches the order against the opposite side and rests the rest
+     * of a gtc order
+     *
+     * @return state of the order with fills of this call
+     */
+    OrderState Place(Side side, common::Price price, common::Qty qty,
+                     std::string client_id,
+                     TimeInForce time_in_force = TimeInForce::kGtc) {
+        OrderState order;
+        order.order_id      = next_order_id_++;
+        order.client_id     = std::move(client_id);
+        order.side          = side;
+        order.time_in_force = time_in_force;
+        order.price         = price;
+        order.qty           = qty;
+
+        if (time_in_force == TimeInForce::kPostOnly && Crosses(side, price)) {
+            order.status = OrderStatus::kExpired;
+            return order;
+        }
+        if (side == Side::kBuy)
+            Match(order, asks_);
+        else
+            Match(order, bids_);
+
+        if (order.executed == order.qty) {
+            order.status = OrderStatus::kFilled;
+            return order;
+        }
+        if (time_in_force == TimeInForce::kIoc) {
+            order.status = OrderStatus::kExpired;
+            return order;
+        }
+        order.status = order.executed ? OrderStatus::kPartiallyFilled
+                                      : OrderStatus::kNew;
+        Rest(order);
+        return order;
+    }
+
+    std::optional<OrderState> Cancel(uint64_t order_id) {
+        auto it = orders_.find(order_id);
+        if (it == orders_.end()) return std::nullopt;
+        OrderState order = std::move(it->second);
+        orders_.erase(it);
+        ForgetClientId(order);
+
+        auto remove = [&order, this](auto& levels) {
+            auto level = levels.find(order.price);
+            auto& ids  = level->second.order_ids;
+            for (auto id = ids.begin(); id != ids.end(); ++id)
+                if (*id == order.order_id) {
+                    ids.erase(id);
+                    break;
+                }
+            ChangeLevel(levels, level, order.side,
+                        -static_cast<int64_t>(order.qty - order.executed));
+        };
+        if (order.side == Side::kBuy)
+            remove(bids_);
+        else
+            remove(asks_);
+        order.status = OrderStatus::kCanceled;
+        order.fills.clear();
+        return order;
+    }
+
+    std::optional<OrderState> CancelByClientId(std::string_view client_id) {
+        auto it = client_ids_.find(std::string(client_id));
+        if (it == client_ids_.end()) return std::nullopt;
+        return Cancel(it->second);
+    }
+
+    /// resting order
+    const OrderState* Find(uint64_t order_id) const {
+        auto it = orders_.find(order_id);
+        return it == orders_.end() ? nullptr : &it->second;
+    }
+
+    const OrderState* FindByClientId(std::string_view client_id) const {
+        auto it = client_ids_.find(std::string(client_id));
+        return it == client_ids_.end() ? nullptr : Find(it->second);
+    }
+
+    /// best depth levels of the side, best first
+    std::vector<Level> Levels(Side side, size_t depth) const {
+        std::vector<Level> levels;
+        auto copy = [&levels, depth](const auto& side_levels) {
+            for (const auto& [price, level] : side_levels) {
+                if (levels.size() == depth) break;
+                levels.emplace_back(price, level.qty);
+            }
+        };
+        if (side == Side::kBuy)
+            copy(bids_);
+        else
+            copy(asks_);
+        return levels;
+    }
+
+    std::optional<common::Price> Best(Side side) const {
+        if (side == Side::kBuy)
+            return bids_.empty() ? std::nullopt
+                                 : std::optional(bids_.begin()->first);
+        return asks_.empty() ? std::nullopt
+                             : std::optional(asks_.begin()->first);
+    }
+
+    /**
+     * @brief changes since the previous call. Consecutive diffs are
+     * contiguous: first_id of one is last_id + 1 of the previous one
+     */
+    DepthDiff TakeDiff() {
+        DepthDiff diff;
+        if (changed_bids_.empty() && changed_asks_.empty()) return diff;
+        diff.first_id = published_id_ + 1;
+        diff.last_id  = update_id_;
+        diff.seq      = ++diff_seq_;
+        diff.bids.assign(changed_bids_.begin(), changed_bids_.end());
+        diff.asks.assign(changed_asks_.begin(), changed_asks_.end());
+        changed_bids_.clear();
+        changed_asks_.clear();
+        published_id_ = update_id_;
+        return diff;
+    }
+
+    /**
+     * @brief skips ids as if count updates and diffs were lost before they
+     * reached anybody, so the next diff does not continue the previous one
+     */
+    void SkipIds(uint64_t count) {
+        update_id_    += count;
+        published_id_ += count;
+        diff_seq_     += count;
+    }
+
+    /// id of the last change, lastUpdateId of a snapshot
+    uint64_t UpdateId() const { return update_id_; }
+    /// seq of the last diff
+    uint64_t DiffSeq() const { return diff_seq_; }
+    const std::string& Symbol() const { return symbol_; }
+    size_t Orders() const { return orders_.size(); }
+
+  private:
+    struct PriceLevel {
+        common::Qty qty = 0;
+        /// in time priority
+        std::deque<uint64_t> order_ids;
+    };
+    using Bids = std::map<common::Price, PriceLevel, std::greater<>>;
+    using Asks = std::map<common::Price, PriceLevel, std::less<>>;
+
+    bool Crosses(Side side, common::Price price) const {
+        if (side == Side::kBuy)
+            return !asks_.empty() && asks_.begin()->first <= price;
+        return !bids_.empty() && bids_.begin()->first >= price;
+    }
+
+    template <typename Levels>
+    void Match(OrderState& taker, Levels& levels) {
+        while (taker.executed < taker.qty && !levels.empty()) {
+            auto level = levels.begin();
+            if (taker.side == Side::kBuy ? level->first > taker.price
+                                         : level->first < taker.price)
+                break;
+            const auto price = level->first;
+            auto& ids        = level->second.order_ids;
+            common::Qty traded_on_level = 0;
+            while (taker.executed < taker.qty && !ids.empty()) {
+                auto& maker = orders_.find(ids.front())->second;
+                const auto qty =
+                    std::min(taker.qty - taker.executed,
+                             maker.qty - maker.executed);
+                const Fill fill{price, qty, next_trade_id_++};
+                Execute(taker, fill);
+                Execute(maker, fill);
+                taker.fills.push_back(fill);
+                traded_on_level += qty;
+                if (maker.executed == maker.qty) {
+                    ForgetClientId(maker);
+                    orders_.erase(ids.front());
+                    ids.pop_front();
+                } else {
+                    maker.status = OrderStatus::kPartiallyFilled;
+                }
+            }
+            ChangeLevel(levels, level, Opposite(taker.side),
+                        -static_cast<int64_t>(traded_on_level));
+        }
+    }
+
+    static void Execute(OrderState& order, const Fill& fill) {
+        order.executed += fill.qty;
+        order.quote    += fill.price * fill.qty;
+    }
+
+    static Side Opposite(Side side) {
+        return side == Side::kBuy ? Side::kSell : Side::kBuy;
+    }
+
+    void Rest(const OrderState& order) {
+        auto rest = [&order, this](auto& levels) {
+            auto [level, _] = levels.try_emplace(order.price);
+            level->second.order_ids.push_back(order.order_id);
+            ChangeLevel(levels, level, order.side,
+                        static_cast<int64_t>(order.qty - order.executed));
+        };
+        if (order.side == Side::kBuy)
+            rest(bids_);
+        else
+            rest(asks_);
+        OrderState resting = order;
+        resting.fills.clear();
+        if (!resting.client_id.empty())
+            client_ids_[resting.client_id] = resting.order_id;
+        orders_.emplace(resting.order_id, std::move(resting));
+    }
+
+    /// client ids are optional and the exchanges don't force them unique
+    void ForgetClientId(const OrderState& order) {
+        if (order.client_id.empty()) return;
+        auto it = client_ids_.find(order.client_id);
+        if (it != client_ids_.end() && it->second == order.order_id)
+            client_ids_.erase(it);
+    }
+
+    template <typename Levels>
+    void ChangeLevel(Levels& levels, typename Levels::iterator level,
+                     Side side, int64_t delta) {
+        if (delta == 0) return;
+        level->second.qty += delta;
+        const auto price = level->first;
+        const auto qty   = level->second.qty;
+        if (level->second.order_ids.empty()) levels.erase(level);
+        ++update_id_;
+        if (side == Side::kBuy)
+            changed_bids_[price] = qty;
+        else
+            changed_asks_[price] = qty;
+    }
+
+    std::string symbol_;
+    Bids bids_;
+    Asks asks_;
+    std::unordered_map<uint64_t, OrderState> orders_;
+    std::unordered_map<std::string, uint64_t> client_ids_;
+    std::map<common::Price, common::Qty, std::greater<>> changed_bids_;
+    std::map<common::Price, common::Qty, std::less<>> changed_asks_;
+
+    uint64_t next_order_id_ = 1;
+    uint64_t next_trade_id_ = 1;
+    uint64_t update_id_     = 0;
+    uint64_t published_id_  = 0;
+    uint64_t diff_seq_      = 0;
+};
+}  // namespace simulator
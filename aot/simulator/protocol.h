@@ -0,0 +1,194 @@
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aot/common/fixed_point.h"
+#include "aot/simulator/matching_engine.h"
+#include "boost/beast/http.hpp"
+#include "fmt/format.h"
+#include "nlohmann/json.hpp"
+
+namespace simulator {
+using Request  = boost::beast::http::request<boost::beast::http::string_body>;
+using Response = boost::beast::http::response<boost::beast::http::string_body>;
+
+/// a symbol of the simulated exchange
+struct Market {
+    MatchingEngine engine;
+    uint8_t price_precision = 0;
+    uint8_t qty_precision   = 0;
+};
+/// by the symbol in requests of the exchange, e.g. BTCUSDT
+using Markets = std::map<std::string, Market, std::less<>>;
+
+struct Keys {
+    std::string api_key;
+    std::string secret_key;
+};
+
+/// depth stream of a websocket client
+struct Subscription {
+    std::string symbol;
+    /// stream or topic name as the client sent it
+    std::string topic;
+    /// levels of the first snapshot, 0 if the exchange sends none
+    size_t depth = 0;
+};
+
+struct WsReply {
+    /// answer to the client, empty if none
+    std::string text;
+    std::vector<Subscription> subscribe;
+    std::vector<std::string> unsubscribe;
+};
+
+/**
+ * @brief requests and messages of one exchange. The simulator server is the
+ * same for every exchange, it calls the protocol to answer https requests and
+ * websocket messages and to render depth diffs of its markets.
+ */
+class ProtocolI {
+  public:
+    virtual Response OnRequest(const Request& request, Markets& markets,
+                               int64_t now_ms) = 0;
+    /// streams the target of an upgrade request names, e.g. /ws/btcusdt@depth
+    virtual std::vector<Subscription> OnConnect(std::string_view target,
+                                                const Markets& markets) = 0;
+    virtual WsReply OnMessage(std::string_view text,
+                              const Markets& markets) = 0;
+    /// first message of a new subscription, empty if the exchange sends none
+    virtual std::string RenderSubscribed(const Subscription& subscription,
+                                         const Market& market,
+                                         int64_t now_ms) = 0;
+    virtual std::string RenderDiff(const Subscription& subscription,
+                                   const Market& market,
+                                   const DepthDiff& diff,
+                                   int64_t now_ms) = 0;
+    virtual ~ProtocolI() = default;
+};
+
+/// lower case hex hmac sha256, the signature of both exchanges
+inline std::string HmacSha256Hex(std::string_view key, std::string_view data) {
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    uint32_t size = 0;
+    ::HMAC(::EVP_sha256(), key.data(), static_cast<int>(key.size()),
+           reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest,
+           &size);
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(size * 2);
+    for (uint32_t i = 0; i < size; ++i) {
+        hex.push_back(kHex[digest[i] >> 4]);
+        hex.push_back(kHex[digest[i] & 0xf]);
+    }
+    return hex;
+}
+
+inline bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    return true;
+}
+
+inline std::string UrlDecode(std::string_view value) {
+    std::string decoded;
+    decoded.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '+') {
+            decoded.push_back(' ');
+        } else if (uint8_t byte = 0;
+                   value[i] == '%' && i + 2 < value.size() &&
+                   std::from_chars(&value[i + 1], &value[i + 3], byte, 16)
+                           .ptr == &value[i + 3]) {
+            decoded.push_back(static_cast<char>(byte));
+            i += 2;
+        } else {
+            decoded.push_back(value[i]);
+        }
+    }
+    return decoded;
+}
+
+using Params = std::map<std::string, std::string, std::less<>>;
+
+/// name=value pairs of a query string or a form body
+inline Params ParseQuery(std::string_view query) {
+    Params params;
+    while (!query.empty()) {
+        const auto end  = query.find('&');
+        const auto pair = query.substr(0, end);
+        const auto eq   = pair.find('=');
+        if (eq != std::string_view::npos)
+            params[UrlDecode(pair.substr(0, eq))] =
+                UrlDecode(pair.substr(eq + 1));
+        else if (!pair.empty())
+            params[UrlDecode(pair)] = {};
+        if (end == std::string_view::npos) break;
+        query.remove_prefix(end + 1);
+    }
+    return params;
+}
+
+/// beast::string_view is boost::string_view before boost 1.81
+inline std::string_view View(boost::beast::string_view value) {
+    return {value.data(), value.size()};
+}
+
+/// path and query of a request target
+inline std::pair<std::string_view, std::string_view> SplitTarget(
+    std::string_view target) {
+    const auto question = target.find('?');
+    if (question == std::string_view::npos) return {target, {}};
+    return {target.substr(0, question), target.substr(question + 1)};
+}
+
+/// json string literal of value
+inline std::string Quote(std::string_view value) {
+    return nlohmann::json(value).dump();
+}
+
+/// [["price","qty"],...]
+inline void AppendLevels(std::string& out, const std::vector<Level>& levels,
+                         const Market& market) {
+    out.push_back('[');
+    for (size_t i = 0; i < levels.size(); ++i) {
+        if (i) out.push_back(',');
+        fmt::format_to(
+            std::back_inserter(out), "[\"{}\",\"{}\"]",
+            common::FormatFixedPoint(levels[i].first, market.price_precision),
+            common::FormatFixedPoint(levels[i].second, market.qty_precision));
+    }
+    out.push_back(']');
+}
+
+/// sum of price * qty scaled by the price precision
+inline std::string FormatQuote(uint64_t quote, const Market& market) {
+    return common::FormatFixedPoint(
+        quote / common::kPow10[market.qty_precision], market.price_precision);
+}
+
+inline Response MakeResponse(const Request& request,
+                             boost::beast::http::status status,
+                             std::string body) {
+    Response response{status, request.version()};
+    response.set(boost::beast::http::field::server, "aot-simulator");
+    response.set(boost::beast::http::field::content_type, "application/json");
+    response.keep_alive(request.keep_alive());
+    response.body() = std::move(body);
+    response.prepare_payload();
+    return response;
+}
+}  // namespace simulator
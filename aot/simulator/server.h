@@ -0,0 +1,324 @@
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/simulator/faults.h"
+#include "aot/simulator/protocol.h"
+#include "aot/simulator/synthetic_flow.h"
+#include "boost/asio/co_spawn.hpp"
+#include "boost/asio/detached.hpp"
+#include "boost/asio/redirect_error.hpp"
+#include "boost/asio/ssl.hpp"
+#include "boost/asio/steady_timer.hpp"
+#include "boost/asio/use_awaitable.hpp"
+#include "boost/beast/core.hpp"
+#include "boost/beast/http.hpp"
+#include "boost/beast/ssl.hpp"
+#include "boost/beast/websocket.hpp"
+#include "boost/beast/websocket/ssl.hpp"
+
+namespace simulator {
+/**
+ * @brief tls context with a new self-signed P-256 certificate for localhost.
+ * Clients of this tree don't verify certificates, so it is enough to serve
+ * https and wss on a test machine.
+ */
+inline boost::asio::ssl::context MakeSelfSignedContext() {
+    boost::asio::ssl::context context(boost::asio::ssl::context::tls_server);
+    std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)> key(
+        ::EVP_EC_gen("P-256"), &::EVP_PKEY_free);
+    std::unique_ptr<X509, decltype(&::X509_free)> cert(::X509_new(),
+                                                       &::X509_free);
+    if (!key || !cert) throw std::runtime_error("can't create a certificate");
+    ::X509_set_version(cert.get(), 2);
+    ::ASN1_INTEGER_set(::X509_get_serialNumber(cert.get()), 1);
+    ::X509_gmtime_adj(::X509_getm_notBefore(cert.get()), 0);
+    ::X509_gmtime_adj(::X509_getm_notAfter(cert.get()), 365L * 24 * 3600);
+    ::X509_set_pubkey(cert.get(), key.get());
+    auto* name = ::X509_get_subject_name(cert.get());
+    ::X509_NAME_add_entry_by_txt(
+        name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    ::X509_set_issuer_name(cert.get(), name);
+    if (!::X509_sign(cert.get(), key.get(), ::EVP_sha256()))
+        throw std::runtime_error("can't sign a certificate");
+    if (::SSL_CTX_use_certificate(context.native_handle(), cert.get()) != 1 ||
+        ::SSL_CTX_use_PrivateKey(context.native_handle(), key.get()) != 1)
+        throw std::runtime_error("can't use a certificate");
+    return context;
+}
+
+/**
+ * @brief https and wss server of a simulated exchange.
+ *
+ * Every tick the synthetic flows trade, then the depth diff of every market
+ * goes to its websocket subscribers. Requests of clients are matched by the
+ * same engines at once, their changes go out with the next tick.
+ *
+ * Run the io_context in one thread: the engines, the flows and the fault
+ * injector are not synchronized, and one thread keeps a run with a seed
+ * reproducible. Replies and stream messages of a connection leave in the
+ * order they were made, latency and jitter only move them later.
+ */
+class Server {
+  public:
+    struct Options {
+        std::string address = "127.0.0.1";
+        /// 0 picks a free port, see Port()
+        uint16_t port       = 0;
+        std::chrono::milliseconds tick_interval{100};
+        /// orders and cancels of every flow per tick
+        size_t steps_per_tick = 10;
+        FaultInjector::Options faults;
+    };
+
+    Server(boost::asio::io_context& ioc, boost::asio::ssl::context& ssl,
+           ProtocolI& protocol, Markets& markets,
+           std::vector<SyntheticFlow>& flows, Options options)
+        : ioc_(ioc),
+          ssl_(ssl),
+          protocol_(protocol),
+          markets_(markets),
+          flows_(flows),
+          options_(std::move(options)),
+          faults_(options_.faults),
+          acceptor_(ioc),
+          tick_timer_(ioc) {
+        boost::asio::ip::tcp::endpoint endpoint(
+            boost::asio::ip::make_address(options_.address), options_.port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(boost::asio::socket_base::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen();
+    }
+
+    void Start() {
+        boost::asio::co_spawn(ioc_, Accept(), boost::asio::detached);
+        boost::asio::co_spawn(ioc_, Tick(), boost::asio::detached);
+    }
+
+    /**
+     * @brief closes the acceptor and websocket connections and stops the
+     * ticks. Https connections close when their clients close them or when
+     * the io_context stops.
+     */
+    void Stop() {
+        boost::system::error_code ec;
+        acceptor_.close(ec);
+        tick_timer_.cancel();
+        for (auto& client : clients_) {
+            client->closed = true;
+            boost::beast::get_lowest_layer(client->ws).close();
+            client->wake.cancel();
+        }
+    }
+
+    uint16_t Port() const { return acceptor_.local_endpoint().port(); }
+
+  private:
+    using Clock     = std::chrono::steady_clock;
+    using TlsStream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+
+    struct WsClient {
+        explicit WsClient(TlsStream stream)
+            : ws(std::move(stream)), wake(ws.get_executor()) {}
+        boost::beast::websocket::stream<TlsStream> ws;
+        /// messages with the time they may leave
+        std::deque<std::pair<Clock::time_point, std::string>> outbox;
+        /// wakes the writer on a new message or when it is due
+        boost::asio::steady_timer wake;
+        std::vector<Subscription> subscriptions;
+        Clock::time_point last_due;
+        bool closed = false;
+    };
+    using ClientPtr = std::shared_ptr<WsClient>;
+
+    static int64_t NowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    boost::asio::awaitable<void> Accept() {
+        for (;;) {
+            boost::system::error_code ec;
+            auto socket = co_await acceptor_.async_accept(
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            if (ec) {
+                if (acceptor_.is_open())
+                    loge("accept failed: {}", ec.message());
+                co_return;
+            }
+            socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+            boost::asio::co_spawn(ioc_, Serve(std::move(socket)),
+                                  boost::asio::detached);
+        }
+    }
+
+    boost::asio::awaitable<void> Serve(boost::asio::ip::tcp::socket socket) {
+        namespace http = boost::beast::http;
+        TlsStream stream(std::move(socket), ssl_);
+        try {
+            co_await stream.async_handshake(
+                boost::asio::ssl::stream_base::server,
+                boost::asio::use_awaitable);
+            boost::beast::flat_buffer buffer;
+            for (;;) {
+                Request request;
+                co_await http::async_read(stream, buffer, request,
+                                          boost::asio::use_awaitable);
+                if (boost::beast::websocket::is_upgrade(request)) {
+                    co_await ServeWebSocket(std::move(stream),
+                                            std::move(request));
+                    co_return;
+                }
+                auto response = protocol_.OnRequest(request, markets_, NowMs());
+                co_await Sleep(faults_.Delay());
+                co_await http::async_write(stream, response,
+                                           boost::asio::use_awaitable);
+                if (!response.keep_alive()) break;
+            }
+            boost::system::error_code ec;
+            co_await stream.async_shutdown(
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        } catch (const boost::system::system_error& e) {
+            // a client closing its connection is not an error
+            if (e.code() != http::error::end_of_stream)
+                logd("https connection: {}", e.what());
+        }
+    }
+
+    boost::asio::awaitable<void> ServeWebSocket(TlsStream stream,
+                                                Request request) {
+        auto client = std::make_shared<WsClient>(std::move(stream));
+        client->ws.text(true);
+        co_await client->ws.async_accept(request, boost::asio::use_awaitable);
+        clients_.push_back(client);
+        boost::asio::co_spawn(ioc_, Write(client), boost::asio::detached);
+
+        for (auto& subscription :
+             protocol_.OnConnect(View(request.target()), markets_))
+            Subscribe(client, std::move(subscription));
+
+        boost::beast::flat_buffer buffer;
+        while (!client->closed) {
+            boost::system::error_code ec;
+            co_await client->ws.async_read(
+                buffer,
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            if (ec) break;
+            const auto text = boost::beast::buffers_to_string(buffer.data());
+            buffer.consume(buffer.size());
+            auto reply = protocol_.OnMessage(text, markets_);
+            if (!reply.text.empty()) Send(client, std::move(reply.text));
+            for (const auto& topic : reply.unsubscribe)
+                std::erase_if(client->subscriptions,
+                              [&topic](const Subscription& subscription) {
+                                  return subscription.topic == topic;
+                              });
+            for (auto& subscription : reply.subscribe)
+                Subscribe(client, std::move(subscription));
+        }
+        client->closed = true;
+        client->wake.cancel();
+        clients_.remove(client);
+    }
+
+    void Subscribe(const ClientPtr& client, Subscription subscription) {
+        auto market = markets_.find(subscription.symbol);
+        if (market == markets_.end()) return;
+        auto first = protocol_.RenderSubscribed(subscription, market->second,
+                                                NowMs());
+        if (!first.empty()) Send(client, std::move(first));
+        client->subscriptions.push_back(std::move(subscription));
+    }
+
+    /// never before a message queued earlier, so jitter doesn't reorder
+    void Send(const ClientPtr& client, std::string message) {
+        const auto due = std::max(Clock::now() + faults_.Delay(),
+                                  client->last_due);
+        client->last_due = due;
+        client->outbox.emplace_back(due, std::move(message));
+        if (client->outbox.size() == 1) client->wake.cancel();
+    }
+
+    boost::asio::awaitable<void> Write(ClientPtr client) {
+        while (!client->closed) {
+            boost::system::error_code ec;
+            if (client->outbox.empty() ||
+                client->outbox.front().first > Clock::now()) {
+                client->wake.expires_at(client->outbox.empty()
+                                            ? Clock::time_point::max()
+                                            : client->outbox.front().first);
+                co_await client->wake.async_wait(boost::asio::redirect_error(
+                    boost::asio::use_awaitable, ec));
+                continue;
+            }
+            auto message = std::move(client->outbox.front().second);
+            client->outbox.pop_front();
+            co_await client->ws.async_write(
+                boost::asio::buffer(message),
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            if (ec) {
+                logd("websocket write failed: {}", ec.message());
+                client->closed = true;
+            }
+        }
+    }
+
+    boost::asio::awaitable<void> Tick() {
+        for (;;) {
+            boost::system::error_code ec;
+            tick_timer_.expires_after(options_.tick_interval);
+            co_await tick_timer_.async_wait(
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            if (ec || !acceptor_.is_open()) co_return;
+
+            for (auto& flow : flows_) flow.Steps(options_.steps_per_tick);
+            const auto now = NowMs();
+            for (auto& [symbol, market] : markets_) {
+                const auto diff = market.engine.TakeDiff();
+                if (diff.Empty()) continue;
+                for (const auto& client : clients_)
+                    for (const auto& subscription : client->subscriptions) {
+                        if (subscription.symbol != symbol || faults_.Lose())
+                            continue;
+                        Send(client, protocol_.RenderDiff(subscription, market,
+                                                          diff, now));
+                    }
+                if (auto ids = faults_.Gap()) market.engine.SkipIds(ids);
+            }
+        }
+    }
+
+    boost::asio::awaitable<void> Sleep(std::chrono::microseconds delay) {
+        if (delay.count() <= 0) co_return;
+        boost::asio::steady_timer timer(ioc_, delay);
+        boost::system::error_code ec;
+        co_await timer.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+    }
+
+    boost::asio::io_context& ioc_;
+    boost::asio::ssl::context& ssl_;
+    ProtocolI& protocol_;
+    Markets& markets_;
+    std::vector<SyntheticFlow>& flows_;
+    Options options_;
+    FaultInjector faults_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::steady_timer tick_timer_;
+    std::list<ClientPtr> clients_;
+};
+}  // namespace simulator
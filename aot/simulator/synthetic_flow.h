@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "aot/simulator/matching_engine.h"
+
+namespace simulator {
+/**
+ * @brief orders of other market participants. Keeps levels orders per side
+ * around a mid price that drifts with trades. The sequence of orders depends
+ * only on the seed, so two runs with the same seed and the same client orders
+ * see the same books.
+ */
+class SyntheticFlow {
+  public:
+    struct Options {
+        /// first mid price and the price step, scaled by the price precision
+        common::Price mid   = 0;
+        common::Price tick  = 1;
+        /// levels per side near the mid
+        uint32_t levels     = 20;
+        /// qty of an order is in [1, max_qty], scaled by the qty precision
+        common::Qty max_qty = 100;
+        /// probability that a step sends an order that takes liquidity
+        double take         = 0.1;
+        /// probability that a step cancels a resting order
+        double cancel       = 0.3;
+        uint64_t seed       = 1;
+    };
+
+    SyntheticFlow(MatchingEngine& engine, Options options)
+        : engine_(engine), options_(options), random_(options.seed) {
+        for (uint32_t level = 1; level <= options_.levels; ++level) {
+            Add(Side::kBuy, options_.mid - level * options_.tick);
+            Add(Side::kSell, options_.mid + level * options_.tick);
+        }
+    }
+
+    /// one order or one cancel
+    void Step() {
+        const double event = Uniform();
+        if (event < options_.take) {
+            Take();
+        } else if ((event < options_.take + options_.cancel &&
+                    !resting_.empty()) ||
+                   resting_.size() > 4 * options_.levels) {
+            CancelRandom();
+        } else {
+            const auto side  = Uniform() < 0.5 ? Side::kBuy : Side::kSell;
+            const auto level = 1 + random_() % options_.levels;
+            const auto mid   = Mid();
+            if (side == Side::kBuy && mid > level * options_.tick)
+                Add(side, mid - level * options_.tick);
+            else if (side == Side::kSell)
+                Add(side, mid + level * options_.tick);
+        }
+    }
+
+    void Steps(size_t count) {
+        for (size_t i = 0; i < count; ++i) Step();
+    }
+
+  private:
+    /// the same on every standard library, unlike uniform_real_distribution
+    double Uniform() { return (random_() >> 11) * 0x1.0p-53; }
+
+    common::Qty Qty() { return 1 + random_() % options_.max_qty; }
+
+    /// mid of the best levels, or the last mid if a side is empty
+    common::Price Mid() {
+        auto bid = engine_.Best(Side::kBuy);
+        auto ask = engine_.Best(Side::kSell);
+        if (bid && ask)
+            mid_ = (*bid + *ask) / 2 / options_.tick * options_.tick;
+        return mid_;
+    }
+
+    void Add(Side side, common::Price price) {
+        auto order = engine_.Place(side, price, Qty(), {});
+        if (order.status == OrderStatus::kNew ||
+            order.status == OrderStatus::kPartiallyFilled)
+            resting_.push_back(order.order_id);
+    }
+
+    void Take() {
+        const auto side = Uniform() < 0.5 ? Side::kBuy : Side::kSell;
+        const auto best = engine_.Best(side == Side::kBuy ? Side::kSell
+                                                          : Side::kBuy);
+        if (!best) return;
+        engine_.Place(side, *best, Qty(), {}, TimeInForce::kIoc);
+    }
+
+    void CancelRandom() {
+        const auto index = random_() % resting_.size();
+        engine_.Cancel(resting_[index]);
+        // filled orders are gone already, both cases free the entry
+        resting_[index] = resting_.back();
+        resting_.pop_back();
+    }
+
+    MatchingEngine& engine_;
+    Options options_;
+    std::mt19937_64 random_;
+    common::Price mid_ = options_.mid;
+    std::vector<uint64_t> resting_;
+};
+}  // namespace simulator
@@ -1,14 +1,20 @@
 #pragma once
+#include <bit>
 #include <iostream>
 
 #include "aot/Logger.h"
 #include "aot/bus/bus.h"
 #include "aot/bus/bus_component.h"
+#include "aot/bus/bus_envelope.h"
 #include "aot/bus/bus_event.h"
 #include "aot/common/exchange_trading_pair.h"
 #include "aot/common/mem_pool.h"
 #include "aot/common/types.h"
+#include "aot/hot_log.h"
 #include "aot/pnl/pnl_calculator.h"
+#include "aot/strategy/arbitrage/cycle_batch.h"
+#include "aot/strategy/arbitrage/cycle_index.h"
+#include "aot/strategy/arbitrage/instrument_registry.h"
 #include "aot/strategy/arbitrage/trade_dictionary.h"
 #include "aot/strategy/arbitrage/trade_state.h"
 #include "aot/strategy/arbitrage/transaction_report.h"
@@ -30,7 +36,6 @@ class TransactionReportString {
     std::string exit_qty_;
     std::string entry_time_;
     std::string exit_time_;
-    aot::ExchangeTradingPairs exchange_trading_pairs_;
     double pnl;
 
   public:
@@ -40,7 +45,6 @@ class TransactionReportString {
           trading_pair_(ref.trading_pair),
           entry_time_(std::to_string(ref.entry_time)),
           exit_time_(std::to_string(ref.exit_time)),
-          exchange_trading_pairs_(exchange_trading_pairs),
           pnl(ref.pnl) {
         auto* info =
             exchange_trading_pairs.GetPairInfo(exchange_id_, trading_pair_);
@@ -48,10 +52,13 @@ class TransactionReportString {
             logw("No info for {} {}", exchange_id_, trading_pair_);
             return;
         }
-        entry_price_ = std::to_string(info->GetPriceDouble(ref.entry_price));
-        exit_price_  = std::to_string(info->GetPriceDouble(ref.exit_price));
-        entry_qty_   = std::to_string(info->GetQtyDouble(ref.entry_qty));
-        exit_qty_    = std::to_string(info->GetQtyDouble(ref.exit_qty));
+        // exact decimal strings of the fixed point values, without double
+        const uint8_t price = info->price_precission;
+        const uint8_t qty   = info->qty_precission;
+        entry_price_        = common::FormatFixedPoint(ref.entry_price, price);
+        exit_price_         = common::FormatFixedPoint(ref.exit_price, price);
+        entry_qty_          = common::FormatFixedPoint(ref.entry_qty, qty);
+        exit_qty_           = common::FormatFixedPoint(ref.exit_qty, qty);
     }
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(TransactionReportString, entry_price_,
                                    exit_price_, entry_qty_, exit_qty_, pnl,
@@ -157,18 +164,41 @@ struct BusEventArbitrageReport
     boost::intrusive_ptr<ArbitrageReport> wrapped_event_;
 };
 
+/// ArbitrageReport and its bus event in one block, see aot::BusEnvelope
+using ArbitrageReportEnvelopePool = ArbitrageReportEnvelope::Pool;
+
 // key is arbitrage id
 
+/**
+ * @brief classic two leg arbitrage over cycles of steps.
+ *
+ * Cycles are compiled in AddArbitrageCycle(): every (exchange, market type,
+ * pair) gets a dense InstrumentId, BBO live in a flat array indexed by it and
+ * a CSR index maps an instrument to its cycles. A BBO costs one hash lookup,
+ * the evaluation of its cycles costs none.
+ *
+ * Cycles of the instrument of a BBO are evaluated at once by CycleBatch, only
+ * cycles of its Act() mask reach the scalar code which changes the trade state.
+ */
 template <typename ThreadPool>
 class ArbitrageStrategyComponent : public bus::Component {
     ThreadPool& thread_pool_;
+    /// BBO handlers share the batch and the trade states, they run one by one
+    boost::asio::strand<typename ThreadPool::executor_type> strand_;
     aot::CoBus& bus_;
-    Trading::ExchangeBBOMap exchange_bbo_map_;
-    TradeDictionary exchange_trading_pair_arbitrage_map_;
+    InstrumentRegistry instruments_;
+    CycleIndex cycles_;
+    /// last BBO per InstrumentId
+    std::vector<Trading::BBO> bbos_;
+    /// SoA prices and trade states of cycles for the batch evaluation
+    CycleBatch batch_;
+    CycleThresholds thresholds_;
+    /// one copy per unique cycle, only for GetTradeDictionary(). The hot
+    /// path reads cycles_ and batch_
+    TradeDictionary trades_;
     static constexpr std::string_view name_component_ =
         "ArbitrageStrategyComponent";
-    ArbitrageReportPool arbitrage_report_pool_;
-    BusEventArbitrageReportPool bus_event_arbitrage_report_pool_;
+    ArbitrageReportEnvelopePool arbitrage_report_pool_;
     // using TradesState = std::unordered_map<size_t, TradeState>;
     aot::TradesState trades_state_;
     ExchangeTradingPairs& exchange_trading_pairs_;
@@ -178,49 +208,46 @@ class ArbitrageStrategyComponent : public bus::Component {
         ThreadPool& thread_pool, aot::CoBus& bus, size_t max_event_per_time,
         ExchangeTradingPairs& exchange_trading_pairs)
         : thread_pool_(thread_pool),
+          strand_(boost::asio::make_strand(thread_pool)),
           bus_(bus),
           arbitrage_report_pool_(max_event_per_time),
-          bus_event_arbitrage_report_pool_(max_event_per_time),
           exchange_trading_pairs_(exchange_trading_pairs) {}
     void AddArbitrageCycle(ArbitrageCycle& cycle) {
         ArbitrageCycleHash hasher;
-        StepHash hasher_step;
-        for (auto& step : cycle) {
-            auto key = common::HashCombined(step.exchange_id, step.market_type,
-                                            step.trading_pair);
-            // Проверяем, существует ли уже такой ключ в мультимапе
-            auto range = exchange_trading_pair_arbitrage_map_.equal_range(key);
-            bool exists =
-                std::any_of(range.first, range.second, [&](const auto& pair) {
-                    return pair.second ==
-                           cycle;  // Если нужно проверить одинаковость по
-                                   // содержимому цикла
-                });
-
-            if (!exists) {
-                auto inserted =
-                    exchange_trading_pair_arbitrage_map_.insert({key, cycle});
-                logi("add arbitrage cycle key:{} {} {} {} hash:{}", key,
-                     step.exchange_id, step.market_type, step.trading_pair,
-                     hasher(inserted->second));
-            } else {
-                logi(
-                    "Arbitrage cycle with the same key already exists, "
-                    "skipping: {}",
-                    key);
-            }
-        }
         // Create 1 Trade state for unique trade
         auto uid_trade = hasher(cycle);
-        if (trades_state_.contains(uid_trade)) return;
+        if (trades_state_.contains(uid_trade)) {
+            logi("arbitrage cycle hash:{} already exists, skipping", uid_trade);
+            return;
+        }
+        trades_.insert({uid_trade, cycle});
+        logi("add arbitrage cycle hash:{} steps:{}", uid_trade, cycle.size());
         trades_state_[uid_trade] = {};
         auto& trade_state        = trades_state_[uid_trade];
-        // need create transaction state for new trade state
+        // need create transaction state for new trade state, nodes of
+        // unordered_map are stable so the compiled cycle keeps pointers
         StepHash step_hasher;
+        CompiledCycle compiled{.uid_trade = uid_trade, .state = &trade_state};
+        std::vector<InstrumentId> instruments;
+        instruments.reserve(cycle.size());
         for (auto& step : cycle) {
-            trade_state.transaction_states[step_hasher(step)] = {
-                step.exchange_id, step.trading_pair, step.operation};
+            auto& transaction =
+                trade_state.transaction_states[step_hasher(step)];
+            transaction = {step.exchange_id, step.trading_pair, step.operation};
+            auto instrument = instruments_.Register(
+                {step.exchange_id, step.market_type, step.trading_pair});
+            instruments.push_back(instrument);
+            if (step.operation == aot::Operation::kBuy) {
+                compiled.buy             = instrument;
+                compiled.buy_transaction = &transaction;
+            } else if (step.operation == aot::Operation::kSell) {
+                compiled.sell             = instrument;
+                compiled.sell_transaction = &transaction;
+            }
         }
+        bbos_.resize(instruments_.Size());
+        cycles_.Add(compiled, instruments);
+        batch_.Build(cycles_, instruments_.Size());
     }
     void AsyncHandleEvent(
         boost::intrusive_ptr<Trading::BusEventNewBBO> event) override {
@@ -238,266 +265,161 @@ class ArbitrageStrategyComponent : public bus::Component {
         }
 
         boost::asio::co_spawn(
-            thread_pool_,
+            strand_,
             [this, wrapped_event]() -> boost::asio::awaitable<void> {
-                co_await HandleNewBBO(wrapped_event);
+                co_await HandleNewBBO(*wrapped_event);
+            },
+            boost::asio::detached);
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope> event) override {
+        if (!event) {
+            logw("[{}] Received nullptr event in AsyncHandleEvent",
+                 ArbitrageStrategyComponent<ThreadPool>::name_component_);
+            return;
+        }
+        // the envelope owns NewBBO, keep it alive until the handler ends
+        boost::asio::co_spawn(
+            strand_,
+            [this, event]() -> boost::asio::awaitable<void> {
+                co_await HandleNewBBO(*event->WrappedEvent());
             },
             boost::asio::detached);
     }
     const TradeDictionary& GetTradeDictionary() const {
-        return exchange_trading_pair_arbitrage_map_;
+        return trades_;
+    }
+    const InstrumentRegistry& GetInstruments() const { return instruments_; }
+    const CycleIndex& GetCycles() const { return cycles_; }
+    /// must be called before the first BBO
+    void SetThresholds(const CycleThresholds& thresholds) {
+        thresholds_ = thresholds;
     }
 
   private:
-    void AddOrUpdateBBO(std::size_t key, Trading::BBO& bbo) {
-        // Attempt to insert the key-value pair, or update the value if it
-        // already exists
-        auto result = exchange_bbo_map_.try_emplace(key, bbo);
-        if (!result.second) {
-            // Key already exists; update the existing BBO
-            result.first->second = bbo;
-            logi("[{}] BBO updated for key: {}",
-                 ArbitrageStrategyComponent<ThreadPool>::name_component_, key);
-        } else {
-            logi("[{}] BBO added for key: {}",
-                 ArbitrageStrategyComponent<ThreadPool>::name_component_, key);
+    /**
+     * @brief applies decisions of CycleBatch to a cycle of Act() mask: opens
+     * the trade and closes it by take profit or stop loss
+     */
+    void ApplyDecision(CompiledCycle& cycle, bool open, bool take_profit,
+                       bool stop_loss) {
+        const auto& buy_bbo    = bbos_[cycle.buy];
+        const auto& sell_bbo   = bbos_[cycle.sell];
+        auto& trade_state      = *cycle.state;
+        auto& buy_transaction  = *cycle.buy_transaction;
+        auto& sell_transaction = *cycle.sell_transaction;
+        if (open) {
+            trade_state.is_open         = true;
+            buy_transaction.entry_price = buy_bbo.ask_price;
+            buy_transaction.entry_qty   = buy_bbo.ask_qty;
+            buy_transaction.entry_time  = common::getCurrentNanoS();
+
+            sell_transaction.entry_price = sell_bbo.bid_price;
+            sell_transaction.entry_qty   = sell_bbo.bid_qty;
+            sell_transaction.entry_time  = common::getCurrentNanoS();
+            trade_state.entry_time       = std::min(
+                buy_transaction.entry_time, sell_transaction.entry_time);
         }
-    }
-    void EvaluateOpportunityArbitrageCycle(ArbitrageCycle& cycle) {
-        StepHash transaction_hasher;
-        auto open_buy_price  = common::kPriceInvalid;
-        auto exit_buy_price  = common::kPriceInvalid;
-        auto open_sell_price = common::kPriceInvalid;
-        auto exit_sell_price = common::kPriceInvalid;
-
-        auto open_buy_qty    = common::kQtyInvalid;
-        auto exit_buy_qty    = common::kQtyInvalid;
-
-        auto open_sell_qty   = common::kQtyInvalid;
-        auto exit_sell_qty   = common::kQtyInvalid;
-
-        size_t transaction_buy;
-        size_t transaction_sell;
-
-        for (auto& step : cycle) {
-            auto key = common::HashCombined(step.exchange_id, step.market_type,
-                                            step.trading_pair);
-            if (!exchange_bbo_map_.contains(key)) {
-                // The BBO for this exchange, trading pair, market_type has not
-                // yet been received from the OrderBook, so we skip the
-                // arbitrage opportunity evaluation at this moment.
-                logw(
-                    "[{}] exchange_bbo_map_ doesn't contain hashed key: "
-                    "{}. "
-                    "skip process step in arbitrage cycle",
-                    ArbitrageStrategyComponent<ThreadPool>::name_component_,
-                    key);
-                return;
-            }
-            if (step.operation == aot::Operation::kBuy) {
-                open_buy_price  = exchange_bbo_map_[key].ask_price;
-                open_buy_qty    = exchange_bbo_map_[key].ask_qty;
-                exit_buy_price  = exchange_bbo_map_[key].bid_price;
-                exit_buy_qty    = exchange_bbo_map_[key].bid_qty;
-                transaction_buy = transaction_hasher(step);
-            } else if (step.operation == aot::Operation::kSell) {
-                open_sell_price  = exchange_bbo_map_[key].bid_price;
-                open_sell_qty    = exchange_bbo_map_[key].bid_qty;
-                exit_sell_price  = exchange_bbo_map_[key].ask_price;
-                exit_sell_qty    = exchange_bbo_map_[key].ask_qty;
-                transaction_sell = transaction_hasher(step);
-            }
+        if (!trade_state.IsOpened()) return;
+        auto exit_buy_price   = buy_bbo.bid_price;
+        auto exit_sell_price  = sell_bbo.ask_price;
+        auto buy_entry_price  = buy_transaction.entry_price;
+        auto sell_entry_price = sell_transaction.entry_price;
+        // P&L in price units of the closing, the batch has compared its percent
+        // with thresholds_
+        int64_t profit_or_loss = -static_cast<int64_t>(exit_sell_price) +
+                                 static_cast<int64_t>(sell_entry_price) +
+                                 static_cast<int64_t>(exit_buy_price) -
+                                 static_cast<int64_t>(buy_entry_price);
+        if (take_profit) {
+            logi(
+                "Fix profit with {} thr {}: exit_sell_price {} < "
+                "sell_entry_price {} && exit_buy_price {} > buy_entry_price {}",
+                profit_or_loss, thresholds_.take_profit_percent,
+                exit_sell_price, sell_entry_price, exit_buy_price,
+                buy_entry_price);
+        } else if (stop_loss) {
+            logi(
+                "Fix loss with {} thr {}: exit_sell_price {} > "
+                "sell_entry_price {} || exit_buy_price {} < buy_entry_price {}",
+                profit_or_loss, thresholds_.stop_loss_percent, exit_sell_price,
+                sell_entry_price, exit_buy_price, buy_entry_price);
         }
-        if (open_buy_price == common::kPriceInvalid) return;
-        if (open_sell_price == common::kPriceInvalid) return;
-        if (exit_buy_price == common::kPriceInvalid) return;
-        if (exit_sell_price == common::kPriceInvalid) return;
-        if (open_buy_qty == common::kQtyInvalid) return;
-        if (exit_buy_qty == common::kQtyInvalid) return;
-        if (open_sell_qty == common::kQtyInvalid) return;
-        if (exit_sell_qty == common::kQtyInvalid) return;
+        trade_state.is_open = false;
 
-        ArbitrageCycleHash hasher_trade;
-        auto uid_trade = hasher_trade(cycle);
-        if (!trades_state_.contains(uid_trade)) return;
-        auto& trade_state = trades_state_[uid_trade];
-        if (!trade_state.transaction_states.contains(transaction_buy)) return;
-        if (!trade_state.transaction_states.contains(transaction_sell)) return;
-        if (!trade_state.IsOpened()) {
-            // check that can open
-            if (open_sell_price > open_buy_price) {
-                trade_state.is_open = true;
-                trade_state.transaction_states[transaction_buy].entry_price =
-                    open_buy_price;
-                trade_state.transaction_states[transaction_buy].entry_qty =
-                    open_buy_qty;
-                trade_state.transaction_states[transaction_buy].entry_time =
-                    common::getCurrentNanoS();
-
-                trade_state.transaction_states[transaction_sell].entry_price =
-                    open_sell_price;
-                trade_state.transaction_states[transaction_sell].entry_qty =
-                    open_sell_qty;
-                trade_state.transaction_states[transaction_sell].entry_time =
-                    common::getCurrentNanoS();
-                trade_state.entry_time = std::min(
-                    trade_state.transaction_states[transaction_buy].entry_time,
-                    trade_state.transaction_states[transaction_sell]
-                        .entry_time);
-            }
+        if (stop_loss) {
+            return;
         }
-        if (trade_state.IsOpened()) {
-            // Проверяем условия закрытия позиции
-            auto buy_entry_price =
-                trade_state.transaction_states[transaction_buy].entry_price;
-            auto sell_entry_price =
-                trade_state.transaction_states[transaction_sell].entry_price;
-
-            // Приводим цены к int64_t для правильного вычисления разницы
-            int64_t exit_sell_price_signed =
-                static_cast<int64_t>(exit_sell_price);
-            int64_t sell_entry_price_signed =
-                static_cast<int64_t>(sell_entry_price);
-            int64_t exit_buy_price_signed =
-                static_cast<int64_t>(exit_buy_price);
-            int64_t buy_entry_price_signed =
-                static_cast<int64_t>(buy_entry_price);
-
-            // Вычисляем прибыль/убыток для Take Profit и Stop Loss
-            int64_t take_profit_condition =
-                -exit_sell_price_signed + sell_entry_price_signed +
-                exit_buy_price_signed - buy_entry_price_signed;
-
-            int64_t stop_loss_condition =
-                -exit_sell_price_signed + sell_entry_price_signed +
-                exit_buy_price_signed - buy_entry_price_signed;
-
-            // Определение порога для прибыли и убытка в процентах
-            // const double take_profit_threshold_percent = 1.0;  // 1% для
-            // прибыли const double stop_loss_threshold_percent = -10.0;  // -1%
-            // для убытка
-
-            const double take_profit_threshold_percent = 0;  // 1% для прибыли
-            const double stop_loss_threshold_percent   = 0;  // -1% для убытка
-
-            // Вычисляем разницу между ценами покупки и продажи
-            double profit_or_loss_buy = static_cast<double>(exit_buy_price) -
-                                        static_cast<double>(buy_entry_price);
-            double profit_or_loss_sell = static_cast<double>(sell_entry_price) -
-                                         static_cast<double>(exit_sell_price);
-
-            // Вычисляем процентное изменение
-            double profit_or_loss_percent =
-                (profit_or_loss_buy + profit_or_loss_sell) /
-                static_cast<double>(buy_entry_price) * 100.0;
-            if (profit_or_loss_percent > 0) {
-                auto x = profit_or_loss_percent;
-            }
-            // Определяем условия Take Profit и Stop Loss
-            bool take_profit =
-                (profit_or_loss_percent >= take_profit_threshold_percent);
-            bool stop_loss =
-                (profit_or_loss_percent <= stop_loss_threshold_percent);
-
-            if (take_profit) {
-                logi(
-                    "Fix profit with {} percent {} thr {}: exit_sell_price {} "
-                    "< sell_entry_price "
-                    "{} && "
-                    "exit_buy_price {} > buy_entry_price {}",
-                    take_profit_condition, profit_or_loss_percent,
-                    take_profit_threshold_percent, exit_sell_price,
-                    sell_entry_price, exit_buy_price, buy_entry_price);
-            } else if (stop_loss) {
-                logi(
-                    "Fix loss with {} percent {} thr {}: exit_sell_price {} > "
-                    "sell_entry_price "
-                    "{} || "
-                    "exit_buy_price {} < buy_entry_price {}",
-                    stop_loss_condition, profit_or_loss_percent,
-                    stop_loss_threshold_percent, exit_sell_price,
-                    sell_entry_price, exit_buy_price, buy_entry_price);
-            }
-            trade_state.is_open = false;
-
-            if (stop_loss) {
+        if (take_profit) {
+            buy_transaction.exit_price = exit_buy_price;
+            buy_transaction.exit_qty   = buy_bbo.bid_qty;
+            buy_transaction.exit_time  = common::getCurrentNanoS();
+
+            sell_transaction.exit_price = exit_sell_price;
+            sell_transaction.exit_qty   = sell_bbo.ask_qty;
+            sell_transaction.exit_time  = common::getCurrentNanoS();
+
+            logi(
+                "Closed arbitrage transaction: buy at {}, sell at {}, "
+                "exit_sell_price: {}",
+                buy_entry_price, sell_entry_price, exit_sell_price);
+
+            trade_state.exit_time =
+                std::max(buy_transaction.exit_time, sell_transaction.exit_time);
+
+            PnlCalculator pnl_calculator(exchange_trading_pairs_);
+            auto [status, pnl] = pnl_calculator.CalculatePnl(trade_state);
+            if (!status) {
                 return;
             }
-            if (take_profit) {
-                trade_state.transaction_states[transaction_buy].exit_price =
-                    exit_buy_price;
-                trade_state.transaction_states[transaction_buy].exit_qty =
-                    exit_buy_qty;
-                trade_state.transaction_states[transaction_buy].exit_time =
-                    common::getCurrentNanoS();
-
-                trade_state.transaction_states[transaction_sell].exit_price =
-                    exit_sell_price;
-                trade_state.transaction_states[transaction_sell].exit_qty =
-                    exit_sell_qty;
-                trade_state.transaction_states[transaction_sell].exit_time =
-                    common::getCurrentNanoS();
-
-                logi(
-                    "Closed arbitrage transaction: buy at {}, sell at {}, "
-                    "exit_sell_price: {}",
-                    buy_entry_price, sell_entry_price, exit_sell_price);
-
-                trade_state.exit_time = std::max(
-                    trade_state.transaction_states[transaction_buy].exit_time,
-                    trade_state.transaction_states[transaction_sell].exit_time);
+            trade_state.pnl = pnl;
 
-                PnlCalculator pnl_calculator(exchange_trading_pairs_);
-                auto [status, pnl] = pnl_calculator.CalculatePnl(trade_state);
-                if (!status) {
-                    return;
-                }
-                trade_state.pnl = pnl;
-
-                // Отправляем отчёт об арбитраже
-                SendArbitrageReportToBus(uid_trade);
-            }
+            // Отправляем отчёт об арбитраже
+            SendArbitrageReportToBus(cycle.uid_trade, trade_state);
         }
     }
 
     boost::asio::awaitable<void> HandleNewBBO(
-        boost::intrusive_ptr<Trading::NewBBO> wrapped_event) {
-        auto key = common::HashCombined(wrapped_event->exchange_id,
-                                        wrapped_event->market_type,
-                                        wrapped_event->trading_pair);
-        AddOrUpdateBBO(key, wrapped_event->bbo);
-        // get access to list arbitrage cycle using exchange_id,
-        // trading_pair необходимо выбрать только те пары, которые в которых
-        // присутсвуют биржа и торговая пара
-
-        if (!exchange_trading_pair_arbitrage_map_.contains(key)) co_return;
-        auto range = exchange_trading_pair_arbitrage_map_.equal_range(key);
-
-        // Перебираем все элементы в этом диапазоне
-        for (auto it = range.first; it != range.second; ++it) {
-            // Получаем арбитражный цикл из мультимапа
-            auto& cycle = it->second;  // Для каждого арбитражного цикла
-
-            // Теперь можно провести оценку арбитражной возможности для
-            // каждого цикла
-            EvaluateOpportunityArbitrageCycle(cycle);
+        const Trading::NewBBO& wrapped_event) {
+        // the only hash of the BBO, instruments without cycles are not stored
+        const auto instrument = instruments_.Find({wrapped_event.exchange_id,
+                                                   wrapped_event.market_type,
+                                                   wrapped_event.trading_pair});
+        if (instrument == kInstrumentIdInvalid) co_return;
+        bbos_[instrument] = wrapped_event.bbo;
+        batch_.UpdateBBO(instrument, wrapped_event.bbo);
+        hlogd(kStrategy, "[{}] BBO updated for instrument: {}",
+              ArbitrageStrategyComponent<ThreadPool>::name_component_,
+              instrument);
+
+        batch_.Evaluate(instrument, thresholds_);
+        auto act = batch_.Act();
+        for (size_t word = 0; word < act.size(); ++word) {
+            for (auto bits = act[word]; bits; bits &= bits - 1) {
+                const size_t lane = word * CycleBatch::kBitsPerWord +
+                                    std::countr_zero(bits);
+                const auto cycle_id = batch_.Lane(lane);
+                auto& cycle         = cycles_.Cycle(cycle_id);
+                ApplyDecision(cycle, CycleBatch::Test(batch_.Open(), lane),
+                              CycleBatch::Test(batch_.TakeProfit(), lane),
+                              CycleBatch::Test(batch_.StopLoss(), lane));
+                batch_.SyncState(cycle_id, cycle);
+            }
         }
         co_return;
     }
-    void SendArbitrageReportToBus(const size_t uid_trade) {
-        ArbitrageCycleHash hasher;
-        auto event =
+    void SendArbitrageReportToBus(const size_t uid_trade,
+                                  const TradeState& trade_state) {
+        // the report and its bus event are one allocation
+        auto* envelope =
             arbitrage_report_pool_.Allocate(&arbitrage_report_pool_, uid_trade);
-        event->transactions   = trades_state_[uid_trade].transaction_states;
-        event->time_open      = trades_state_[uid_trade].entry_time;
-        event->time_close     = trades_state_[uid_trade].exit_time;
-        event->pnl            = trades_state_[uid_trade].pnl;
-        auto intr_ptr_request = boost::intrusive_ptr<ArbitrageReport>(event);
-        auto bus_event        = bus_event_arbitrage_report_pool_.Allocate(
-            &bus_event_arbitrage_report_pool_, intr_ptr_request);
-        auto intr_ptr_bus_request =
-            boost::intrusive_ptr<BusEventArbitrageReport>(bus_event);
-        bus_.AsyncSend(this, intr_ptr_bus_request);
+        auto* event         = envelope->WrappedEvent();
+        event->transactions = trade_state.transaction_states;
+        event->time_open    = trade_state.entry_time;
+        event->time_close   = trade_state.exit_time;
+        event->pnl          = trade_state.pnl;
+        bus_.AsyncSend(this,
+                       boost::intrusive_ptr<ArbitrageReportEnvelope>(envelope));
     }
 };
 };  // namespace aot
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "aot/strategy/arbitrage/cycle_index.h"
+#include "aot/strategy/market_order.h"
+
+namespace aot {
+/// thresholds of the closing of a trade, percents of the buy entry price
+struct CycleThresholds {
+    double take_profit_percent = 0;
+    double stop_loss_percent   = 0;
+};
+
+/**
+ * @brief decisions over all cycles of an instrument, evaluated at once.
+ *
+ * Prices live in SoA columns of double: bid/ask per InstrumentId (NaN while
+ * the price or qty is invalid), entry prices and status per CycleId. Build()
+ * lays out the cycles of every instrument contiguously with the instruments of
+ * their buy and sell legs, so Evaluate() walks one range and gathers columns
+ * with AVX2 (scalar on older CPU). For every cycle of the range it computes:
+ * - open: trade is closed and the sell bid is above the buy ask
+ * - take profit/stop loss: exit P&L percent of an opened (or just opened)
+ * trade against CycleThresholds, the same double math as the scalar strategy
+ *
+ * Results are bitmasks over lanes of the range, Lane(i) is the cycle of bit i.
+ * Only cycles of Act() need the scalar code, it reports the new state of the
+ * trade by SyncState().
+ */
+class CycleBatch {
+  public:
+    /// lanes of one AVX2 register of double
+    static constexpr size_t kLanesPerGroup = 4;
+    static constexpr size_t kBitsPerWord   = 64;
+
+    enum class Kernel { kAuto, kScalar, kAvx2 };
+
+    /**
+     * @brief lays out cycles of the index, called after a cycle is added.
+     * State of known cycles and BBO are kept. O(number of entries), meant for
+     * startup only
+     */
+    void Build(const CycleIndex& index, size_t instruments) {
+        bid_.resize(instruments, kNoPrice);
+        ask_.resize(instruments, kNoPrice);
+        received_.resize(instruments, 0);
+        entry_buy_.resize(index.Size(), 1);
+        entry_sell_.resize(index.Size(), 0);
+        status_.resize(index.Size(), kNotReady);
+        offsets_.assign(1, 0);
+        lane_cycles_.clear();
+        lane_buy_.clear();
+        lane_sell_.clear();
+        for (InstrumentId instrument = 0; instrument < instruments;
+             ++instrument) {
+            for (auto id : index.CyclesOf(instrument)) {
+                const auto& cycle = index.Cycle(id);
+                if (cycle.buy == kInstrumentIdInvalid ||
+                    cycle.sell == kInstrumentIdInvalid)
+                    continue;
+                lane_cycles_.push_back(static_cast<int32_t>(id));
+                lane_buy_.push_back(static_cast<int32_t>(cycle.buy));
+                lane_sell_.push_back(static_cast<int32_t>(cycle.sell));
+            }
+            offsets_.push_back(static_cast<uint32_t>(lane_cycles_.size()));
+        }
+        index_ = &index;
+        for (CycleId id = 0; id < index.Size(); ++id) MarkReady(id);
+    }
+
+    /// stores the BBO, the first one of an instrument can make its cycles ready
+    void UpdateBBO(InstrumentId instrument, const Trading::BBO& bbo) {
+        bid_[instrument] = bbo.bid_price == common::kPriceInvalid ||
+                                   bbo.bid_qty == common::kQtyInvalid
+                               ? kNoPrice
+                               : static_cast<double>(bbo.bid_price);
+        ask_[instrument] = bbo.ask_price == common::kPriceInvalid ||
+                                   bbo.ask_qty == common::kQtyInvalid
+                               ? kNoPrice
+                               : static_cast<double>(bbo.ask_price);
+        if (received_[instrument]) [[likely]]
+            return;
+        received_[instrument] = 1;
+        for (auto id : index_->CyclesOf(instrument)) MarkReady(id);
+    }
+    /// true if BBO of every step of the cycle has been received
+    bool Ready(CycleId id) const { return status_[id] != kNotReady; }
+    /// state of the trade after the scalar code has acted on a ready cycle
+    void SyncState(CycleId id, const CompiledCycle& cycle) {
+        if (!cycle.state->IsOpened()) {
+            status_[id] = kClosed;
+            return;
+        }
+        status_[id]     = kOpened;
+        entry_buy_[id] =
+            static_cast<double>(cycle.buy_transaction->entry_price);
+        entry_sell_[id] =
+            static_cast<double>(cycle.sell_transaction->entry_price);
+    }
+
+    /// computes Open(), TakeProfit(), StopLoss() and Act() of the cycles of
+    /// the instrument
+    void Evaluate(InstrumentId instrument, const CycleThresholds& thresholds,
+                  Kernel kernel = Kernel::kAuto);
+
+    size_t Size() const { return size_; }
+    CycleId Lane(size_t lane) const {
+        return static_cast<CycleId>(lane_cycles_[begin_ + lane]);
+    }
+    std::span<const uint64_t> Open() const { return Mask(kOpen); }
+    std::span<const uint64_t> TakeProfit() const { return Mask(kTakeProfit); }
+    std::span<const uint64_t> StopLoss() const { return Mask(kStopLoss); }
+    /// lanes whose trade state changes: opened now or opened before
+    std::span<const uint64_t> Act() const { return Mask(kAct); }
+
+    static bool Test(std::span<const uint64_t> mask, size_t lane) {
+        return (mask[lane / kBitsPerWord] >> (lane % kBitsPerWord)) & 1;
+    }
+    /// true if the CPU runs the AVX2 kernel
+    static bool HasAvx2();
+
+  private:
+    static constexpr double kNoPrice = std::numeric_limits<double>::quiet_NaN();
+    /// status_ of a cycle: not all BBO received, ready and closed, opened
+    static constexpr double kNotReady = 0;
+    static constexpr double kClosed   = 1;
+    static constexpr double kOpened   = 2;
+    /// masks are consecutive in masks_
+    enum MaskIndex : size_t { kOpen, kTakeProfit, kStopLoss, kAct, kMasks };
+
+    /// a cycle becomes ready with the state of its trade
+    void MarkReady(CycleId id) {
+        if (status_[id] != kNotReady) return;
+        const auto& cycle = index_->Cycle(id);
+        for (auto instrument : index_->Instruments(cycle))
+            if (!received_[instrument]) return;
+        SyncState(id, cycle);
+    }
+    /// lanes [first, size_) of the range, tail of the AVX2 kernel
+    void EvaluateScalar(const CycleThresholds& thresholds, size_t first);
+    /// full groups of the range, returns the first lane left to evaluate
+    size_t EvaluateAvx2(const CycleThresholds& thresholds);
+    std::span<const uint64_t> Mask(MaskIndex mask) const {
+        return {masks_.data() + mask * words_, words_};
+    }
+    void SetLane(MaskIndex mask, size_t lane, uint64_t bits) {
+        const size_t word = mask * words_ + lane / kBitsPerWord;
+        masks_[word] |= bits << (lane % kBitsPerWord);
+    }
+
+    const CycleIndex* index_ = nullptr;
+    /// per InstrumentId
+    std::vector<double> bid_;
+    std::vector<double> ask_;
+    std::vector<uint8_t> received_;
+    /// per CycleId, entry prices are meaningful while kOpened
+    std::vector<double> entry_buy_;
+    std::vector<double> entry_sell_;
+    std::vector<double> status_;
+    /// cycles of instrument i are lanes [offsets_[i], offsets_[i+1])
+    std::vector<uint32_t> offsets_{0};
+    std::vector<int32_t> lane_cycles_;
+    std::vector<int32_t> lane_buy_;
+    std::vector<int32_t> lane_sell_;
+    /// range of the last Evaluate()
+    size_t begin_ = 0;
+    size_t size_  = 0;
+    size_t words_ = 0;
+    std::vector<uint64_t> masks_;
+};
+};  // namespace aot
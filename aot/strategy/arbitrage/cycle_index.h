@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "aot/strategy/arbitrage/instrument_registry.h"
+#include "aot/strategy/arbitrage/trade_state.h"
+#include "aot/strategy/arbitrage/transaction_report.h"
+
+namespace aot {
+using CycleId = uint32_t;
+
+/**
+ * @brief ArbitrageCycle resolved at startup. Legs are instrument ids and the
+ * state of the trade is reached by pointers, the evaluation hashes nothing
+ */
+struct CompiledCycle {
+    /// ArbitrageCycleHash of the cycle, key of trades state and reports
+    size_t uid_trade                    = 0;
+    /// instrument of the last kBuy step
+    InstrumentId buy                    = kInstrumentIdInvalid;
+    /// instrument of the last kSell step
+    InstrumentId sell                   = kInstrumentIdInvalid;
+    TradeState* state                   = nullptr;
+    TransactionReport* buy_transaction  = nullptr;
+    TransactionReport* sell_transaction = nullptr;
+    /// range of instruments of all steps in CycleIndex
+    uint32_t first_instrument           = 0;
+    uint32_t instruments                = 0;
+};
+
+/**
+ * @brief compiled cycles and CSR adjacency from an instrument to its cycles.
+ *
+ * Cycles containing instrument i are cycle_ids_[offsets_[i], offsets_[i+1]),
+ * so a BBO walks one contiguous array. Add() keeps the arrays packed, it is
+ * O(number of entries) and meant for startup only.
+ */
+class CycleIndex {
+  public:
+    CycleId Add(CompiledCycle cycle,
+                std::span<const InstrumentId> instruments) {
+        const auto id          = static_cast<CycleId>(cycles_.size());
+        cycle.first_instrument =
+            static_cast<uint32_t>(cycle_instruments_.size());
+        for (auto instrument : instruments) {
+            auto begin = cycle_instruments_.begin() + cycle.first_instrument;
+            if (std::find(begin, cycle_instruments_.end(), instrument) !=
+                cycle_instruments_.end())
+                continue;
+            cycle_instruments_.push_back(instrument);
+            if (offsets_.size() < instrument + 2)
+                offsets_.resize(instrument + 2, offsets_.back());
+            cycle_ids_.insert(cycle_ids_.begin() + offsets_[instrument + 1],
+                              id);
+            for (size_t i = instrument + 1; i < offsets_.size(); ++i)
+                ++offsets_[i];
+        }
+        cycle.instruments = static_cast<uint32_t>(cycle_instruments_.size()) -
+                            cycle.first_instrument;
+        cycles_.push_back(cycle);
+        return id;
+    }
+
+    std::span<const CycleId> CyclesOf(InstrumentId instrument) const {
+        if (instrument + 1 >= offsets_.size()) return {};
+        return {cycle_ids_.data() + offsets_[instrument],
+                offsets_[instrument + 1] - offsets_[instrument]};
+    }
+    std::span<const InstrumentId> Instruments(
+        const CompiledCycle& cycle) const {
+        return {cycle_instruments_.data() + cycle.first_instrument,
+                cycle.instruments};
+    }
+    CompiledCycle& Cycle(CycleId id) { return cycles_[id]; }
+    const CompiledCycle& Cycle(CycleId id) const { return cycles_[id]; }
+    size_t Size() const { return cycles_.size(); }
+
+  private:
+    std::vector<CompiledCycle> cycles_;
+    std::vector<InstrumentId> cycle_instruments_;
+    std::vector<uint32_t> offsets_{0};
+    std::vector<CycleId> cycle_ids_;
+};
+};  // namespace aot
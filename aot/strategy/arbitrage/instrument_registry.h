@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "aot/common/types.h"
+
+namespace aot {
+/// Dense index of (exchange, market type, pair), ids go from 0 without gaps.
+using InstrumentId = uint32_t;
+inline constexpr InstrumentId kInstrumentIdInvalid =
+    std::numeric_limits<InstrumentId>::max();
+
+struct InstrumentKey {
+    common::ExchangeId exchange_id;
+    common::MarketType market_type;
+    common::TradingPair trading_pair;
+    bool operator==(const InstrumentKey&) const = default;
+};
+
+struct InstrumentKeyHash {
+    std::size_t operator()(const InstrumentKey& key) const {
+        return common::HashCombined(key.exchange_id, key.market_type,
+                                    key.trading_pair);
+    }
+};
+
+/**
+ * @brief assigns dense ids to instruments when cycles are added at startup.
+ *
+ * Hot paths hash the key once with Find() and then index flat arrays by the
+ * id. The registry is not thread safe, Register() must happen before the
+ * first BBO.
+ */
+class InstrumentRegistry {
+  public:
+    /// Returns the id of the instrument, a new one if it is not known yet.
+    InstrumentId Register(const InstrumentKey& key) {
+        auto [it, inserted] =
+            ids_.try_emplace(key, static_cast<InstrumentId>(keys_.size()));
+        if (inserted) keys_.push_back(key);
+        return it->second;
+    }
+    InstrumentId Find(const InstrumentKey& key) const {
+        auto it = ids_.find(key);
+        return it == ids_.end() ? kInstrumentIdInvalid : it->second;
+    }
+    const InstrumentKey& Key(InstrumentId id) const { return keys_[id]; }
+    size_t Size() const { return keys_.size(); }
+
+  private:
+    std::unordered_map<InstrumentKey, InstrumentId, InstrumentKeyHash> ids_;
+    std::vector<InstrumentKey> keys_;
+};
+};  // namespace aot
@@ -1,68 +1,84 @@
-#include <deque>
+#pragma once
+
+#include <cmath>
+#include <span>
 #include <unordered_map>
 
+#include "aot/Logger.h"
+#include "aot/common/rolling_stats.h"
 #include "aot/strategy/arbitrage/arbitrage_cycle.h"
 #include "aot/strategy/arbitrage/arbitrage_step.h"
 #include "aot/strategy/arbitrage/trade_state.h"
 #include "aot/strategy/market_order.h"
 
 namespace aot {
+/**
+ * @brief spread of arbitrage cycles against its rolling statistics.
+ *
+ * Every strategy key gets a series of common::RollingStats at its first spread,
+ * mean, variance, EWMA and z-score of the window are O(1). The window is a
+ * time, spreads come with the time of the exchange that produced them. Hot
+ * paths keep the SpreadId of their strategy and use AddSpread()/AddSpreads(),
+ * which allocate nothing.
+ */
 class SpreadMonitor {
     static constexpr std::string_view name_component_ = "SpreadMonitor";
-    using StrategyKey                                 = size_t;
-    using SpreadHistory                               = std::deque<double>;
-    std::unordered_map<StrategyKey, SpreadHistory>
-        spread_history_;  // История спредов
-    size_t time_window_;  // Окно для расчета среднего спреда (в секундах)
+
+  public:
+    using StrategyKey = size_t;
+    using SpreadId    = common::RollingStats::SeriesId;
+
+  private:
     Trading::ExchangeBBOMap& exchange_bbo_map_;
     aot::TradesState& trades_state_;
+    common::RollingStats stats_;
+    std::unordered_map<StrategyKey, SpreadId> spread_ids_;
 
   public:
     SpreadMonitor(Trading::ExchangeBBOMap& exchange_bbo_map,
-                  aot::TradesState& trade_states)
+                  aot::TradesState& trade_states,
+                  common::RollingStats::Options options = {})
         : exchange_bbo_map_(exchange_bbo_map),
           trades_state_(trade_states),
-          time_window_(10) {
-        // TO DO INIT spread_history_ with empty SpreadHistory
-    }
+          stats_(options) {}
 
-    // Получаем текущий спред между двумя биржами
+    /// series of the strategy, created at the first call
+    SpreadId Register(StrategyKey strategy_id) {
+        auto [it, inserted] = spread_ids_.try_emplace(strategy_id, 0);
+        if (inserted) it->second = stats_.AddSeries();
+        return it->second;
+    }
 
     // Добавляем новый спред в историю для данной стратегии
-    void AddSpreadToHistory(StrategyKey strategy_id, double spread) {
-        // Проверяем, существует ли уже ключ для стратегии
-        if (spread_history_.find(strategy_id) == spread_history_.end()) {
-            spread_history_[strategy_id] =
-                SpreadHistory();  // Инициализация истории
-        }
-
-        // Добавляем спред в историю
-        spread_history_[strategy_id].push_back(spread);
-
-        // Если история превышает окно времени, удаляем старые значения
-        if (spread_history_[strategy_id].size() > time_window_) {
-            spread_history_[strategy_id].pop_front();
-        }
+    void AddSpreadToHistory(StrategyKey strategy_id, double spread,
+                            common::Nanos time) {
+        AddSpread(Register(strategy_id), spread, time);
+    }
+    void AddSpread(SpreadId id, double spread, common::Nanos time) {
+        stats_.Add(id, time, spread);
+    }
+    /**
+     * @brief spreads of many strategies at one time, e.g. all cycles of a tick
+     *
+     * @param z_scores receives z-score of every spread against the window
+     * before it
+     */
+    void AddSpreads(std::span<const SpreadId> ids,
+                    std::span<const double> spreads, common::Nanos time,
+                    std::span<double> z_scores) {
+        stats_.AddBatch(ids, spreads, time, z_scores);
     }
 
     // Рассчитываем среднее значение спреда за заданное окно времени
-    double CalculateAverageSpread(StrategyKey strategy_id) {
-        // Проверяем, существует ли ключ для стратегии
-        if (spread_history_.find(strategy_id) == spread_history_.end()) {
-            return 0.0;  // Если нет истории, возвращаем 0
-        }
-
-        const auto& history = spread_history_[strategy_id];
-        double sum          = 0;
-        for (double spread : history) {
-            sum += spread;
-        }
-        return history.empty() ? 0.0 : sum / history.size();
+    double CalculateAverageSpread(StrategyKey strategy_id) const {
+        auto it = spread_ids_.find(strategy_id);
+        if (it == spread_ids_.end()) return 0.0;  // Если нет истории
+        return stats_.Mean(it->second);
     }
 
     // Рассчитываем процентное отклонение спреда от среднего значения
     double CalculatePercentageDeviation(StrategyKey strategy_id,
-                                        double current_spread) {
+                                        double current_spread) const {
         double average_spread = CalculateAverageSpread(strategy_id);
         if (average_spread == 0) return 0.0;  // Избегаем деления на 0
         return ((current_spread - average_spread) / average_spread) * 100.0;
@@ -70,32 +86,29 @@ class SpreadMonitor {
 
     // Проверка на процентное отклонение
     bool IsSpreadOutOfBounds(StrategyKey strategy_id, double spread,
-                             double threshold) {
+                             double threshold) const {
         double percentage_deviation =
             CalculatePercentageDeviation(strategy_id, spread);
         return std::abs(percentage_deviation) > threshold;
     }
 
+    /// deviation of spread from the mean of the window in standard deviations
+    double ZScore(SpreadId id, double spread) const {
+        return stats_.ZScore(id, spread);
+    }
+    const common::RollingStats& Stats() const { return stats_; }
+
     std::pair<bool, double> GetCurrentSpread(aot::ArbitrageCycle& cycle) {
-        StepHash transaction_hasher;
         auto open_buy_price  = common::kPriceInvalid;
-        auto exit_buy_price  = common::kPriceInvalid;
         auto open_sell_price = common::kPriceInvalid;
-        auto exit_sell_price = common::kPriceInvalid;
-
         auto open_buy_qty    = common::kQtyInvalid;
-        auto exit_buy_qty    = common::kQtyInvalid;
-
         auto open_sell_qty   = common::kQtyInvalid;
-        auto exit_sell_qty   = common::kQtyInvalid;
-
-        size_t transaction_buy;
-        size_t transaction_sell;
 
         for (auto& step : cycle) {
             auto key = common::HashCombined(step.exchange_id, step.market_type,
                                             step.trading_pair);
-            if (!exchange_bbo_map_.contains(key)) {
+            auto it  = exchange_bbo_map_.find(key);
+            if (it == exchange_bbo_map_.end()) {
                 // The BBO for this exchange, trading pair, market_type has not
                 // yet been received from the OrderBook, so we skip the
                 // arbitrage opportunity evaluation at this moment.
@@ -104,57 +117,38 @@ class SpreadMonitor {
                     "{}. "
                     "skip process step in arbitrage cycle",
                     SpreadMonitor::name_component_, key);
-                return;
+                return {false, 0.0};
             }
             if (step.operation == aot::Operation::kBuy) {
-                open_buy_price  = exchange_bbo_map_[key].ask_price;
-                open_buy_qty    = exchange_bbo_map_[key].ask_qty;
-                exit_buy_price  = exchange_bbo_map_[key].bid_price;
-                exit_buy_qty    = exchange_bbo_map_[key].bid_qty;
-                transaction_buy = transaction_hasher(step);
+                open_buy_price = it->second.ask_price;
+                open_buy_qty   = it->second.ask_qty;
             } else if (step.operation == aot::Operation::kSell) {
-                open_sell_price  = exchange_bbo_map_[key].bid_price;
-                open_sell_qty    = exchange_bbo_map_[key].bid_qty;
-                exit_sell_price  = exchange_bbo_map_[key].ask_price;
-                exit_sell_qty    = exchange_bbo_map_[key].ask_qty;
-                transaction_sell = transaction_hasher(step);
+                open_sell_price = it->second.bid_price;
+                open_sell_qty   = it->second.bid_qty;
             }
         }
-        if (open_buy_price == common::kPriceInvalid) return;
-        if (open_sell_price == common::kPriceInvalid) return;
-        if (exit_buy_price == common::kPriceInvalid) return;
-        if (exit_sell_price == common::kPriceInvalid) return;
-        if (open_buy_qty == common::kQtyInvalid) return;
-        if (exit_buy_qty == common::kQtyInvalid) return;
-        if (open_sell_qty == common::kQtyInvalid) return;
-        if (exit_sell_qty == common::kQtyInvalid) return;
-
         // If any of the prices or quantities are invalid, return false
         if (open_buy_price == common::kPriceInvalid ||
             open_sell_price == common::kPriceInvalid ||
-            exit_buy_price == common::kPriceInvalid ||
-            exit_sell_price == common::kPriceInvalid ||
             open_buy_qty == common::kQtyInvalid ||
-            exit_buy_qty == common::kQtyInvalid ||
-            open_sell_qty == common::kQtyInvalid ||
-            exit_sell_qty == common::kQtyInvalid) {
+            open_sell_qty == common::kQtyInvalid) {
             return {false, 0.0};
         }
 
-        // Calculate the spread between the exchanges
-        double spread =
-            open_sell_price - open_buy_price;  // Spread between buy on first
-                                               // exchange and sell on second
+        // Spread between buy on first exchange and sell on second, signed
+        double spread = static_cast<double>(open_sell_price) -
+                        static_cast<double>(open_buy_price);
 
         return {true, spread};
     }
 
     // // Логика торговли при отклонении спреда
-    void EvaluateOpportunityArbitrageCycle(aot::ArbitrageCycle& cycle) {
+    void EvaluateOpportunityArbitrageCycle(aot::ArbitrageCycle& cycle,
+                                           common::Nanos time) {
         auto [status, spread] = GetCurrentSpread(cycle);
         if (!status) return;
         ArbitrageCycleHash hasher_trade;
-        AddSpreadToHistory(hasher_trade(cycle), spread);
+        AddSpreadToHistory(hasher_trade(cycle), spread, time);
 
         // std::cout << "Current spread: " << spread
         //           << ", Average spread: " << CalculateAverageSpread()
@@ -9,9 +9,8 @@
 
 namespace aot {
 class TradeDictionary
-    : public std::unordered_multimap<size_t,  // key is now the combined hash
-                                              // value (size_t) of exchange id,
-                                              // market_type, trading_apir
+    : public std::unordered_multimap<size_t,  // key is ArbitrageCycleHash of
+                                              // the cycle, one entry per cycle
                                      ArbitrageCycle> {
   public:
     inline void SerializeToJson(nlohmann::json& j) const {
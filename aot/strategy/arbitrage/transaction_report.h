@@ -1,4 +1,5 @@
 #pragma once
+#include "aot/common/time_utils.h"
 #include "aot/common/types.h"
 #include "aot/strategy/arbitrage/arbitrage_step.h"
 
@@ -7,6 +7,7 @@
 #include "aot/common/macros.h"
 #include "aot/strategy/market_order.h"
 #include "aot/strategy/market_order_book.h"
+#include "aot/strategy/inference.h"
 #include "aot/strategy/order_manager.h"
 #include "aot/wallet_asset.h"
 
@@ -55,6 +56,12 @@ class BaseStrategy {
      *
      */
     auto OnNewKLine(const OHLCVExt *new_kline) noexcept -> void;
+    /**
+     * @brief Process kline already scored by inference::InferenceService.
+     * Launch order manager without calling the predictor
+     *
+     */
+    auto OnNewKLine(const inference::Prediction *prediction) noexcept -> void;
 
     virtual void OnNewSignal(strategy::cross_arbitrage::Event *signal) {
         logi("doing nothing");
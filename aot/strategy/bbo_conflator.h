@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/bus/bus_component.h"
+#include "aot/common/types.h"
+#include "aot/strategy/market_order.h"
+#include "boost/asio/any_io_executor.hpp"
+#include "boost/asio/post.hpp"
+#include "boost/container_hash/hash.hpp"
+
+namespace Trading {
+/**
+ * @brief conflating fan-out of NewBBO for slow subscribers.
+ *
+ * The conflator is subscribed to OrderBookComponent like any other component.
+ * It keeps the latest BBO per (exchange, market type, pair) and releases the
+ * event of the book at once, so slow consumers don't hold NewBBOEnvelope of
+ * the book pool. Every subscriber of the conflator has a dirty bit per key and
+ * at most one pending drain on its executor. A drain delivers the newest BBO
+ * of every dirty key, intermediate states of a key updated several times
+ * between two drains are dropped and counted as conflated.
+ *
+ * The path of a BBO takes no lock and allocates nothing: the key is found in
+ * a lock-free index, the value goes to its slot under a sequence lock and the
+ * dirty bits are atomic words. A drain reuses the buffer of its subscriber.
+ *
+ * Subscribers which need every tick, e.g. the arbitrage strategy, stay
+ * subscribed to the order book directly.
+ *
+ * @code
+ * bus.Subscribe(&order_book, &arbitrage_strategy);  // every tick
+ * bus.Subscribe(&order_book, &conflator);
+ * conflator.Subscribe(&red_panda, red_panda_strand);  // latest value only
+ * @endcode
+ */
+class BBOConflator : public bus::Component {
+  public:
+    struct SubscriberStats {
+        /// BBO given to the conflator for the subscriber
+        uint64_t received  = 0;
+        uint64_t delivered = 0;
+        /// BBO replaced by a newer one of the same key before a drain
+        uint64_t conflated = 0;
+        uint64_t drains    = 0;
+    };
+
+    /// distinct (exchange, market type, pair) a conflator keeps by default
+    static constexpr size_t kDefaultMaxKeys = 1024;
+
+    /**
+     * @param max_new_bbo size of the pool of delivered events, it needs about
+     * number of keys * number of subscribers
+     * @param max_keys distinct keys, BBO of more keys are dropped
+     */
+    explicit BBOConflator(size_t max_new_bbo,
+                          size_t max_keys = kDefaultMaxKeys)
+        : max_keys_(std::max<size_t>(max_keys, 1)),
+          index_size_(std::bit_ceil(max_keys_ * 2)),
+          index_(std::make_unique<IndexEntry[]>(index_size_)),
+          slots_(std::make_unique<Slot[]>(max_keys_)),
+          pool_(max_new_bbo) {}
+    ~BBOConflator() override = default;
+
+    /**
+     * @brief add a slow subscriber, must be called before the first BBO
+     *
+     * @param executor drains run on it. It must not run two handlers at once,
+     * use the strand of the subscriber or a single thread
+     * @return index of the subscriber for Stats()
+     */
+    size_t Subscribe(bus::Component *subscriber,
+                     boost::asio::any_io_executor executor) {
+        auto entry       = std::make_unique<Subscriber>();
+        entry->component = subscriber;
+        entry->executor  = std::move(executor);
+        entry->words     = max_keys_ / kBitsPerWord + 1;
+        entry->dirty =
+            std::make_unique<std::atomic<uint64_t>[]>(entry->words);
+        entry->drained.reserve(max_keys_);
+        subscribers_.push_back(std::move(entry));
+        return subscribers_.size() - 1;
+    }
+
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope> event) override {
+        if (!event) [[unlikely]]
+            return;
+        Update(*event->WrappedEvent());
+    }
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::BusEventNewBBO> event) override {
+        if (!event || !event->WrappedEvent()) [[unlikely]]
+            return;
+        Update(*event->WrappedEvent());
+    }
+    void AsyncStop() override {}
+
+    SubscriberStats Stats(size_t subscriber) const {
+        const auto &entry = *subscribers_.at(subscriber);
+        return {entry.received.load(std::memory_order_relaxed),
+                entry.delivered.load(std::memory_order_relaxed),
+                entry.conflated.load(std::memory_order_relaxed),
+                entry.drains.load(std::memory_order_relaxed)};
+    }
+    /// Number of distinct (exchange, market type, pair) seen.
+    size_t Keys() const {
+        return std::min(used_slots_.load(std::memory_order_acquire),
+                        max_keys_);
+    }
+
+  private:
+    static constexpr size_t kBitsPerWord = 64;
+    static constexpr uint64_t kEmptyPair = ~uint64_t{0};
+    static constexpr uint32_t kNoSlot    = ~uint32_t{0};
+
+    struct Value {
+        common::ExchangeId exchange_id;
+        common::TradingPair trading_pair;
+        BBO bbo;
+        common::MarketType market_type;
+    };
+    /// open addressing index from a key to its slot, entries are never removed
+    struct IndexEntry {
+        std::atomic<uint64_t> pair{kEmptyPair};
+        std::atomic<uint32_t> slot{kNoSlot};
+    };
+    /**
+     * @brief latest BBO of a key. The key is written once before the slot is
+     * published, the BBO under a sequence lock: odd while it is written
+     */
+    struct Slot {
+        common::ExchangeId exchange_id;
+        common::MarketType market_type;
+        common::TradingPair trading_pair;
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<common::Price> bid_price{common::kPriceInvalid};
+        std::atomic<common::Price> ask_price{common::kPriceInvalid};
+        std::atomic<common::Qty> bid_qty{common::kQtyInvalid};
+        std::atomic<common::Qty> ask_qty{common::kQtyInvalid};
+    };
+    struct Subscriber {
+        bus::Component *component = nullptr;
+        boost::asio::any_io_executor executor;
+        size_t words = 0;
+        std::unique_ptr<std::atomic<uint64_t>[]> dirty;
+        std::atomic<bool> scheduled{false};
+        /// values of one drain, only the executor touches it
+        std::vector<Value> drained;
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> delivered{0};
+        std::atomic<uint64_t> conflated{0};
+        std::atomic<uint64_t> drains{0};
+    };
+
+    static uint64_t Pack(common::TradingPair trading_pair) {
+        return uint64_t{trading_pair.first} << 32 | trading_pair.second;
+    }
+
+    /// slot of the key of bbo, kNoSlot if all max_keys_ slots are taken
+    uint32_t FindOrAdd(const NewBBO &bbo) {
+        const uint64_t pair = Pack(bbo.trading_pair);
+        size_t hash         = common::TradingPairHash{}(bbo.trading_pair);
+        boost::hash_combine(hash, static_cast<int>(bbo.exchange_id));
+        boost::hash_combine(hash, static_cast<int>(bbo.market_type));
+        // a key always takes the same probe sequence, so two threads adding
+        // it at once meet at the same entry
+        for (size_t probe = 0; probe < index_size_; ++probe) {
+            auto &entry = index_[(hash + probe) & (index_size_ - 1)];
+            auto current = entry.pair.load(std::memory_order_acquire);
+            if (current == kEmptyPair &&
+                entry.pair.compare_exchange_strong(current, pair,
+                                                   std::memory_order_acq_rel))
+                return AddSlot(entry, bbo);
+            if (current != pair) continue;
+            uint32_t slot;
+            while ((slot = entry.slot.load(std::memory_order_acquire)) ==
+                   kNoSlot)
+                std::this_thread::yield();
+            if (slot >= max_keys_) return kNoSlot;
+            if (slots_[slot].exchange_id == bbo.exchange_id &&
+                slots_[slot].market_type == bbo.market_type)
+                return slot;
+        }
+        return kNoSlot;
+    }
+
+    uint32_t AddSlot(IndexEntry &entry, const NewBBO &bbo) {
+        const auto slot = used_slots_.fetch_add(1, std::memory_order_acq_rel);
+        if (slot >= max_keys_) [[unlikely]] {
+            loge("BBOConflator keeps {} keys, BBO of {} are dropped",
+                 max_keys_, bbo.trading_pair.ToString());
+            // waiters of the entry see a slot out of range
+            entry.slot.store(static_cast<uint32_t>(max_keys_),
+                             std::memory_order_release);
+            return kNoSlot;
+        }
+        slots_[slot].exchange_id  = bbo.exchange_id;
+        slots_[slot].market_type  = bbo.market_type;
+        slots_[slot].trading_pair = bbo.trading_pair;
+        entry.slot.store(static_cast<uint32_t>(slot),
+                         std::memory_order_release);
+        return static_cast<uint32_t>(slot);
+    }
+
+    static void Store(Slot &slot, const BBO &bbo) {
+        auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        while (sequence & 1 ||
+               !slot.sequence.compare_exchange_weak(
+                   sequence, sequence + 1, std::memory_order_acquire))
+            sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.bid_price.store(bbo.bid_price, std::memory_order_relaxed);
+        slot.ask_price.store(bbo.ask_price, std::memory_order_relaxed);
+        slot.bid_qty.store(bbo.bid_qty, std::memory_order_relaxed);
+        slot.ask_qty.store(bbo.ask_qty, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    static Value Load(const Slot &slot) {
+        Value value{slot.exchange_id, slot.trading_pair, BBO(),
+                    slot.market_type};
+        uint64_t before, after;
+        do {
+            const auto relaxed  = std::memory_order_relaxed;
+            before              = slot.sequence.load(std::memory_order_acquire);
+            value.bbo.bid_price = slot.bid_price.load(relaxed);
+            value.bbo.ask_price = slot.ask_price.load(relaxed);
+            value.bbo.bid_qty   = slot.bid_qty.load(relaxed);
+            value.bbo.ask_qty   = slot.ask_qty.load(relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = slot.sequence.load(relaxed);
+        } while (before != after || before & 1);
+        return value;
+    }
+
+    void Update(const NewBBO &bbo) {
+        const auto slot = FindOrAdd(bbo);
+        if (slot == kNoSlot) [[unlikely]]
+            return;
+        Store(slots_[slot], bbo.bbo);
+        const uint64_t bit = uint64_t{1} << (slot % kBitsPerWord);
+        for (auto &subscriber : subscribers_) {
+            subscriber->received.fetch_add(1, std::memory_order_relaxed);
+            if (subscriber->dirty[slot / kBitsPerWord].fetch_or(bit) & bit)
+                subscriber->conflated.fetch_add(1, std::memory_order_relaxed);
+            // a drain clears scheduled before it takes the dirty bits, so
+            // either it sees this bit or a new drain is posted
+            if (!subscriber->scheduled.exchange(true))
+                boost::asio::post(subscriber->executor,
+                                  [this, subscriber = subscriber.get()]() {
+                                      Drain(*subscriber);
+                                  });
+        }
+    }
+
+    void Drain(Subscriber &subscriber) {
+        // BBO which come after this store schedule the next drain
+        subscriber.scheduled.store(false);
+        auto &values = subscriber.drained;
+        values.clear();
+        for (size_t i = 0; i < subscriber.words; ++i) {
+            for (auto word = subscriber.dirty[i].exchange(0); word;
+                 word &= word - 1)
+                values.push_back(Load(
+                    slots_[i * kBitsPerWord + std::countr_zero(word)]));
+        }
+        subscriber.drains.fetch_add(1, std::memory_order_relaxed);
+        subscriber.delivered.fetch_add(values.size(),
+                                       std::memory_order_relaxed);
+        for (const auto &value : values) {
+            auto *envelope =
+                pool_.Allocate(&pool_, value.exchange_id, value.trading_pair,
+                               value.bbo, value.market_type);
+            try {
+                subscriber.component->AsyncHandleEvent(
+                    boost::intrusive_ptr<NewBBOEnvelope>(envelope));
+            } catch (const std::exception &ex) {
+                loge("Exception while handling conflated bbo: {}", ex.what());
+            }
+        }
+    }
+
+    const size_t max_keys_;
+    /// power of two, at least twice max_keys_
+    const size_t index_size_;
+    std::unique_ptr<IndexEntry[]> index_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<size_t> used_slots_{0};
+    /// fixed before the first BBO, read without a lock
+    std::vector<std::unique_ptr<Subscriber>> subscribers_;
+    NewBBOEnvelopePool pool_;
+};
+}  // namespace Trading
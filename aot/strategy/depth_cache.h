@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "aot/common/types.h"
+#include "aot/strategy/market_order.h"
+
+namespace Trading {
+/**
+ * @brief max amount of levels per side which can be requested from DepthCache
+ *
+ */
+constexpr size_t kMaxDepthLevels = 64;
+
+struct DepthLevel {
+    common::Price price        = common::kPriceInvalid;
+    common::Qty qty            = common::kQtyInvalid;
+    /// sum of qty from the best level to this level inclusive
+    common::Qty cumulative_qty = 0;
+    /// sum of price * qty from the best level to this level inclusive
+    double cumulative_notional = 0;
+};
+
+/**
+ * @brief top-N levels of both sides of an order book. It is a fixed size
+ * struct, copying it does not allocate
+ *
+ */
+struct DepthSnapshot {
+    std::array<DepthLevel, kMaxDepthLevels> bids;
+    std::array<DepthLevel, kMaxDepthLevels> asks;
+    size_t bids_size = 0;
+    size_t asks_size = 0;
+
+    std::span<const DepthLevel> Bids() const noexcept {
+        return {bids.data(), bids_size};
+    }
+    std::span<const DepthLevel> Asks() const noexcept {
+        return {asks.data(), asks_size};
+    }
+};
+
+/**
+ * @brief result of walking one side of the book until qty is filled
+ *
+ */
+struct VwapResult {
+    /// volume weighted average price in units of common::Price
+    double vwap               = 0;
+    /// filled_qty < requested qty if cached depth has not enough liquidity
+    common::Qty filled_qty    = 0;
+    /// the least aggressive price touched by the walk
+    common::Price worst_price = common::kPriceInvalid;
+};
+
+/**
+ * @brief cache of top-N levels of one order book.
+ *
+ * The owner reports every touched level with OnLevelTouched. A side is rebuilt
+ * lazily on the next query only if a touched level lies inside the cached
+ * depth, so updates deep in the book cost one comparison. The cached depth
+ * grows to the deepest depth requested so far.
+ */
+class DepthCache {
+  public:
+    /// Mark the side dirty if price can change the cached top-N levels.
+    void OnLevelTouched(common::Side side, common::Price price) noexcept {
+        if (side == common::Side::kBid)
+            Touch(bids_, snapshot_.bids, snapshot_.bids_size, price,
+                  [](common::Price a, common::Price b) { return a >= b; });
+        else if (side == common::Side::kAsk)
+            Touch(asks_, snapshot_.asks, snapshot_.asks_size, price,
+                  [](common::Price a, common::Price b) { return a <= b; });
+    }
+
+    /// Mark both sides dirty, e.g. after snapshot or clear event.
+    void Invalidate() noexcept {
+        bids_.dirty = true;
+        asks_.dirty = true;
+    }
+
+    /**
+     * @brief return cached snapshot that contains at least depth levels per
+     * side (if the book has so many levels)
+     *
+     */
+    const DepthSnapshot &Get(const IMarketOrderBook &book,
+                             size_t depth) noexcept {
+        depth = std::min(depth, kMaxDepthLevels);
+        Refresh(book, common::Side::kBid, depth);
+        Refresh(book, common::Side::kAsk, depth);
+        return snapshot_;
+    }
+
+    /// Return level from cache, fall back to the book for deep levels.
+    std::pair<common::Price, common::Qty> GetLevel(const IMarketOrderBook &book,
+                                                   common::Side side,
+                                                   size_t level) noexcept {
+        if (level >= kMaxDepthLevels) [[unlikely]]
+            return book.GetPriceAndQtyAtLevel(side, level);
+        Refresh(book, side, level + 1);
+        const auto levels = (side == common::Side::kBid) ? snapshot_.Bids()
+                                                         : snapshot_.Asks();
+        if (level >= levels.size())
+            return std::make_pair(common::kPriceInvalid, common::kQtyInvalid);
+        return std::make_pair(levels[level].price, levels[level].qty);
+    }
+
+    /**
+     * @brief walk side of the book from the best price until qty is filled
+     *
+     * @param side common::Side::kAsk walks asks (price of buying qty),
+     * common::Side::kBid walks bids (price of selling qty)
+     */
+    VwapResult GetVwap(const IMarketOrderBook &book, common::Side side,
+                       common::Qty qty) noexcept {
+        VwapResult result;
+        if (qty == 0) return result;
+        auto levels = Levels(book, side, std::max<size_t>(GetDepth(side), 1));
+        // grow the cache until it covers qty or reaches kMaxDepthLevels
+        while (levels.size() == GetDepth(side) && !levels.empty() &&
+               levels.back().cumulative_qty < qty &&
+               GetDepth(side) < kMaxDepthLevels) {
+            levels = Levels(book, side,
+                            std::min(GetDepth(side) * 2, kMaxDepthLevels));
+        }
+        if (levels.empty()) return result;
+
+        auto it = std::lower_bound(levels.begin(), levels.end(), qty,
+                                   [](const DepthLevel &level, common::Qty q) {
+                                       return level.cumulative_qty < q;
+                                   });
+        if (it == levels.end()) {
+            const auto &last   = levels.back();
+            result.filled_qty  = last.cumulative_qty;
+            result.worst_price = last.price;
+            result.vwap = last.cumulative_notional / last.cumulative_qty;
+            return result;
+        }
+        const double before_notional =
+            (it == levels.begin()) ? 0 : std::prev(it)->cumulative_notional;
+        const common::Qty before_qty =
+            (it == levels.begin()) ? 0 : std::prev(it)->cumulative_qty;
+        const double notional =
+            before_notional +
+            static_cast<double>(it->price) * (qty - before_qty);
+        result.filled_qty  = qty;
+        result.worst_price = it->price;
+        result.vwap        = notional / qty;
+        return result;
+    }
+
+    /// How many times sides were rebuilt. Used by tests and metrics.
+    uint64_t Rebuilds() const noexcept { return rebuilds_; }
+
+  private:
+    struct SideState {
+        size_t depth = 0;
+        bool dirty   = true;
+    };
+
+    template <class Cmp>
+    static void Touch(SideState &state,
+                      const std::array<DepthLevel, kMaxDepthLevels> &levels,
+                      size_t size, common::Price price, Cmp in_depth) noexcept {
+        if (state.dirty) return;
+        // the book had less levels than cached depth, any level can enter
+        if (size < state.depth || size == 0 ||
+            in_depth(price, levels[size - 1].price))
+            state.dirty = true;
+    }
+
+    size_t GetDepth(common::Side side) const noexcept {
+        return (side == common::Side::kBid) ? bids_.depth : asks_.depth;
+    }
+
+    std::span<const DepthLevel> Levels(const IMarketOrderBook &book,
+                                       common::Side side,
+                                       size_t depth) noexcept {
+        Refresh(book, side, depth);
+        return (side == common::Side::kBid) ? snapshot_.Bids()
+                                            : snapshot_.Asks();
+    }
+
+    void Refresh(const IMarketOrderBook &book, common::Side side,
+                 size_t depth) noexcept {
+        auto &state  = (side == common::Side::kBid) ? bids_ : asks_;
+        auto &levels = (side == common::Side::kBid) ? snapshot_.bids
+                                                    : snapshot_.asks;
+        auto &size   = (side == common::Side::kBid) ? snapshot_.bids_size
+                                                    : snapshot_.asks_size;
+        if (depth > state.depth) {
+            state.depth = depth;
+            state.dirty = true;
+        }
+        if (!state.dirty) return;
+
+        std::array<PriceLevel, kMaxDepthLevels> raw;
+        size = book.GetLevels(side, {raw.data(), state.depth});
+        common::Qty cumulative_qty = 0;
+        double cumulative_notional = 0;
+        for (size_t i = 0; i < size; ++i) {
+            cumulative_qty      += raw[i].qty;
+            cumulative_notional += static_cast<double>(raw[i].price) *
+                                   static_cast<double>(raw[i].qty);
+            levels[i] = {raw[i].price, raw[i].qty, cumulative_qty,
+                         cumulative_notional};
+        }
+        state.dirty = false;
+        ++rebuilds_;
+    }
+
+    DepthSnapshot snapshot_;
+    SideState bids_;
+    SideState asks_;
+    uint64_t rebuilds_ = 0;
+};
+}  // namespace Trading
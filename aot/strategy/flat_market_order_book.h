@@ -0,0 +1,140 @@
+#pragma once
+
+#include "aot/Logger.h"
+#include "aot/common/types.h"
+#include "aot/market_data/market_update.h"
+#include "aot/strategy/market_order.h"
+#include "aot/strategy/price_ladder.h"
+
+namespace Trading {
+/**
+ * @brief order book engine that stores each side as a PriceLadder.
+ *
+ * It is a drop-in alternative to MarketOrderBook2: it processes the same
+ * MEMarketUpdate2/BookSnapshot2/BookDiffSnapshot2 events and emits the same
+ * BBO signal. There is no hash map, no tree rebalance and no allocation per
+ * level, BBO is read in O(1) from both ladders.
+ *
+ * The BBO signal is emitted only if the best price or the best qty of any side
+ * was really changed by the event.
+ */
+class FlatMarketOrderBook : public IMarketOrderBook {
+    PriceLadder<common::Side::kBid> bids_;
+    PriceLadder<common::Side::kAsk> asks_;
+    BBO bbo_;
+    common::ExchangeId exchange_id_;
+    common::TradingPair trading_pair_;
+    SignalEmitter<BBO> bbo_signal_emitter_;
+
+  public:
+    /**
+     * @param window amount of ticks stored in the contiguous part of each side
+     * @param far_capacity amount of levels reserved for levels outside window
+     */
+    explicit FlatMarketOrderBook(
+        common::ExchangeId exchange_id, common::TradingPair trading_pair,
+        size_t window       = kPriceLadderDefaultWindow,
+        size_t far_capacity = kPriceLadderDefaultFarCapacity)
+        : bids_(window, far_capacity),
+          asks_(window, far_capacity),
+          exchange_id_(exchange_id),
+          trading_pair_(trading_pair) {};
+
+    ~FlatMarketOrderBook() override {
+        logi("call ~FlatMarketOrderBook()");
+    };
+
+    /// Process market data update and update the limit order book.
+    void OnMarketUpdate(
+        const Exchange::MEMarketUpdate2 *market_update) noexcept override;
+
+    /// Process market data snapshot and update the limit order book.
+    void OnMarketUpdate(
+        const Exchange::BookSnapshot2 *market_snapshot) noexcept override;
+
+    /// Process market data diff and update the limit order book.
+    void OnMarketUpdate(
+        const Exchange::BookDiffSnapshot2 *market_diff) noexcept override;
+
+    auto GetBBO() const noexcept -> const BBO * override { return &bbo_; }
+
+    std::pair<common::Price, common::Qty> GetPriceAndQtyAtLevel(
+        common::Side side, size_t level) const noexcept override {
+        const PriceLevel result = (side == common::Side::kBid)
+                                      ? bids_.GetLevel(level)
+                                      : asks_.GetLevel(level);
+        return {result.price, result.qty};
+    }
+
+    size_t GetLevels(common::Side side,
+                     std::span<PriceLevel> levels) const noexcept override {
+        size_t i     = 0;
+        auto copy_to = [&levels, &i](common::Price price, common::Qty qty) {
+            levels[i++] = {price, qty};
+        };
+        if (side == common::Side::kBid)
+            return bids_.ForEachLevel(levels.size(), copy_to);
+        return asks_.ForEachLevel(levels.size(), copy_to);
+    }
+
+    const PriceLadder<common::Side::kBid> &GetBids() const noexcept {
+        return bids_;
+    }
+
+    const PriceLadder<common::Side::kAsk> &GetAsks() const noexcept {
+        return asks_;
+    }
+
+    const common::TradingPair &GetTradingPair() const noexcept override {
+        return trading_pair_;
+    }
+
+    void SubscribeToBBO(std::function<void(const BBO &)> callback) override {
+        bbo_signal_emitter_.Subscribe(std::move(callback));
+    }
+
+    void ClearOrderBook() override {
+        logi("found {} bids in order book", bids_.Size());
+        logi("found {} asks in order book", asks_.Size());
+        bids_.Clear();
+        asks_.Clear();
+    }
+
+    FlatMarketOrderBook(const FlatMarketOrderBook &)             = delete;
+
+    FlatMarketOrderBook(const FlatMarketOrderBook &&)            = delete;
+
+    FlatMarketOrderBook &operator=(const FlatMarketOrderBook &)  = delete;
+
+    FlatMarketOrderBook &operator=(const FlatMarketOrderBook &&) = delete;
+
+  private:
+    void AddOrRemove(common::Side side, common::Price price,
+                     common::Qty qty) noexcept {
+        if (side == common::Side::kBid)
+            bids_.Set(price, qty);
+        else if (side == common::Side::kAsk)
+            asks_.Set(price, qty);
+    }
+
+    /// Read BBO from both ladders and emit the signal if it was changed.
+    void UpdateBBO() noexcept {
+        const auto bid_price = bids_.BestPrice();
+        const auto bid_qty   = bids_.BestQty();
+        const auto ask_price = asks_.BestPrice();
+        const auto ask_qty   = asks_.BestQty();
+        if (bid_price == bbo_.bid_price && bid_qty == bbo_.bid_qty &&
+            ask_price == bbo_.ask_price && ask_qty == bbo_.ask_qty)
+            return;
+        bbo_.bid_price = bid_price;
+        bbo_.bid_qty   = bid_qty;
+        bbo_.ask_price = ask_price;
+        bbo_.ask_qty   = ask_qty;
+        if (bid_price != common::kPriceInvalid &&
+            ask_price != common::kPriceInvalid && bid_price > ask_price)
+            [[unlikely]]
+            loge("bid:{} > ask:{}", bid_price, ask_price);
+        bbo_signal_emitter_.Emit(bbo_);
+    }
+};
+}  // namespace Trading
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "aot/Exchange.h"
+#include "aot/Logger.h"
+#include "aot/common/thread_utils.h"
+#include "aot/common/types.h"
+#include "concurrentqueue.h"
+
+namespace inference {
+/// open, high, low, close, volume of a kline as the python predictor gets them
+constexpr size_t kOhlcvFeatures = 5;
+
+/**
+ * @brief the action of the strategy for a predicted return, the same
+ * thresholds as BaseStrategy.__generate_action__ of
+ * aot/python/prepare_model_for_bot.py
+ */
+inline common::TradeAction ActionFromScore(double score) {
+    if (score > 0.01) return common::TradeAction::kEnterLong;
+    if (score < -0.01) return common::TradeAction::kEnterShort;
+    if (score < 0) return common::TradeAction::kExitLong;
+    if (score > 0) return common::TradeAction::kExitShort;
+    return common::TradeAction::kNope;
+}
+
+/// kline with the signal the model gave for it
+struct Prediction {
+    OHLCVExt kline;
+    common::TradeAction action = common::TradeAction::kNope;
+    double score               = 0;
+};
+using PredictionLFQueue = moodycamel::ConcurrentQueue<Prediction>;
+
+/**
+ * @brief model which scores many klines at once. All calls come from the
+ * thread of InferenceService, a model may keep thread affine state there,
+ * e.g. the python interpreter
+ */
+class BatchModel {
+  public:
+    virtual ~BatchModel() = default;
+    /// called once on the inference thread before the first Predict()
+    virtual bool Init()   = 0;
+    /**
+     * @brief one score per row
+     *
+     * @param features rows x Columns() values, row major
+     * @param scores rows values
+     */
+    virtual bool Predict(std::span<const double> features, size_t rows,
+                         std::span<double> scores) = 0;
+    /// number of features of a row
+    virtual size_t Columns() const { return kOhlcvFeatures; }
+    /// called on the inference thread when it stops
+    virtual void Shutdown() {}
+};
+
+/**
+ * @brief features of a kline for the model, the default passes the raw fixed
+ * point OHLCV as Strategy::Predict() does. Models trained on indicators need
+ * an extractor which computes them
+ */
+class FeatureExtractor {
+  public:
+    virtual ~FeatureExtractor() = default;
+    /// values written by Extract(), must be BatchModel::Columns()
+    virtual size_t Columns() const { return kOhlcvFeatures; }
+    /// row has Columns() values
+    virtual void Extract(const OHLCVExt& kline, std::span<double> row) {
+        row[0] = static_cast<double>(kline.ohlcv.open);
+        row[1] = static_cast<double>(kline.ohlcv.high);
+        row[2] = static_cast<double>(kline.ohlcv.low);
+        row[3] = static_cast<double>(kline.ohlcv.close);
+        row[4] = static_cast<double>(kline.ohlcv.volume);
+    }
+};
+
+struct InferenceOptions {
+    /// klines of all trading pairs scored by one call of the model
+    size_t max_batch = 256;
+    /// core of the inference thread, -1 does not pin
+    int core         = -1;
+};
+
+/**
+ * @brief runs the model on a thread of its own.
+ *
+ * Klines of all trading pairs wait in klines until the thread takes up to
+ * max_batch of them, builds one contiguous feature matrix and calls the model
+ * once. Predictions go to predictions in the order of the klines, the trade
+ * engine takes them with TradeEngine::SetPredictions(). The trade engine
+ * thread never waits for the model and never touches the interpreter.
+ *
+ * @code
+ * KLineService klines(&fetcher, &internal_klines, &klines_for_model);
+ * inference::InferenceService inference(model, &klines_for_model,
+ *                                       &predictions);
+ * trade_engine.SetPredictions(&predictions);
+ * @endcode
+ */
+class InferenceService {
+  public:
+    InferenceService(BatchModel& model, OHLCVILFQueue* klines,
+                     PredictionLFQueue* predictions,
+                     InferenceOptions options = {},
+                     FeatureExtractor* extractor = nullptr)
+        : model_(model),
+          klines_(klines),
+          predictions_(predictions),
+          options_(options),
+          extractor_(extractor ? extractor : &default_extractor_) {
+        options_.max_batch = std::max<size_t>(options_.max_batch, 1);
+        batch_.resize(options_.max_batch);
+        scores_.resize(options_.max_batch);
+        out_.resize(options_.max_batch);
+    }
+    ~InferenceService() { Stop(); }
+
+    auto Start() -> void {
+        run_    = true;
+        thread_ = std::make_unique<std::thread>([this]() {
+            if (options_.core >= 0 && !common::setThreadCore(options_.core))
+                logw("can't pin inference thread to core {}", options_.core);
+            Run();
+        });
+    }
+    /// scores klines already in the queue and joins the thread
+    auto Stop() -> void {
+        run_ = false;
+        if (thread_ && thread_->joinable()) thread_->join();
+        thread_.reset();
+    }
+
+    uint64_t Batches() const {
+        return batches_.load(std::memory_order_relaxed);
+    }
+    uint64_t Klines() const {
+        return klines_done_.load(std::memory_order_relaxed);
+    }
+    /// the model could not be initialised, the thread has stopped
+    bool Failed() const { return failed_.load(std::memory_order_relaxed); }
+
+    InferenceService(const InferenceService&)            = delete;
+    InferenceService& operator=(const InferenceService&) = delete;
+
+  private:
+    auto Run() noexcept -> void {
+        if (!model_.Init()) {
+            loge("can't init model, inference is stopped");
+            failed_ = true;
+            return;
+        }
+        // the number of features may be known only after Init(). Columns the
+        // extractor does not fill would be zeros and the scores garbage
+        if (extractor_->Columns() != model_.Columns()) {
+            loge("model has {} features, extractor gives {}, inference is "
+                 "stopped",
+                 model_.Columns(), extractor_->Columns());
+            model_.Shutdown();
+            failed_ = true;
+            return;
+        }
+        features_.resize(options_.max_batch * model_.Columns());
+        logi("inference start, batch up to {} klines", options_.max_batch);
+        while (true) {
+            const bool running = run_;
+            const size_t count =
+                klines_->try_dequeue_bulk(batch_.data(), options_.max_batch);
+            if (count) [[likely]]
+                Process(count);
+            else if (!running)
+                break;
+            else
+                std::this_thread::yield();
+        }
+        model_.Shutdown();
+        logi("inference stop, {} klines in {} batches", Klines(), Batches());
+    }
+
+    void Process(size_t count) {
+        const size_t columns = model_.Columns();
+        for (size_t i = 0; i < count; ++i)
+            extractor_->Extract(
+                batch_[i],
+                std::span<double>(features_.data() + i * columns, columns));
+        if (!model_.Predict({features_.data(), count * columns}, count,
+                            {scores_.data(), count})) [[unlikely]] {
+            loge("model failed on a batch of {} klines, they are dropped",
+                 count);
+            return;
+        }
+        for (size_t i = 0; i < count; ++i)
+            out_[i] = {.kline  = batch_[i],
+                       .action = ActionFromScore(scores_[i]),
+                       .score  = scores_[i]};
+        if (!predictions_->enqueue_bulk(out_.data(), count)) [[unlikely]]
+            loge("can't push {} predictions", count);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        klines_done_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    BatchModel& model_;
+    OHLCVILFQueue* klines_;
+    PredictionLFQueue* predictions_;
+    InferenceOptions options_;
+    FeatureExtractor default_extractor_;
+    FeatureExtractor* extractor_;
+    std::vector<OHLCVExt> batch_;
+    std::vector<double> features_;
+    std::vector<double> scores_;
+    std::vector<Prediction> out_;
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> run_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> klines_done_{0};
+};
+}  // namespace inference
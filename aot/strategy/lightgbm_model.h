@@ -0,0 +1,118 @@
+#pragma once
+
+#include <LightGBM/c_api.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/strategy/inference.h"
+
+namespace inference {
+/**
+ * @brief LightGBM boosters loaded through the C API, no python at all.
+ *
+ * The score of a row is the mean of the predictions of all boosters, as
+ * BaseStrategy.__predict__ of aot/python/prepare_model_for_bot.py does for
+ * models/model_{0,1,2}.txt. A batch is one LGBM_BoosterPredictForMat() per
+ * booster over the row major matrix of InferenceService, nothing is copied.
+ *
+ * Columns() is the number of features the boosters were trained on, the
+ * extractor given to InferenceService must fill them in the order of
+ * feature_name() of the booster. The tree has no extractor of the indicators
+ * of models/model_*.txt, and InferenceService refuses to start if the
+ * columns of the extractor and of the boosters differ. Without an extractor
+ * only boosters trained on the raw OHLCV can be used.
+ *
+ * @code
+ * // booster trained on open, high, low, close, volume
+ * inference::LightGbmModel model({"models/ohlcv.txt"});
+ * inference::InferenceService inference(model, &klines, &predictions);
+ * @endcode
+ */
+class LightGbmModel : public BatchModel {
+  public:
+    /**
+     * @param threads OpenMP threads of LightGBM for a batch, the inference
+     * thread is already the only consumer so one is usually enough
+     */
+    explicit LightGbmModel(std::vector<std::string> model_files,
+                           int threads = 1)
+        : model_files_(std::move(model_files)),
+          parameters_("num_threads=" + std::to_string(std::max(threads, 1))) {}
+    ~LightGbmModel() override { Shutdown(); }
+
+    /// loads the boosters, all of them must have the same features
+    bool Init() override {
+        for (const auto& file : model_files_) {
+            int iterations        = 0;
+            BoosterHandle booster = nullptr;
+            if (LGBM_BoosterCreateFromModelfile(file.c_str(), &iterations,
+                                                &booster) != 0) {
+                loge("can't load booster {}: {}", file, LGBM_GetLastError());
+                return false;
+            }
+            boosters_.push_back(booster);
+            int features = 0;
+            if (LGBM_BoosterGetNumFeature(booster, &features) != 0 ||
+                (boosters_.size() > 1 &&
+                 static_cast<size_t>(features) != columns_)) {
+                loge("booster {} has {} features, expected {}", file,
+                     features, columns_);
+                return false;
+            }
+            columns_ = static_cast<size_t>(features);
+            logi("booster {} loaded, {} iterations {} features", file,
+                 iterations, features);
+        }
+        if (boosters_.empty()) {
+            loge("no boosters to load");
+            return false;
+        }
+        return true;
+    }
+
+    bool Predict(std::span<const double> features, size_t rows,
+                 std::span<double> scores) override {
+        prediction_.resize(rows);
+        std::fill_n(scores.begin(), rows, 0.);
+        for (auto booster : boosters_) {
+            int64_t length = 0;
+            if (LGBM_BoosterPredictForMat(
+                    booster, features.data(), C_API_DTYPE_FLOAT64,
+                    static_cast<int32_t>(rows),
+                    static_cast<int32_t>(columns_), 1, C_API_PREDICT_NORMAL,
+                    0, -1, parameters_.c_str(), &length,
+                    prediction_.data()) != 0 ||
+                length != static_cast<int64_t>(rows)) [[unlikely]] {
+                loge("booster failed on {} rows: {}", rows,
+                     LGBM_GetLastError());
+                return false;
+            }
+            for (size_t i = 0; i < rows; ++i) scores[i] += prediction_[i];
+        }
+        const double count = static_cast<double>(boosters_.size());
+        for (size_t i = 0; i < rows; ++i) scores[i] /= count;
+        return true;
+    }
+
+    /// valid after Init()
+    size_t Columns() const override { return columns_; }
+
+    void Shutdown() override {
+        for (auto booster : boosters_) LGBM_BoosterFree(booster);
+        boosters_.clear();
+    }
+
+  private:
+    std::vector<std::string> model_files_;
+    std::string parameters_;
+    std::vector<BoosterHandle> boosters_;
+    std::vector<double> prediction_;
+    size_t columns_ = kOhlcvFeatures;
+};
+}  // namespace inference
@@ -2,19 +2,28 @@
 
 #include <array>
 #include <atomic>
+#include <functional>
+#include <span>
 #include <sstream>
 #include <vector>
 
 #include "aot/Logger.h"
+#include "aot/bus/bus_envelope.h"
 #include "aot/bus/bus_event.h"
 #include "aot/common/mem_pool.h"
 #include "aot/common/types.h"
+#include "aot/strategy/price_ladder.h"
 #include "aot/third_party/emhash/hash_table7.hpp"
 #include "boost/intrusive/avltree.hpp"
 
 namespace bus {
 class Component;
 }
+namespace Exchange {
+struct MEMarketUpdate2;
+struct BookSnapshot2;
+struct BookDiffSnapshot2;
+}  // namespace Exchange
 struct BBOI {
     virtual common::Price GetWeightedPrice() const = 0;
     virtual ~BBOI()                                = default;
@@ -178,6 +187,9 @@ struct NewBBO : public aot::Event<NewBBOPool> {
     }
 };
 
+/// NewBBO and its bus event in one block, see aot::BusEnvelope
+using NewBBOEnvelopePool = NewBBOEnvelope::Pool;
+
 struct BusEventNewBBO;
 using BusEventNewBBOPool = common::MemoryPool<BusEventNewBBO>;
 
@@ -214,6 +226,65 @@ struct BusEventNewBBO : public bus::Event2<BusEventNewBBOPool> {
 
 using ExchangeBBOMap = std::unordered_map<common::TradingPairId, Trading::BBO>;
 
+// template class to store all subscribers on order book signals
+template <typename SignalType>
+class SignalEmitter {
+    using SignalCallback = std::function<void(const SignalType &)>;
+    std::vector<SignalCallback> subscribers_;
+
+  public:
+    void Subscribe(SignalCallback callback) {
+        subscribers_.emplace_back(std::move(callback));
+    }
+
+    void Emit(const SignalType &signal) {
+        for (const auto &subscriber : subscribers_) {
+            if (subscriber) {
+                subscriber(signal);
+            }
+        }
+    }
+};
+
+/**
+ * @class IMarketOrderBook
+ * @brief Interface of an order book engine used by OrderBookComponent.
+ *
+ * MarketOrderBook2 keeps levels in an avl tree, FlatMarketOrderBook keeps them
+ * in a tick-indexed ladder. Both process the same market data events and emit
+ * BBO signals to subscribers.
+ */
+class IMarketOrderBook {
+  public:
+    virtual ~IMarketOrderBook() = default;
+    /// Process market data update and update the limit order book.
+    virtual void OnMarketUpdate(
+        const Exchange::MEMarketUpdate2 *market_update) noexcept = 0;
+    /// Process market data snapshot and update the limit order book.
+    virtual void OnMarketUpdate(
+        const Exchange::BookSnapshot2 *market_snapshot) noexcept = 0;
+    /// Process market data diff and update the limit order book.
+    virtual void OnMarketUpdate(
+        const Exchange::BookDiffSnapshot2 *market_diff) noexcept = 0;
+    virtual const BBO *GetBBO() const noexcept = 0;
+    /**
+     * @brief return price and qty at level (level = 0 is the best price). If
+     * the level does not exist return kPriceInvalid and kQtyInvalid
+     */
+    virtual std::pair<common::Price, common::Qty> GetPriceAndQtyAtLevel(
+        common::Side side, size_t level) const noexcept = 0;
+    /**
+     * @brief copy up to levels.size() best levels of side into levels
+     *
+     * @return amount of copied levels
+     */
+    virtual size_t GetLevels(common::Side side,
+                             std::span<PriceLevel> levels) const noexcept = 0;
+    virtual const common::TradingPair &GetTradingPair() const noexcept = 0;
+    virtual void SubscribeToBBO(std::function<void(const BBO &)> callback) = 0;
+    virtual void ClearOrderBook() = 0;
+};
+
 };  // namespace Trading
 
 namespace backtesting {
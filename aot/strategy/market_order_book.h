@@ -1,5 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <limits>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <type_traits>
 #include <typeinfo>
+#include <variant>
 #include <vector>
 
 #include "aot/Exchange.h"
@@ -8,8 +17,12 @@
 #include "aot/common/mem_pool.h"
 #include "aot/common/thread_utils.h"
 #include "aot/common/types.h"
+#include "aot/common/wait_strategy.h"
+#include "aot/hot_log.h"
 #include "aot/market_data/market_update.h"
 #include "aot/strategy/cross_arbitrage/signals.h"
+#include "aot/strategy/depth_cache.h"
+#include "aot/strategy/flat_market_order_book.h"
 #include "aot/strategy/market_order.h"
 #include "aot/strategy/position_keeper.h"
 
@@ -169,26 +182,7 @@ class MarketOrderBook {
     }
 };
 
-class MarketOrderBook2 {
-    // template class to store all subscribers on MarketOrderBook2 signals
-    template <typename SignalType>
-    class SignalEmitter {
-        using SignalCallback = std::function<void(const SignalType &)>;
-        std::vector<SignalCallback> subscribers_;
-
-      public:
-        void Subscribe(SignalCallback callback) {
-            subscribers_.emplace_back(std::move(callback));
-        }
-
-        void Emit(const SignalType &signal) {
-            for (const auto &subscriber : subscribers_) {
-                if (subscriber) {
-                    subscriber(signal);
-                }
-            }
-        }
-    };
+class MarketOrderBook2 : public IMarketOrderBook {
     /// Pointers to beginning / best prices / top of book of buy and sell price
     /// levels.
     /// Hash map from Price -> MarketOrdersAtPrice.
@@ -211,7 +205,7 @@ class MarketOrderBook2 {
                               common::TradingPair trading_pair)
         : exchange_id_(exchange_id), trading_pair_(trading_pair) {};
 
-    virtual ~MarketOrderBook2() {
+    ~MarketOrderBook2() override {
         logi("call ~MarketOrderBook2()");
         ClearOrderBook();
     };
@@ -219,18 +213,48 @@ class MarketOrderBook2 {
 
     AsksatPriceMap &GetAsksatPriceMap() { return asks_at_price_map_; };
     /// Process market data update and update the limit order book.
-    virtual void OnMarketUpdate(
-        const Exchange::MEMarketUpdate2 *market_update) noexcept;
+    void OnMarketUpdate(
+        const Exchange::MEMarketUpdate2 *market_update) noexcept override;
 
     /// Process market data snapshot and update the limit order book.
-    virtual void OnMarketUpdate(
-        const Exchange::BookSnapshot2 *market_snapshot) noexcept;
+    void OnMarketUpdate(
+        const Exchange::BookSnapshot2 *market_snapshot) noexcept override;
 
     /// Process market data diff and update the limit order book.
-    virtual void OnMarketUpdate(
-        const Exchange::BookDiffSnapshot2 *market_diff) noexcept;
+    void OnMarketUpdate(
+        const Exchange::BookDiffSnapshot2 *market_diff) noexcept override;
+
+    auto GetBBO() const noexcept -> const BBO * override { return &bbo_; }
+
+    /// Walk the avl tree from the best price to the level. It is O(level).
+    std::pair<common::Price, common::Qty> GetPriceAndQtyAtLevel(
+        common::Side side, size_t level) const noexcept override {
+        auto walk = [level](const auto &price_map) {
+            if (level >= price_map.size())
+                return std::make_pair(common::kPriceInvalid,
+                                      common::kQtyInvalid);
+            auto it = price_map.begin();
+            std::advance(it, level);
+            return std::make_pair(it->first_mkt_order_.price_,
+                                  it->first_mkt_order_.qty_);
+        };
+        if (side == common::Side::kBid) return walk(bids_at_price_map_);
+        return walk(asks_at_price_map_);
+    }
 
-    auto GetBBO() const noexcept -> const BBO * { return &bbo_; }
+    size_t GetLevels(common::Side side,
+                     std::span<PriceLevel> levels) const noexcept override {
+        auto copy = [&levels](const auto &price_map) {
+            size_t i = 0;
+            for (auto it = price_map.begin();
+                 it != price_map.end() && i < levels.size(); ++it, ++i)
+                levels[i] = {it->first_mkt_order_.price_,
+                             it->first_mkt_order_.qty_};
+            return i;
+        };
+        if (side == common::Side::kBid) return copy(bids_at_price_map_);
+        return copy(asks_at_price_map_);
+    }
 
     /// Update the BBO abstraction, the two boolean parameters represent if the
     /// buy or the sekk (or both) sides or both need to be updated.
@@ -261,16 +285,18 @@ class MarketOrderBook2 {
         if (bbo_.bid_price > bbo_.ask_price)
             loge("bid:{} > ask:{}", bbo_.bid_price, bbo_.ask_price);
     }
-    const common::TradingPair &GetTradingPair() const noexcept {
+    const common::TradingPair &GetTradingPair() const noexcept override {
         return trading_pair_;
     }
     // Подписчики на BBO
-    void SubscribeToBBO(std::function<void(const BBO &)> callback) {
+    void SubscribeToBBO(std::function<void(const BBO &)> callback) override {
         bbo_signal_emitter_.Subscribe(std::move(callback));
     }
-    void ClearOrderBook() {
-        logi("found {} bids in order book", bids_at_price_map_.size());
-        logi("found {} asks in order book", asks_at_price_map_.size());
+    void ClearOrderBook() override {
+        hlogi(kOrderBook, "found {} bids in order book",
+              bids_at_price_map_.size());
+        hlogi(kOrderBook, "found {} asks in order book",
+              asks_at_price_map_.size());
         bids_at_price_map_.clear();
         asks_at_price_map_.clear();
         for (const auto &order_at_price : price_orders_at_price_bids_)
@@ -309,11 +335,13 @@ class MarketOrderBook2 {
                 new_orders_at_price->price_, new_orders_at_price);
 
         if (new_orders_at_price->side_ == common::Side::kAsk) {
-            logi("add new ask with p:{}", new_orders_at_price->price_);
+            hlogd(kOrderBook, "add new ask with p:{}",
+                  new_orders_at_price->price_);
             asks_at_price_map_.insert_equal(*new_orders_at_price);
         }
         if (new_orders_at_price->side_ == common::Side::kBid) {
-            logi("add new bid with p:{}", new_orders_at_price->price_);
+            hlogd(kOrderBook, "add new bid with p:{}",
+                  new_orders_at_price->price_);
             bids_at_price_map_.insert_equal(*new_orders_at_price);
         }
     }
@@ -329,7 +357,8 @@ class MarketOrderBook2 {
             // How to manage a local order book correctly
             // 9.Receiving an event that removes a price level that is not in
             // your local order book can happen and is normal.
-            logw("order_book not contain such price");
+            hlogwl(kOrderBook, aot::log::kSecondNs,
+                   "order_book not contain such price");
             return;
         }
         if (side == common::Side::kAsk) {
@@ -376,12 +405,12 @@ class MarketOrderBook2 {
                 [[unlikely]]
                 ASSERT(true,
                        "try change asks_at_price_map_ or bids_at_price_map_");
-            logi(
-                "update position old price:{} old qty:{} new price:{} new "
-                "qty:{}",
-                orders_at_price->first_mkt_order_.price_,
-                orders_at_price->first_mkt_order_.qty_, order->price_,
-                order->qty_);
+            hlogd(kOrderBook,
+                  "update position old price:{} old qty:{} new price:{} new "
+                  "qty:{}",
+                  orders_at_price->first_mkt_order_.price_,
+                  orders_at_price->first_mkt_order_.qty_, order->price_,
+                  order->qty_);
             orders_at_price->first_mkt_order_.price_ = order->price_;
             orders_at_price->first_mkt_order_.qty_   = order->qty_;
         }
@@ -399,6 +428,7 @@ class OrderBookService : public common::ServiceI {
         : ob_(ob), queue_(book_update) {};
     ~OrderBookService() override {
         run_ = false;
+        wait_.Notify();
         using namespace std::literals::chrono_literals;
         std::this_thread::sleep_for(1s);
     };
@@ -417,14 +447,27 @@ class OrderBookService : public common::ServiceI {
             std::this_thread::sleep_for(10ms);
         }
         run_ = false;
+        wait_.Notify();
+    };
+    void StopImmediately() override {
+        run_ = false;
+        wait_.Notify();
     };
-    void StopImmediately() override { run_ = false; };
+    /// how the thread waits for updates, set it before Start()
+    void SetWaitStrategy(common::WaitStrategy::Options options) {
+        wait_.SetOptions(options);
+    }
+    /// producers of updates call Notify() of it after enqueue
+    common::WaitStrategy *Waiter() { return &wait_; }
+    /// name of the service in the [wait_strategy] table of a config
+    static constexpr std::string_view kServiceName = "order_book_service";
 
     void Run();
 
   private:
     volatile bool run_ = false;
     std::unique_ptr<std::jthread> thread_;
+    common::WaitStrategy wait_;
 
     MarketOrderBook *ob_           = nullptr;
     Exchange::EventLFQueue *queue_ = nullptr;
@@ -483,344 +526,692 @@ class IOrderBookComponent {
     AsyncGetPriceAndQtyAtLevelAsk(const common::ExchangeId &exchange_id,
                                   const common::TradingPair &trading_pair,
                                   size_t level) = 0;
+
+    /**
+     * @brief Asynchronously retrieves top-N levels of both sides of the order
+     * book in one call.
+     *
+     * Levels are served from a cached snapshot which is rebuilt only if
+     * updates touched levels inside the cached depth.
+     *
+     * @param depth amount of levels per side, clamped to kMaxDepthLevels.
+     * @return A boost::asio::awaitable DepthSnapshot. Sizes of sides are zero
+     * if the order book does not exist.
+     */
+    virtual boost::asio::awaitable<DepthSnapshot> AsyncGetDepth(
+        const common::ExchangeId &exchange_id,
+        const common::TradingPair &trading_pair, size_t depth) = 0;
+
+    /**
+     * @brief Asynchronously computes volume weighted average price of filling
+     * qty against one side of the order book.
+     *
+     * @param side common::Side::kAsk walks asks (price of buying qty),
+     * common::Side::kBid walks bids (price of selling qty).
+     * @return A boost::asio::awaitable VwapResult. filled_qty is less than qty
+     * if top kMaxDepthLevels levels do not have enough liquidity.
+     */
+    virtual boost::asio::awaitable<VwapResult> AsyncGetVwap(
+        const common::ExchangeId &exchange_id,
+        const common::TradingPair &trading_pair, common::Side side,
+        common::Qty qty) = 0;
+};
+
+/**
+ * @brief engine used by OrderBookComponent to store levels of a trading pair
+ *
+ */
+enum class OrderBookEngine {
+    kAvlTree,    ///< MarketOrderBook2: emhash7 map + boost::intrusive::avltree
+    kFlatLadder  ///< FlatMarketOrderBook: tick-indexed ladder per side
 };
 
+/**
+ * @brief order books of many exchanges and trading pairs.
+ *
+ * Books are spread over shards. A shard owns an executor and the books which
+ * are assigned to it: books of one shard are updated one by one without
+ * locks, books of different shards are updated in parallel. Every (exchange,
+ * trading pair) is mapped to a stable shard in AddOrderBook(), all events and
+ * requests of the book are handled by this shard.
+ *
+ * AsyncRebalance() moves a hot book from the busiest shard to the idlest one.
+ *
+ * @tparam Executor strand (or another executor which runs handlers one by
+ * one) of a shard
+ */
 template <typename Executor>
 class OrderBookComponent : public bus::Component, public IOrderBookComponent {
+    struct OrderBookEntry {
+        std::unique_ptr<IMarketOrderBook> order_book;
+        DepthCache depth_cache;
+    };
     using OrderBookMap = std::unordered_map<
         common::ExchangeId,
-        std::unordered_map<common::TradingPair, MarketOrderBook2,
+        std::unordered_map<common::TradingPair, OrderBookEntry,
                            common::TradingPairHash, common::TradingPairEqual>>;
+    using OrderBookNode = typename OrderBookMap::mapped_type::node_type;
+    using PendingEvent =
+        std::variant<boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2>,
+                     boost::intrusive_ptr<Exchange::MEMarketUpdate2Envelope>,
+                     boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot>,
+                     boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>;
+
+    /**
+     * @brief book which is moving to the shard. Its events which come before
+     * the book wait here
+     *
+     */
+    struct BookInTransit {
+        common::ExchangeId exchange_id;
+        common::TradingPair trading_pair;
+        std::vector<PendingEvent> events;
+    };
 
-    Executor executor_;
+    struct Shard {
+        explicit Shard(Executor &&_executor) : executor(std::move(_executor)) {}
+        Executor executor;
+        OrderBookMap order_books;
+        std::vector<BookInTransit> in_transit;
+    };
+
+    /// shard of the book and amount of events routed to it since the last
+    /// rebalance
+    struct Route {
+        std::atomic<size_t> shard{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<bool> moving{false};
+    };
+    using RouteMap = std::unordered_map<
+        common::ExchangeId,
+        std::unordered_map<common::TradingPair, Route, common::TradingPairHash,
+                           common::TradingPairEqual>>;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
     aot::CoBus &bus_;
     common::MarketType market_type_;
-    OrderBookMap order_books_;
-    Trading::NewBBOPool new_bbo_pool_;
-    Trading::BusEventNewBBOPool bus_event_new_bbo_pool_;
+    /**
+     * @brief dispatchers of events read routes, AddOrderBook() and moving of
+     * books write them. Events are posted to shards under the shared lock, so
+     * a book leaves its old shard only after all events routed there
+     *
+     */
+    mutable std::shared_mutex routes_mutex_;
+    RouteMap routes_;
+    Trading::NewBBOEnvelopePool new_bbo_pool_;
 
   public:
+    static constexpr size_t kNoShard = std::numeric_limits<size_t>::max();
+    /**
+     * @brief AsyncRebalance() does nothing if load of the busiest and the
+     * idlest shards differs less than this amount of events
+     *
+     */
+    static constexpr uint64_t kMinRebalanceGap = 1024;
+
+    /**
+     * @brief all books are handled by one executor
+     *
+     */
     explicit OrderBookComponent(Executor &&executor, aot::CoBus &bus,
                                 uint64_t max_new_bbo_,
                                 common::MarketType market_type)
-        : executor_(std::move(executor)),
-          bus_(bus),
+        : OrderBookComponent(std::vector<Executor>(1, std::move(executor)),
+                             bus, max_new_bbo_, market_type) {}
+
+    /**
+     * @brief every executor serves one shard of books
+     *
+     * @param executors usually strands of one thread pool, one per thread
+     */
+    explicit OrderBookComponent(std::vector<Executor> executors,
+                                aot::CoBus &bus, uint64_t max_new_bbo_,
+                                common::MarketType market_type)
+        : bus_(bus),
           market_type_(market_type),
-          new_bbo_pool_{max_new_bbo_},
-          bus_event_new_bbo_pool_{max_new_bbo_} {}
+          new_bbo_pool_{max_new_bbo_} {
+        shards_.reserve(executors.size());
+        for (auto &executor : executors)
+            shards_.push_back(std::make_unique<Shard>(std::move(executor)));
+        if (shards_.empty()) [[unlikely]]
+            loge("OrderBookComponent needs at least one executor");
+    }
     ~OrderBookComponent() override = default;
 
     void AsyncHandleEvent(
         boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2> event)
         override {
-        // need logic co choose right executor depends on trading pair
-        // and exchange
-        boost::asio::co_spawn(executor_, HandleNewMEMarketUpdate(event),
-                              boost::asio::detached);
+        const auto *wrapped_event = event->WrappedEvent();
+        if (!wrapped_event) return;
+        Dispatch(wrapped_event->exchange_id, wrapped_event->trading_pair,
+                 std::move(event));
     };
 
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::MEMarketUpdate2Envelope> event)
+        override {
+        const auto *wrapped_event = event->WrappedEvent();
+        Dispatch(wrapped_event->exchange_id, wrapped_event->trading_pair,
+                 std::move(event));
+    }
+
     void AsyncHandleEvent(
         boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot> event)
         override {
-        // Обработка событий типа ResponseNewSnapshot
-        boost::asio::co_spawn(executor_, HandleResponseNewSnapshot(event),
-                              boost::asio::detached);
+        const auto *wrapped_event = event->WrappedEvent();
+        if (!wrapped_event) return;
+        Dispatch(wrapped_event->exchange_id, wrapped_event->trading_pair,
+                 std::move(event));
     }
 
     void AsyncHandleEvent(
         boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot> event)
         override {
-        // Обработка событий типа MEMarketUpdate
-        boost::asio::co_spawn(executor_, HandleNewDiff(event),
-                              boost::asio::detached);
+        const auto *wrapped_event = event->WrappedEvent();
+        if (!wrapped_event) return;
+        Dispatch(wrapped_event->exchange_id, wrapped_event->trading_pair,
+                 std::move(event));
+    }
+
+    /**
+     * @brief batch delivered by aot::StaticBus. Events of every shard are
+     * handled by one coroutine instead of one coroutine per event, the order
+     * of events of a book is kept
+     *
+     * @tparam Event BusEventMEMarketUpdate2, MEMarketUpdate2Envelope,
+     * BusEventResponseNewSnapshot or BusEventBookDiffSnapshot
+     */
+    template <class Event>
+    void AsyncHandleBatch(std::span<const boost::intrusive_ptr<Event>> events) {
+        std::vector<std::vector<boost::intrusive_ptr<Event>>> batches(
+            shards_.size());
+        std::shared_lock lock(routes_mutex_);
+        for (const auto &event : events) {
+            const auto *wrapped_event = event->WrappedEvent();
+            if (!wrapped_event) continue;
+            auto *route = FindRoute(wrapped_event->exchange_id,
+                                    wrapped_event->trading_pair);
+            if (!route) {
+                loge("[ORDER BOOK NOT FOUND] {}, {}", wrapped_event->exchange_id,
+                     wrapped_event->trading_pair.ToString());
+                continue;
+            }
+            route->events.fetch_add(1, std::memory_order_relaxed);
+            batches[route->shard.load(std::memory_order_relaxed)].push_back(
+                event);
+        }
+        for (size_t i = 0; i < batches.size(); ++i) {
+            if (batches[i].empty()) continue;
+            boost::asio::co_spawn(shards_[i]->executor,
+                                  HandleBatch(*shards_[i], std::move(batches[i])),
+                                  boost::asio::detached);
+        }
     }
 
     boost::asio::awaitable<std::pair<common::Price, common::Qty>>
     AsyncGetPriceAndQtyAtLevelBid(const common::ExchangeId &exchange_id,
                                   const common::TradingPair &trading_pair,
                                   size_t level) override {
-        // Прямо внутри executor_ выполняем асинхронный код
-        co_await boost::asio::post(executor_, boost::asio::use_awaitable);
-
-        // Проверяем наличие книги ордеров для этого обмена и торговой пары
-        auto it_exchange = order_books_.find(exchange_id);
-        if (it_exchange == order_books_.end()) {
+        auto *entry = co_await EnterShard(exchange_id, trading_pair);
+        if (!entry) {
             co_return std::make_pair(common::kPriceInvalid,
                                      common::kQtyInvalid);
         }
+        co_return entry->depth_cache.GetLevel(*entry->order_book,
+                                              common::Side::kBid, level);
+    }
 
-        auto it_pair = it_exchange->second.find(trading_pair);
-        if (it_pair == it_exchange->second.end()) {
+    boost::asio::awaitable<std::pair<common::Price, common::Qty>>
+    AsyncGetPriceAndQtyAtLevelAsk(const common::ExchangeId &exchange_id,
+                                  const common::TradingPair &trading_pair,
+                                  size_t level) override {
+        auto *entry = co_await EnterShard(exchange_id, trading_pair);
+        if (!entry) {
             co_return std::make_pair(common::kPriceInvalid,
                                      common::kQtyInvalid);
         }
+        co_return entry->depth_cache.GetLevel(*entry->order_book,
+                                              common::Side::kAsk, level);
+    }
 
-        auto &order_book      = it_pair->second;
+    boost::asio::awaitable<DepthSnapshot> AsyncGetDepth(
+        const common::ExchangeId &exchange_id,
+        const common::TradingPair &trading_pair, size_t depth) override {
+        DepthSnapshot result;
+        auto *entry = co_await EnterShard(exchange_id, trading_pair);
+        if (!entry) co_return result;
+        result = entry->depth_cache.Get(*entry->order_book, depth);
+        result.bids_size = std::min(result.bids_size, depth);
+        result.asks_size = std::min(result.asks_size, depth);
+        co_return result;
+    }
 
-        // Проверяем, на какой стороне (bid/ask) нужно извлекать информацию
-        const auto &price_map = order_book.GetBidsatPriceMap();
+    boost::asio::awaitable<VwapResult> AsyncGetVwap(
+        const common::ExchangeId &exchange_id,
+        const common::TradingPair &trading_pair, common::Side side,
+        common::Qty qty) override {
+        auto *entry = co_await EnterShard(exchange_id, trading_pair);
+        if (!entry) co_return VwapResult{};
+        co_return entry->depth_cache.GetVwap(*entry->order_book, side, qty);
+    }
 
-        // Если уровень вне допустимого диапазона, возвращаем недопустимые
-        // значения
-        if (level >= price_map.size()) {
-            co_return std::make_pair(common::kPriceInvalid,
-                                     common::kQtyInvalid);
+    /**
+     * @brief Method to add a new order book. Books must be added before events
+     * of them are sent to the component
+     *
+     * @param engine chooses how levels of this trading pair are stored. Use
+     * OrderBookEngine::kFlatLadder for busy pairs
+     * @param shard index of the executor which serves the book. kNoShard picks
+     * the shard with the fewest books
+     */
+    void AddOrderBook(common::ExchangeId exchange_id,
+                      const common::TradingPair &trading_pair,
+                      OrderBookEngine engine = OrderBookEngine::kAvlTree,
+                      size_t shard           = kNoShard) {
+        std::unique_lock lock(routes_mutex_);
+        auto &routes = routes_[exchange_id];
+        if (routes.contains(trading_pair)) {
+            logi(
+                "[MarketOrderBook already exists in the inner map!] with {} "
+                "{}",
+                exchange_id, trading_pair.ToString());
+            return;
         }
+        if (shard >= shards_.size()) shard = LeastLoadedShard();
+
+        std::unique_ptr<IMarketOrderBook> order_book;
+        if (engine == OrderBookEngine::kFlatLadder)
+            order_book = std::make_unique<FlatMarketOrderBook>(exchange_id,
+                                                               trading_pair);
+        else
+            order_book =
+                std::make_unique<MarketOrderBook2>(exchange_id, trading_pair);
+
+        // Подписка на сигналы BBO
+        order_book->SubscribeToBBO(
+            [this, exchange_id, trading_pair](const BBO &bbo) {
+                SendBBOToBus(exchange_id, trading_pair, bbo);
+            });
+        shards_[shard]->order_books[exchange_id].emplace(
+            trading_pair, OrderBookEntry{std::move(order_book), {}});
+        routes[trading_pair].shard.store(shard, std::memory_order_relaxed);
+        logi(
+            "[MarketOrderBook inserted successfully!] with {} {} engine:{} "
+            "shard:{}",
+            exchange_id, trading_pair.ToString(), magic_enum::enum_name(engine),
+            shard);
+    }
 
-        // Перемещаем итератор на нужный уровень
-        auto it = price_map.begin();
-        std::advance(it, level);  // Перемещаем на (level-1)-й элемент
-
-        // Возвращаем пару (цена, объём)
-        const auto &order_at_price = *it;
-        co_return std::make_pair(order_at_price.first_mkt_order_.price_,
-                                 order_at_price.first_mkt_order_.qty_);
+    /// Index of the shard which serves the book, kNoShard if there is no book.
+    size_t ShardOf(common::ExchangeId exchange_id,
+                   const common::TradingPair &trading_pair) const {
+        std::shared_lock lock(routes_mutex_);
+        const auto *route = FindRoute(exchange_id, trading_pair);
+        return route ? route->shard.load(std::memory_order_relaxed) : kNoShard;
     }
 
-    boost::asio::awaitable<std::pair<common::Price, common::Qty>>
-    AsyncGetPriceAndQtyAtLevelAsk(const common::ExchangeId &exchange_id,
-                                  const common::TradingPair &trading_pair,
-                                  size_t level) override {
-        // Прямо внутри executor_ выполняем асинхронный код
-        co_await boost::asio::post(executor_, boost::asio::use_awaitable);
+    size_t ShardsCount() const { return shards_.size(); }
 
-        // Проверяем наличие книги ордеров для этого обмена и торговой пары
-        auto it_exchange = order_books_.find(exchange_id);
-        if (it_exchange == order_books_.end()) {
-            co_return std::make_pair(common::kPriceInvalid,
-                                     common::kQtyInvalid);
+    /**
+     * @brief move the book to another shard. Events which arrive while the
+     * book is moving wait in the new shard and are applied after the book in
+     * the order of arrival
+     *
+     */
+    void AsyncMoveOrderBook(common::ExchangeId exchange_id,
+                            common::TradingPair trading_pair, size_t to) {
+        if (to >= shards_.size()) [[unlikely]] {
+            loge("[MOVE ORDER BOOK] shard:{} does not exist", to);
+            return;
         }
+        boost::asio::post(shards_[to]->executor,
+                          [this, exchange_id, trading_pair, to]() {
+                              StartMove(exchange_id, trading_pair, to);
+                          });
+    }
 
-        auto it_pair = it_exchange->second.find(trading_pair);
-        if (it_pair == it_exchange->second.end()) {
-            co_return std::make_pair(common::kPriceInvalid,
-                                     common::kQtyInvalid);
+    /**
+     * @brief move the hottest book of the busiest shard to the idlest shard
+     * if it brings load of the shards closer. Load of a shard is the amount
+     * of events routed to its books since the previous call, the call resets
+     * counters. Call it periodically, e.g. from a timer
+     *
+     * @return true if a book is being moved
+     */
+    bool AsyncRebalance(uint64_t min_gap = kMinRebalanceGap) {
+        if (shards_.size() < 2) return false;
+        struct BookLoad {
+            common::ExchangeId exchange_id;
+            common::TradingPair trading_pair;
+            size_t shard;
+            uint64_t events;
+        };
+        std::vector<BookLoad> books;
+        std::vector<uint64_t> load(shards_.size(), 0);
+        {
+            std::shared_lock lock(routes_mutex_);
+            for (auto &[exchange_id, routes] : routes_) {
+                for (auto &[trading_pair, route] : routes) {
+                    const auto shard =
+                        route.shard.load(std::memory_order_relaxed);
+                    const auto events =
+                        route.events.exchange(0, std::memory_order_relaxed);
+                    load[shard] += events;
+                    if (!route.moving.load(std::memory_order_relaxed))
+                        books.push_back(
+                            {exchange_id, trading_pair, shard, events});
+                }
+            }
         }
+        const auto busiest = static_cast<size_t>(
+            std::ranges::max_element(load) - load.begin());
+        const auto idlest = static_cast<size_t>(
+            std::ranges::min_element(load) - load.begin());
+        const auto gap = load[busiest] - load[idlest];
+        if (gap < min_gap) return false;
+
+        // moving of a book with load less than gap lowers the busiest load
+        // and does not make the idlest shard busier than the busiest was
+        const BookLoad *candidate = nullptr;
+        for (const auto &book : books)
+            if (book.shard == busiest && book.events < gap &&
+                (!candidate || book.events > candidate->events))
+                candidate = &book;
+        if (!candidate || !candidate->events) return false;
+        logi("[REBALANCE] move {} {} events:{} from shard:{} to shard:{}",
+             candidate->exchange_id, candidate->trading_pair.ToString(),
+             candidate->events, busiest, idlest);
+        AsyncMoveOrderBook(candidate->exchange_id, candidate->trading_pair,
+                           idlest);
+        return true;
+    }
+
+  private:
+    /// Must be called under routes_mutex_.
+    Route *FindRoute(common::ExchangeId exchange_id,
+                     const common::TradingPair &trading_pair) {
+        auto it_exchange = routes_.find(exchange_id);
+        if (it_exchange == routes_.end()) return nullptr;
+        auto it_pair = it_exchange->second.find(trading_pair);
+        if (it_pair == it_exchange->second.end()) return nullptr;
+        return &it_pair->second;
+    }
+    const Route *FindRoute(common::ExchangeId exchange_id,
+                           const common::TradingPair &trading_pair) const {
+        return const_cast<OrderBookComponent *>(this)->FindRoute(exchange_id,
+                                                                 trading_pair);
+    }
 
-        auto &order_book      = it_pair->second;
+    /// Must be called under routes_mutex_.
+    size_t LeastLoadedShard() const {
+        std::vector<size_t> books(shards_.size(), 0);
+        for (const auto &[exchange_id, routes] : routes_)
+            for (const auto &[trading_pair, route] : routes)
+                ++books[route.shard.load(std::memory_order_relaxed)];
+        return static_cast<size_t>(std::ranges::min_element(books) -
+                                   books.begin());
+    }
 
-        // Проверяем, на какой стороне (bid/ask) нужно извлекать информацию
-        const auto &price_map = order_book.GetAsksatPriceMap();
+    /// Must be called inside the executor of the shard.
+    OrderBookEntry *FindOrderBook(Shard &shard, common::ExchangeId exchange_id,
+                                  const common::TradingPair &trading_pair) {
+        auto it_exchange = shard.order_books.find(exchange_id);
+        if (it_exchange == shard.order_books.end()) return nullptr;
+        auto it_pair = it_exchange->second.find(trading_pair);
+        if (it_pair == it_exchange->second.end()) return nullptr;
+        return &it_pair->second;
+    }
 
-        // Если уровень вне допустимого диапазона, возвращаем недопустимые
-        // значения
-        if (level >= price_map.size()) {
-            co_return std::make_pair(common::kPriceInvalid,
-                                     common::kQtyInvalid);
+    BookInTransit *FindInTransit(Shard &shard, common::ExchangeId exchange_id,
+                                 const common::TradingPair &trading_pair) {
+        for (auto &book : shard.in_transit)
+            if (book.exchange_id == exchange_id &&
+                book.trading_pair == trading_pair)
+                return &book;
+        return nullptr;
+    }
+
+    template <class Event>
+    void Dispatch(common::ExchangeId exchange_id,
+                  const common::TradingPair &trading_pair,
+                  boost::intrusive_ptr<Event> event) {
+        std::shared_lock lock(routes_mutex_);
+        auto *route = FindRoute(exchange_id, trading_pair);
+        if (!route) {
+            loge("[ORDER BOOK NOT FOUND] {}, {}", exchange_id,
+                 trading_pair.ToString());
+            return;
         }
+        route->events.fetch_add(1, std::memory_order_relaxed);
+        auto &shard = *shards_[route->shard.load(std::memory_order_relaxed)];
+        boost::asio::co_spawn(shard.executor,
+                              HandleEvent(shard, std::move(event)),
+                              boost::asio::detached);
+    }
 
-        // Перемещаем итератор на нужный уровень
-        auto it = price_map.begin();
-        std::advance(it, level);  // Перемещаем на (level-1)-й элемент
+    template <class Event>
+    boost::asio::awaitable<void> HandleEvent(
+        Shard &shard, boost::intrusive_ptr<Event> event) {
+        Apply(shard, std::move(event));
+        co_return;
+    }
 
-        // Возвращаем пару (цена, объём)
-        const auto &order_at_price = *it;
-        co_return std::make_pair(order_at_price.first_mkt_order_.price_,
-                                 order_at_price.first_mkt_order_.qty_);
+    template <class Event>
+    boost::asio::awaitable<void> HandleBatch(
+        Shard &shard, std::vector<boost::intrusive_ptr<Event>> events) {
+        for (auto &event : events) Apply(shard, std::move(event));
+        co_return;
     }
 
-    // Method to add a new order book
-    void AddOrderBook(common::ExchangeId exchange_id,
-                      const common::TradingPair &trading_pair) {
-        // Ensure the outer map contains the desired ExchangeId
-        auto &inner_map =
-            order_books_
-                .try_emplace(
-                    exchange_id,
-                    std::unordered_map<common::TradingPair, MarketOrderBook2,
-                                       common::TradingPairHash,
-                                       common::TradingPairEqual>())
-                .first->second;
-
-        auto result = inner_map.try_emplace(
-            trading_pair,  // Key (TradingPair)
-            exchange_id,
-            trading_pair  // Constructor arguments for MarketOrderBook2
-        );
-
-        if (result.second) {
-            logi("[MarketOrderBook2 inserted successfully!] with {} {}",
-                 exchange_id, trading_pair.ToString());
-            MarketOrderBook2 &order_book = result.first->second;
-
-            // Подписка на сигналы BBO
-            order_book.SubscribeToBBO(
-                [this, exchange_id, trading_pair](const BBO &bbo) {
-                    SendBBOToBus(exchange_id, trading_pair, bbo);
-                });
-            logi("add subscription to BBO for ob with {} {}", exchange_id,
+    /**
+     * @brief switch the coroutine to the executor of the shard which serves
+     * the book
+     *
+     * @return entry of the book, nullptr if there is no book
+     */
+    boost::asio::awaitable<OrderBookEntry *> EnterShard(
+        common::ExchangeId exchange_id, common::TradingPair trading_pair) {
+        while (true) {
+            const auto index = ShardOf(exchange_id, trading_pair);
+            if (index == kNoShard) co_return nullptr;
+            auto &shard = *shards_[index];
+            co_await boost::asio::post(shard.executor,
+                                       boost::asio::use_awaitable);
+            if (auto *entry = FindOrderBook(shard, exchange_id, trading_pair))
+                co_return entry;
+            // the book was moved away while the coroutine switched executors
+            // or it is still on the way to this shard
+            if (ShardOf(exchange_id, trading_pair) == index &&
+                !FindInTransit(shard, exchange_id, trading_pair))
+                co_return nullptr;
+        }
+    }
+
+    /// Runs in the destination shard.
+    void StartMove(common::ExchangeId exchange_id,
+                   common::TradingPair trading_pair, size_t to) {
+        auto &destination = *shards_[to];
+        std::unique_lock lock(routes_mutex_);
+        auto *route = FindRoute(exchange_id, trading_pair);
+        if (!route) return;
+        const auto from = route->shard.load(std::memory_order_relaxed);
+        if (from == to) return;
+        if (route->moving.exchange(true, std::memory_order_relaxed)) {
+            logw("[MOVE ORDER BOOK] {} {} is already moving", exchange_id,
                  trading_pair.ToString());
+            return;
+        }
+        destination.in_transit.push_back({exchange_id, trading_pair, {}});
+        route->shard.store(to, std::memory_order_relaxed);
+        // the lock is still held, so the book is extracted after all events
+        // which were routed to the source shard
+        auto &source = *shards_[from];
+        boost::asio::post(source.executor, [this, &source, &destination,
+                                            exchange_id, trading_pair]() {
+            auto node =
+                source.order_books[exchange_id].extract(trading_pair);
+            boost::asio::post(destination.executor,
+                              [this, &destination, exchange_id, trading_pair,
+                               node = std::move(node)]() mutable {
+                                  FinishMove(destination, exchange_id,
+                                             trading_pair, std::move(node));
+                              });
+        });
+    }
 
-        } else {
-            logi(
-                "[MarketOrderBook2 already exists in the inner map!] with {} "
-                "{}",
-                exchange_id, trading_pair.ToString());
+    /// Runs in the destination shard.
+    void FinishMove(Shard &shard, common::ExchangeId exchange_id,
+                    common::TradingPair trading_pair, OrderBookNode node) {
+        std::vector<PendingEvent> events;
+        if (auto *book = FindInTransit(shard, exchange_id, trading_pair)) {
+            events = std::move(book->events);
+            shard.in_transit.erase(shard.in_transit.begin() +
+                                   (book - shard.in_transit.data()));
+        }
+        if (node.empty()) [[unlikely]]
+            loge("[MOVE ORDER BOOK] {} {} is lost", exchange_id,
+                 trading_pair.ToString());
+        else
+            shard.order_books[exchange_id].insert(std::move(node));
+        {
+            std::shared_lock lock(routes_mutex_);
+            if (auto *route = FindRoute(exchange_id, trading_pair))
+                route->moving.store(false, std::memory_order_relaxed);
         }
+        logi("[MOVE ORDER BOOK] {} {} applies {} pending events", exchange_id,
+             trading_pair.ToString(), events.size());
+        // applied right now, events posted to the shard later must not
+        // overtake them
+        for (auto &event : events)
+            std::visit([&](auto &pending) { Apply(shard, std::move(pending)); },
+                       event);
     }
 
-  private:
-    boost::asio::awaitable<void> HandleNewMEMarketUpdate(
-        boost::intrusive_ptr<Exchange::BusEventMEMarketUpdate2> event) {
+    /**
+     * @brief the book is moving to this shard, keep the event until it comes
+     *
+     * @return false if the book is unknown
+     */
+    bool Defer(Shard &shard, common::ExchangeId exchange_id,
+               const common::TradingPair &trading_pair, PendingEvent event) {
+        auto *book = FindInTransit(shard, exchange_id, trading_pair);
+        if (!book) return false;
+        book->events.push_back(std::move(event));
+        return true;
+    }
+
+    void Apply(Shard &shard,
+               boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot>
+                   event) {
+        hlogd(kOrderBook, "[ORDERBOOK] processing new snapshot");
         // Extract the necessary information from the event
         const auto *wrapped_event = event->WrappedEvent();
         if (!wrapped_event) {
-            co_return;  // Exit if the event is invalid
+            return;  // Exit if the event is invalid
         }
 
         const auto exchange_id   = wrapped_event->exchange_id;
         const auto &trading_pair = wrapped_event->trading_pair;
 
         // Check if the exchange and trading pair exist in the order books
-        if (!order_books_.contains(exchange_id)) {
-            loge("[EXCHANGE NOT FOUND] {}, {}", exchange_id,
+        auto *entry = FindOrderBook(shard, exchange_id, trading_pair);
+        if (!entry) {
+            if (Defer(shard, exchange_id, trading_pair, std::move(event)))
+                return;
+            loge("[ORDER BOOK NOT FOUND] {}, {}", exchange_id,
                  trading_pair.ToString());
-            co_return;
-        }
-        if (!order_books_[exchange_id].contains(trading_pair)) {
-            loge("[TRADING PAIR NOT FOUND] {}, {}", exchange_id,
-                 trading_pair.ToString());
-            co_return;
+            return;
         }
 
-        auto &inner_map =
-            order_books_
-                .try_emplace(
-                    exchange_id,
-                    std::unordered_map<common::TradingPair, MarketOrderBook2,
-                                       common::TradingPairHash,
-                                       common::TradingPairEqual>())
-                .first->second;
-
-        auto &order_book =
-            inner_map
-                .try_emplace(
-                    trading_pair, exchange_id,
-                    trading_pair  // Arguments for constructing MarketOrderBook2
-                    )
-                .first->second;
-
-        logi("[PROCESSING MARKET UPDATE] {}, {}, Price: {}, Qty: {}",
-             exchange_id, trading_pair.ToString(), wrapped_event->price,
-             wrapped_event->qty);
-
-        order_book.OnMarketUpdate(wrapped_event);
+        hlogi(kOrderBook,
+              "[PROCESSING MARKET UPDATE] {}, {}, {}, b_size: {}, a_size: {}",
+              exchange_id, market_type_, trading_pair.ToString(),
+              wrapped_event->bids.size(), wrapped_event->asks.size());
 
-        co_return;
+        entry->order_book->OnMarketUpdate(wrapped_event);
+        entry->depth_cache.Invalidate();
     }
 
-    boost::asio::awaitable<void> HandleResponseNewSnapshot(
-        boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot> event) {
-        logi("[ORDERBOOK] processing new snapshot");
+    void Apply(Shard &shard,
+               boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot> event) {
+        hlogd(kOrderBook, "[ORDERBOOK] processing new diff");
         // Extract the necessary information from the event
         const auto *wrapped_event = event->WrappedEvent();
         if (!wrapped_event) {
-            co_return;  // Exit if the event is invalid
+            return;  // Exit if the event is invalid
         }
 
         const auto exchange_id   = wrapped_event->exchange_id;
         const auto &trading_pair = wrapped_event->trading_pair;
 
         // Check if the exchange and trading pair exist in the order books
-        if (!order_books_.contains(exchange_id)) {
-            loge("[EXCHANGE NOT FOUND] {}, {}", exchange_id,
-                 trading_pair.ToString());
-            co_return;
-        }
-        if (!order_books_[exchange_id].contains(trading_pair)) {
-            loge("[TRADING PAIR NOT FOUND] {}, {}", exchange_id,
+        auto *entry = FindOrderBook(shard, exchange_id, trading_pair);
+        if (!entry) {
+            if (Defer(shard, exchange_id, trading_pair, std::move(event)))
+                return;
+            loge("[ORDER BOOK NOT FOUND] {}, {}", exchange_id,
                  trading_pair.ToString());
-            co_return;
+            return;
         }
 
-        auto &inner_map =
-            order_books_
-                .try_emplace(
-                    exchange_id,
-                    std::unordered_map<common::TradingPair, MarketOrderBook2,
-                                       common::TradingPairHash,
-                                       common::TradingPairEqual>())
-                .first->second;
-
-        auto &order_book =
-            inner_map
-                .try_emplace(
-                    trading_pair, exchange_id,
-                    trading_pair  // Arguments for constructing MarketOrderBook2
-                    )
-                .first->second;
-
-        logi("[PROCESSING MARKET UPDATE] {}, {}, {}, b_size: {}, a_size: {}",
-             exchange_id, market_type_, trading_pair.ToString(),
-             wrapped_event->bids.size(), wrapped_event->asks.size());
+        hlogi(kOrderBook,
+              "[PROCESSING MARKET UPDATE] {}, {}, b_size: {}, a_size: {}",
+              exchange_id, trading_pair.ToString(), wrapped_event->bids.size(),
+              wrapped_event->asks.size());
 
-        order_book.OnMarketUpdate(wrapped_event);
-
-        co_return;
+        entry->order_book->OnMarketUpdate(wrapped_event);
+        for (const auto &bid : wrapped_event->bids)
+            entry->depth_cache.OnLevelTouched(common::Side::kBid, bid.price);
+        for (const auto &ask : wrapped_event->asks)
+            entry->depth_cache.OnLevelTouched(common::Side::kAsk, ask.price);
     }
 
-    boost::asio::awaitable<void> HandleNewDiff(
-        boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot> event) {
-        logi("[ORDERBOOK] processing new diff");
+    /// BusEventMEMarketUpdate2 or MEMarketUpdate2Envelope.
+    template <class Event>
+        requires std::same_as<
+            std::remove_cvref_t<
+                decltype(*std::declval<Event &>().WrappedEvent())>,
+            Exchange::MEMarketUpdate2>
+    void Apply(Shard &shard, boost::intrusive_ptr<Event> event) {
         // Extract the necessary information from the event
         const auto *wrapped_event = event->WrappedEvent();
         if (!wrapped_event) {
-            co_return;  // Exit if the event is invalid
+            return;  // Exit if the event is invalid
         }
 
         const auto exchange_id   = wrapped_event->exchange_id;
         const auto &trading_pair = wrapped_event->trading_pair;
 
         // Check if the exchange and trading pair exist in the order books
-        if (!order_books_.contains(exchange_id)) {
-            loge("[EXCHANGE NOT FOUND] {}, {}", exchange_id,
-                 trading_pair.ToString());
-            co_return;
-        }
-        if (!order_books_[exchange_id].contains(trading_pair)) {
-            loge("[TRADING PAIR NOT FOUND] {}, {}", exchange_id,
+        auto *entry = FindOrderBook(shard, exchange_id, trading_pair);
+        if (!entry) {
+            if (Defer(shard, exchange_id, trading_pair, std::move(event)))
+                return;
+            loge("[ORDER BOOK NOT FOUND] {}, {}", exchange_id,
                  trading_pair.ToString());
-            co_return;
+            return;
         }
 
-        auto &inner_map =
-            order_books_
-                .try_emplace(
-                    exchange_id,
-                    std::unordered_map<common::TradingPair, MarketOrderBook2,
-                                       common::TradingPairHash,
-                                       common::TradingPairEqual>())
-                .first->second;
-
-        auto &order_book =
-            inner_map
-                .try_emplace(
-                    trading_pair, exchange_id,
-                    trading_pair  // Arguments for constructing MarketOrderBook2
-                    )
-                .first->second;
-
-        logi("[PROCESSING MARKET UPDATE] {}, {}, b_size: {}, a_size: {}",
-             exchange_id, trading_pair.ToString(), wrapped_event->bids.size(),
-             wrapped_event->asks.size());
-
-        order_book.OnMarketUpdate(wrapped_event);
-
-        co_return;
+        hlogi(kOrderBook,
+              "[PROCESSING MARKET UPDATE] {}, {}, Price: {}, Qty: {}",
+              exchange_id, trading_pair.ToString(), wrapped_event->price,
+              wrapped_event->qty);
+
+        entry->order_book->OnMarketUpdate(wrapped_event);
+        if (wrapped_event->type == Exchange::MarketUpdateType::CLEAR)
+            [[unlikely]]
+            entry->depth_cache.Invalidate();
+        else
+            entry->depth_cache.OnLevelTouched(wrapped_event->side,
+                                              wrapped_event->price);
     }
 
     void SendBBOToBus(common::ExchangeId exchange_id,
                       const common::TradingPair &trading_pair, const BBO &bbo) {
-        auto request = new_bbo_pool_.Allocate(&new_bbo_pool_, exchange_id,
-                                              trading_pair, bbo, market_type_);
-        auto intr_ptr_request = boost::intrusive_ptr<NewBBO>(request);
-
-        auto bus_event        = bus_event_new_bbo_pool_.Allocate(
-            &bus_event_new_bbo_pool_, intr_ptr_request);
-        auto intr_ptr_bus_request =
-            boost::intrusive_ptr<BusEventNewBBO>(bus_event);
-
-        bus_.AsyncSend(this, intr_ptr_bus_request);
+        // NewBBO and its bus event are one allocation
+        auto *envelope = new_bbo_pool_.Allocate(
+            &new_bbo_pool_, exchange_id, trading_pair, bbo, market_type_);
+        bus_.AsyncSend(this, boost::intrusive_ptr<NewBBOEnvelope>(envelope));
     }
 };
 
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "aot/Logger.h"
+#include "aot/client_request.h"
+#include "aot/client_response.h"
+#include "aot/strategy/om_order_slab.h"
+
+namespace Trading {
+class TradeEngine;
+/**
+ * @brief Manages many working orders per trading pair and side.
+ *
+ * Unlike OrderManager, which keeps one order per side, orders live in an
+ * OMOrderSlab of a fixed capacity. That allows quoting layers, slicing, or a
+ * replacement sent while a cancel is in flight. Client order ids come from the
+ * slab, so responses are matched to their orders in O(1), and responses of
+ * orders that are already gone are dropped.
+ */
+class MultiOrderManager {
+  public:
+    MultiOrderManager(TradeEngine *trade_engine, size_t capacity)
+        : trade_engine_(trade_engine), orders_(capacity) {}
+
+    /**
+     * @brief Sends a new limit order.
+     *
+     * @return client order id of the order, kOrderIdInvalid if capacity
+     * orders are working already
+     */
+    auto NewOrder(common::ExchangeId exchange_id,
+                  common::TradingPair trading_pair, common::Price price,
+                  common::Side side, common::Qty qty) noexcept
+        -> common::OrderId;
+
+    /**
+     * @brief Sends a cancel of the order unless one is in flight already.
+     *
+     * @return false if the order is gone or a cancel was sent before
+     */
+    auto CancelOrder(common::ExchangeId exchange_id,
+                     common::OrderId order_id) noexcept -> bool;
+
+    /**
+     * @brief Cancels every working order of the side.
+     */
+    auto CancelOrder(common::ExchangeId exchange_id,
+                     common::TradingPair trading_pair,
+                     common::Side side) noexcept -> void;
+
+    auto OnOrderResponse(
+        const Exchange::MEClientResponse *client_response) noexcept -> void {
+        logd("{}", client_response->ToString());
+        if (!orders_.Find(client_response->order_id)) [[unlikely]]
+            logw("no working order for {}", client_response->ToString());
+        orders_.OnResponse(client_response->type, client_response->order_id,
+                           client_response->leaves_qty);
+    }
+
+    auto OnOrderResponse(Exchange::IResponse *client_response) noexcept
+        -> void {
+        const auto order_id = client_response->GetOrderId();
+        if (!orders_.Find(order_id)) [[unlikely]]
+            logw("no working order for {}", client_response->ToString());
+        orders_.OnResponse(client_response->GetType(), order_id,
+                           client_response->GetLeavesQty());
+        client_response->Deallocate();
+    }
+
+    OMOrderSlab &Orders() { return orders_; }
+
+    MultiOrderManager(const MultiOrderManager &)            = delete;
+    MultiOrderManager &operator=(const MultiOrderManager &) = delete;
+    virtual ~MultiOrderManager()                            = default;
+
+  private:
+    /// The parent trade engine object, used to send out client requests.
+    TradeEngine *trade_engine_ = nullptr;
+
+    OMOrderSlab orders_;
+};
+}  // namespace Trading
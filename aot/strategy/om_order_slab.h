@@ -0,0 +1,221 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+#include "aot/client_response.h"
+#include "aot/common/types.h"
+#include "aot/strategy/om_order.h"
+
+namespace Trading {
+/**
+ * @brief working orders of a strategy in a fixed-capacity slab.
+ *
+ * Any number of orders per trading pair and side, up to the capacity in
+ * total. The client order id of an order is its slot and the generation of the
+ * slot, so a response finds its order in O(1) and a late response of an order
+ * that is gone does not touch the order that reuses its slot. Orders of a pair
+ * and side are linked in the order they were added.
+ *
+ * Slots are allocated by the constructor, the first order of a trading pair
+ * allocates its lists, nothing else allocates. Not thread safe.
+ */
+class OMOrderSlab {
+  public:
+    using Index                 = uint32_t;
+    static constexpr Index kNil = std::numeric_limits<Index>::max();
+
+    /// @param capacity max working orders, rounded up to a power of two
+    explicit OMOrderSlab(size_t capacity)
+        : slot_bits_(
+              std::bit_width(std::bit_ceil(capacity ? capacity : 1) - 1)),
+          slots_(size_t{1} << slot_bits_) {
+        for (Index i = 0; i < slots_.size(); ++i)
+            slots_[i].next = i + 1 < slots_.size() ? i + 1 : kNil;
+    }
+
+    /// new PENDING_NEW order at the tail of its side, nullptr if full
+    OMOrder* Add(common::TradingPair trading_pair, common::Side side,
+                 common::Price price, common::Qty qty) {
+        if (free_ == kNil) [[unlikely]]
+            return nullptr;
+        const Index index = free_;
+        auto& slot        = slots_[index];
+        free_             = slot.next;
+        const auto order_id =
+            (common::OrderId{slot.generation} << slot_bits_) | index;
+        slot.order = {trading_pair, order_id, side,
+                      price,        qty,      OMOrderState::PENDING_NEW};
+        slot.list  = ListOf(trading_pair, side);
+        Link(index);
+        ++size_;
+        return &slot.order;
+    }
+
+    /// working order of the client order id, nullptr if it is gone
+    OMOrder* Find(common::OrderId order_id) {
+        const auto index = static_cast<Index>(order_id & (slots_.size() - 1));
+        auto& slot       = slots_[index];
+        if (slot.list == kNil || (order_id >> slot_bits_) != slot.generation)
+            return nullptr;
+        return &slot.order;
+    }
+
+    /**
+     * @brief marks the order PENDING_CANCEL.
+     *
+     * @return the order if a cancel should be sent, nullptr if it is gone or
+     * a cancel is already in flight
+     */
+    OMOrder* RequestCancel(common::OrderId order_id) {
+        auto order = Find(order_id);
+        if (!order || order->state == OMOrderState::PENDING_CANCEL)
+            return nullptr;
+        order->state = OMOrderState::PENDING_CANCEL;
+        return order;
+    }
+
+    /**
+     * @brief applies a response of the exchange to its order.
+     *
+     * Responses may come in any order: a fill or a cancel before the ack, an
+     * ack after the order is filled or after a cancel was sent. A fill of the
+     * whole leaves qty, a cancel or a reject of a new order removes the order.
+     *
+     * @return the order if it is still working, nullptr otherwise
+     */
+    OMOrder* OnResponse(Exchange::ClientResponseType type,
+                        common::OrderId order_id, common::Qty leaves_qty) {
+        auto order = Find(order_id);
+        if (!order) [[unlikely]]
+            return nullptr;
+        switch (type) {
+            case Exchange::ClientResponseType::ACCEPTED:
+                if (order->state == OMOrderState::PENDING_NEW)
+                    order->state = OMOrderState::LIVE;
+                break;
+            case Exchange::ClientResponseType::FILLED:
+                order->qty = leaves_qty;
+                if (leaves_qty == 0) {
+                    Remove(order_id);
+                    return nullptr;
+                }
+                if (order->state == OMOrderState::PENDING_NEW)
+                    order->state = OMOrderState::LIVE;
+                break;
+            case Exchange::ClientResponseType::CANCELED:
+                Remove(order_id);
+                return nullptr;
+            case Exchange::ClientResponseType::CANCEL_REJECTED:
+                if (order->state == OMOrderState::PENDING_CANCEL)
+                    order->state = OMOrderState::LIVE;
+                break;
+            case Exchange::ClientResponseType::INVALID:
+                if (order->state == OMOrderState::PENDING_NEW) {
+                    Remove(order_id);
+                    return nullptr;
+                }
+                break;
+        }
+        return order;
+    }
+
+    /// calls f(OMOrder&) for the orders of the side from the oldest one, f may
+    /// request cancels
+    template <typename F>
+    void ForEach(common::TradingPair trading_pair, common::Side side, F&& f) {
+        auto pair = pairs_.find(trading_pair);
+        if (pair == pairs_.end()) return;
+        for (Index index = lists_[pair->second + sideToIndex(side)].head;
+             index != kNil;) {
+            const Index next = slots_[index].next;
+            f(slots_[index].order);
+            index = next;
+        }
+    }
+
+    /// working orders of the side
+    size_t Count(common::TradingPair trading_pair, common::Side side) const {
+        auto pair = pairs_.find(trading_pair);
+        if (pair == pairs_.end()) return 0;
+        return lists_[pair->second + sideToIndex(side)].size;
+    }
+    size_t Size() const { return size_; }
+    size_t Capacity() const { return slots_.size(); }
+
+  private:
+    static constexpr size_t kSides = sideToIndex(common::Side::kMax) + 1;
+
+    struct Slot {
+        OMOrder order;
+        /// neighbours in the list of the side, next links free slots too
+        Index prev          = kNil;
+        Index next          = kNil;
+        /// list of the side, kNil for a free slot
+        Index list          = kNil;
+        /// bumped when the order is removed, so its id gets stale
+        uint32_t generation = 1;
+    };
+    struct List {
+        Index head  = kNil;
+        Index tail  = kNil;
+        size_t size = 0;
+    };
+
+    Index ListOf(common::TradingPair trading_pair, common::Side side) {
+        auto [pair, inserted] = pairs_.try_emplace(
+            trading_pair, static_cast<Index>(lists_.size()));
+        if (inserted) [[unlikely]]
+            lists_.resize(lists_.size() + kSides);
+        return pair->second + static_cast<Index>(sideToIndex(side));
+    }
+
+    void Link(Index index) {
+        auto& slot = slots_[index];
+        auto& list = lists_[slot.list];
+        slot.prev  = list.tail;
+        slot.next  = kNil;
+        if (list.tail == kNil)
+            list.head = index;
+        else
+            slots_[list.tail].next = index;
+        list.tail = index;
+        ++list.size;
+    }
+
+    void Remove(common::OrderId order_id) {
+        const auto index = static_cast<Index>(order_id & (slots_.size() - 1));
+        auto& slot       = slots_[index];
+        auto& list       = lists_[slot.list];
+        if (slot.prev == kNil)
+            list.head = slot.next;
+        else
+            slots_[slot.prev].next = slot.next;
+        if (slot.next == kNil)
+            list.tail = slot.prev;
+        else
+            slots_[slot.next].prev = slot.prev;
+        --list.size;
+
+        slot.order.state = OMOrderState::DEAD;
+        slot.list        = kNil;
+        slot.next        = free_;
+        ++slot.generation;
+        free_ = index;
+        --size_;
+    }
+
+    const int slot_bits_;
+    std::vector<Slot> slots_;
+    std::vector<List> lists_;
+    ankerl::unordered_dense::map<common::TradingPair, Index,
+                                 common::TradingPairHash,
+                                 common::TradingPairEqual>
+        pairs_;
+    Index free_  = 0;
+    size_t size_ = 0;
+};
+}  // namespace Trading
@@ -152,13 +152,14 @@ class OrderManager {
     };
 };
 
-template<typename Executor>
+/// Manager is OrderManager or MultiOrderManager
+template<typename Executor, typename Manager = Trading::OrderManager>
 class OrderManagerComponent : public bus::Component{
     Executor executor_;
 
-    Trading::OrderManager *om_         = nullptr;
+    Manager *om_         = nullptr;
   public:
-    explicit OrderManagerComponent(Executor&& executor, Trading::OrderManager *om)
+    explicit OrderManagerComponent(Executor&& executor, Manager *om)
         : executor_(executor),om_(om) {}
     
     ~OrderManagerComponent() override = default;
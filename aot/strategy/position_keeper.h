@@ -12,13 +12,15 @@
 #include "aot/common/macros.h"
 #include "aot/common/thread_utils.h"
 #include "aot/common/types.h"
+#include "aot/pnl/pnl_book.h"
 #include "aot/strategy/cross_arbitrage/signals.h"
 #include "aot/strategy/market_order.h"
 
 namespace Trading {
 
 /// PositionInfo tracks the position, pnl (realized and unrealized) and volume
-/// for a single trading instrument.
+/// for a single trading instrument. P&L is kept in fixed point by the PnlBook
+/// of the keeper, the double fields are its report values.
 struct PositionInfo {
     int position      = 0;
     double real_pnl   = 0;
@@ -27,6 +29,8 @@ struct PositionInfo {
     std::array<double, common::sideToIndex(common::Side::kMax) + 1> open_vwap;
     double volume           = 0;
     const Trading::BBO *bbo = nullptr;
+    /// instrument of the position in the PnlBook of the keeper
+    aot::PnlBook::Id pnl_id = 0;
 
     auto ToString() const {
         std::stringstream ss;
@@ -50,9 +54,11 @@ struct PositionInfo {
      * @brief add only filled order. it is regulate from trade_engine.cpp
      * Process an execution and update the position, pnl and volume.
      * @param client_response
+     * @param pnl_book keeps P&L of the position in fixed point
      * @return auto
      */
-    auto addFill(const Exchange::IResponse *client_response) noexcept {
+    auto addFill(const Exchange::IResponse *client_response,
+                 aot::PnlBook &pnl_book) noexcept {
         auto side                 = client_response->GetSide();
         auto exec_qty             = client_response->GetExecQty();
         auto price                = client_response->GetPrice();
@@ -74,67 +80,45 @@ struct PositionInfo {
             const auto opp_side_vwap =
                 open_vwap[opp_side_index] / std::abs(old_position);
             open_vwap[opp_side_index] = opp_side_vwap * std::abs(position);
-            real_pnl +=
-                std::min(static_cast<int>(exec_qty), std::abs(old_position)) *
-                (opp_side_vwap - price) * sideToValue(side);
             if (position * old_position <
                 0) {  // flipped position to opposite sign.
                 open_vwap[side_index]     = (price * std::abs(position));
                 open_vwap[opp_side_index] = 0;
             }
         }
-
-        if (!position) {  // flat
+        if (!position)  // flat
             open_vwap[common::sideToIndex(common::Side::kAsk)] =
                 open_vwap[sideToIndex(common::Side::kBid)] = 0;
-            unreal_pnl                                     = 0;
-        } else {
-            if (position > 0)
-                unreal_pnl =
-                    (price - open_vwap[sideToIndex(common::Side::kAsk)] /
-                                 std::abs(position)) *
-                    std::abs(position);
-            else
-                unreal_pnl =
-                    (open_vwap[common::sideToIndex(common::Side::kBid)] /
-                         std::abs(position) -
-                     price) *
-                    std::abs(position);
-        }
 
-        total_pnl = unreal_pnl + real_pnl;
+        pnl_book.AddFill(pnl_id, side, price, exec_qty);
+        Report(pnl_book);
 
         logi("{} {}", ToString(), client_response->ToString());
     }
 
     /// Process a change in top-of-book prices (BBO), and update unrealized pnl
     /// if there is an open position.
-    auto updateBBO(const Trading::BBO *_bbo) noexcept {
+    auto updateBBO(const Trading::BBO *_bbo, aot::PnlBook &pnl_book) noexcept {
         bbo = _bbo;
 
         if (position && bbo->bid_price != common::kPriceInvalid &&
             bbo->ask_price != common::kPriceInvalid) {
-            const auto mid_price = (bbo->bid_price + bbo->ask_price) * 0.5;
-            if (position > 0)
-                unreal_pnl =
-                    (mid_price -
-                     open_vwap[common::sideToIndex(common::Side::kAsk)] /
-                         std::abs(position)) *
-                    std::abs(position);
-            else
-                unreal_pnl =
-                    (open_vwap[common::sideToIndex(common::Side::kBid)] /
-                         std::abs(position) -
-                     mid_price) *
-                    std::abs(position);
-
+            pnl_book.UpdateBBO(pnl_id, bbo->bid_price, bbo->ask_price);
             const auto old_total_pnl = total_pnl;
-            total_pnl                = unreal_pnl + real_pnl;
+            Report(pnl_book);
 
             if (total_pnl != old_total_pnl)
                 logi("{} {}", ToString(), bbo->ToString());
         }
     }
+
+  private:
+    /// converts P&L of the book to the report fields
+    void Report(const aot::PnlBook &pnl_book) noexcept {
+        real_pnl   = pnl_book.RealPnlDouble(pnl_id);
+        unreal_pnl = pnl_book.UnrealPnlDouble(pnl_id);
+        total_pnl  = pnl_book.TotalPnlDouble(pnl_id);
+    }
 };
 
 /// Top level position keeper class to compute position, pnl and volume for all
@@ -142,6 +126,12 @@ struct PositionInfo {
 class PositionKeeper {
   public:
     explicit PositionKeeper()                          = default;
+    /**
+     * @param pairs_info P&L of a pair is reported in units of its precision,
+     * pairs out of it in units of the price step * the qty step
+     */
+    explicit PositionKeeper(const common::TradingPairHashMap *pairs_info)
+        : pairs_info_(pairs_info) {}
 
     /// Deleted default, copy & move constructors and assignment-operators.
 
@@ -159,34 +149,49 @@ class PositionKeeper {
     std::unordered_map<common::TradingPair, PositionInfo,
                        common::TradingPairHash, common::TradingPairEqual>
         ticker_position;
+    const common::TradingPairHashMap *pairs_info_ = nullptr;
+    aot::PnlBook pnl_book_;
+
+    /// position of trading_pair, a new one gets an instrument of pnl_book_
+    PositionInfo &Position(const common::TradingPair trading_pair) noexcept {
+        auto [it, inserted] = ticker_position.try_emplace(trading_pair);
+        if (inserted) {
+            common::TradingPairInfo info{};
+            if (pairs_info_) {
+                auto pair_info = pairs_info_->find(trading_pair);
+                if (pair_info != pairs_info_->end()) info = pair_info->second;
+            }
+            it->second.pnl_id = pnl_book_.AddInstrument(info);
+        }
+        return it->second;
+    }
 
   public:
     virtual void AddFill(const Exchange::IResponse *client_response) noexcept {
-        ticker_position[client_response->GetTradingPair()].addFill(
-            client_response);
+        Position(client_response->GetTradingPair())
+            .addFill(client_response, pnl_book_);
     };
     virtual void UpdateBBO(const common::TradingPair trading_pair,
                            const Trading::BBO *bbo) noexcept {
-        ticker_position[trading_pair].updateBBO(bbo);
+        Position(trading_pair).updateBBO(bbo, pnl_book_);
     };
 
     virtual Trading::PositionInfo *GetPositionInfo(
         const common::TradingPair trading_pair) noexcept {
-        return &(ticker_position[trading_pair]);
+        return &Position(trading_pair);
     };
 
     virtual std::string ToString() const {
-        double total_pnl = 0;
         double total_vol = 0;
 
         std::stringstream ss;
         for (auto &it : ticker_position) {
             ss << "TickerId:" << it.first.ToString() << " "
                << it.second.ToString() << "\n";
-            total_pnl += it.second.total_pnl;
             total_vol += it.second.volume;
         }
-        ss << "Total PnL:" << total_pnl << " Vol:" << total_vol << "\n";
+        ss << "Total PnL:" << pnl_book_.TotalPnlDouble()
+           << " Vol:" << total_vol << "\n";
         return ss.str();
     };
 };
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "aot/common/types.h"
+
+namespace Trading {
+/**
+ * @brief default amount of ticks covered by the contiguous part of a
+ * PriceLadder
+ *
+ */
+constexpr size_t kPriceLadderDefaultWindow = 4096;
+/**
+ * @brief default amount of levels reserved for levels that lie outside the
+ * ladder window. for binance max depth of snapshot is 5000
+ *
+ */
+constexpr size_t kPriceLadderDefaultFarCapacity = 5000;
+
+struct PriceLevel {
+    common::Price price = common::kPriceInvalid;
+    common::Qty qty     = common::kQtyInvalid;
+};
+
+/**
+ * @brief one side of an order book stored as a contiguous tick-indexed array.
+ *
+ * Prices are already integers scaled by TradingPairInfo::price_precission, so
+ * one tick equals one unit of common::Price. The ladder keeps a window of
+ * `window` ticks starting at the better edge of the book. Index 0 is the most
+ * aggressive price of the window, bigger indexes are less aggressive prices.
+ * Levels that are worse than the window live in a sorted vector `far_` whose
+ * back() is the best far level.
+ *
+ * Invariants:
+ * 1. every far level is worse than the worse edge of the window
+ * 2. the window is never empty while far levels exist
+ *
+ * Best level lookup is O(1), update of a level inside the window is O(1),
+ * finding the next best level after the best one is removed is O(window/64)
+ * thanks to the occupancy bitmap. The window is recentred only when a new best
+ * price arrives above the better edge or when the window becomes empty.
+ *
+ * @tparam kSide common::Side::kBid or common::Side::kAsk
+ */
+template <common::Side kSide>
+class PriceLadder {
+    static_assert(kSide == common::Side::kBid || kSide == common::Side::kAsk,
+                  "PriceLadder supports only bid or ask side");
+
+  public:
+    using Level = PriceLevel;
+
+    explicit PriceLadder(size_t window       = kPriceLadderDefaultWindow,
+                         size_t far_capacity = kPriceLadderDefaultFarCapacity)
+        : window_(std::max<size_t>((window + 63) / 64 * 64, 64)),
+          headroom_(window_ / 4),
+          qtys_(window_, 0),
+          occupancy_(window_ / 64, 0),
+          best_(window_) {
+        far_.reserve(far_capacity);
+    }
+
+    bool Empty() const noexcept { return count_ == 0; }
+
+    /// Amount of price levels on this side of the book.
+    size_t Size() const noexcept { return count_ + far_.size(); }
+
+    /// Amount of price levels stored inside the contiguous window.
+    size_t SizeInWindow() const noexcept { return count_; }
+
+    size_t Window() const noexcept { return window_; }
+
+    common::Price BestPrice() const noexcept {
+        if (Empty()) [[unlikely]]
+            return common::kPriceInvalid;
+        return PriceAt(best_);
+    }
+
+    common::Qty BestQty() const noexcept {
+        if (Empty()) [[unlikely]]
+            return common::kQtyInvalid;
+        return qtys_[best_];
+    }
+
+    /// Return true if price a is more aggressive than price b for this side.
+    static constexpr bool IsBetter(common::Price a, common::Price b) noexcept {
+        if constexpr (kSide == common::Side::kBid)
+            return a > b;
+        else
+            return a < b;
+    }
+
+    /**
+     * @brief add, update or remove (qty == 0) the level with price
+     *
+     */
+    void Set(common::Price price, common::Qty qty) noexcept {
+        if (qty == 0) {
+            Erase(price);
+            return;
+        }
+        if (Empty()) [[unlikely]] {
+            CentreOn(price);
+        } else if (Offset(price) < 0) {
+            // new best price is above the better edge of the window
+            ShiftWorse(static_cast<size_t>(static_cast<int64_t>(headroom_) -
+                                           Offset(price)));
+        }
+        const auto offset = Offset(price);
+        if (offset < static_cast<int64_t>(window_)) [[likely]] {
+            const auto idx = static_cast<size_t>(offset);
+            if (qtys_[idx] == 0) {
+                ++count_;
+                SetBit(idx);
+                if (idx < best_) best_ = idx;
+            }
+            qtys_[idx] = qty;
+            return;
+        }
+        UpsertFar(price, qty);
+    }
+
+    /**
+     * @brief remove the level with price
+     *
+     * @return false if the side does not contain such price. It can happen and
+     * is normal for exchange diffs
+     */
+    bool Erase(common::Price price) noexcept {
+        if (Empty()) return false;
+        const auto offset = Offset(price);
+        if (offset < 0) return false;
+        if (offset >= static_cast<int64_t>(window_)) return EraseFar(price);
+
+        const auto idx = static_cast<size_t>(offset);
+        if (qtys_[idx] == 0) return false;
+        qtys_[idx] = 0;
+        ClearBit(idx);
+        --count_;
+        if (idx == best_) best_ = NextOccupied(idx + 1);
+        if (Empty() && !far_.empty()) [[unlikely]]
+            PullFromFar();
+        return true;
+    }
+
+    /**
+     * @brief replace the side with the levels of a snapshot. The window is
+     * centred on the best level and the far levels are sorted once, so a deep
+     * snapshot costs O(n log n) instead of an insert per far level
+     *
+     * @tparam Levels range of elements with price and qty
+     */
+    template <class Levels>
+    void Assign(const Levels &levels) noexcept {
+        Clear();
+        auto best = common::kPriceInvalid;
+        for (const auto &level : levels)
+            if (level.qty &&
+                (best == common::kPriceInvalid || IsBetter(level.price, best)))
+                best = level.price;
+        if (best == common::kPriceInvalid) return;
+        CentreOn(best);
+        for (const auto &level : levels) {
+            if (level.qty == 0) continue;
+            const auto offset = Offset(level.price);
+            if (offset < static_cast<int64_t>(window_)) {
+                const auto idx = static_cast<size_t>(offset);
+                if (qtys_[idx] == 0) {
+                    ++count_;
+                    SetBit(idx);
+                }
+                qtys_[idx] = level.qty;
+            } else {
+                far_.push_back({level.price, level.qty});
+            }
+        }
+        best_ = NextOccupied(0);
+        std::stable_sort(far_.begin(), far_.end(),
+                         [](const Level &a, const Level &b) {
+                             return IsBetter(b.price, a.price);
+                         });
+        // the last level of a price wins as with Set()
+        size_t kept = 0;
+        for (const auto &level : far_) {
+            if (kept && far_[kept - 1].price == level.price)
+                far_[kept - 1] = level;
+            else
+                far_[kept++] = level;
+        }
+        far_.resize(kept);
+    }
+
+    void Clear() noexcept {
+        if (count_) {
+            std::fill(qtys_.begin(), qtys_.end(), 0);
+            std::fill(occupancy_.begin(), occupancy_.end(), 0);
+        }
+        far_.clear();
+        count_ = 0;
+        best_  = window_;
+    }
+
+    /**
+     * @brief return price and qty on level from the best one (level = 0 is the
+     * best price). if the level does not exist return invalid price and qty
+     *
+     */
+    Level GetLevel(size_t level) const noexcept {
+        if (level < count_) {
+            size_t word_idx = best_ / 64;
+            uint64_t word   = occupancy_[word_idx] & (~0ULL << (best_ % 64));
+            while (true) {
+                const auto bits = static_cast<size_t>(std::popcount(word));
+                if (level < bits) {
+                    for (size_t i = 0; i < level; ++i) word &= word - 1;
+                    const auto idx =
+                        word_idx * 64 +
+                        static_cast<size_t>(std::countr_zero(word));
+                    return {PriceAt(idx), qtys_[idx]};
+                }
+                level -= bits;
+                word = occupancy_[++word_idx];
+            }
+        }
+        level -= count_;
+        if (level < far_.size()) return far_[far_.size() - 1 - level];
+        return {};
+    }
+
+    /**
+     * @brief visit levels from the best one. fn is invoked as fn(price, qty)
+     *
+     * @return amount of visited levels
+     */
+    template <class Fn>
+    size_t ForEachLevel(size_t max_levels, Fn &&fn) const {
+        size_t visited = 0;
+        for (auto idx = best_; idx < window_ && visited < max_levels;
+             idx      = NextOccupied(idx + 1)) {
+            fn(PriceAt(idx), qtys_[idx]);
+            ++visited;
+        }
+        for (auto it = far_.rbegin(); it != far_.rend() && visited < max_levels;
+             ++it) {
+            fn(it->price, it->qty);
+            ++visited;
+        }
+        return visited;
+    }
+
+  private:
+    /// Price of the index inside the window.
+    common::Price PriceAt(size_t idx) const noexcept {
+        if constexpr (kSide == common::Side::kBid)
+            return base_ - idx;
+        else
+            return base_ + idx;
+    }
+
+    /// Distance from the better edge of the window in ticks. Negative value
+    /// means the price is more aggressive than the window.
+    int64_t Offset(common::Price price) const noexcept {
+        if constexpr (kSide == common::Side::kBid)
+            return static_cast<int64_t>(base_) - static_cast<int64_t>(price);
+        else
+            return static_cast<int64_t>(price) - static_cast<int64_t>(base_);
+    }
+
+    /// Place the better edge of the window so that price lands on headroom_.
+    void CentreOn(common::Price price) noexcept {
+        if constexpr (kSide == common::Side::kBid)
+            base_ = price + headroom_;
+        else
+            base_ = price > headroom_ ? price - headroom_ : 0;
+    }
+
+    /// Move the window by delta ticks in the aggressive direction. Levels
+    /// leaving the worse edge are moved to far_, they are better than any
+    /// level already stored there.
+    void ShiftWorse(size_t delta) noexcept {
+        if constexpr (kSide == common::Side::kAsk) delta = std::min(delta, base_);
+        if (delta == 0) [[unlikely]]
+            return;
+        const auto kept = delta < window_ ? window_ - delta : 0;
+        // traverse from the worst evicted level to the best one
+        for (size_t idx = window_; idx-- > kept;) {
+            if (qtys_[idx] == 0) continue;
+            far_.push_back({PriceAt(idx), qtys_[idx]});
+            --count_;
+        }
+        if (kept) {
+            std::move_backward(qtys_.begin(), qtys_.begin() + kept,
+                               qtys_.end());
+        }
+        std::fill(qtys_.begin(), qtys_.begin() + std::min(delta, window_), 0);
+        if constexpr (kSide == common::Side::kBid)
+            base_ += delta;
+        else
+            base_ -= delta;
+        RebuildOccupancy();
+    }
+
+    /// Window became empty, move it to the best far level.
+    void PullFromFar() noexcept {
+        CentreOn(far_.back().price);
+        while (!far_.empty() &&
+               Offset(far_.back().price) < static_cast<int64_t>(window_)) {
+            const auto idx = static_cast<size_t>(Offset(far_.back().price));
+            qtys_[idx]     = far_.back().qty;
+            SetBit(idx);
+            ++count_;
+            far_.pop_back();
+        }
+        best_ = NextOccupied(0);
+    }
+
+    void RebuildOccupancy() noexcept {
+        std::fill(occupancy_.begin(), occupancy_.end(), 0);
+        for (size_t idx = 0; idx < window_; ++idx)
+            if (qtys_[idx]) SetBit(idx);
+        best_ = NextOccupied(0);
+    }
+
+    /// far_ is sorted from the worst level to the best one.
+    auto FindFar(common::Price price) noexcept {
+        return std::lower_bound(far_.begin(), far_.end(), price,
+                                [](const Level &level, common::Price p) {
+                                    return IsBetter(p, level.price);
+                                });
+    }
+
+    void UpsertFar(common::Price price, common::Qty qty) noexcept {
+        auto it = FindFar(price);
+        if (it != far_.end() && it->price == price) {
+            it->qty = qty;
+            return;
+        }
+        far_.insert(it, {price, qty});
+    }
+
+    bool EraseFar(common::Price price) noexcept {
+        auto it = FindFar(price);
+        if (it == far_.end() || it->price != price) return false;
+        far_.erase(it);
+        return true;
+    }
+
+    void SetBit(size_t idx) noexcept {
+        occupancy_[idx / 64] |= (1ULL << (idx % 64));
+    }
+
+    void ClearBit(size_t idx) noexcept {
+        occupancy_[idx / 64] &= ~(1ULL << (idx % 64));
+    }
+
+    /// First occupied index starting from idx, window_ if there is no one.
+    size_t NextOccupied(size_t idx) const noexcept {
+        if (idx >= window_) return window_;
+        size_t word_idx = idx / 64;
+        uint64_t word   = occupancy_[word_idx] & (~0ULL << (idx % 64));
+        while (!word) {
+            if (++word_idx == occupancy_.size()) return window_;
+            word = occupancy_[word_idx];
+        }
+        return word_idx * 64 + static_cast<size_t>(std::countr_zero(word));
+    }
+
+    const size_t window_;
+    const size_t headroom_;
+    /// price of index 0 (the better edge of the window)
+    common::Price base_ = 0;
+    std::vector<common::Qty> qtys_;
+    std::vector<uint64_t> occupancy_;
+    std::vector<Level> far_;
+    size_t count_ = 0;
+    /// index of the best level inside the window, window_ if the side is empty
+    size_t best_;
+};
+}  // namespace Trading
@@ -8,9 +8,11 @@
 #include "aot/common/macros.h"
 #include "aot/common/thread_utils.h"
 #include "aot/common/time_utils.h"
+#include "aot/common/wait_strategy.h"
 #include "aot/market_data/market_update.h"
 #include "aot/prometheus/event.h"
 #include "aot/strategy/base_strategy.h"
+#include "aot/strategy/inference.h"
 #include "aot/strategy/market_order_book.h"
 #include "aot/strategy/order_manager.h"
 #include "aot/strategy/position_keeper.h"
@@ -37,6 +39,13 @@ class TradeEngine {
     virtual ~TradeEngine();
     void SetStrategy(Trading::BaseStrategy* strategy){strategy_ = strategy;};
     void SetOrderManager(Trading::OrderManager* om){order_manager_ = om;};
+    /**
+     * @brief klines scored by inference::InferenceService, the engine takes
+     * actions from them and never calls the predictor itself
+     */
+    void SetPredictions(inference::PredictionLFQueue* predictions) {
+        predictions_ = predictions;
+    };
     /// Start and stop the trade engine main thread.
     auto Start() -> void {
         run_    = true;
@@ -62,6 +71,13 @@ class TradeEngine {
      * @param new_kline
      */
     virtual auto OnNewKLine(const OHLCVExt *new_kline) noexcept -> void;
+    /**
+     * @brief launch strategy actions for a kline the model has already scored
+     *
+     * @param prediction
+     */
+    virtual auto OnNewKLine(const inference::Prediction *prediction) noexcept
+        -> void;
 
     common::Delta GetDownTimeInS() const { return time_manager_.GetDeltaInS(); }
 
@@ -72,6 +88,7 @@ class TradeEngine {
         auto status_op = request_new_order_->try_enqueue(*request_new_order);
         if (!status_op) [[unlikely]]
             loge("my queue is full");
+        if (request_waiter_) request_waiter_->Notify();
     }
     auto SendRequestCancelOrder(const Exchange::RequestCancelOrder
                                     *request_cancel_order) noexcept -> void {
@@ -79,6 +96,12 @@ class TradeEngine {
             request_cancel_order_->try_enqueue(*request_cancel_order);
         if (!status_op) [[unlikely]]
             loge("my queue is full");
+        if (request_waiter_) request_waiter_->Notify();
+    }
+    /// wakes the consumer of requests after enqueue, e.g.
+    /// OrderGateway2::Waiter()
+    auto SetRequestWaiter(common::WaitStrategy *waiter) noexcept -> void {
+        request_waiter_ = waiter;
     }
 
     /// Process changes to the order book - updates the position keeper, feature
@@ -103,6 +126,7 @@ class TradeEngine {
     Exchange::RequestNewLimitOrderLFQueue *request_new_order_  = nullptr;
     Exchange::RequestCancelOrderLFQueue *request_cancel_order_ = nullptr;
     Exchange::ClientResponseLFQueue *response_                 = nullptr;
+    common::WaitStrategy *request_waiter_                      = nullptr;
     prometheus::EventLFQueue *latency_event_lfqueue_           = nullptr;
     const TradingPair trading_pair_;
     TradingPairHashMap pairs_;
@@ -123,7 +147,8 @@ class TradeEngine {
     volatile bool run_ = false;
     common::TimeManager time_manager_;
     OHLCVILFQueue *klines_ = nullptr;
-    Trading::BaseStrategy* strategy_;
+    inference::PredictionLFQueue *predictions_ = nullptr;
+    Trading::BaseStrategy* strategy_ = nullptr;
 
     /// Main loop for this thread - processes incoming client responses and
     /// market data updates which in turn may generate client requests.
@@ -148,5 +173,7 @@ class TradeEngine : public Trading::TradeEngine {
   private:
     auto Run() noexcept -> void override;
     auto OnNewKLine(const OHLCVExt *new_kline) noexcept -> void override;
+    auto OnNewKLine(const inference::Prediction *prediction) noexcept
+        -> void override;
 };
 };  // namespace backtesting
\ No newline at end of file
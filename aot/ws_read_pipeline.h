@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "aot/Logger.h"
+#include "aot/common/json_parser.h"
+#include "aot/common/thread_utils.h"
+#include "aot/common/time_utils.h"
+#include "boost/asio/post.hpp"
+#include "boost/asio/thread_pool.hpp"
+#include "boost/beast/core/flat_buffer.hpp"
+
+namespace aot {
+/**
+ * @brief where a websocket session parses the frames it has read
+ */
+enum class WsParseMode {
+    kInline,        ///< on the io_context right after async_read, the default
+    kPinnedThread,  ///< on a dedicated thread, optionally pinned to a core
+    kThreadPool     ///< on a shared boost::asio::thread_pool
+};
+
+struct WsReadPipelineOptions {
+    WsParseMode mode = WsParseMode::kInline;
+    /// number of frames the reader may be ahead of the parser, rounded up to
+    /// a power of two
+    size_t capacity  = 32;
+    /// core of the parser thread for kPinnedThread, -1 leaves it unpinned
+    int core_id      = -1;
+    /// pool for kThreadPool, it must outlive the session
+    boost::asio::thread_pool *pool = nullptr;
+};
+
+/**
+ * @brief counters of the read -> parse hand-off. Queue latency is the time a
+ * frame waits in the ring, parse latency is the time of the callbacks
+ */
+struct WsReadPipelineStats {
+    uint64_t frames          = 0;
+    /// frames read but not parsed yet
+    size_t depth             = 0;
+    size_t max_depth         = 0;
+    /// times the reader found the ring full and had to wait for the parser
+    uint64_t full_waits      = 0;
+    uint64_t queue_ns_total  = 0;
+    uint64_t queue_ns_max    = 0;
+    uint64_t parse_ns_total  = 0;
+    uint64_t parse_ns_max    = 0;
+    uint64_t AvgQueueNs() const { return frames ? queue_ns_total / frames : 0; }
+    uint64_t AvgParseNs() const { return frames ? parse_ns_total / frames : 0; }
+};
+
+/**
+ * @brief single producer single consumer ring of recycled frame buffers
+ * between the reader of a websocket session and its parser.
+ *
+ * The reader reads straight into AcquireWrite() and calls Publish(), so a
+ * frame is never copied. The parser runs the handler on the frame and clears
+ * the buffer, its capacity is kept for the next frame. The reader must not
+ * call AcquireWrite() again before Publish().
+ *
+ * The parser runs on its own thread (kPinnedThread) or as a task of a thread
+ * pool, which is scheduled only when the ring turns non-empty (kThreadPool).
+ * An idle pinned parser sleeps on an atomic and is woken by Publish() only
+ * while it sleeps.
+ */
+class WsReadPipeline {
+  public:
+    using Handler = std::function<void(boost::beast::flat_buffer &)>;
+
+    WsReadPipeline(const WsReadPipelineOptions &options, Handler handler)
+        : mode_(options.mode),
+          capacity_(std::bit_ceil(std::max<size_t>(options.capacity, 2))),
+          mask_(capacity_ - 1),
+          slots_(std::make_unique<Slot[]>(capacity_)),
+          handler_(std::move(handler)),
+          pool_(options.pool) {
+        for (size_t i = 0; i < capacity_; ++i)
+            slots_[i].buffer.reserve(common::kJsonReadBufferCapacity);
+        if (mode_ == WsParseMode::kThreadPool && !pool_) {
+            logw("kThreadPool without pool, frames are parsed on a new thread");
+            mode_ = WsParseMode::kPinnedThread;
+        }
+        if (mode_ == WsParseMode::kPinnedThread)
+            worker_ = std::jthread([this, core_id = options.core_id] {
+                if (core_id >= 0 && !common::setThreadCore(core_id))
+                    logw("can't pin ws parser to core {}", core_id);
+                RunPinned();
+            });
+    }
+    WsReadPipeline(const WsReadPipeline &)            = delete;
+    WsReadPipeline &operator=(const WsReadPipeline &) = delete;
+    ~WsReadPipeline() { Stop(); }
+
+    /// Buffer of the next frame, nullptr if the parser is capacity frames
+    /// behind.
+    boost::beast::flat_buffer *AcquireWrite() {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_) [[unlikely]] {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_) {
+                full_waits_.store(
+                    full_waits_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_].buffer;
+    }
+
+    /// Hands the frame filled after AcquireWrite() to the parser.
+    void Publish() {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        slots_[tail & mask_].read_ns = common::getCurNano();
+        tail_.store(tail + 1, std::memory_order_release);
+        cached_head_       = head_.load(std::memory_order_relaxed);
+        const size_t depth = tail + 1 - cached_head_;
+        if (depth > max_depth_.load(std::memory_order_relaxed))
+            max_depth_.store(depth, std::memory_order_relaxed);
+        // pairs with the fence of the parser going idle: either the parser
+        // sees the frame or the reader sees the parser idle
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mode_ == WsParseMode::kPinnedThread) {
+            if (sleeping_.load(std::memory_order_relaxed)) Wake();
+        } else if (!scheduled_.exchange(true, std::memory_order_acq_rel)) {
+            boost::asio::post(*pool_, [this, tasks = pool_tasks_] {
+                // a task that runs after Stop() must not touch the pipeline
+                if (tasks->fetch_add(1, std::memory_order_acq_rel) &
+                    kPoolStopped) {
+                    tasks->fetch_sub(1, std::memory_order_release);
+                    return;
+                }
+                RunScheduled();
+                tasks->fetch_sub(1, std::memory_order_release);
+            });
+        }
+    }
+
+    /// Stops the parser, frames left in the ring are dropped. The reader must
+    /// not publish after it.
+    void Stop() {
+        if (stopping_.exchange(true)) return;
+        if (mode_ == WsParseMode::kPinnedThread) {
+            Wake();
+            if (worker_.joinable()) worker_.join();
+        } else {
+            // waits only for a drain that is running: a task the pool never
+            // runs, because it was stopped or joined, is not waited for
+            pool_tasks_->fetch_or(kPoolStopped, std::memory_order_acq_rel);
+            while (pool_tasks_->load(std::memory_order_acquire) & ~kPoolStopped)
+                std::this_thread::yield();
+        }
+    }
+
+    WsReadPipelineStats Stats() const {
+        WsReadPipelineStats stats;
+        // head first, it never passes the tail loaded after it
+        const auto head      = head_.load(std::memory_order_acquire);
+        stats.depth          = tail_.load(std::memory_order_acquire) - head;
+        stats.frames         = frames_.load(std::memory_order_relaxed);
+        stats.max_depth      = max_depth_.load(std::memory_order_relaxed);
+        stats.full_waits     = full_waits_.load(std::memory_order_relaxed);
+        stats.queue_ns_total = queue_ns_total_.load(std::memory_order_relaxed);
+        stats.queue_ns_max   = queue_ns_max_.load(std::memory_order_relaxed);
+        stats.parse_ns_total = parse_ns_total_.load(std::memory_order_relaxed);
+        stats.parse_ns_max   = parse_ns_max_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    size_t Capacity() const { return capacity_; }
+    WsParseMode Mode() const { return mode_; }
+
+  private:
+    struct Slot {
+        boost::beast::flat_buffer buffer;
+        uint64_t read_ns = 0;
+    };
+    /// bit of pool_tasks_ set by Stop(), the other bits count running tasks
+    static constexpr uint32_t kPoolStopped = 1u << 31;
+
+    /// Parses everything published so far. Returns false if nothing was.
+    bool Drain() {
+        auto head       = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        if (head == tail || stopping_.load(std::memory_order_relaxed))
+            return false;
+        for (; head != tail && !stopping_.load(std::memory_order_relaxed);
+             ++head) {
+            auto &slot     = slots_[head & mask_];
+            const auto now = common::getCurNano();
+            // parsers read the message in place with simdjson
+            common::ReserveJsonPadding(slot.buffer);
+            try {
+                handler_(slot.buffer);
+            } catch (const std::exception &ex) {
+                loge("Exception while parsing ws frame: {}", ex.what());
+            }
+            const auto done     = common::getCurNano();
+            const auto queue_ns = now - slot.read_ns;
+            slot.buffer.consume(slot.buffer.size());
+            // the slot belongs to the reader after this store
+            head_.store(head + 1, std::memory_order_release);
+            Account(queue_ns, done - now);
+        }
+        return true;
+    }
+
+    void Account(uint64_t queue_ns, uint64_t parse_ns) {
+        // only the parser writes these counters
+        auto add = [](std::atomic<uint64_t> &total, std::atomic<uint64_t> &max,
+                      uint64_t value) {
+            total.store(total.load(std::memory_order_relaxed) + value,
+                        std::memory_order_relaxed);
+            if (value > max.load(std::memory_order_relaxed))
+                max.store(value, std::memory_order_relaxed);
+        };
+        add(queue_ns_total_, queue_ns_max_, queue_ns);
+        add(parse_ns_total_, parse_ns_max_, parse_ns);
+        frames_.store(frames_.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    }
+
+    void RunPinned() {
+        constexpr int kSpins = 64;
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            int spins = 0;
+            while (!Drain() && ++spins < kSpins) {
+                if (stopping_.load(std::memory_order_relaxed)) return;
+            }
+            if (spins < kSpins) continue;
+            const auto seen = wake_.load(std::memory_order_relaxed);
+            sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (Empty() && !stopping_.load(std::memory_order_relaxed))
+                wake_.wait(seen, std::memory_order_relaxed);
+            sleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void RunScheduled() {
+        do {
+            while (Drain()) {
+            }
+            scheduled_.store(false, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        } while (!Empty() && !stopping_.load(std::memory_order_relaxed) &&
+                 !scheduled_.exchange(true, std::memory_order_acq_rel));
+    }
+
+    void Wake() {
+        wake_.fetch_add(1, std::memory_order_relaxed);
+        wake_.notify_one();
+    }
+
+    bool Empty() const {
+        return head_.load(std::memory_order_relaxed) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+    WsParseMode mode_;
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    Handler handler_;
+    boost::asio::thread_pool *pool_;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> queue_ns_total_{0};
+    std::atomic<uint64_t> queue_ns_max_{0};
+    std::atomic<uint64_t> parse_ns_total_{0};
+    std::atomic<uint64_t> parse_ns_max_{0};
+
+    alignas(64) std::atomic<size_t> tail_{0};
+    /// head_ seen by the reader at the last Publish()
+    size_t cached_head_ = 0;
+    std::atomic<size_t> max_depth_{0};
+    std::atomic<uint64_t> full_waits_{0};
+
+    alignas(64) std::atomic<bool> sleeping_{false};
+    std::atomic<bool> scheduled_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint32_t> wake_{0};
+    /// shared with the tasks posted to the pool, they may outlive the pipeline
+    std::shared_ptr<std::atomic<uint32_t>> pool_tasks_ =
+        std::make_shared<std::atomic<uint32_t>>(0);
+    std::jthread worker_;
+};
+}  // namespace aot
@@ -29,7 +29,7 @@ int main() {
     // Initialize a thread pool for asynchronous tasks
     boost::asio::thread_pool thread_pool;
 
-    LogPolling log_polling(thread_pool, std::chrono::microseconds(1));
+    LogPollingThread log_polling;
 
     boost::asio::io_context io_context;
 
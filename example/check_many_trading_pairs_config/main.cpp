@@ -1,11 +1,13 @@
 #define PY_SSIZE_T_CLEAN
 #include <aot/WS.h>
 
+#include <algorithm>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "aot/Binance.h"
 #include "aot/Bybit.h"
@@ -66,7 +68,7 @@ int main(int argc, char** argv) {
     // Initialize a thread pool for asynchronous tasks
     boost::asio::thread_pool thread_pool;
 
-    LogPolling log_polling(thread_pool, std::chrono::microseconds(1));
+    LogPollingThread log_polling;
 
     boost::asio::io_context io_context_bybit;
     boost::asio::io_context io_context_binance;
@@ -339,16 +341,23 @@ int main(int argc, char** argv) {
         bid_ask_generator_futures_callback_handler_binance(
             bus, bid_ask_generator_futures_binance);
     // --------------------------Order Book
-    // Component-------------------------------- Initialize the spot order book
-    // component with its own strand and event bus
+    // Component-------------------------------- books of many pairs are
+    // spread over one strand per core
+    auto make_order_book_shards = [&thread_pool]() {
+        std::vector<decltype(boost::asio::make_strand(thread_pool))> strands;
+        for (unsigned int i = 0;
+             i < std::max(1u, std::thread::hardware_concurrency()); i++)
+            strands.push_back(boost::asio::make_strand(thread_pool));
+        return strands;
+    };
+    // Initialize the spot order book component with its own strands and
+    // event bus
     Trading::OrderBookComponent order_book_spot_component(
-        boost::asio::make_strand(thread_pool), bus, 1000,
-        common::MarketType::kSpot);
-    // Initialize the spot order book component with its own strand and event
-    // bus
+        make_order_book_shards(), bus, 1000, common::MarketType::kSpot);
+    // Initialize the futures order book component with its own strands and
+    // event bus
     Trading::OrderBookComponent order_book_futures_component(
-        boost::asio::make_strand(thread_pool), bus, 1000,
-        common::MarketType::kFutures);
+        make_order_book_shards(), bus, 1000, common::MarketType::kFutures);
     // Add an order book for Bybit's BTC/USDT trading pair
     for (const auto& [ignored1, ignored2, trading_pair] : pairs_bybit) {
         order_book_spot_component.AddOrderBook(common::ExchangeId::kBybit,
@@ -0,0 +1,142 @@
+#include <toml++/toml.hpp>
+
+#include <csignal>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aot/Logger.h"
+#include "aot/simulator/binance_protocol.h"
+#include "aot/simulator/bybit_protocol.h"
+#include "aot/simulator/server.h"
+
+/**
+ * @brief runs a local exchange with synthetic markets. Point an
+ * EndpointManager at it with SetEndpoint.
+ *
+ * [simulator]
+ * exchange = "binance"       # or "bybit"
+ * host = "127.0.0.1"
+ * port = 8443
+ * seed = 1
+ * tick_interval_ms = 100
+ * steps_per_tick = 10
+ * api_key = "key"
+ * secret_key = "secret"
+ * cert = "cert.pem"          # optional, self-signed if cert or key is absent
+ * key = "key.pem"
+ *
+ * [simulator.faults]
+ * latency_us = 500
+ * jitter_us = 200
+ * loss = 0.01
+ * gap = 0.001
+ * gap_ids = 10
+ *
+ * [[simulator.symbols]]
+ * name = "BTCUSDT"
+ * price_precision = 2
+ * qty_precision = 5
+ * mid = 6000000              # scaled by the price precision
+ * tick = 1
+ */
+int main(int argc, char** argv) {
+    using namespace std::literals;
+    if (argc < 2) {
+        fmt::print("usage: {} simulator.toml\n", argv[0]);
+        return 1;
+    }
+    toml::table config;
+    try {
+        config = toml::parse_file(argv[1]);
+    } catch (const toml::parse_error& e) {
+        loge("can't parse file=\"{}\": {}", argv[1], e.description());
+        fmtlog::poll();
+        return 1;
+    }
+    auto section    = config["simulator"];
+    const auto seed = section["seed"].value_or(uint64_t{1});
+
+    simulator::Keys keys{
+        std::string(section["api_key"].value_or(""sv)),
+        std::string(section["secret_key"].value_or(""sv))};
+    std::unique_ptr<simulator::ProtocolI> protocol;
+    const auto exchange = section["exchange"].value_or("binance"sv);
+    if (exchange == "binance") {
+        protocol = std::make_unique<simulator::BinanceProtocol>(keys);
+    } else if (exchange == "bybit") {
+        protocol = std::make_unique<simulator::BybitProtocol>(keys);
+    } else {
+        loge("unknown exchange={}", exchange);
+        fmtlog::poll();
+        return 1;
+    }
+
+    simulator::Markets markets;
+    std::vector<simulator::SyntheticFlow> flows;
+    if (auto* symbols = section["symbols"].as_array()) {
+        flows.reserve(symbols->size());
+        for (auto& node : *symbols) {
+            toml::node_view<toml::node> symbol{node};
+            const auto name  = std::string(symbol["name"].value_or(""sv));
+            auto [market, _] = markets.try_emplace(
+                name, simulator::Market{
+                          simulator::MatchingEngine(name),
+                          symbol["price_precision"].value_or(uint8_t{2}),
+                          symbol["qty_precision"].value_or(uint8_t{5})});
+            simulator::SyntheticFlow::Options flow;
+            flow.mid  = symbol["mid"].value_or(common::Price{0});
+            flow.tick = symbol["tick"].value_or(common::Price{1});
+            flow.seed = seed + flows.size();
+            flows.emplace_back(market->second.engine, flow);
+        }
+    }
+    if (markets.empty()) {
+        loge("no [[simulator.symbols]] in file=\"{}\"", argv[1]);
+        fmtlog::poll();
+        return 1;
+    }
+
+    simulator::Server::Options options;
+    options.address = section["host"].value_or("127.0.0.1"sv);
+    options.port    = section["port"].value_or(uint16_t{0});
+    options.tick_interval =
+        std::chrono::milliseconds(section["tick_interval_ms"].value_or(100));
+    options.steps_per_tick =
+        section["steps_per_tick"].value_or(options.steps_per_tick);
+
+    auto faults = section["faults"];
+    options.faults.latency =
+        std::chrono::microseconds(faults["latency_us"].value_or(int64_t{0}));
+    options.faults.jitter =
+        std::chrono::microseconds(faults["jitter_us"].value_or(int64_t{0}));
+    options.faults.loss    = faults["loss"].value_or(0.0);
+    options.faults.gap     = faults["gap"].value_or(0.0);
+    options.faults.gap_ids = faults["gap_ids"].value_or(uint64_t{10});
+    options.faults.seed    = seed;
+
+    auto ssl = simulator::MakeSelfSignedContext();
+    if (auto cert = section["cert"].value<std::string>(),
+        key       = section["key"].value<std::string>();
+        cert && key) {
+        ssl = boost::asio::ssl::context(boost::asio::ssl::context::tls_server);
+        ssl.use_certificate_chain_file(*cert);
+        ssl.use_private_key_file(*key, boost::asio::ssl::context::pem);
+    }
+
+    boost::asio::io_context ioc;
+    simulator::Server server(ioc, ssl, *protocol, markets, flows, options);
+    server.Start();
+    boost::asio::signal_set signals(ioc, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int) {
+        server.Stop();
+        ioc.stop();
+    });
+    logi("{} simulator listens on {}:{}", exchange, options.address,
+         server.Port());
+    fmtlog::poll();
+    ioc.run();
+    fmtlog::poll();
+    return 0;
+}
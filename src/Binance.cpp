@@ -5,6 +5,7 @@
 #include <unordered_set>
 
 #include "aot/Logger.h"
+#include "aot/common/fixed_point.h"
 #include "nlohmann/json.hpp"
 
 using namespace std::literals;
@@ -45,42 +46,34 @@ binance::detail::FamilyBookSnapshot::ParserResponse::Parse(
     // NEED ADD EXCHANGE ID FIELD
     logi("{}", response);
     Exchange::BookSnapshot book_snapshot;
-    simdjson::ondemand::parser parser;
     if (!trading_pairs_.count(trading_pair)) {
         logw("no existing registered {} trading pair info",
              trading_pair.ToString());
         return book_snapshot;
     }
     auto& pair_info = trading_pairs_[trading_pair];
-    simdjson::padded_string my_padded_data(response.data(), response.size());
-    simdjson::ondemand::document doc = parser.iterate(my_padded_data);
+    simdjson::ondemand::document doc = parser_.Iterate(response);
     try {
         book_snapshot.lastUpdateId = doc["lastUpdateId"].get_uint64();
-        auto price_prec            = std::pow(10, pair_info.price_precission);
-        auto qty_prec              = std::pow(10, pair_info.qty_precission);
+        common::Price price;
+        common::Qty qty;
         for (auto all : doc["bids"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;  // price + qty
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info.price_precission,
+                    pair_info.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid bid level in snapshot");
+                continue;
             }
-            book_snapshot.bids.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_snapshot.bids.emplace_back(price, qty);
         }
         for (auto all : doc["asks"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;  // price + qty
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info.price_precission,
+                    pair_info.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid ask level in snapshot");
+                continue;
             }
-            book_snapshot.asks.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_snapshot.asks.emplace_back(price, qty);
         }
     } catch (simdjson::simdjson_error& error) {
         loge("JSON error in FamilyBookSnapshot response: {}", error.what());
@@ -94,9 +87,7 @@ Exchange::MEClientResponse
 binance::detail::FamilyLimitOrder::ParserResponse::Parse(
     std::string_view response) {
     Exchange::MEClientResponse output;
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string my_padded_data(response.data(), response.size());
-    simdjson::ondemand::document doc = parser.iterate(my_padded_data);
+    simdjson::ondemand::document doc = parser_.Iterate(response);
     try {
         // Helper function to get a string view from the document
         auto getStringView = [&](const char* key, std::string_view& value) {
@@ -128,25 +119,26 @@ binance::detail::FamilyLimitOrder::ParserResponse::Parse(
         if (!success_status.contains(status)) return {};
 
         // Handling price based on status
-        double price = 0;
+        const auto& pair_info = pairs_[output.trading_pair];
+        auto get_fixed_point  = [&](const char* key, uint8_t precision,
+                                   uint64_t& value) -> bool {
+            std::string_view str;
+            if (doc[key].get_string().get(str) != simdjson::SUCCESS)
+                return false;
+            return common::ParseFixedPoint(str, precision, value);
+        };
 
         if (status == "NEW"sv) {
             output.type = Exchange::ClientResponseType::ACCEPTED;
-            if (doc["price"].get_double_in_string().get(price) !=
-                simdjson::SUCCESS)
+            if (!get_fixed_point("price", pair_info.price_precission,
+                                 output.price))
                 return {};
-            output.price = static_cast<common::Price>(
-                price *
-                std::pow(10, pairs_[output.trading_pair].price_precission));
 
         } else if (status == "PARTIALLY_FILLED"sv || status == "FILLED"sv) {
             output.type = Exchange::ClientResponseType::FILLED;
-            if (doc["cummulativeQuoteQty"].get_double_in_string().get(price) !=
-                simdjson::SUCCESS)
+            if (!get_fixed_point("cummulativeQuoteQty",
+                                 pair_info.price_precission, output.price))
                 return {};
-            output.price = static_cast<common::Price>(
-                price *
-                std::pow(10, pairs_[output.trading_pair].price_precission));
         }
 
         // Handling side
@@ -158,21 +150,16 @@ binance::detail::FamilyLimitOrder::ParserResponse::Parse(
         }
 
         // Getting executed quantity
-        double executed_qty = 0;
-        if (doc["executedQty"].get_double_in_string().get(executed_qty) !=
-            simdjson::SUCCESS)
+        common::Qty executed_qty = 0;
+        if (!get_fixed_point("executedQty", pair_info.qty_precission,
+                             executed_qty))
             return {};
-        output.exec_qty = static_cast<common::Qty>(
-            executed_qty *
-            std::pow(10, pairs_[output.trading_pair].qty_precission));
+        output.exec_qty = executed_qty;
 
         // Getting original quantity and calculating leaves quantity
-        double orig_qty;
-        if (doc["origQty"].get_double_in_string().get(orig_qty) ==
-            simdjson::SUCCESS) {
-            output.leaves_qty = static_cast<common::Qty>(
-                (orig_qty - executed_qty) *
-                std::pow(10, pairs_[output.trading_pair].qty_precission));
+        common::Qty orig_qty;
+        if (get_fixed_point("origQty", pair_info.qty_precission, orig_qty)) {
+            output.leaves_qty = orig_qty - executed_qty;
         } else {
             loge("no key origQty in response");
         }
@@ -188,9 +175,7 @@ Exchange::MEClientResponse
 binance::detail::FamilyCancelOrder::ParserResponse::Parse(
     std::string_view response) {
     Exchange::MEClientResponse output;
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string my_padded_data(response.data(), response.size());
-    simdjson::ondemand::document doc = parser.iterate(my_padded_data);
+    simdjson::ondemand::document doc = parser_.Iterate(response);
 
     try {
         // Retrieve order ID
@@ -235,9 +220,7 @@ Exchange::BookDiffSnapshot
 binance::detail::FamilyBookEventGetter::ParserResponse::Parse(
     std::string_view response) {
     Exchange::BookDiffSnapshot book_diff_snapshot;
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string my_padded_data(response.data(), response.size());
-    simdjson::ondemand::document doc = parser.iterate(my_padded_data);
+    simdjson::ondemand::document doc = parser_.Iterate(response);
     try {
         book_diff_snapshot.first_id = doc["U"].get_uint64();
         book_diff_snapshot.last_id  = doc["u"].get_uint64();
@@ -269,33 +252,26 @@ binance::detail::FamilyBookEventGetter::ParserResponse::Parse(
             loge("pairs_reverse not contain {}", trading_pair);
             return {};
         }
-        auto price_prec = std::pow(
-            10, pairs_[book_diff_snapshot.trading_pair].price_precission);
-        auto qty_prec = std::pow(
-            10, pairs_[book_diff_snapshot.trading_pair].qty_precission);
+        const auto& pair_info = pairs_[book_diff_snapshot.trading_pair];
+        common::Price price;
+        common::Qty qty;
         for (auto all : doc["b"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info.price_precission,
+                    pair_info.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid bid level in diff");
+                continue;
             }
-            book_diff_snapshot.bids.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_diff_snapshot.bids.emplace_back(price, qty);
         }
         for (auto all : doc["a"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info.price_precission,
+                    pair_info.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid ask level in diff");
+                continue;
             }
-            book_diff_snapshot.asks.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_diff_snapshot.asks.emplace_back(price, qty);
         }
     } catch (const simdjson::simdjson_error& error) {
         loge("JSON error: {}", error.what());
@@ -357,38 +333,31 @@ binance::detail::FamilyBookEventGetter::ParserResponse::Parse(
             return {};  // Early return if trading pair is not found
         }
 
-        // Calculate price and quantity precision
-        auto price_prec = std::pow(
-            10, pairs_[book_diff_snapshot.trading_pair].price_precission);
-        auto qty_prec = std::pow(
-            10, pairs_[book_diff_snapshot.trading_pair].qty_precission);
+        // Price and qty are converted to fixed point by precision of the pair
+        const auto& pair_info = pairs_[book_diff_snapshot.trading_pair];
+        common::Price price;
+        common::Qty qty;
 
         // Parse bids from the document and store them in the snapshot
         for (auto all : doc["b"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info.price_precission,
+                    pair_info.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid bid level in diff");
+                continue;
             }
-            book_diff_snapshot.bids.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_diff_snapshot.bids.emplace_back(price, qty);
         }
 
         // Parse asks from the document and store them in the snapshot
         for (auto all : doc["a"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info.price_precission,
+                    pair_info.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid ask level in diff");
+                continue;
             }
-            book_diff_snapshot.asks.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_diff_snapshot.asks.emplace_back(price, qty);
         }
 
     } catch (const simdjson::simdjson_error& error) {
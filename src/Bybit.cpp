@@ -1,4 +1,3 @@
-#include <list>
 #include <string_view>
 #include <unordered_set>
 
@@ -7,6 +6,7 @@
 
 #include "aot/Logger.h"
 #include "aot/Bybit.h"
+#include "aot/common/fixed_point.h"
 #include "aot/market_data/market_update.h"
 
 std::string bybit::ArgsBody::Body() {
@@ -30,36 +30,28 @@ Exchange::BookSnapshot bybit::detail::FamilyBookSnapshot::ParserResponse::Parse(
     std::string_view response) {
     // NEED ADD EXCHANGE ID FIELD
     Exchange::BookSnapshot book_snapshot;
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string my_padded_data(response.data(), response.size());
-    simdjson::ondemand::document doc = parser.iterate(my_padded_data);
+    simdjson::ondemand::document doc = parser_.Iterate(response);
     try {
         book_snapshot.lastUpdateId = doc["lastUpdateId"].get_uint64();
-        auto price_prec            = std::pow(10, pair_info_.price_precission);
-        auto qty_prec              = std::pow(10, pair_info_.qty_precission);
+        common::Price price;
+        common::Qty qty;
         for (auto all : doc["bids"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;  // price + qty
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info_.price_precission,
+                    pair_info_.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid bid level in snapshot");
+                continue;
             }
-            book_snapshot.bids.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_snapshot.bids.emplace_back(price, qty);
         }
         for (auto all : doc["asks"]) {
-            simdjson::ondemand::array arr = all.get_array();
-            std::array<double, 2> pair;  // price + qty
-            uint8_t i = 0;
-            for (auto number : arr) {
-                pair[i] = number.get_double_in_string();
-                i++;
+            if (!common::ParseFixedPointLevel(
+                    all.get_array(), pair_info_.price_precission,
+                    pair_info_.qty_precission, price, qty)) [[unlikely]] {
+                logw("invalid ask level in snapshot");
+                continue;
             }
-            book_snapshot.asks.emplace_back(
-                static_cast<int>(pair[0] * price_prec),
-                static_cast<int>(pair[1] * qty_prec));
+            book_snapshot.asks.emplace_back(price, qty);
         }
     } catch (simdjson::simdjson_error& error) {
         loge("JSON error in FamilyBookSnapshot response: {}", error.what());
@@ -86,9 +78,7 @@ bybit::detail::FamilyBookEventGetter::ParserResponse::Parse(
     bybit::detail::FamilyBookEventGetter::ParserResponse::ResponseVariant out;
     Exchange::BookDiffSnapshot book_diff_snapshot;
     Exchange::BookSnapshot book_snapshot;
-    simdjson::ondemand::parser parser;
-    simdjson::padded_string my_padded_data(response.data(), response.size());
-    simdjson::ondemand::document doc = parser.iterate(my_padded_data);
+    simdjson::ondemand::document doc = parser_.Iterate(response);
     std::string_view type;
     try {
         if (doc.find_field_unordered("data").error() != simdjson::SUCCESS) {
@@ -146,85 +136,37 @@ bybit::detail::FamilyBookEventGetter::ParserResponse::Parse(
 
         auto is_snapshot = IsSnapshot(type);
         auto is_diff = IsDelta(type);
-        std::list<Exchange::BookSnapshotElem> bids;
-        std::list<Exchange::BookSnapshotElem> asks;
+        Exchange::BookLevels bids;
+        Exchange::BookLevels asks;
 //------------------------
-        auto price_prec = std::pow(
-            10, pairs_[trading_pair].price_precission);
-        auto qty_prec = std::pow(
-            10, pairs_[trading_pair].qty_precission);
+        const auto& pair_info = pairs_[trading_pair];
+        common::Price price;
+        common::Qty qty;
         if (data["b"].error() == simdjson::SUCCESS) {
-
             for (auto all : data["b"]) {
-                simdjson::ondemand::array arr = all.get_array();
-                std::array<double, 2> pair;
-                uint8_t i = 0;
-                for (auto number : arr) {
-                    if (i >= 2){
-                        logw("Ensure no out-of-bounds access");
-                        break;
-                    }
-                    auto num_result = number.get_double_in_string();
-                    if (num_result.error() == simdjson::SUCCESS) {
-                        pair[i] = num_result.value();
-                        i++;
-                    } else {
-                        // Handle invalid number format (log or skip)
-                        break;
-                    }
-                }
-                if (i == 2) { // Ensure we have both price and quantity
-                    bids.emplace_back(
-                        static_cast<int>(pair[0] * price_prec),
-                        static_cast<int>(pair[1] * qty_prec));
+                if (common::ParseFixedPointLevel(
+                        all.get_array(), pair_info.price_precission,
+                        pair_info.qty_precission, price, qty)) [[likely]] {
+                    bids.emplace_back(price, qty);
                 } else {
                     logw("pair is incomplete");
-                    // Handle case where pair is incomplete
                 }
             }
         } else {
             logw("missing 'b' in responce");
-            // Handle missing or invalid "a"
-            // Log or handle accordingly
         }
         if (data["a"].error() == simdjson::SUCCESS) {
             for (auto all : data["a"]) {
-                auto arr_result = all.get_array();
-                if (arr_result.error() == simdjson::SUCCESS) {
-                    simdjson::ondemand::array arr = arr_result.value();
-                    std::array<double, 2> pair;
-                    uint8_t i = 0;
-
-                    for (auto number : arr) {
-                        if (i >= 2) break; // Ensure no out-of-bounds access
-                        auto num_result = number.get_double_in_string();
-                        if (num_result.error() == simdjson::SUCCESS) {
-                            pair[i] = num_result.value();
-                            i++;
-                        } else {
-                            // Handle invalid number format (log or skip)
-                            break;
-                        }
-                    }
-
-                    if (i == 2) { // Ensure we have both price and quantity
-                        asks.emplace_back(
-                            static_cast<int>(pair[0] * price_prec),
-                            static_cast<int>(pair[1] * qty_prec));
-                    } else {
-                        logw("pair is incomplete");
-                        // Handle case where pair is incomplete
-                        // Log or handle accordingly
-                    }
+                if (common::ParseFixedPointLevel(
+                        all.get_array(), pair_info.price_precission,
+                        pair_info.qty_precission, price, qty)) [[likely]] {
+                    asks.emplace_back(price, qty);
                 } else {
-                    // Handle invalid array in "a"
-                    // Log or handle accordingly
+                    logw("pair is incomplete");
                 }
             }
         } else {
             logw("missing 'a' in responce");
-            // Handle missing or invalid "a"
-            // Log or handle accordingly
         }
 //-----------------------------------------------------------------
         if(is_snapshot){
@@ -233,14 +175,14 @@ bybit::detail::FamilyBookEventGetter::ParserResponse::Parse(
             book_snapshot.bids = std::move(bids);
             book_snapshot.asks = std::move(asks);
             book_snapshot.exchange_id = common::ExchangeId::kBybit;
-            out = book_snapshot;
+            out = std::move(book_snapshot);
         } else if(is_diff){
             book_diff_snapshot.trading_pair = trading_pair;
             book_diff_snapshot.last_id = data["u"].get_uint64();
             book_diff_snapshot.bids = std::move(bids);
             book_diff_snapshot.asks = std::move(asks);
             book_diff_snapshot.exchange_id = common::ExchangeId::kBybit;
-            out = book_diff_snapshot;
+            out = std::move(book_diff_snapshot);
         }
     } catch (const simdjson::simdjson_error& error) {
         loge("JSON error: {}", error.what());
@@ -311,85 +253,37 @@ bybit::detail::FamilyBookEventGetter::ParserResponse::Parse(
 
         auto is_snapshot = IsSnapshot(type);
         auto is_diff = IsDelta(type);
-        std::list<Exchange::BookSnapshotElem> bids;
-        std::list<Exchange::BookSnapshotElem> asks;
+        Exchange::BookLevels bids;
+        Exchange::BookLevels asks;
 //------------------------
-        auto price_prec = std::pow(
-            10, pairs_[trading_pair].price_precission);
-        auto qty_prec = std::pow(
-            10, pairs_[trading_pair].qty_precission);
+        const auto& pair_info = pairs_[trading_pair];
+        common::Price price;
+        common::Qty qty;
         if (data["b"].error() == simdjson::SUCCESS) {
-
             for (auto all : data["b"]) {
-                simdjson::ondemand::array arr = all.get_array();
-                std::array<double, 2> pair;
-                uint8_t i = 0;
-                for (auto number : arr) {
-                    if (i >= 2){
-                        logw("Ensure no out-of-bounds access");
-                        break;
-                    }
-                    auto num_result = number.get_double_in_string();
-                    if (num_result.error() == simdjson::SUCCESS) {
-                        pair[i] = num_result.value();
-                        i++;
-                    } else {
-                        // Handle invalid number format (log or skip)
-                        break;
-                    }
-                }
-                if (i == 2) { // Ensure we have both price and quantity
-                    bids.emplace_back(
-                        static_cast<int>(pair[0] * price_prec),
-                        static_cast<int>(pair[1] * qty_prec));
+                if (common::ParseFixedPointLevel(
+                        all.get_array(), pair_info.price_precission,
+                        pair_info.qty_precission, price, qty)) [[likely]] {
+                    bids.emplace_back(price, qty);
                 } else {
                     logw("pair is incomplete");
-                    // Handle case where pair is incomplete
                 }
             }
         } else {
             logw("missing 'b' in responce");
-            // Handle missing or invalid "a"
-            // Log or handle accordingly
         }
         if (data["a"].error() == simdjson::SUCCESS) {
             for (auto all : data["a"]) {
-                auto arr_result = all.get_array();
-                if (arr_result.error() == simdjson::SUCCESS) {
-                    simdjson::ondemand::array arr = arr_result.value();
-                    std::array<double, 2> pair;
-                    uint8_t i = 0;
-
-                    for (auto number : arr) {
-                        if (i >= 2) break; // Ensure no out-of-bounds access
-                        auto num_result = number.get_double_in_string();
-                        if (num_result.error() == simdjson::SUCCESS) {
-                            pair[i] = num_result.value();
-                            i++;
-                        } else {
-                            // Handle invalid number format (log or skip)
-                            break;
-                        }
-                    }
-
-                    if (i == 2) { // Ensure we have both price and quantity
-                        asks.emplace_back(
-                            static_cast<int>(pair[0] * price_prec),
-                            static_cast<int>(pair[1] * qty_prec));
-                    } else {
-                        logw("pair is incomplete");
-                        // Handle case where pair is incomplete
-                        // Log or handle accordingly
-                    }
+                if (common::ParseFixedPointLevel(
+                        all.get_array(), pair_info.price_precission,
+                        pair_info.qty_precission, price, qty)) [[likely]] {
+                    asks.emplace_back(price, qty);
                 } else {
-                    // Handle invalid array in "a"
-                    // Log or handle accordingly
+                    logw("pair is incomplete");
                 }
             }
         } else {
             logw("missing 'a' in responce");
-            // Handle missing or invalid "a"
-            // Log or handle accordingly
         }
 //-----------------------------------------------------------------
         if(is_snapshot){
@@ -398,14 +292,14 @@ bybit::detail::FamilyBookEventGetter::ParserResponse::Parse(
             book_snapshot.bids = std::move(bids);
             book_snapshot.asks = std::move(asks);
             book_snapshot.exchange_id = common::ExchangeId::kBybit;
-            out = book_snapshot;
+            out = std::move(book_snapshot);
         } else if(is_diff){
             book_diff_snapshot.trading_pair = trading_pair;
             book_diff_snapshot.last_id = data["u"].get_uint64();
             book_diff_snapshot.bids = std::move(bids);
             book_diff_snapshot.asks = std::move(asks);
             book_diff_snapshot.exchange_id = common::ExchangeId::kBybit;
-            out = book_diff_snapshot;
+            out = std::move(book_diff_snapshot);
         }
     } catch (const simdjson::simdjson_error& error) {
         loge("JSON error: {}", error.what());
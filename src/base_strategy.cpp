@@ -34,6 +34,13 @@ auto Trading::BaseStrategy::OnNewKLine(const OHLCVExt *new_kline) noexcept
                                    // actions_size()
 }
 
+auto Trading::BaseStrategy::OnNewKLine(
+    const inference::Prediction *prediction) noexcept -> void {
+    logd("{} score:{}", prediction->kline.trading_pair.ToString(),
+         prediction->score);
+    actions_[(int)prediction->action](prediction->kline.trading_pair);
+}
+
 strategy::cross_arbitrage::CrossArbitrage::CrossArbitrage(
     std::unordered_map<common::ExchangeId, common::TradingPair> &working_pairs,
     std::list<common::ExchangeId> &exchanges,
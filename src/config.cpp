@@ -50,4 +50,30 @@ config::IApiKey::Answer config::ApiSecretKey::SecretKey() {
     if(status)
         logw("can't found {} in section:{} config file", kSecretKey, kExchangeField);
     return {!status, path};
-}
\ No newline at end of file
+}
+config::WaitStrategies::WaitStrategies(std::string_view path_to_toml) {
+    try {
+        config = (toml::parse_file(path_to_toml));
+    } catch (...) {
+        loge("can't open file=\"{}\"", path_to_toml);
+    }
+}
+
+common::WaitStrategy::Options config::WaitStrategies::WaitStrategy(
+    std::string_view service) {
+    common::WaitStrategy::Options options;
+    auto section = config[kWaitStrategyField][service];
+    if (!section) return options;
+
+    auto name   = section[kPolicy].value_or("busy_spin"sv);
+    auto policy = common::WaitPolicyFromString(name);
+    if (!policy) {
+        logw("unknown {}={} of {}. use busy_spin", kPolicy, name, service);
+        return options;
+    }
+    options.policy = *policy;
+    options.spins  = section[kSpins].value_or(options.spins);
+    options.park_timeout = std::chrono::microseconds(
+        section[kParkTimeoutUs].value_or(options.park_timeout.count()));
+    return options;
+}
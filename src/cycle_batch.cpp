@@ -0,0 +1,124 @@
+#include "aot/strategy/arbitrage/cycle_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AOT_CYCLE_BATCH_X86 1
+#endif
+
+namespace aot {
+bool CycleBatch::HasAvx2() {
+#ifdef AOT_CYCLE_BATCH_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+#else
+    return false;
+#endif
+}
+
+void CycleBatch::Evaluate(InstrumentId instrument,
+                          const CycleThresholds& thresholds, Kernel kernel) {
+    begin_ = 0;
+    size_  = 0;
+    if (instrument + 1 < offsets_.size()) {
+        begin_ = offsets_[instrument];
+        size_  = offsets_[instrument + 1] - begin_;
+    }
+    words_ = (size_ + kBitsPerWord - 1) / kBitsPerWord;
+    masks_.assign(kMasks * words_, 0);
+
+    if (kernel == Kernel::kAuto)
+        kernel = HasAvx2() ? Kernel::kAvx2 : Kernel::kScalar;
+    size_t first = 0;
+    if (kernel == Kernel::kAvx2 && HasAvx2()) first = EvaluateAvx2(thresholds);
+    EvaluateScalar(thresholds, first);
+}
+
+void CycleBatch::EvaluateScalar(const CycleThresholds& thresholds,
+                                size_t first) {
+    for (size_t lane = first; lane < size_; ++lane) {
+        const size_t i          = begin_ + lane;
+        const auto id           = lane_cycles_[i];
+        const double buy_ask    = ask_[lane_buy_[i]];
+        const double buy_bid    = bid_[lane_buy_[i]];
+        const double sell_bid   = bid_[lane_sell_[i]];
+        const double sell_ask   = ask_[lane_sell_[i]];
+        // NaN of an invalid price fails every comparison
+        const bool valid        = buy_ask == buy_ask && buy_bid == buy_bid &&
+                                  sell_bid == sell_bid &&
+                                  sell_ask == sell_ask &&
+                                  status_[id] != kNotReady;
+        const bool opened       = status_[id] == kOpened;
+        const bool can_open     = valid && !opened && sell_bid > buy_ask;
+        const double entry_buy  = can_open ? buy_ask : entry_buy_[id];
+        const double entry_sell = can_open ? sell_bid : entry_sell_[id];
+        const double percent =
+            ((buy_bid - entry_buy) + (entry_sell - sell_ask)) / entry_buy *
+            100.0;
+        const bool active = valid && (opened || can_open);
+        SetLane(kOpen, lane, can_open);
+        SetLane(kTakeProfit, lane,
+                active && percent >= thresholds.take_profit_percent);
+        SetLane(kStopLoss, lane,
+                active && percent <= thresholds.stop_loss_percent);
+        SetLane(kAct, lane, active);
+    }
+}
+
+#ifdef AOT_CYCLE_BATCH_X86
+__attribute__((target("avx2"))) size_t CycleBatch::EvaluateAvx2(
+    const CycleThresholds& thresholds) {
+    const __m256d hundred     = _mm256_set1_pd(100.0);
+    const __m256d not_ready   = _mm256_set1_pd(kNotReady);
+    const __m256d opened_flag = _mm256_set1_pd(kOpened);
+    const __m256d take_profit = _mm256_set1_pd(thresholds.take_profit_percent);
+    const __m256d stop_loss   = _mm256_set1_pd(thresholds.stop_loss_percent);
+    const size_t groups       = size_ / kLanesPerGroup;
+    for (size_t group = 0; group < groups; ++group) {
+        const size_t lane = group * kLanesPerGroup;
+        const size_t i    = begin_ + lane;
+        const __m128i ids = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(lane_cycles_.data() + i));
+        const __m128i buys = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(lane_buy_.data() + i));
+        const __m128i sells = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(lane_sell_.data() + i));
+        const __m256d buy_ask  = _mm256_i32gather_pd(ask_.data(), buys, 8);
+        const __m256d buy_bid  = _mm256_i32gather_pd(bid_.data(), buys, 8);
+        const __m256d sell_bid = _mm256_i32gather_pd(bid_.data(), sells, 8);
+        const __m256d sell_ask = _mm256_i32gather_pd(ask_.data(), sells, 8);
+        const __m256d status   = _mm256_i32gather_pd(status_.data(), ids, 8);
+        const __m256d valid    = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(buy_ask, buy_bid, _CMP_ORD_Q),
+                          _mm256_cmp_pd(sell_bid, sell_ask, _CMP_ORD_Q)),
+            _mm256_cmp_pd(status, not_ready, _CMP_NEQ_OQ));
+        const __m256d opened = _mm256_cmp_pd(status, opened_flag, _CMP_EQ_OQ);
+        const __m256d can_open = _mm256_andnot_pd(
+            opened, _mm256_and_pd(valid, _mm256_cmp_pd(sell_bid, buy_ask,
+                                                       _CMP_GT_OQ)));
+        const __m256d entry_buy = _mm256_blendv_pd(
+            _mm256_i32gather_pd(entry_buy_.data(), ids, 8), buy_ask, can_open);
+        const __m256d entry_sell = _mm256_blendv_pd(
+            _mm256_i32gather_pd(entry_sell_.data(), ids, 8), sell_bid,
+            can_open);
+        const __m256d percent = _mm256_mul_pd(
+            _mm256_div_pd(_mm256_add_pd(_mm256_sub_pd(buy_bid, entry_buy),
+                                        _mm256_sub_pd(entry_sell, sell_ask)),
+                          entry_buy),
+            hundred);
+        const __m256d active =
+            _mm256_and_pd(valid, _mm256_or_pd(opened, can_open));
+        SetLane(kOpen, lane, _mm256_movemask_pd(can_open));
+        SetLane(kTakeProfit, lane,
+                _mm256_movemask_pd(_mm256_and_pd(
+                    active, _mm256_cmp_pd(percent, take_profit, _CMP_GE_OQ))));
+        SetLane(kStopLoss, lane,
+                _mm256_movemask_pd(_mm256_and_pd(
+                    active, _mm256_cmp_pd(percent, stop_loss, _CMP_LE_OQ))));
+        SetLane(kAct, lane, _mm256_movemask_pd(active));
+    }
+    return groups * kLanesPerGroup;
+}
+#else
+size_t CycleBatch::EvaluateAvx2(const CycleThresholds&) { return 0; }
+#endif
+};  // namespace aot
@@ -0,0 +1,54 @@
+#include "aot/strategy/flat_market_order_book.h"
+
+#include "aot/Logger.h"
+
+namespace Trading {
+
+/// Process market data update and update the limit order book.
+void FlatMarketOrderBook::OnMarketUpdate(
+    const Exchange::MEMarketUpdate2 *market_update) noexcept {
+    if (!market_update) [[unlikely]] {
+        loge("Received null market update");
+        return;
+    }
+    if (market_update->type == Exchange::MarketUpdateType::CLEAR)
+        [[unlikely]] {
+        ClearOrderBook();
+        UpdateBBO();
+        return;
+    }
+    AddOrRemove(market_update->side, market_update->price,
+                market_update->qty);
+    UpdateBBO();
+}
+
+/// Process market data snapsot and update the limit order book.
+void FlatMarketOrderBook::OnMarketUpdate(
+    const Exchange::BookSnapshot2 *market_snapshot) noexcept {
+    if (!market_snapshot) [[unlikely]] {
+        loge("Received null market snapshot");
+        return;
+    }
+
+    ClearOrderBook();
+    bids_.Assign(market_snapshot->bids);
+    asks_.Assign(market_snapshot->asks);
+
+    logi("[FLAT ORDER BOOK] snapshot applied {} bids:{} asks:{}",
+         trading_pair_.ToString(), bids_.Size(), asks_.Size());
+    UpdateBBO();
+}
+
+/// Process market data diff and update the limit order book.
+void FlatMarketOrderBook::OnMarketUpdate(
+    const Exchange::BookDiffSnapshot2 *market_diff) noexcept {
+    if (!market_diff) [[unlikely]] {
+        loge("Received null market diff");
+        return;
+    }
+
+    for (const auto &bid : market_diff->bids) bids_.Set(bid.price, bid.qty);
+    for (const auto &ask : market_diff->asks) asks_.Set(ask.price, ask.qty);
+    UpdateBBO();
+}
+}  // namespace Trading
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "aot/Logger.h"
+#include "aot/hot_log.h"
 #include "aot/strategy/trade_engine.h"
 
 // #include "trade_engine.h"
@@ -69,6 +70,11 @@ void OrderBookService::Run() {
         for (uint i = 0; i < count; i++) [[likely]] {
             ob_->OnMarketUpdate(&results[i]);
         }
+        if (count) {
+            wait_.Busy();
+            continue;
+        }
+        wait_.Idle([this] { return !run_ || queue_->size_approx(); });
     }
 }
 
@@ -86,7 +92,7 @@ void MarketOrderBook2::OnMarketUpdate(
              market_update->side == common::Side::kBid &&
              market_update->price >= bids_at_price_map_.begin()->price_);
     if(bid_will_be_updated){
-        logi("bids_at_price_map_size:{} {} price:{} cur_best_bid:{}", bids_at_price_map_.size(),
+        hlogd(kOrderBook, "bids_at_price_map_size:{} {} price:{} cur_best_bid:{}", bids_at_price_map_.size(),
         market_update->side,
         market_update->price,
         bids_at_price_map_.begin()->price_);
@@ -98,7 +104,7 @@ void MarketOrderBook2::OnMarketUpdate(
              market_update->side == common::Side::kAsk &&
              market_update->price <= asks_at_price_map_.begin()->price_);
     if(ask_will_be_updated){
-        logi("bids_at_price_map_size:{} {} price:{} cur_best_ask:{}", bids_at_price_map_.size(),
+        hlogd(kOrderBook, "bids_at_price_map_size:{} {} price:{} cur_best_ask:{}", bids_at_price_map_.size(),
         market_update->side,
         market_update->price,
         asks_at_price_map_.begin()->price_);
@@ -113,7 +119,7 @@ void MarketOrderBook2::OnMarketUpdate(
 
     UpdateBBO(bid_will_be_updated, ask_will_be_updated);
     if (bid_will_be_updated || ask_will_be_updated){
-        logi("{}", bbo_.ToString());
+        hlogi(kOrderBook, "{}", bbo_.ToString());
         bbo_signal_emitter_.Emit(bbo_);
     }
     //logd("{}", market_update->ToString());
@@ -143,11 +149,11 @@ void MarketOrderBook2::OnMarketUpdate(
                 (!bids_at_price_map_.size() || bids_at_price_map_.size() && bid.price >= bids_at_price_map_.begin()->price_)) {
                 bid_will_be_updated = true;
             }
-            logi("add bid order price:{} qty:{}", bid.price, bid.qty);
+            hlogd(kOrderBook, "add bid order price:{} qty:{}", bid.price, bid.qty);
             MarketOrder order(common::kOrderIdInvalid, common::Side::kBid, bid.price, bid.qty);
             AddOrder(&order);
         } else {
-            logi("rm bid price:{}", bid.price);
+            hlogd(kOrderBook, "rm bid price:{}", bid.price);
             RemoveOrdersAtPrice(common::Side::kBid, bid.price);
         }
     }
@@ -161,11 +167,11 @@ void MarketOrderBook2::OnMarketUpdate(
                 (!asks_at_price_map_.size() || asks_at_price_map_.size() && ask.price <= asks_at_price_map_.begin()->price_)) {
                 ask_will_be_updated = true;
             }
-            logi("add ask order price:{} qty:{}", ask.price, ask.qty);
+            hlogd(kOrderBook, "add ask order price:{} qty:{}", ask.price, ask.qty);
             MarketOrder order(common::kOrderIdInvalid, common::Side::kAsk, ask.price, ask.qty);
             AddOrder(&order);
         } else {
-            logi("rm ask price:{}", ask.price);
+            hlogd(kOrderBook, "rm ask price:{}", ask.price);
             RemoveOrdersAtPrice(common::Side::kAsk, ask.price);
         }
     }
@@ -173,7 +179,7 @@ void MarketOrderBook2::OnMarketUpdate(
     // Обновление и эмиссия сигнала BBO
     UpdateBBO(bid_will_be_updated, ask_will_be_updated);
     if (bid_will_be_updated || ask_will_be_updated) {
-        logi("BBO updated: {}", bbo_.ToString());
+        hlogi(kOrderBook, "BBO updated: {}", bbo_.ToString());
         bbo_signal_emitter_.Emit(bbo_);
     }
 }
@@ -201,11 +207,11 @@ void MarketOrderBook2::OnMarketUpdate(
         if (qty > 0) {
             // Если новый bid улучшает лучшую цену
 
-            logi("add bid order price:{} qty:{}", bid.price, bid.qty);
+            hlogd(kOrderBook, "add bid order price:{} qty:{}", bid.price, bid.qty);
             MarketOrder order(common::kOrderIdInvalid, common::Side::kBid, bid.price, bid.qty);
             AddOrder(&order);
         } else {
-            logi("rm bid price:{}", bid.price);
+            hlogd(kOrderBook, "rm bid price:{}", bid.price);
             RemoveOrdersAtPrice(common::Side::kBid, bid.price);
         }
     }
@@ -220,11 +226,11 @@ void MarketOrderBook2::OnMarketUpdate(
         if (qty > 0) {
             // Если новый ask улучшает лучшую цену
 
-            logi("add ask order price:{} qty:{}", ask.price, ask.qty);
+            hlogd(kOrderBook, "add ask order price:{} qty:{}", ask.price, ask.qty);
             MarketOrder order(common::kOrderIdInvalid, common::Side::kAsk, ask.price, ask.qty);
             AddOrder(&order);
         } else {
-            logi("rm ask price:{}", ask.price);
+            hlogd(kOrderBook, "rm ask price:{}", ask.price);
             RemoveOrdersAtPrice(common::Side::kAsk, ask.price);
         }
     }
@@ -232,7 +238,7 @@ void MarketOrderBook2::OnMarketUpdate(
     // Обновление и эмиссия сигнала BBO
     UpdateBBO(bid_will_be_updated, ask_will_be_updated);
     if (bid_will_be_updated || ask_will_be_updated) {
-        logi("BBO updated: {}", bbo_.ToString());
+        hlogi(kOrderBook, "BBO updated: {}", bbo_.ToString());
         bbo_signal_emitter_.Emit(bbo_);
     }
 }
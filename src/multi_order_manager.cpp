@@ -0,0 +1,42 @@
+#include "aot/strategy/multi_order_manager.h"
+#include "aot/strategy/trade_engine.h"
+
+auto Trading::MultiOrderManager::NewOrder(common::ExchangeId exchange_id,
+                                          common::TradingPair trading_pair,
+                                          common::Price price,
+                                          common::Side side,
+                                          common::Qty qty) noexcept
+    -> common::OrderId {
+    auto order = orders_.Add(trading_pair, side, price, qty);
+    if (!order) [[unlikely]] {
+        logw("{} orders are working. can't create new order for {}",
+             orders_.Size(), trading_pair.ToString());
+        return common::kOrderIdInvalid;
+    }
+    const Exchange::RequestNewOrder new_request(
+        exchange_id, Exchange::ClientRequestType::NEW, trading_pair,
+        order->order_id, side, price, qty);
+    trade_engine_->SendRequestNewOrder(&new_request);
+    return order->order_id;
+}
+
+auto Trading::MultiOrderManager::CancelOrder(common::ExchangeId exchange_id,
+                                             common::OrderId order_id) noexcept
+    -> bool {
+    auto order = orders_.RequestCancel(order_id);
+    if (!order) return false;
+    const Exchange::RequestCancelOrder cancel_request{
+        exchange_id, Exchange::ClientRequestType::CANCEL, order->trading_pair,
+        order->order_id};
+    trade_engine_->SendRequestCancelOrder(&cancel_request);
+    return true;
+}
+
+auto Trading::MultiOrderManager::CancelOrder(common::ExchangeId exchange_id,
+                                             common::TradingPair trading_pair,
+                                             common::Side side) noexcept
+    -> void {
+    orders_.ForEach(trading_pair, side, [this, exchange_id](OMOrder &order) {
+        CancelOrder(exchange_id, order.order_id);
+    });
+}
@@ -162,5 +162,13 @@ auto Trading::OrderGateway2::Run() noexcept -> void {
             executor_canceled_orders_[exchange_id]->Exec(&requests_cancel_orders[i],
                                             incoming_responses_);
         }
+        if (count_new_order || count_cancel_order) {
+            wait_.Busy();
+            continue;
+        }
+        wait_.Idle([this] {
+            return !run_ || requests_new_order_->size_approx() ||
+                   requests_cancel_order_->size_approx();
+        });
     }
 }
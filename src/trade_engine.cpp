@@ -20,6 +20,7 @@ TradeEngine::TradeEngine(
       latency_event_lfqueue_(latency_event_lfqueue),
       trading_pair_(trading_pair),
       pairs_(pairs),
+      position_keeper_(&pairs_),
       order_book_(trading_pair, pairs)//,
       //order_manager_(this)
     //   strategy_(predictor, this, &order_manager_, config_, trading_pair,
@@ -56,6 +57,7 @@ auto TradeEngine::Run() noexcept -> void {
     Exchange::MEMarketUpdate results[50];
     OHLCVExt new_klines[50];
     strategy::cross_arbitrage::Event* strategy_events[50];
+    inference::Prediction predictions[50];
     common::Delta delta          = 0;
     unsigned int number_messages = 0;
     unsigned int dequed_elements = 0;
@@ -67,6 +69,14 @@ auto TradeEngine::Run() noexcept -> void {
             OnOrderResponse(&results_responses[i]);
         }
         if (count_responses) time_manager_.Update();
+        if (!predictions_) continue;
+        size_t count_predictions =
+            predictions_->try_dequeue_bulk(predictions, 50);
+        for (uint i = 0; i < count_predictions; i++) {
+            OnNewKLine(&predictions[i]);
+        }
+        if (count_predictions) time_manager_.Update();
+        dequed_elements += count_predictions;
     }
     logd("dequed klines={}", dequed_elements);
     logd("dequed diffs_mb={}", dequed_mb_elements);
@@ -94,6 +104,12 @@ auto Trading::TradeEngine::OnNewKLine(const OHLCVExt* new_kline) noexcept
     strategy_->OnNewKLine(new_kline);
 }
 
+auto Trading::TradeEngine::OnNewKLine(
+    const inference::Prediction* prediction) noexcept -> void {
+    logi("launch algorithm action for {}", prediction->kline.ToString());
+    strategy_->OnNewKLine(prediction);
+}
+
 auto backtesting::TradeEngine::OnNewKLine(const OHLCVExt* new_kline) noexcept
     -> void {
     logi("launch algorithm prediction for {}", new_kline->ToString());
@@ -101,16 +117,30 @@ auto backtesting::TradeEngine::OnNewKLine(const OHLCVExt* new_kline) noexcept
     //strategy_.OnNewKLine(new_kline);
 }
 
+auto backtesting::TradeEngine::OnNewKLine(
+    const inference::Prediction* prediction) noexcept -> void {
+    // the book takes the prices of the kline, then the strategy buys or sells
+    // for the action of the model as on a live run
+    OnNewKLine(&prediction->kline);
+    if (strategy_) strategy_->OnNewKLine(prediction);
+}
+
 auto backtesting::TradeEngine::Run() noexcept -> void{
     logi("TradeEngineService start");
     OHLCVExt new_klines[50];
+    inference::Prediction predictions[50];
 
     while (run_){
         size_t count_new_klines = klines_->try_dequeue_bulk(new_klines, 50);
         for (uint i = 0; i < count_new_klines; i++) [[likely]] {
             OnNewKLine(&new_klines[i]);
         }
-        if (count_new_klines) {
+        size_t count_predictions =
+            predictions_ ? predictions_->try_dequeue_bulk(predictions, 50) : 0;
+        for (uint i = 0; i < count_predictions; i++) {
+            OnNewKLine(&predictions[i]);
+        }
+        if (count_new_klines || count_predictions) {
             time_manager_.Update();
         }
     }
@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "aot/strategy/arbitrage/cycle_batch.h"
+
+namespace {
+/**
+ * @brief compiled cycles with their trade states and BBO of every instrument.
+ * A cycle joins two random instruments. About a tenth of the trades is opened,
+ * books are crossed between instruments rarely as in a quiet market
+ */
+struct Universe {
+    struct State {
+        aot::TradeState state;
+        aot::TransactionReport buy;
+        aot::TransactionReport sell;
+    };
+    std::vector<Trading::BBO> bbos;
+    std::vector<uint8_t> has_bbo;
+    std::vector<std::unique_ptr<State>> states;
+    aot::CycleIndex index;
+    aot::CycleBatch batch;
+    aot::InstrumentId instruments;
+
+    Universe(size_t size, aot::InstrumentId _instruments)
+        : bbos(_instruments), has_bbo(_instruments, 1),
+          instruments(_instruments) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<common::Price> price(99'990, 100'000);
+        std::uniform_int_distribution<aot::InstrumentId> instrument(
+            0, instruments - 1);
+        std::bernoulli_distribution opened(0.1);
+        for (size_t i = 0; i < size; ++i) {
+            auto& state = *states.emplace_back(std::make_unique<State>());
+            if (opened(generator)) {
+                state.state.is_open    = true;
+                state.buy.entry_price  = price(generator);
+                state.sell.entry_price = price(generator);
+            }
+            std::vector<aot::InstrumentId> legs{instrument(generator),
+                                                instrument(generator)};
+            index.Add({.buy              = legs[0],
+                       .sell             = legs[1],
+                       .state            = &state.state,
+                       .buy_transaction  = &state.buy,
+                       .sell_transaction = &state.sell},
+                      legs);
+        }
+        batch.Build(index, instruments);
+        for (aot::InstrumentId i = 0; i < instruments; ++i) {
+            bbos[i].bid_price = price(generator);
+            bbos[i].ask_price = bbos[i].bid_price + 10;
+            bbos[i].bid_qty   = 1'000;
+            bbos[i].ask_qty   = 1'000;
+            batch.UpdateBBO(i, bbos[i]);
+        }
+    }
+};
+
+/// cycles and instruments, about 40 cycles per instrument
+void Universes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->Args({200, 10})->Args({10'000, 512});
+}
+
+const aot::CycleThresholds kThresholds{.take_profit_percent = 0.01,
+                                       .stop_loss_percent   = -0.01};
+}  // namespace
+
+/// per cycle branchy evaluation as in the strategy before CycleBatch, one BBO
+/// of every instrument
+static void BM_ScalarPerCycle(benchmark::State& state) {
+    Universe universe(state.range(0), state.range(1));
+    size_t cycles = 0;
+    for (auto _ : state) {
+        size_t act = 0;
+        for (aot::InstrumentId i = 0; i < universe.instruments; ++i) {
+            for (auto id : universe.index.CyclesOf(i)) {
+                const auto& cycle = universe.index.Cycle(id);
+                bool ready        = true;
+                for (auto instrument : universe.index.Instruments(cycle))
+                    ready = ready && universe.has_bbo[instrument];
+                if (!ready) continue;
+                const auto& buy  = universe.bbos[cycle.buy];
+                const auto& sell = universe.bbos[cycle.sell];
+                if (buy.ask_price == common::kPriceInvalid) continue;
+                if (sell.bid_price == common::kPriceInvalid) continue;
+                if (buy.bid_price == common::kPriceInvalid) continue;
+                if (sell.ask_price == common::kPriceInvalid) continue;
+                bool opened       = cycle.state->IsOpened();
+                double entry_buy  = cycle.buy_transaction->entry_price;
+                double entry_sell = cycle.sell_transaction->entry_price;
+                if (!opened && sell.bid_price > buy.ask_price) {
+                    opened     = true;
+                    entry_buy  = buy.ask_price;
+                    entry_sell = sell.bid_price;
+                }
+                if (!opened) continue;
+                double profit_or_loss_buy =
+                    static_cast<double>(buy.bid_price) - entry_buy;
+                double profit_or_loss_sell =
+                    entry_sell - static_cast<double>(sell.ask_price);
+                double percent = (profit_or_loss_buy + profit_or_loss_sell) /
+                                 entry_buy * 100.0;
+                if (percent >= kThresholds.take_profit_percent)
+                    ++act;
+                else if (percent <= kThresholds.stop_loss_percent)
+                    ++act;
+            }
+            cycles += universe.index.CyclesOf(i).size();
+        }
+        benchmark::DoNotOptimize(act);
+    }
+    state.SetItemsProcessed(cycles);
+}
+BENCHMARK(BM_ScalarPerCycle)->Apply(Universes);
+
+/// CycleBatch::Evaluate() with the given kernel, one BBO of every instrument
+static void BatchEvaluate(benchmark::State& state,
+                          aot::CycleBatch::Kernel kernel) {
+    if (kernel == aot::CycleBatch::Kernel::kAvx2 &&
+        !aot::CycleBatch::HasAvx2()) {
+        state.SkipWithError("no AVX2");
+        return;
+    }
+    Universe universe(state.range(0), state.range(1));
+    size_t cycles = 0;
+    for (auto _ : state) {
+        for (aot::InstrumentId i = 0; i < universe.instruments; ++i) {
+            universe.batch.Evaluate(i, kThresholds, kernel);
+            benchmark::DoNotOptimize(universe.batch.Act().data());
+            cycles += universe.batch.Size();
+        }
+    }
+    state.SetItemsProcessed(cycles);
+}
+
+static void BM_BatchScalar(benchmark::State& state) {
+    BatchEvaluate(state, aot::CycleBatch::Kernel::kScalar);
+}
+BENCHMARK(BM_BatchScalar)->Apply(Universes);
+
+static void BM_BatchAvx2(benchmark::State& state) {
+    BatchEvaluate(state, aot::CycleBatch::Kernel::kAvx2);
+}
+BENCHMARK(BM_BatchAvx2)->Apply(Universes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <vector>
+
+#include "aot/bus/bus.h"
+#include "aot/bus/static_bus.h"
+#include "aot/market_data/market_update.h"
+#include "boost/asio/co_spawn.hpp"
+#include "boost/asio/detached.hpp"
+#include "boost/asio/io_context.hpp"
+
+namespace {
+constexpr size_t kBatchSize = 64;
+
+class Publisher : public bus::Component {};
+
+/// Subscriber which does almost nothing, so the cost of the bus is measured.
+class Counter : public bus::Component {
+  public:
+    uint64_t count = 0;
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>) override {
+        ++count;
+    }
+};
+
+/**
+ * @brief subscriber which switches to its executor as OrderBookComponent
+ * does: one coroutine per event, or one per batch
+ */
+class Hop : public bus::Component {
+    boost::asio::io_context &ioc_;
+
+  public:
+    uint64_t count = 0;
+    explicit Hop(boost::asio::io_context &ioc) : ioc_(ioc) {}
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot> event)
+        override {
+        boost::asio::co_spawn(ioc_, Handle(std::move(event)),
+                              boost::asio::detached);
+    }
+    void AsyncHandleBatch(
+        std::span<const boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>
+            events) {
+        boost::asio::co_spawn(
+            ioc_,
+            HandleBatch({events.begin(), events.end()}),
+            boost::asio::detached);
+    }
+
+  private:
+    boost::asio::awaitable<void> Handle(
+        boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>) {
+        ++count;
+        co_return;
+    }
+    boost::asio::awaitable<void> HandleBatch(
+        std::vector<boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>
+            events) {
+        count += events.size();
+        co_return;
+    }
+};
+
+std::vector<boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>
+MakeEvents(size_t count) {
+    std::vector<boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>
+        events;
+    for (size_t i = 0; i < count; ++i)
+        events.emplace_back(new Exchange::BusEventBookDiffSnapshot(
+            nullptr, new Exchange::BookDiffSnapshot2()));
+    return events;
+}
+
+using CounterRoute = aot::Route<Publisher, Exchange::BusEventBookDiffSnapshot,
+                                Counter, Counter, Counter, Counter>;
+using HopRoute =
+    aot::Route<Publisher, Exchange::BusEventBookDiffSnapshot, Hop>;
+}  // namespace
+
+/// unordered_map lookup and Accept() -> AsyncHandleEvent() per subscriber
+static void BM_CoBusSend(benchmark::State &state) {
+    boost::asio::thread_pool pool(1);
+    aot::CoBus bus(pool);
+    Publisher publisher;
+    std::array<Counter, 4> counters;
+    for (auto &counter : counters) bus.Subscribe(&publisher, &counter);
+    auto events = MakeEvents(1);
+    for (auto _ : state) bus.AsyncSend(&publisher, events[0]);
+    benchmark::DoNotOptimize(counters[3].count);
+}
+BENCHMARK(BM_CoBusSend);
+
+/// same topology wired at compile time, subscribers are called directly
+static void BM_StaticBusSend(benchmark::State &state) {
+    Publisher publisher;
+    std::array<Counter, 4> counters;
+    aot::StaticBus<CounterRoute> bus{
+        CounterRoute{counters[0], counters[1], counters[2], counters[3]}};
+    auto events = MakeEvents(1);
+    for (auto _ : state) bus.AsyncSend(&publisher, events[0]);
+    benchmark::DoNotOptimize(counters[3].count);
+}
+BENCHMARK(BM_StaticBusSend);
+
+/// kBatchSize diffs, one coroutine per diff
+static void BM_CoBusSendBatchWithHop(benchmark::State &state) {
+    boost::asio::thread_pool pool(1);
+    boost::asio::io_context ioc;
+    aot::CoBus bus(pool);
+    Publisher publisher;
+    Hop hop(ioc);
+    bus.Subscribe(&publisher, &hop);
+    auto events = MakeEvents(kBatchSize);
+    for (auto _ : state) {
+        bus.AsyncSendBatch(&publisher, events);
+        ioc.poll();
+        ioc.restart();
+    }
+    benchmark::DoNotOptimize(hop.count);
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_CoBusSendBatchWithHop);
+
+/// kBatchSize diffs, one coroutine per batch
+static void BM_StaticBusSendBatchWithHop(benchmark::State &state) {
+    boost::asio::io_context ioc;
+    Publisher publisher;
+    Hop hop(ioc);
+    aot::StaticBus<HopRoute> bus{HopRoute{hop}};
+    auto events = MakeEvents(kBatchSize);
+    for (auto _ : state) {
+        bus.AsyncSendBatch(&publisher, events);
+        ioc.poll();
+        ioc.restart();
+    }
+    benchmark::DoNotOptimize(hop.count);
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_StaticBusSendBatchWithHop);
+
+BENCHMARK_MAIN();
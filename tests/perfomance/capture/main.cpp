@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "aot/backtesting/capture.h"
+
+namespace {
+constexpr size_t kDiffs = 200'000;
+const common::TradingPair kBtcUsdt{2, 1};
+
+std::string TempPath(std::string_view name) {
+    return (std::filesystem::temp_directory_path() /
+            fmt::format("bch-capture-{}", name))
+        .string();
+}
+
+/// the same diffs as log lines of MEMarketUpdateDouble, as 999.txt has them,
+/// and as raw and packed captures
+void MakeFiles() {
+    static bool made = false;
+    if (made) return;
+    made = true;
+    std::ofstream text(TempPath("diffs.txt"));
+    backtesting::CaptureWriter raw;
+    backtesting::CaptureWriter packed({.packed = true});
+    raw.Open(TempPath("raw.tck"));
+    packed.Open(TempPath("packed.tck"));
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<common::Price> price(6'000'000, 6'010'000);
+    std::uniform_int_distribution<common::Qty> qty(0, 10'000'000);
+    common::Nanos time = 0;
+    for (size_t i = 0; i < kDiffs; ++i) {
+        const auto p   = price(generator);
+        const auto q   = qty(generator);
+        const bool bid = i % 2;
+        text << fmt::format(
+            "12:00:00.000000 market_order_book.h:42 INF[1] "
+            "MEMarketUpdateDouble[ticker:BTCUSDT type:DEFAULT side:{} "
+            "qty:{:.5f} price:{:.2f}]\n",
+            bid ? "BUY" : "SELL", q * 1e-5, p * 1e-2);
+        Exchange::MEMarketUpdate2 update(
+            nullptr, common::ExchangeId::kBinance, kBtcUsdt,
+            Exchange::MarketUpdateType::DEFAULT, common::kOrderIdInvalid,
+            bid ? common::Side::kBid : common::Side::kAsk, p, q);
+        time += 1'000;
+        for (auto* writer : {&raw, &packed})
+            writer->Write(time,
+                          writer->Instrument(common::ExchangeId::kBinance,
+                                             common::MarketType::kSpot,
+                                             kBtcUsdt),
+                          update);
+    }
+}
+}  // namespace
+
+/// what the order book benchmark does with 999.txt
+static void BM_RegexText(benchmark::State& state) {
+    MakeFiles();
+    const std::regex word_regex(
+        ".+ MEMarketUpdateDouble\\[ticker:(\\w*) type:(\\w*) side:(\\w+) "
+        "qty:(\\d+\\.\\d+) price:(\\d+\\.\\d+)\\]");
+    for (auto _ : state) {
+        std::ifstream infile(TempPath("diffs.txt"));
+        std::vector<Exchange::MEMarketUpdate> diffs;
+        diffs.reserve(kDiffs);
+        std::smatch pieces_match;
+        for (std::string line; std::getline(infile, line);) {
+            if (!std::regex_match(line, pieces_match, word_regex)) continue;
+            Exchange::MEMarketUpdate update;
+            update.side  = pieces_match[3] == "BUY" ? common::Side::kBid
+                                                    : common::Side::kAsk;
+            update.qty   = std::stod(pieces_match[4]) * 100'000;
+            update.price = std::stod(pieces_match[5]) * 100;
+            diffs.push_back(update);
+        }
+        benchmark::DoNotOptimize(diffs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kDiffs);
+}
+BENCHMARK(BM_RegexText)->Unit(benchmark::kMillisecond);
+
+/// mmap and a pass over all records, arg 1 is the packed capture
+static void BM_CaptureReader(benchmark::State& state) {
+    MakeFiles();
+    const auto path = TempPath(state.range(0) ? "packed.tck" : "raw.tck");
+    for (auto _ : state) {
+        backtesting::CaptureReader reader;
+        reader.Open(path);
+        backtesting::CaptureCursor cursor(reader);
+        common::Qty volume = 0;
+        while (const auto* record = cursor.Next()) volume += record->qty;
+        benchmark::DoNotOptimize(volume);
+    }
+    state.SetItemsProcessed(state.iterations() * kDiffs);
+    state.counters["bytes_per_record"] =
+        static_cast<double>(std::filesystem::file_size(path)) / kDiffs;
+}
+BENCHMARK(BM_CaptureReader)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+    fmtlog::setLogLevel(fmtlog::OFF);
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    for (auto name : {"diffs.txt", "raw.tck", "packed.tck"})
+        std::filesystem::remove(TempPath(name));
+}
@@ -0,0 +1,228 @@
+#include <benchmark/benchmark.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "aot/Https.h"
+
+namespace {
+using Session              = V2::HttpsSession3<std::chrono::seconds>;
+using Pool                 = V2::ConnectionPool<Session>;
+constexpr size_t kPoolSize = 16;
+using Clock                = std::chrono::steady_clock;
+constexpr auto kTimeout    = std::chrono::seconds(30);
+
+/// self-signed certificate of localhost and its key in PEM
+std::pair<std::string, std::string> SelfSignedPem() {
+    EVP_PKEY* key = EVP_EC_gen("prime256v1");
+    X509* cert    = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    auto name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(
+        name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+
+    auto pem = [](auto write) {
+        BIO* bio = BIO_new(BIO_s_mem());
+        write(bio);
+        char* data = nullptr;
+        auto size  = BIO_get_mem_data(bio, &data);
+        std::string result(data, size);
+        BIO_free(bio);
+        return result;
+    };
+    auto cert_pem = pem([cert](BIO* bio) { PEM_write_bio_X509(bio, cert); });
+    auto key_pem  = pem([key](BIO* bio) {
+        PEM_write_bio_PrivateKey(bio, key, nullptr, nullptr, 0, nullptr,
+                                 nullptr);
+    });
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return {std::move(cert_pem), std::move(key_pem)};
+}
+
+/**
+ * @brief TLS server on 127.0.0.1 that answers a request with its target.
+ *
+ * Serves one request per connection and closes it, as HttpsSession3 expects.
+ */
+class EchoServer {
+  public:
+    EchoServer() : acceptor_(ioc_, {net::ip::make_address("127.0.0.1"), 0}) {
+        auto [cert, key] = SelfSignedPem();
+        ssl_ctx_.use_certificate_chain(net::buffer(cert));
+        ssl_ctx_.use_private_key(net::buffer(key), ssl::context::pem);
+        net::co_spawn(ioc_, Accept(), net::detached);
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+    ~EchoServer() {
+        ioc_.stop();
+        thread_.join();
+    }
+    std::string Port() const {
+        return std::to_string(acceptor_.local_endpoint().port());
+    }
+
+  private:
+    net::awaitable<void> Accept() {
+        while (true) {
+            auto socket = co_await acceptor_.async_accept(net::use_awaitable);
+            net::co_spawn(ioc_, Serve(std::move(socket)), net::detached);
+        }
+    }
+    net::awaitable<void> Serve(tcp::socket socket) {
+        beast::ssl_stream<tcp::socket> stream(std::move(socket), ssl_ctx_);
+        beast::error_code ec;
+        co_await stream.async_handshake(
+            ssl::stream_base::server,
+            net::redirect_error(net::use_awaitable, ec));
+        if (ec) co_return;
+        beast::flat_buffer buffer;
+        http::request<http::string_body> req;
+        co_await http::async_read(stream, buffer, req,
+                                  net::redirect_error(net::use_awaitable, ec));
+        if (ec) co_return;
+        http::response<http::string_body> res{http::status::ok,
+                                              req.version()};
+        res.body() = std::string(req.target());
+        res.prepare_payload();
+        co_await http::async_write(stream, res,
+                                   net::redirect_error(net::use_awaitable, ec));
+    }
+
+    net::io_context ioc_;
+    ssl::context ssl_ctx_{ssl::context::tls_server};
+    tcp::acceptor acceptor_;
+    std::thread thread_;
+};
+
+/// user and system time of the process, the server threads included
+double CpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+http::request<http::string_body> Request(size_t i) {
+    http::request<http::string_body> req{http::verb::get,
+                                         "/" + std::to_string(i), 11};
+    req.set(http::field::host, "127.0.0.1");
+    return req;
+}
+
+/**
+ * @brief state.range(0) coroutines send a request each through one pool.
+ *
+ * acquire(pool) gets the session of a request. Reports percentiles of the
+ * time from sending a request to getting its session and CPU time of the
+ * process per iteration, the server does the same work for every acquire.
+ */
+template <typename Acquire>
+void SendConcurrently(benchmark::State& state, Acquire acquire) {
+    const auto requests = static_cast<size_t>(state.range(0));
+    EchoServer server;
+    net::io_context ioc;
+    auto work = net::make_work_guard(ioc);
+    Pool pool(ioc, kTimeout, kPoolSize, "127.0.0.1", server.Port());
+    std::vector<std::thread> io_threads;
+    for (int i = 0; i < 2; ++i) io_threads.emplace_back([&ioc] { ioc.run(); });
+    net::thread_pool callers(4);
+
+    std::vector<double> latencies;
+    double cpu_seconds = 0;
+    size_t failed      = 0;
+    for (auto _ : state) {
+        std::vector<double> acquire_us(requests);
+        std::atomic<size_t> left = requests, no_session = 0;
+        std::promise<void> done;
+        auto finish = [&left, &done] {
+            if (--left == 0) done.set_value();
+        };
+        const auto cpu_start = CpuSeconds();
+        for (size_t i = 0; i < requests; ++i)
+            net::co_spawn(
+                callers,
+                [&, i, start = Clock::now()]() -> net::awaitable<void> {
+                    Session* session   = co_await acquire(pool);
+                    const auto elapsed = Clock::now() - start;
+                    acquire_us[i] =
+                        std::chrono::duration<double, std::micro>(elapsed)
+                            .count();
+                    if (!session) {
+                        ++no_session;
+                        finish();
+                        co_return;
+                    }
+                    session->RegisterOnResponse(
+                        [finish](http::response<http::string_body>&) {
+                            finish();
+                        });
+                    session->AsyncRequest(Request(i));
+                },
+                net::detached);
+        done.get_future().wait();
+        cpu_seconds += CpuSeconds() - cpu_start;
+        failed      += no_session;
+        latencies.insert(latencies.end(), acquire_us.begin(),
+                         acquire_us.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    state.counters["p50_us"]     = percentile(0.5);
+    state.counters["p99_us"]     = percentile(0.99);
+    state.counters["cpu_s"]      = cpu_seconds / state.iterations();
+    state.counters["no_session"] = failed;
+
+    callers.join();
+    pool.CloseAllSessions();
+    work.reset();
+    ioc.stop();
+    for (auto& thread : io_threads) thread.join();
+}
+}  // namespace
+
+/// the caller thread spins until a session is ready, as AcquireConnection()
+static void BM_SpinAcquire(benchmark::State& state) {
+    SendConcurrently(state, [](Pool& pool) -> net::awaitable<Session*> {
+        Session* session = nullptr;
+        while (!(session = pool.TryAcquire())) {
+        }
+        co_return session;
+    });
+}
+BENCHMARK(BM_SpinAcquire)
+    ->Arg(1000)
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/// the caller coroutine is parked until a session is ready
+static void BM_AsyncAcquire(benchmark::State& state) {
+    SendConcurrently(state, [](Pool& pool) {
+        return pool.AsyncAcquire(kTimeout);
+    });
+}
+BENCHMARK(BM_AsyncAcquire)
+    ->Arg(1000)
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "aot/hot_log.h"
+#include "aot/market_data/market_update.h"
+#include "aot/strategy/market_order_book.h"
+
+namespace {
+constexpr uint64_t kDepth     = 100;
+constexpr uint64_t kDiffDepth = 20;
+constexpr common::Price kMid  = 6'500'000;
+
+/// fmtlog writes to /dev/null, the poller drains the queues as in production
+struct LogSetup {
+    LogSetup() {
+        fmtlog::setLogFile("/dev/null", false);
+        fmtlog::setLogLevel(fmtlog::DBG);
+    }
+    LogPollingThread poller;
+};
+LogSetup &Setup() {
+    static LogSetup setup;
+    return setup;
+}
+
+/// qty of a level repeats with (i + level) % 8 and % 100
+constexpr uint64_t kDiffPeriod = 200;
+
+/// every level changes its qty, every 8th diff of a level removes it
+std::vector<Exchange::BookDiffSnapshot2> MakeDiffs() {
+    std::vector<Exchange::BookDiffSnapshot2> diffs(kDiffPeriod);
+    for (uint64_t i = 0; i < kDiffPeriod; ++i)
+        for (uint64_t level = 0; level < kDiffDepth; ++level) {
+            const common::Qty qty =
+                (i + level) % 8 ? 1 + (i + level) % 100 : 0;
+            diffs[i].bids.emplace_back(kMid - 1 - level, qty);
+            diffs[i].asks.emplace_back(kMid + 1 + level, qty);
+        }
+    return diffs;
+}
+}  // namespace
+
+/// MarketOrderBook2 as built: bch_hot_log has logs of the book compiled out,
+/// bch_hot_log_enabled compiles them in at debug level
+static void BM_BookDiff(benchmark::State &state) {
+    Setup();
+    Trading::MarketOrderBook2 book(common::ExchangeId::kBinance, {2, 1});
+    Exchange::BookSnapshot2 snapshot;
+    for (uint64_t level = 0; level < kDepth; ++level) {
+        snapshot.bids.emplace_back(kMid - 1 - level, 10);
+        snapshot.asks.emplace_back(kMid + 1 + level, 10);
+    }
+    book.OnMarketUpdate(&snapshot);
+    const auto diffs = MakeDiffs();
+    uint64_t i       = 0;
+    for (auto _ : state) {
+        book.OnMarketUpdate(&diffs[i++ % kDiffPeriod]);
+        benchmark::DoNotOptimize(book.GetBBO());
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * kDiffDepth);
+    state.counters["order_book_log_level"] = AOT_LOG_LEVEL_ORDER_BOOK;
+}
+BENCHMARK(BM_BookDiff);
+
+/// one site of the book below the compile time level
+static void BM_LogSiteCompiledOut(benchmark::State &state) {
+    Setup();
+    common::Price price = kMid;
+    for (auto _ : state) {
+        hlogd(kWs, "add bid order price:{} qty:{}", price, price);
+        benchmark::DoNotOptimize(++price);
+    }
+}
+BENCHMARK(BM_LogSiteCompiledOut);
+
+static void BM_LogSiteRuntimeOff(benchmark::State &state) {
+    Setup();
+    aot::log::SetLevel(aot::log::Subsystem::kParser, fmtlog::ERR);
+    common::Price price = kMid;
+    for (auto _ : state) {
+        hlogw(kParser, "add bid order price:{} qty:{}", price, price);
+        benchmark::DoNotOptimize(++price);
+    }
+    aot::log::SetLevel(aot::log::Subsystem::kParser, fmtlog::DBG);
+}
+BENCHMARK(BM_LogSiteRuntimeOff);
+
+static void BM_LogSiteEnabled(benchmark::State &state) {
+    Setup();
+    common::Price price = kMid;
+    for (auto _ : state) {
+        hlogw(kParser, "add bid order price:{} qty:{}", price, price);
+        benchmark::DoNotOptimize(++price);
+    }
+}
+BENCHMARK(BM_LogSiteEnabled);
+
+static void BM_LogSiteSampled(benchmark::State &state) {
+    Setup();
+    common::Price price = kMid;
+    for (auto _ : state) {
+        hlogwn(kParser, 64, "add bid order price:{} qty:{}", price, price);
+        benchmark::DoNotOptimize(++price);
+    }
+}
+BENCHMARK(BM_LogSiteSampled);
+
+BENCHMARK_MAIN();
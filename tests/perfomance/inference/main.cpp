@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "aot/launcher_predictor.h"
+#include "aot/python/batch_strategy.h"
+#include "aot/strategy/inference.h"
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+
+/// the same trivial model behind the per kline and the batch method, only
+/// the cost of crossing into python is left
+std::string PythonPath() {
+    const auto dir = std::filesystem::temp_directory_path() / "bch-inference";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "bch_predictor.py") << R"(import array
+
+class Predictor:
+    def __init__(self, path_where_models):
+        pass
+
+    def score(self, open, close):
+        return (close - open) / open
+
+    def action(self, score):
+        if score > 0.01:
+            return 'enter_long'
+        if score < -0.01:
+            return 'enter_short'
+        return ''
+
+    def predict(self, open, high, low, close, volume):
+        return {self.action(self.score(open, close)): 1}
+
+    def predict_batch(self, candles):
+        return array.array('d', (self.score(row[0], row[3])
+                                 for row in candles.tolist()))
+)";
+    return dir.string();
+}
+
+/// owns the interpreter for all benchmarks of the process
+base_strategy::Strategy& PerKline() {
+    static base_strategy::Strategy strategy(
+        PythonPath(), "", "bch_predictor.py", "Predictor", "predict");
+    return strategy;
+}
+
+std::vector<OHLCVExt> Klines(size_t count) {
+    std::vector<OHLCVExt> klines(count);
+    for (size_t i = 0; i < count; ++i) {
+        klines[i].trading_pair = kBtcUsdt;
+        klines[i].ohlcv        = {.open   = 6'000'000 + i % 100,
+                                  .high   = 6'000'200,
+                                  .low    = 5'999'800,
+                                  .close  = 6'000'000 + i % 77,
+                                  .volume = 1'000'000};
+    }
+    return klines;
+}
+}  // namespace
+
+/// Strategy::Predict() and Parser as BaseStrategy::OnNewKLine() calls them
+static void BM_PredictPerKline(benchmark::State& state) {
+    auto& strategy = PerKline();
+    auto klines    = Klines(state.range(0));
+    base_strategy::Strategy::Parser parser;
+    for (auto _ : state) {
+        for (const auto& kline : klines) {
+            auto result = strategy.Predict(kline.ohlcv.open, kline.ohlcv.high,
+                                           kline.ohlcv.low, kline.ohlcv.close,
+                                           kline.ohlcv.volume);
+            benchmark::DoNotOptimize(parser.Parse(result));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * klines.size());
+}
+BENCHMARK(BM_PredictPerKline)->Arg(16)->Arg(256);
+
+/// the same klines scored by one call of BatchStrategy as InferenceService
+/// makes it
+static void BM_PredictBatch(benchmark::State& state) {
+    PerKline();
+    base_strategy::BatchStrategy model(PythonPath(), "", "bch_predictor.py",
+                                       "Predictor");
+    if (!model.Init()) {
+        state.SkipWithError("can't init batch model");
+        return;
+    }
+    auto klines = Klines(state.range(0));
+    inference::FeatureExtractor extractor;
+    std::vector<double> features(klines.size() * model.Columns());
+    std::vector<double> scores(klines.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < klines.size(); ++i)
+            extractor.Extract(klines[i],
+                              std::span<double>(
+                                  features.data() + i * model.Columns(),
+                                  model.Columns()));
+        model.Predict(features, klines.size(), scores);
+        for (auto score : scores)
+            benchmark::DoNotOptimize(inference::ActionFromScore(score));
+    }
+    model.Shutdown();
+    state.SetItemsProcessed(state.iterations() * klines.size());
+}
+BENCHMARK(BM_PredictBatch)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
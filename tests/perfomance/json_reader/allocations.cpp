@@ -0,0 +1,129 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "aot/common/fixed_point.h"
+#include "aot/common/json_parser.h"
+#include "boost/asio/buffer.hpp"
+#include "simdjson.h"
+
+/**
+ * @brief every heap allocation of the benchmark binary is counted, so the
+ * benchmarks below can report allocations per parsed depth message
+ *
+ */
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+constexpr uint8_t kPricePrecision = 2;
+constexpr uint8_t kQtyPrecision   = 5;
+
+std::string MakeDepthMessage(int levels) {
+    std::string json = R"({"e":"depthUpdate","E":1713648154751,"s":"BTCUSDT",)"
+                       R"("U":157,"u":160,"b":[)";
+    for (int i = 0; i < levels; ++i) {
+        if (i) json += ',';
+        json += "[\"" + std::to_string(64730 - i) + ".02000000\",\"0." +
+                std::to_string(100 + i) + "00000\"]";
+    }
+    json += "],\"a\":[]}";
+    return json;
+}
+
+const std::string kDepthMessage = MakeDepthMessage(100);
+
+/// Walk bids of the depth message as the parsers do.
+uint64_t WalkLevels(simdjson::ondemand::document& doc) {
+    uint64_t sum = 0;
+    uint64_t price;
+    uint64_t qty;
+    for (auto all : doc["b"]) {
+        if (common::ParseFixedPointLevel(all.get_array(), kPricePrecision,
+                                         kQtyPrecision, price, qty))
+            sum += price + qty;
+    }
+    return sum;
+}
+
+/// Must be called right after the loop, setting the counter allocates itself.
+void ReportAllocations(benchmark::State& state, uint64_t before,
+                       bool expect_none) {
+    const auto count = allocations.load() - before;
+    state.counters["allocs_per_msg"] = benchmark::Counter(
+        static_cast<double>(count), benchmark::Counter::kAvgIterations);
+    if (expect_none && count != 0)
+        state.SkipWithError("depth message path allocated memory");
+}
+}  // namespace
+
+/// the way parsers worked before: new parser and padded copy per message
+static void BM_DepthMessageFreshParser(benchmark::State& state) {
+    const auto before = allocations.load();
+    for (auto _ : state) {
+        simdjson::ondemand::parser parser;
+        simdjson::padded_string padded(kDepthMessage);
+        simdjson::ondemand::document doc = parser.iterate(padded);
+        benchmark::DoNotOptimize(WalkLevels(doc));
+    }
+    ReportAllocations(state, before, false);
+}
+BENCHMARK(BM_DepthMessageFreshParser);
+
+/// websocket path: message is read into flat_buffer and parsed in place
+static void BM_DepthMessageReusedParserInPlace(benchmark::State& state) {
+    boost::beast::flat_buffer buffer;
+    buffer.reserve(common::kJsonReadBufferCapacity);
+    common::JsonParser parser;
+    // warm up, the parser allocates its buffers on the first message
+    {
+        auto n = boost::asio::buffer_copy(buffer.prepare(kDepthMessage.size()),
+                                          boost::asio::buffer(kDepthMessage));
+        buffer.commit(n);
+        simdjson::ondemand::document doc =
+            parser.Iterate(common::PaddedView(buffer));
+        benchmark::DoNotOptimize(WalkLevels(doc));
+        buffer.consume(n);
+    }
+    const auto before = allocations.load();
+    for (auto _ : state) {
+        auto n = boost::asio::buffer_copy(buffer.prepare(kDepthMessage.size()),
+                                          boost::asio::buffer(kDepthMessage));
+        buffer.commit(n);
+        simdjson::ondemand::document doc =
+            parser.Iterate(common::PaddedView(buffer));
+        benchmark::DoNotOptimize(WalkLevels(doc));
+        buffer.consume(n);
+    }
+    ReportAllocations(state, before, true);
+}
+BENCHMARK(BM_DepthMessageReusedParserInPlace);
+
+/// https path: response is copied into the scratch buffer of the parser
+static void BM_DepthMessageReusedParserCopy(benchmark::State& state) {
+    common::JsonParser parser;
+    {
+        simdjson::ondemand::document doc = parser.Iterate(kDepthMessage);
+        benchmark::DoNotOptimize(WalkLevels(doc));
+    }
+    const auto before = allocations.load();
+    for (auto _ : state) {
+        simdjson::ondemand::document doc =
+            parser.Iterate(std::string_view(kDepthMessage));
+        benchmark::DoNotOptimize(WalkLevels(doc));
+    }
+    ReportAllocations(state, before, true);
+}
+BENCHMARK(BM_DepthMessageReusedParserCopy);
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "aot/common/fixed_point.h"
+#include "simdjson.h"
+
+namespace {
+constexpr uint8_t kPricePrecision = 2;
+constexpr uint8_t kQtyPrecision   = 5;
+
+/// depth stream message with levels formatted like binance does it
+std::string MakeDepthUpdate(int levels) {
+    std::string json = R"({"e":"depthUpdate","E":1713648154751,"s":"BTCUSDT",)"
+                       R"("U":157,"u":160,"b":[)";
+    for (int i = 0; i < levels; ++i) {
+        if (i) json += ',';
+        json += "[\"" + std::to_string(64730 - i) + ".0" +
+                std::to_string(i % 10) + "000000\",\"" +
+                std::to_string(i % 7) + ".4299" + std::to_string(i % 10) +
+                "000\"]";
+    }
+    json += "],\"a\":[]}";
+    return json;
+}
+
+const simdjson::padded_string kDepthUpdate{MakeDepthUpdate(1000)};
+}  // namespace
+
+/// the way parsers converted numbers before: double and std::pow per message
+static void BM_DepthLevelsDoubleAndPow(benchmark::State& state) {
+    simdjson::ondemand::parser parser;
+    for (auto _ : state) {
+        auto doc        = parser.iterate(kDepthUpdate);
+        auto price_prec = std::pow(10, kPricePrecision);
+        auto qty_prec   = std::pow(10, kQtyPrecision);
+        uint64_t sum    = 0;
+        for (auto all : doc["b"]) {
+            simdjson::ondemand::array arr = all.get_array();
+            std::array<double, 2> pair;
+            uint8_t i = 0;
+            for (auto number : arr) {
+                pair[i] = number.get_double_in_string();
+                i++;
+            }
+            sum += static_cast<uint64_t>(pair[0] * price_prec) +
+                   static_cast<uint64_t>(pair[1] * qty_prec);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_DepthLevelsDoubleAndPow);
+
+static void BM_DepthLevelsFixedPoint(benchmark::State& state) {
+    simdjson::ondemand::parser parser;
+    for (auto _ : state) {
+        auto doc     = parser.iterate(kDepthUpdate);
+        uint64_t sum = 0;
+        uint64_t price;
+        uint64_t qty;
+        for (auto all : doc["b"]) {
+            if (common::ParseFixedPointLevel(all.get_array(), kPricePrecision,
+                                             kQtyPrecision, price, qty))
+                sum += price + qty;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_DepthLevelsFixedPoint);
+
+static void BM_SingleNumberStrtodAndPow(benchmark::State& state) {
+    const char* str = "64730.02000000";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str);
+        auto value = static_cast<uint64_t>(std::strtod(str, nullptr) *
+                                           std::pow(10, kPricePrecision));
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_SingleNumberStrtodAndPow);
+
+static void BM_SingleNumberFixedPoint(benchmark::State& state) {
+    std::string_view str = "64730.02000000";
+    uint64_t value;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str);
+        common::ParseFixedPoint(str, kPricePrecision, value);
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_SingleNumberFixedPoint);
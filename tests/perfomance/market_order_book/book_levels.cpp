@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+
+#include <list>
+
+#include "aot/market_data/market_update.h"
+
+/// levels were stored like this before: one heap node per level
+static void BM_SnapshotLevelsList(benchmark::State& state) {
+    const auto depth = static_cast<uint64_t>(state.range(0));
+    for (auto _ : state) {
+        std::list<Exchange::BookSnapshotElem> bids;
+        for (uint64_t i = 0; i < depth; ++i) bids.emplace_back(64730 - i, i);
+        // copy made by BidAskGeneratorCallbackBatchHandler
+        auto copy_bids = bids;
+        uint64_t sum   = 0;
+        for (const auto& bid : copy_bids) sum += bid.qty;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SnapshotLevelsList)->Arg(20)->Arg(5000);
+
+static void BM_SnapshotLevelsPooled(benchmark::State& state) {
+    const auto depth = static_cast<uint64_t>(state.range(0));
+    for (auto _ : state) {
+        Exchange::BookLevels bids;
+        for (uint64_t i = 0; i < depth; ++i) bids.emplace_back(64730 - i, i);
+        Exchange::BookLevels copy_bids = bids;
+        uint64_t sum                   = 0;
+        for (const auto& bid : copy_bids) sum += bid.qty;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SnapshotLevelsPooled)->Arg(20)->Arg(5000);
@@ -1,3 +1,5 @@
+#include <array>
+#include <atomic>
 #include <memory>
 
 #include <benchmark/benchmark.h>
@@ -122,11 +124,32 @@ static void BM_MemoryPoolAllocateRate(benchmark::State& state) {
     state.SetComplexityN(objectSize);
 }
 
+/// events are allocated by one thread and released by another one
+static common::MemoryPool<Dummy> shared_pool(4096);
+static std::array<std::atomic<Dummy*>, 256> handoff{};
+
+static void BM_MemoryPoolCrossThreadFree(benchmark::State& state) {
+    const auto offset = static_cast<size_t>(state.thread_index()) * 64;
+    size_t i          = 0;
+    for (auto _ : state) {
+        Dummy* obj = shared_pool.Allocate();
+        benchmark::DoNotOptimize(obj);
+        // swap with the slot of the neighbour thread and free what was there
+        auto& slot = handoff[(offset + 64 + i++ % 64) % handoff.size()];
+        if (auto* old = slot.exchange(obj)) shared_pool.Deallocate(old);
+    }
+    if (state.thread_index() == 0) {
+        state.counters["heap_allocations"] = static_cast<double>(
+            shared_pool.Stats().heap_allocations);
+    }
+}
+
 // Register the benchmarks
 BENCHMARK(Benchmark_MemPool_Allocate);
 BENCHMARK(BM_MemoryPoolAllocate);
 BENCHMARK(BM_MemPoolAllocateRate)->RangeMultiplier(2)->Range(1, 1 << 10)->Complexity();
 BENCHMARK(BM_MemoryPoolAllocateRate)->RangeMultiplier(2)->Range(1, 1 << 10)->Complexity();
+BENCHMARK(BM_MemoryPoolCrossThreadFree)->ThreadRange(1, 8);
 
 
 // Main function to run the benchmarks
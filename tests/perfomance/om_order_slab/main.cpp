@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "aot/strategy/om_order_slab.h"
+
+namespace {
+constexpr size_t kPairs = 16;
+
+common::TradingPair Pair(size_t i) {
+    return {static_cast<common::TickerId>(i % kPairs + 2), 1};
+}
+common::Side SideOf(size_t i) {
+    return i % 2 ? common::Side::kAsk : common::Side::kBid;
+}
+}  // namespace
+
+/// one order goes new, ack, partial fill, cancel and canceled while
+/// state.range(0) orders are working, 5 operations per iteration
+static void BM_OMOrderSlab(benchmark::State& state) {
+    const auto live = static_cast<size_t>(state.range(0));
+    Trading::OMOrderSlab slab(live + 1);
+    for (size_t i = 0; i < live; ++i) {
+        auto order = slab.Add(Pair(i), SideOf(i), 100 + i % 50, 10);
+        slab.OnResponse(Exchange::ClientResponseType::ACCEPTED,
+                        order->order_id, 10);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto id = slab.Add(Pair(i), SideOf(i), 100, 10)->order_id;
+        slab.OnResponse(Exchange::ClientResponseType::ACCEPTED, id, 10);
+        slab.OnResponse(Exchange::ClientResponseType::FILLED, id, 4);
+        benchmark::DoNotOptimize(slab.RequestCancel(id));
+        slab.OnResponse(Exchange::ClientResponseType::CANCELED, id, 0);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations() * 5);
+}
+BENCHMARK(BM_OMOrderSlab)->Arg(10'000);
+
+/// the same with orders in a hash map by sequential client order id
+static void BM_OMOrdersMap(benchmark::State& state) {
+    const auto live = static_cast<size_t>(state.range(0));
+    Trading::OMOrders orders;
+    common::OrderId next_id = 1;
+    for (size_t i = 0; i < live; ++i, ++next_id)
+        orders[next_id] = {Pair(i), next_id, SideOf(i), 100 + i % 50, 10,
+                           Trading::OMOrderState::LIVE};
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto id = next_id++;
+        orders[id]    = {Pair(i), id, SideOf(i), 100, 10,
+                         Trading::OMOrderState::PENDING_NEW};
+        orders.find(id)->second.state = Trading::OMOrderState::LIVE;
+        orders.find(id)->second.qty   = 4;
+        auto order                    = orders.find(id);
+        order->second.state = Trading::OMOrderState::PENDING_CANCEL;
+        benchmark::DoNotOptimize(order);
+        orders.erase(id);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations() * 5);
+}
+BENCHMARK(BM_OMOrdersMap)->Arg(10'000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "aot/pnl/pnl_book.h"
+
+namespace {
+struct Fill {
+    common::Price entry_price;
+    common::Price exit_price;
+    common::Qty qty;
+    uint32_t pair;
+};
+
+/// closed transactions over pairs of different precisions
+std::vector<Fill> MakeFills(size_t count, size_t pairs) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<common::Price> price(6'000'000, 6'100'000);
+    std::uniform_int_distribution<common::Qty> qty(1, 100'000);
+    std::uniform_int_distribution<uint32_t> pair(0, pairs - 1);
+    std::vector<Fill> fills(count);
+    for (auto& fill : fills)
+        fill = {price(generator), price(generator), qty(generator),
+                pair(generator)};
+    return fills;
+}
+
+std::vector<common::TradingPairInfo> MakePairs(size_t pairs) {
+    std::vector<common::TradingPairInfo> infos(pairs);
+    for (size_t i = 0; i < pairs; ++i)
+        infos[i] = {.price_precission = static_cast<uint8_t>(2 + i % 6),
+                    .qty_precission   = static_cast<uint8_t>(8 - i % 6)};
+    return infos;
+}
+}  // namespace
+
+/// what PnlCalculator did per transaction: three conversions with std::pow()
+static void BM_DoublePnlPow(benchmark::State& state) {
+    auto infos = MakePairs(state.range(1));
+    auto fills = MakeFills(state.range(0), infos.size());
+    for (auto _ : state) {
+        double total = 0;
+        for (const auto& fill : fills) {
+            const auto& info = infos[fill.pair];
+            const double qty = fill.qty * std::pow(10, -info.qty_precission);
+            total += (fill.exit_price * std::pow(10, -info.price_precission) -
+                      fill.entry_price * std::pow(10, -info.price_precission)) *
+                     qty;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * fills.size());
+}
+BENCHMARK(BM_DoublePnlPow)->Args({10'000, 500});
+
+/// integer product and one conversion by the cached scale
+static void BM_FixedPnl(benchmark::State& state) {
+    auto infos = MakePairs(state.range(1));
+    auto fills = MakeFills(state.range(0), infos.size());
+    for (auto _ : state) {
+        double total = 0;
+        for (const auto& fill : fills) {
+            const auto price_diff =
+                static_cast<common::PnlFixed>(fill.exit_price) -
+                static_cast<common::PnlFixed>(fill.entry_price);
+            total += infos[fill.pair].GetPnlDouble(price_diff * fill.qty);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * fills.size());
+}
+BENCHMARK(BM_FixedPnl)->Args({10'000, 500});
+
+/// a tick of every instrument: BBO marks the position, then one total report
+static void BM_PnlBookTick(benchmark::State& state) {
+    auto infos = MakePairs(state.range(0));
+    auto fills = MakeFills(infos.size(), infos.size());
+    aot::PnlBook book;
+    for (const auto& info : infos) book.AddInstrument(info);
+    for (aot::PnlBook::Id id = 0; id < infos.size(); ++id)
+        book.AddFill(id, common::Side::kAsk, fills[id].entry_price,
+                     fills[id].qty);
+    common::Price shift = 0;
+    for (auto _ : state) {
+        shift = (shift + 1) & 15;
+        for (aot::PnlBook::Id id = 0; id < infos.size(); ++id)
+            book.UpdateBBO(id, fills[id].exit_price + shift,
+                           fills[id].exit_price + shift + 2);
+        benchmark::DoNotOptimize(book.TotalPnlDouble());
+    }
+    state.SetItemsProcessed(state.iterations() * infos.size());
+}
+BENCHMARK(BM_PnlBookTick)->Arg(500);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <span>
+#include <string>
+
+#include "nlohmann/json.hpp"
+#include "aot/common/types.h"
+#include "aot/proto/classes/proto_orderbook.h"
+#include "aot/redpanda_client/bbo_batch.h"
+#include "aot/strategy/market_order.h"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
+
+namespace {
+/// every kPollEvery messages the producer thread drains the posted work
+constexpr int kPollEvery = 256;
+
+/// Stands for cppkafka::Producer, it only counts what would be sent.
+struct StubProducer {
+    uint64_t messages = 0;
+    uint64_t bytes    = 0;
+    void Produce(std::span<const std::byte> payload) {
+        ++messages;
+        bytes += payload.size();
+    }
+};
+
+/// Sink of the batcher on top of the stub, the arena is released at once.
+struct StubSink {
+    StubProducer &producer;
+    aot::BBOBatcher<StubSink> *batcher = nullptr;
+    void Produce(std::span<const std::byte> payload,
+                 aot::BBOBatchEncoder *arena) {
+        producer.Produce(payload);
+        batcher->Release(arena);
+    }
+};
+
+void FillBBO(Trading::NewBBO &bbo, uint64_t i) {
+    bbo.exchange_id   = common::ExchangeId::kBinance;
+    bbo.trading_pair  = {2, 1};
+    bbo.market_type   = common::MarketType::kSpot;
+    bbo.bbo.bid_price = 6'500'000 + (i & 63);
+    bbo.bbo.ask_price = bbo.bbo.bid_price + 1;
+    bbo.bbo.bid_qty   = 1'000 + (i & 7);
+    bbo.bbo.ask_qty   = 2'000 + (i & 7);
+}
+
+const common::TradingPairInfo kInfo{.price_precission   = 2,
+                                    .qty_precission     = 5,
+                                    .https_json_request = "BTCUSDT"};
+}  // namespace
+
+/// what RedPandaComponent does per BBO in kJson mode: OrderBook with three
+/// strings, nlohmann::json, dump() and a string posted to the producer
+static void BM_JsonPerBBO(benchmark::State &state) {
+    boost::asio::io_context ioc;
+    StubProducer producer;
+    Trading::NewBBO bbo;
+    uint64_t i = 0;
+    for (auto _ : state) {
+        FillBBO(bbo, i);
+        double price_multiplier = std::pow(10, -kInfo.price_precission);
+        double qty_multiplier   = std::pow(10, -kInfo.qty_precission);
+        double bid              = bbo.bbo.bid_price * price_multiplier;
+        double ask              = bbo.bbo.ask_price * price_multiplier;
+        aot::models::OrderBook ob(
+            common::ExchangeIdPrinter::ToString(bbo.exchange_id),
+            common::MarketTypePrinter::ToString(bbo.market_type),
+            kInfo.https_json_request, bid, ask, ask - bid,
+            bbo.bbo.bid_qty * qty_multiplier, bbo.bbo.ask_qty * qty_multiplier);
+        nlohmann::json json;
+        ob.SerializeToJson(json);
+        std::string json_string = json.dump();
+        boost::asio::post(ioc, [&producer, json_string]() {
+            producer.Produce(std::as_bytes(std::span(json_string)));
+        });
+        if (++i % kPollEvery == 0) {
+            ioc.poll();
+            ioc.restart();
+        }
+    }
+    ioc.poll();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_bbo"] =
+        static_cast<double>(producer.bytes) / producer.messages;
+}
+BENCHMARK(BM_JsonPerBBO);
+
+/// kBinaryBatch: 56 byte record posted to the producer, batched in an arena
+static void BM_BinaryBatch(benchmark::State &state) {
+    boost::asio::io_context ioc;
+    StubProducer producer;
+    StubSink sink{producer};
+    aot::BBOBatcher<StubSink> batcher(
+        {.max_records = static_cast<size_t>(state.range(0))}, sink);
+    sink.batcher = &batcher;
+    Trading::NewBBO bbo;
+    uint64_t i = 0;
+    for (auto _ : state) {
+        FillBBO(bbo, i);
+        auto record = aot::MakeBBORecord(bbo, kInfo, 0);
+        boost::asio::post(ioc, [&batcher, record]() { batcher.Add(record); });
+        if (++i % kPollEvery == 0) {
+            ioc.poll();
+            ioc.restart();
+        }
+    }
+    ioc.poll();
+    batcher.Flush();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_bbo"] =
+        static_cast<double>(producer.bytes) / batcher.Records();
+    state.counters["messages"] = producer.messages;
+}
+BENCHMARK(BM_BinaryBatch)->Arg(1)->Arg(64)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "aot/backtesting/replay.h"
+#include "aot/strategy/arbitrage/arbitrage_strategy.h"
+#include "aot/strategy/market_order_book.h"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/thread_pool.hpp"
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+}  // namespace
+
+/// recorded diffs of two exchanges through order books and the arbitrage
+/// strategy, items are replayed diffs
+static void BM_ReplayDepth(benchmark::State& state) {
+    fmtlog::setLogLevel(fmtlog::OFF);
+    const auto diffs = static_cast<size_t>(state.range(0));
+    Exchange::BookDiff2SnapshotPool pool(diffs);
+    backtesting::ReplayTape tapes[2];
+    const common::ExchangeId exchanges[2] = {common::ExchangeId::kBinance,
+                                             common::ExchangeId::kBybit};
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<common::Price> price(9'900, 10'100);
+    std::uniform_int_distribution<common::Qty> qty(0, 10);
+    for (size_t i = 0; i < diffs; ++i) {
+        auto bid = price(generator);
+        tapes[i % 2].Add(
+            static_cast<common::Nanos>(i) * 1'000,
+            boost::intrusive_ptr<Exchange::BookDiffSnapshot2>(pool.Allocate(
+                &pool, exchanges[i % 2], kBtcUsdt,
+                Exchange::BookLevels{{bid, qty(generator)}},
+                Exchange::BookLevels{{bid + 5, qty(generator)}}, 0, 0)));
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        boost::asio::io_context context;
+        boost::asio::thread_pool bus_pool(1);
+        aot::CoBus bus(bus_pool);
+        aot::ExchangeTradingPairs exchange_trading_pairs;
+        Trading::OrderBookComponent<Strand> books(
+            boost::asio::make_strand(context), bus, 1024,
+            common::MarketType::kSpot);
+        aot::ArbitrageStrategyComponent strategy(context, bus, 1024,
+                                                 exchange_trading_pairs);
+        aot::ArbitrageCycle cycle;
+        for (auto exchange_id : exchanges) {
+            books.AddOrderBook(exchange_id, kBtcUsdt);
+            exchange_trading_pairs.AddOrUpdatePair(
+                exchange_id, kBtcUsdt,
+                {.price_precission = 2, .qty_precission = 3});
+        }
+        cycle.push_back({kBtcUsdt, exchanges[0], common::MarketType::kSpot,
+                         aot::Operation::kBuy});
+        cycle.push_back({kBtcUsdt, exchanges[1], common::MarketType::kSpot,
+                         aot::Operation::kSell});
+        strategy.AddArbitrageCycle(cycle);
+        bus.Subscribe(&books, &strategy);
+        backtesting::ReplayEngine engine(context, bus);
+        for (auto& tape : tapes) {
+            tape.Rewind();
+            bus.Subscribe(&engine.AddFeed(tape), &books);
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(engine.Run());
+        state.PauseTiming();
+        bus_pool.join();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * diffs);
+}
+BENCHMARK(BM_ReplayDepth)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
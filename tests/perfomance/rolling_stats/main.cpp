@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "aot/common/rolling_stats.h"
+
+namespace {
+/// spreads of one tick, one per series
+std::vector<double> MakeSpreads(size_t series) {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> spread(10.0, 2.0);
+    std::vector<double> spreads(series);
+    for (auto& value : spreads) value = spread(generator);
+    return spreads;
+}
+}  // namespace
+
+/// what SpreadMonitor did per spread: map lookups, deque of the window and the
+/// average by a full loop
+static void BM_DequeRecompute(benchmark::State& state) {
+    const auto series = static_cast<size_t>(state.range(0));
+    const auto window = static_cast<size_t>(state.range(1));
+    auto spreads      = MakeSpreads(series);
+    std::unordered_map<size_t, std::deque<double>> history;
+    for (size_t key = 0; key < series; ++key)
+        history[key].assign(window, spreads[key]);
+    for (auto _ : state) {
+        for (size_t key = 0; key < series; ++key) {
+            if (history.find(key) == history.end()) history[key] = {};
+            history[key].push_back(spreads[key]);
+            if (history[key].size() > window) history[key].pop_front();
+            double sum = 0;
+            for (double spread : history[key]) sum += spread;
+            benchmark::DoNotOptimize(sum / history[key].size());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * series);
+}
+BENCHMARK(BM_DequeRecompute)->Args({1'000, 64})->Args({1'000, 1'024});
+
+/// RollingStats::AddBatch(), z-score and O(1) update of every series
+static void BM_RollingStatsBatch(benchmark::State& state) {
+    const auto series = static_cast<size_t>(state.range(0));
+    common::RollingStats stats(
+        {.capacity = static_cast<size_t>(state.range(1)), .window = 0});
+    std::vector<common::RollingStats::SeriesId> ids(series);
+    for (auto& id : ids) id = stats.AddSeries();
+    auto spreads = MakeSpreads(series);
+    std::vector<double> z_scores(series);
+    common::Nanos time = 0;
+    for (auto _ : state) {
+        stats.AddBatch(ids, spreads, ++time, z_scores);
+        benchmark::DoNotOptimize(z_scores.data());
+    }
+    state.SetItemsProcessed(state.iterations() * series);
+}
+BENCHMARK(BM_RollingStatsBatch)->Args({1'000, 64})->Args({1'000, 1'024});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+
+#include "aot/Binance.h"
+#include "aot/order_gw/signed_request.h"
+
+namespace {
+constexpr std::string_view kApiKey    = "api-key-for-benchmarks";
+constexpr std::string_view kSecretKey = "secret-key-for-benchmarks";
+const common::TradingPair kBtcUsdt{2, 1};
+
+common::TradingPairHashMap& Pairs() {
+    static common::TradingPairHashMap pairs = [] {
+        common::TradingPairHashMap result;
+        result[kBtcUsdt] = common::TradingPairInfo{
+            .price_precission     = 2,
+            .qty_precission       = 5,
+            .https_json_request   = "BTCUSDT",
+            .https_query_request  = "BTCUSDT",
+            .ws_query_request     = "btcusdt",
+            .https_query_response = "BTCUSDT"};
+        return result;
+    }();
+    return pairs;
+}
+const Endpoint kEndpoint("testnet.binance.vision", 443, 5000, 60000);
+}  // namespace
+
+/// the request OrderNewLimit3::CoExec builds for every order, not serialized
+static void BM_FactoryRequest(benchmark::State& state) {
+    hmac_sha256::Signer signer(hmac_sha256::Keys{kApiKey, kSecretKey});
+    Exchange::RequestNewOrder request;
+    request.trading_pair = kBtcUsdt;
+    request.side         = common::Side::kAsk;
+    request.qty          = 123'456;
+    common::OrderId id   = 1;
+    for (auto _ : state) {
+        request.price    = 6'543'210 + id % 100;
+        request.order_id = id++;
+        binance::detail::FamilyLimitOrder::ArgsOrder args(&request, Pairs());
+        binance::detail::FactoryRequest factory{
+            kEndpoint,
+            binance::detail::FamilyLimitOrder::end_point,
+            args,
+            boost::beast::http::verb::post,
+            &signer,
+            true};
+        auto req = factory();
+        benchmark::DoNotOptimize(req);
+    }
+}
+BENCHMARK(BM_FactoryRequest);
+
+/// the same order as the bytes on the wire
+static void BM_SignedRequestTemplate(benchmark::State& state) {
+    hmac_sha256::KeyedHmac hmac(kSecretKey);
+    auto request_template = binance::detail::MakeNewLimitOrderTemplate(
+        kEndpoint, kBtcUsdt, common::Side::kAsk, Pairs(), kApiKey, hmac);
+    CurrentTime time_service;
+    common::OrderId id = 1;
+    for (auto _ : state) {
+        auto wire = request_template.Render(6'543'210 + id % 100, 123'456,
+                                            id, time_service.Time());
+        ++id;
+        benchmark::DoNotOptimize(wire);
+    }
+}
+BENCHMARK(BM_SignedRequestTemplate);
+
+static void BM_SignerSign(benchmark::State& state) {
+    hmac_sha256::Signer signer(hmac_sha256::Keys{kApiKey, kSecretKey});
+    const std::string payload(state.range(0), 'a');
+    for (auto _ : state) benchmark::DoNotOptimize(signer.Sign(payload));
+}
+BENCHMARK(BM_SignerSign)->Arg(180);
+
+static void BM_KeyedHmacSign(benchmark::State& state) {
+    hmac_sha256::KeyedHmac hmac(kSecretKey);
+    const std::string payload(state.range(0), 'a');
+    std::array<char, hmac_sha256::kHexDigestSize> digest;
+    for (auto _ : state) {
+        hmac.Sign(payload, digest);
+        benchmark::DoNotOptimize(digest);
+    }
+}
+BENCHMARK(BM_KeyedHmacSign)->Arg(180);
+
+BENCHMARK_MAIN();
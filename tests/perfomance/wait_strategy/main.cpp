@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "aot/common/wait_strategy.h"
+#include "concurrentqueue.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+/// messages the producer sends per run
+constexpr size_t kMessages = 20'000;
+
+double ThreadCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief the producer enqueues send timestamps at state.range(0) messages per
+ * second and notifies the waiter, the consumer polls the queue as the loops of
+ * OrderGateway2 and OrderBookService do. Reports the latency from enqueue to
+ * dequeue and the cpu time of the consumer per second of run.
+ */
+void Run(benchmark::State& state, common::WaitPolicy policy) {
+    const auto rate     = static_cast<size_t>(state.range(0));
+    const auto interval = std::chrono::nanoseconds(1'000'000'000 / rate);
+    const auto messages = std::min(kMessages, rate);
+    std::vector<double> latencies;
+    double cpu_seconds = 0, wall_seconds = 0;
+    uint64_t parks     = 0;
+
+    for (auto _ : state) {
+        moodycamel::ConcurrentQueue<int64_t> queue(messages);
+        common::WaitStrategy wait({.policy = policy});
+        std::atomic<bool> run = true;
+        std::vector<double> run_latencies;
+        run_latencies.reserve(messages);
+        double cpu = 0;
+
+        std::thread consumer([&] {
+            const auto cpu_start = ThreadCpuSeconds();
+            int64_t sent[50];
+            while (run.load(std::memory_order_relaxed)) {
+                size_t count = queue.try_dequeue_bulk(sent, 50);
+                if (count) {
+                    const auto now = NowNs();
+                    for (size_t i = 0; i < count; ++i)
+                        run_latencies.push_back((now - sent[i]) / 1e3);
+                    wait.Busy();
+                    continue;
+                }
+                wait.Idle([&] {
+                    return !run.load(std::memory_order_relaxed) ||
+                           queue.size_approx();
+                });
+            }
+            cpu = ThreadCpuSeconds() - cpu_start;
+        });
+
+        const auto start = Clock::now();
+        auto next        = start;
+        for (size_t i = 0; i < messages; ++i) {
+            next += interval;
+            while (Clock::now() < next) {
+            }
+            queue.enqueue(NowNs());
+            wait.Notify();
+        }
+        while (queue.size_approx()) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        run = false;
+        wait.Notify();
+        consumer.join();
+
+        wall_seconds += std::chrono::duration<double>(Clock::now() - start)
+                            .count();
+        cpu_seconds  += cpu;
+        parks        += wait.Parks();
+        latencies.insert(latencies.end(), run_latencies.begin(),
+                         run_latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    state.counters["p50_us"]      = percentile(0.5);
+    state.counters["p99_us"]      = percentile(0.99);
+    state.counters["p999_us"]     = percentile(0.999);
+    state.counters["cpu_per_s"]   = cpu_seconds / wall_seconds;
+    state.counters["parks_per_s"] = parks / wall_seconds;
+}
+
+void Rates(benchmark::internal::Benchmark* benchmark) {
+    benchmark->Arg(1'000)
+        ->Arg(10'000)
+        ->Arg(100'000)
+        ->Iterations(3)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+}
+}  // namespace
+
+static void BM_BusySpin(benchmark::State& state) {
+    Run(state, common::WaitPolicy::kBusySpin);
+}
+BENCHMARK(BM_BusySpin)->Apply(Rates);
+
+static void BM_SpinPause(benchmark::State& state) {
+    Run(state, common::WaitPolicy::kSpinPause);
+}
+BENCHMARK(BM_SpinPause)->Apply(Rates);
+
+static void BM_SpinYield(benchmark::State& state) {
+    Run(state, common::WaitPolicy::kSpinYield);
+}
+BENCHMARK(BM_SpinYield)->Apply(Rates);
+
+static void BM_SpinPark(benchmark::State& state) {
+    Run(state, common::WaitPolicy::kSpinPark);
+}
+BENCHMARK(BM_SpinPark)->Apply(Rates);
+
+BENCHMARK_MAIN();
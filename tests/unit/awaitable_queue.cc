@@ -0,0 +1,123 @@
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include "aot/common/awaitable_queue.h"
+#include "gtest/gtest.h"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+using Queue = common::AwaitableQueue<int>;
+
+boost::asio::awaitable<void> Pop(Queue& queue, Queue::Duration timeout,
+                                 std::vector<std::optional<int>>& result) {
+    result.push_back(
+        co_await queue.AsyncPop(timeout, boost::asio::use_awaitable));
+}
+}  // namespace
+
+TEST(AwaitableQueue, IdleValueCompletesAtOnce) {
+    boost::asio::io_context ioc;
+    Queue queue(ioc.get_executor());
+    queue.Push(1);
+    queue.Push(2);
+    EXPECT_TRUE(queue.Remove(2));
+    EXPECT_FALSE(queue.Remove(2));
+    std::vector<std::optional<int>> result;
+    boost::asio::co_spawn(ioc, Pop(queue, 1s, result), boost::asio::detached);
+    ioc.run();
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], 1);
+    EXPECT_EQ(queue.Idle(), 0);
+    EXPECT_FALSE(queue.TryPop());
+}
+
+TEST(AwaitableQueue, WaitersAreServedInOrder) {
+    boost::asio::io_context ioc;
+    Queue queue(ioc.get_executor());
+    std::vector<std::optional<int>> result;
+    for (int i = 0; i < 3; ++i)
+        boost::asio::co_spawn(ioc, Pop(queue, 1s, result),
+                              boost::asio::detached);
+    ioc.poll();
+    ASSERT_EQ(queue.Waiters(), 3);
+    for (int i = 0; i < 3; ++i) queue.Push(i);
+    ioc.run();
+    ASSERT_EQ(result.size(), 3);
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(result[i], i);
+    EXPECT_EQ(queue.Idle(), 0);
+}
+
+TEST(AwaitableQueue, ValueGoesToOneWaiterAndOthersTimeOut) {
+    boost::asio::io_context ioc;
+    Queue queue(ioc.get_executor());
+    std::vector<std::optional<int>> result;
+    for (int i = 0; i < 4; ++i)
+        boost::asio::co_spawn(ioc, Pop(queue, 20ms, result),
+                              boost::asio::detached);
+    ioc.poll();
+    queue.Push(7);
+    queue.Push(8);
+    ioc.run();
+    ASSERT_EQ(result.size(), 4);
+    EXPECT_EQ(result[0], 7);
+    EXPECT_EQ(result[1], 8);
+    EXPECT_FALSE(result[2]);
+    EXPECT_FALSE(result[3]);
+    EXPECT_EQ(queue.Waiters(), 0);
+
+    queue.Push(9);
+    EXPECT_EQ(queue.TryPop(), 9);
+}
+
+TEST(AwaitableQueue, CancelledWaitersGetNothing) {
+    boost::asio::io_context ioc;
+    Queue queue(ioc.get_executor());
+    std::vector<std::optional<int>> result;
+    boost::asio::co_spawn(ioc, Pop(queue, 1h, result), boost::asio::detached);
+    ioc.poll();
+    queue.CancelWaiters();
+    ioc.run();
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_FALSE(result[0]);
+}
+
+TEST(AwaitableQueue, CheckoutIsExclusiveAcrossThreads) {
+    constexpr int kObjects  = 4;
+    constexpr int kRequests = 1000;
+    boost::asio::io_context ioc;
+    Queue queue(ioc.get_executor());
+    for (int i = 0; i < kObjects; ++i) queue.Push(i);
+
+    std::array<std::atomic<int>, kObjects> owners{};
+    std::atomic<int> shared = 0, served = 0;
+    for (int i = 0; i < kRequests; ++i)
+        boost::asio::co_spawn(
+            ioc,
+            [&]() -> boost::asio::awaitable<void> {
+                auto object = co_await queue.AsyncPop(
+                    10s, boost::asio::use_awaitable);
+                if (!object) co_return;
+                if (owners[*object].fetch_add(1) != 0) ++shared;
+                co_await boost::asio::post(ioc, boost::asio::use_awaitable);
+                owners[*object].fetch_sub(1);
+                ++served;
+                queue.Push(*object);
+            },
+            boost::asio::detached);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) threads.emplace_back([&ioc] { ioc.run(); });
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(served, kRequests);
+    EXPECT_EQ(shared, 0);
+    EXPECT_EQ(queue.Idle(), kObjects);
+}
@@ -0,0 +1,98 @@
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "aot/redpanda_client/bbo_batch.h"
+#include "gtest/gtest.h"
+
+namespace {
+/// Keeps produced batches, releases them only when asked as kafka does.
+struct StubSink {
+    std::vector<std::vector<std::byte>> payloads;
+    std::vector<aot::BBOBatchEncoder *> in_flight;
+    void Produce(std::span<const std::byte> payload,
+                 aot::BBOBatchEncoder *arena) {
+        payloads.emplace_back(payload.begin(), payload.end());
+        in_flight.push_back(arena);
+    }
+};
+
+aot::BBORecord MakeRecord(uint64_t bid_price) {
+    Trading::NewBBO bbo;
+    bbo.exchange_id   = common::ExchangeId::kBybit;
+    bbo.trading_pair  = {2, 1};
+    bbo.market_type   = common::MarketType::kFutures;
+    bbo.bbo.bid_price = bid_price;
+    bbo.bbo.ask_price = bid_price + 1;
+    bbo.bbo.bid_qty   = 10;
+    bbo.bbo.ask_qty   = 20;
+    common::TradingPairInfo info{.price_precission = 2, .qty_precission = 3};
+    return aot::MakeBBORecord(bbo, info, 123);
+}
+
+std::vector<aot::BBORecord> Decode(const std::vector<std::byte> &payload) {
+    aot::BBOBatchHeader header;
+    std::memcpy(&header, payload.data(), sizeof(header));
+    EXPECT_EQ(header.magic, aot::BBOBatchHeader::kMagic);
+    EXPECT_EQ(header.record_size, sizeof(aot::BBORecord));
+    EXPECT_EQ(payload.size(),
+              sizeof(header) + header.count * sizeof(aot::BBORecord));
+    std::vector<aot::BBORecord> records(header.count);
+    std::memcpy(records.data(), payload.data() + sizeof(header),
+                header.count * sizeof(aot::BBORecord));
+    return records;
+}
+}  // namespace
+
+TEST(BBOBatcher, ShouldSendFullBatchAtOnce) {
+    StubSink sink;
+    aot::BBOBatcher<StubSink> batcher({.max_records = 3, .arenas = 2}, sink);
+    EXPECT_TRUE(batcher.Add(MakeRecord(100)));
+    EXPECT_FALSE(batcher.Add(MakeRecord(101)));
+    EXPECT_TRUE(sink.payloads.empty());
+    batcher.Add(MakeRecord(102));
+    ASSERT_EQ(sink.payloads.size(), 1);
+
+    auto records = Decode(sink.payloads[0]);
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(records[2].bid_price, 102);
+    EXPECT_EQ(records[2].ask_price, 103);
+    EXPECT_EQ(records[0].base, 2);
+    EXPECT_EQ(records[0].quote, 1);
+    EXPECT_EQ(records[0].exchange_id,
+              static_cast<uint8_t>(common::ExchangeId::kBybit));
+    EXPECT_EQ(records[0].price_precision, 2);
+    EXPECT_EQ(records[0].qty_precision, 3);
+    EXPECT_EQ(records[0].timestamp_ns, 123);
+}
+
+TEST(BBOBatcher, ShouldSendPartialBatchOnFlush) {
+    StubSink sink;
+    aot::BBOBatcher<StubSink> batcher({.max_records = 8}, sink);
+    batcher.Flush();
+    EXPECT_TRUE(sink.payloads.empty());
+    batcher.Add(MakeRecord(100));
+    batcher.Flush();
+    ASSERT_EQ(sink.payloads.size(), 1);
+    EXPECT_EQ(Decode(sink.payloads[0]).size(), 1);
+    // the next record opens a new batch
+    EXPECT_TRUE(batcher.Add(MakeRecord(101)));
+}
+
+TEST(BBOBatcher, ShouldReuseArenasAfterRelease) {
+    StubSink sink;
+    aot::BBOBatcher<StubSink> batcher({.max_records = 1, .arenas = 2}, sink);
+    batcher.Add(MakeRecord(100));
+    batcher.Add(MakeRecord(101));
+    EXPECT_EQ(batcher.InFlight(), 2);
+    // all arenas are in flight, one more is allocated
+    batcher.Add(MakeRecord(102));
+    EXPECT_EQ(batcher.InFlight(), 3);
+
+    for (auto *arena : sink.in_flight) batcher.Release(arena);
+    EXPECT_EQ(batcher.InFlight(), 0);
+    batcher.Add(MakeRecord(103));
+    EXPECT_EQ(sink.in_flight.back(), sink.in_flight[2]);
+    EXPECT_EQ(batcher.Batches(), 4);
+    EXPECT_EQ(batcher.Records(), 4);
+}
@@ -0,0 +1,146 @@
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "aot/strategy/bbo_conflator.h"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/strand.hpp"
+#include "boost/asio/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+class Recorder : public bus::Component {
+  public:
+    std::vector<boost::intrusive_ptr<Trading::NewBBOEnvelope>> events;
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope> event) override {
+        events.push_back(std::move(event));
+    }
+};
+
+/// Checks on its strand that a key never goes back to an older BBO.
+class MonotonicRecorder : public bus::Component {
+  public:
+    std::atomic<uint64_t> events{0};
+    std::atomic<bool> went_back{false};
+    std::unordered_map<common::TradingPair, common::Price,
+                       common::TradingPairHash>
+        last;
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<Trading::NewBBOEnvelope> event) override {
+        const auto &bbo = event->WrappedEvent()->bbo;
+        auto &price     = last[event->WrappedEvent()->trading_pair];
+        if (bbo.bid_price < price || bbo.ask_price != bbo.bid_price + 1)
+            went_back = true;
+        price = bbo.bid_price;
+        events.fetch_add(1);
+    }
+};
+
+Trading::BBO MakeBBO(common::Price bid_price) {
+    Trading::BBO bbo;
+    bbo.bid_price = bid_price;
+    bbo.ask_price = bid_price + 1;
+    bbo.bid_qty   = 1;
+    bbo.ask_qty   = 1;
+    return bbo;
+}
+
+/// Sends BBO as OrderBookComponent does, from its own pool.
+void Send(Trading::BBOConflator &conflator, Trading::NewBBOEnvelopePool &pool,
+          common::TradingPair trading_pair, common::Price bid_price) {
+    conflator.AsyncHandleEvent(boost::intrusive_ptr<Trading::NewBBOEnvelope>(
+        pool.Allocate(&pool, common::ExchangeId::kBinance, trading_pair,
+                      MakeBBO(bid_price), common::MarketType::kSpot)));
+}
+}  // namespace
+
+TEST(BBOConflator, ShouldDeliverOnlyLatestBBOPerKey) {
+    boost::asio::io_context ioc;
+    Trading::NewBBOEnvelopePool pool{8};
+    Trading::BBOConflator conflator{8};
+    Recorder recorder;
+    auto id = conflator.Subscribe(&recorder, ioc.get_executor());
+
+    Send(conflator, pool, {2, 1}, 100);
+    Send(conflator, pool, {3, 1}, 500);
+    Send(conflator, pool, {2, 1}, 101);
+    Send(conflator, pool, {2, 1}, 102);
+    // events of the book are not held while the subscriber is busy
+    EXPECT_EQ(pool.Stats().InUse(), 0);
+    EXPECT_EQ(conflator.Keys(), 2);
+
+    ioc.run();
+    ASSERT_EQ(recorder.events.size(), 2);
+    EXPECT_EQ(recorder.events[0]->WrappedEvent()->bbo.bid_price, 102);
+    EXPECT_EQ(recorder.events[1]->WrappedEvent()->bbo.bid_price, 500);
+
+    auto stats = conflator.Stats(id);
+    EXPECT_EQ(stats.received, 4);
+    EXPECT_EQ(stats.delivered, 2);
+    EXPECT_EQ(stats.conflated, 2);
+    EXPECT_EQ(stats.drains, 1);
+}
+
+TEST(BBOConflator, ShouldConflatePerSubscriber) {
+    boost::asio::io_context fast_ioc;
+    boost::asio::io_context slow_ioc;
+    Trading::NewBBOEnvelopePool pool{8};
+    Trading::BBOConflator conflator{8};
+    Recorder fast;
+    Recorder slow;
+    auto fast_id = conflator.Subscribe(&fast, fast_ioc.get_executor());
+    auto slow_id = conflator.Subscribe(&slow, slow_ioc.get_executor());
+
+    for (common::Price price = 100; price < 105; ++price) {
+        Send(conflator, pool, {2, 1}, price);
+        fast_ioc.run();
+        fast_ioc.restart();
+    }
+    ASSERT_EQ(fast.events.size(), 5);
+    EXPECT_EQ(conflator.Stats(fast_id).conflated, 0);
+
+    slow_ioc.run();
+    ASSERT_EQ(slow.events.size(), 1);
+    EXPECT_EQ(slow.events[0]->WrappedEvent()->bbo.bid_price, 104);
+    EXPECT_EQ(conflator.Stats(slow_id).conflated, 4);
+
+    // a drained key is delivered again after a new BBO
+    Send(conflator, pool, {2, 1}, 200);
+    slow_ioc.restart();
+    slow_ioc.run();
+    ASSERT_EQ(slow.events.size(), 2);
+    EXPECT_EQ(slow.events[1]->WrappedEvent()->bbo.bid_price, 200);
+}
+
+TEST(BBOConflator, ShouldConflateBBOsFromSeveralThreads) {
+    constexpr size_t kThreads = 4;
+    constexpr common::Price kBBOs = 2000;
+    boost::asio::thread_pool thread_pool{2};
+    Trading::BBOConflator conflator{256, 16};
+    MonotonicRecorder recorder;
+    auto id = conflator.Subscribe(&recorder,
+                                  boost::asio::make_strand(thread_pool));
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kThreads; ++i)
+        threads.emplace_back([&conflator, i]() {
+            Trading::NewBBOEnvelopePool pool{16};
+            // every thread owns one key, as a book of OrderBookComponent
+            for (common::Price price = 1; price <= kBBOs; ++price)
+                Send(conflator, pool, {static_cast<uint32_t>(i + 1), 1},
+                     price);
+        });
+    for (auto &thread : threads) thread.join();
+    thread_pool.join();
+
+    EXPECT_EQ(conflator.Keys(), kThreads);
+    EXPECT_FALSE(recorder.went_back);
+    for (size_t i = 0; i < kThreads; ++i)
+        EXPECT_EQ((recorder.last[{static_cast<uint32_t>(i + 1), 1}]), kBBOs);
+    auto stats = conflator.Stats(id);
+    EXPECT_EQ(stats.received, kThreads * kBBOs);
+    EXPECT_EQ(stats.delivered, recorder.events);
+    EXPECT_EQ(stats.delivered + stats.conflated, stats.received);
+}
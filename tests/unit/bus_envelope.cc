@@ -0,0 +1,77 @@
+#include <vector>
+
+#include "aot/bus/bus.h"
+#include "aot/bus/bus_envelope.h"
+#include "aot/market_data/market_update.h"
+#include "gtest/gtest.h"
+
+namespace {
+using Envelope = Exchange::MEMarketUpdate2Envelope;
+
+template <class Pool>
+auto MakeDiff(Pool &pool, common::Price price, common::Qty qty) {
+    return pool.Allocate(&pool, common::ExchangeId::kBinance,
+                         common::TradingPair{2, 1},
+                         Exchange::MarketUpdateType::DEFAULT,
+                         common::kOrderIdInvalid, common::Side::kBid, price,
+                         qty);
+}
+
+class Publisher : public bus::Component {};
+
+class Subscriber : public bus::Component {
+  public:
+    std::vector<boost::intrusive_ptr<Envelope>> events;
+    void AsyncHandleEvent(boost::intrusive_ptr<Envelope> event) override {
+        events.push_back(std::move(event));
+    }
+};
+}  // namespace
+
+TEST(BusEnvelope, ShouldKeepPayloadInOneAllocation) {
+    Exchange::MEMarketUpdate2EnvelopePool pool{4};
+    {
+        boost::intrusive_ptr<Envelope> event(MakeDiff(pool, 100, 5));
+        EXPECT_EQ(pool.Stats().allocations, 1);
+        EXPECT_EQ(event->WrappedEvent()->price, 100);
+        EXPECT_EQ(event->WrappedEvent()->qty, 5);
+        EXPECT_EQ(event->WrappedEvent()->trading_pair,
+                  (common::TradingPair{2, 1}));
+    }
+    EXPECT_EQ(pool.Stats().InUse(), 0);
+}
+
+TEST(BusEnvelope, ShouldReturnToPoolAfterLastReference) {
+    Exchange::MEMarketUpdate2EnvelopePool pool{4};
+    boost::intrusive_ptr<Envelope> first(MakeDiff(pool, 100, 5));
+    auto second = first;
+    first.reset();
+    EXPECT_EQ(pool.Stats().InUse(), 1);
+    EXPECT_EQ(second->WrappedEvent()->price, 100);
+    second.reset();
+    EXPECT_EQ(pool.Stats().InUse(), 0);
+}
+
+TEST(BusEnvelope, ShouldBeDeliveredByCoBus) {
+    boost::asio::thread_pool thread_pool(1);
+    aot::CoBus bus(thread_pool);
+    Exchange::MEMarketUpdate2EnvelopePool pool{4};
+    Publisher publisher;
+    Subscriber first;
+    Subscriber second;
+    bus.Subscribe(&publisher, &first);
+    bus.Subscribe(&publisher, &second);
+
+    bus.AsyncSend(&publisher,
+                  boost::intrusive_ptr<Envelope>(MakeDiff(pool, 100, 5)));
+    ASSERT_EQ(first.events.size(), 1);
+    ASSERT_EQ(second.events.size(), 1);
+    EXPECT_EQ(first.events[0], second.events[0]);
+    EXPECT_EQ(first.events[0]->WrappedEvent()->qty, 5);
+
+    first.events.clear();
+    EXPECT_EQ(pool.Stats().InUse(), 1);
+    second.events.clear();
+    EXPECT_EQ(pool.Stats().InUse(), 0);
+    thread_pool.join();
+}
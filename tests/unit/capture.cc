@@ -0,0 +1,402 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "aot/backtesting/capture.h"
+#include "aot/backtesting/capture_recorder.h"
+#include "aot/backtesting/kline_capture.h"
+#include "boost/asio/io_context.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+const common::TradingPair kEthUsdt{3, 1};
+
+std::string TempPath(std::string_view name) {
+    return (std::filesystem::temp_directory_path() /
+            fmt::format("{}-{}.tck", name, ::getpid()))
+        .string();
+}
+
+std::vector<backtesting::TickRecord> ReadAll(
+    const backtesting::CaptureReader& reader) {
+    std::vector<backtesting::TickRecord> records;
+    backtesting::CaptureCursor cursor(reader);
+    while (const auto* record = cursor.Next()) records.push_back(*record);
+    return records;
+}
+
+bool operator==(const backtesting::TickRecord& left,
+                const backtesting::TickRecord& right) {
+    return std::memcmp(&left, &right, sizeof(left)) == 0;
+}
+
+/**
+ * @brief a day of random depth of two instruments with BBO and klines, the
+ * records the writer must produce are appended to expected
+ */
+void WriteDay(backtesting::CaptureWriter& writer, size_t events,
+              std::vector<backtesting::TickRecord>* expected) {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<common::Price> price(9'000'000, 9'100'000);
+    std::uniform_int_distribution<common::Qty> qty(0, 1'000'000);
+    std::uniform_int_distribution<size_t> levels(0, 80);
+    const common::TradingPairInfo info{.price_precission = 2,
+                                       .qty_precission   = 5};
+    const uint32_t btc = writer.Instrument(common::ExchangeId::kBinance,
+                                           common::MarketType::kSpot, kBtcUsdt,
+                                           &info);
+    const uint32_t eth = writer.Instrument(
+        common::ExchangeId::kBybit, common::MarketType::kFutures, kEthUsdt);
+    auto add = [expected](backtesting::TickRecord record) {
+        if (expected) expected->push_back(record);
+    };
+    common::Nanos time = 1'700'000'000'000'000'000;
+    for (size_t i = 0; i < events; ++i) {
+        time            += 1'000 + i % 7;
+        const auto id    = i % 3 ? btc : eth;
+        const auto type  = i % 5 == 0 ? backtesting::TickType::kSnapshot
+                                      : backtesting::TickType::kDiff;
+        Exchange::BookLevels bids;
+        Exchange::BookLevels asks;
+        backtesting::TickRecord record{.time       = time,
+                                       .first_id   = i * 10,
+                                       .last_id    = i * 10 + 9,
+                                       .instrument = id,
+                                       .type       = type};
+        if (type == backtesting::TickType::kSnapshot) record.first_id = 0;
+        for (size_t level = levels(generator); level; --level)
+            (level % 2 ? bids : asks).emplace_back(price(generator),
+                                                   qty(generator));
+        // records go bids first, then asks
+        for (const auto& level : bids) {
+            record.price = level.price;
+            record.qty   = level.qty;
+            record.side  = common::Side::kBid;
+            add(record);
+        }
+        for (const auto& level : asks) {
+            record.price = level.price;
+            record.qty   = level.qty;
+            record.side  = common::Side::kAsk;
+            add(record);
+        }
+        if (bids.empty() && asks.empty()) {
+            record.price = common::kPriceInvalid;
+            record.qty   = common::kQtyInvalid;
+            record.side  = common::Side::kInvalid;
+            add(record);
+        }
+        if (expected)
+            expected->back().flags = backtesting::TickRecord::kEventEnd;
+        if (type == backtesting::TickType::kSnapshot) {
+            Exchange::BookSnapshot2 snapshot(
+                nullptr, common::ExchangeId::kBinance, kBtcUsdt,
+                std::move(bids), std::move(asks), i * 10 + 9);
+            writer.Write(time, id, snapshot);
+        } else {
+            Exchange::BookDiffSnapshot2 diff(
+                nullptr, common::ExchangeId::kBinance, kBtcUsdt,
+                std::move(bids), std::move(asks), i * 10, i * 10 + 9);
+            writer.Write(time, id, diff);
+        }
+        if (i % 10 == 0) {
+            writer.WriteBBO(time, id, 9'000'000 + i, 5, 9'000'100 + i, 6);
+            add({.time       = time,
+                 .price      = 9'000'000 + i,
+                 .qty        = 5,
+                 .instrument = id,
+                 .type       = backtesting::TickType::kBBO,
+                 .side       = common::Side::kBid});
+            add({.time       = time,
+                 .price      = 9'000'100 + i,
+                 .qty        = 6,
+                 .instrument = id,
+                 .type       = backtesting::TickType::kBBO,
+                 .side       = common::Side::kAsk,
+                 .flags      = backtesting::TickRecord::kEventEnd});
+        }
+        if (i % 100 == 0) {
+            writer.WriteKline(time, btc, 10, 14, 9, 12, 1'000 + i);
+            const common::Price prices[] = {10, 14, 9, 12};
+            for (uint8_t field = 0; field < 4; ++field) {
+                const bool close = field == 3;
+                add({.time       = time,
+                     .price      = prices[field],
+                     .qty        = close ? 1'000 + i : 0,
+                     .instrument = btc,
+                     .type       = backtesting::TickType::kKline,
+                     .flags      = close ? backtesting::TickRecord::kEventEnd
+                                         : uint8_t{0},
+                     .field      = field});
+            }
+        }
+    }
+}
+}  // namespace
+
+TEST(Capture, ShouldReadBackWhatWasWritten) {
+    size_t sizes[2] = {};
+    for (bool packed : {false, true}) {
+        const auto path = TempPath(packed ? "packed" : "raw");
+        std::vector<backtesting::TickRecord> expected;
+        {
+            backtesting::CaptureWriter writer(
+                {.block_records = 512, .packed = packed});
+            ASSERT_TRUE(writer.Open(path));
+            WriteDay(writer, 2'000, &expected);
+            EXPECT_EQ(writer.Records(), expected.size());
+            EXPECT_TRUE(writer.Close());
+        }
+        backtesting::CaptureReader reader;
+        ASSERT_TRUE(reader.Open(path));
+        EXPECT_EQ(reader.Records(), expected.size());
+        ASSERT_EQ(reader.Instruments().size(), 2);
+        const auto& btc = reader.Instruments()[0];
+        EXPECT_EQ(btc.ExchangeId(), common::ExchangeId::kBinance);
+        EXPECT_EQ(btc.MarketType(), common::MarketType::kSpot);
+        EXPECT_EQ(btc.TradingPair(), kBtcUsdt);
+        EXPECT_EQ(btc.price_precision, 2);
+        EXPECT_EQ(btc.qty_precision, 5);
+        EXPECT_EQ(reader.Instruments()[1].TradingPair(), kEthUsdt);
+        EXPECT_GT(reader.Blocks().size(), 1);
+        // blocks end on events
+        std::vector<backtesting::TickRecord> buffer;
+        for (size_t block = 0; block < reader.Blocks().size(); ++block)
+            EXPECT_TRUE(reader.ReadBlock(block, buffer).back().EventEnd());
+        auto records = ReadAll(reader);
+        ASSERT_EQ(records.size(), expected.size());
+        for (size_t i = 0; i < records.size(); ++i)
+            ASSERT_TRUE(records[i] == expected[i]) << "record " << i;
+        sizes[packed] = std::filesystem::file_size(path);
+        std::filesystem::remove(path);
+    }
+    // levels of a diff are close, deltas take a few bytes of 48
+    EXPECT_LT(sizes[1] * 3, sizes[0]);
+}
+
+TEST(Capture, ShouldSeekByTime) {
+    const auto path = TempPath("seek");
+    std::vector<backtesting::TickRecord> expected;
+    {
+        backtesting::CaptureWriter writer({.block_records = 256});
+        ASSERT_TRUE(writer.Open(path));
+        WriteDay(writer, 1'000, &expected);
+    }
+    backtesting::CaptureReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    backtesting::CaptureCursor cursor(reader);
+    for (size_t i : {size_t{0}, size_t{1}, expected.size() / 3,
+                     expected.size() / 2, expected.size() - 1}) {
+        const auto time = expected[i].time;
+        auto first = std::find_if(expected.begin(), expected.end(),
+                                  [time](const auto& record) {
+                                      return record.time >= time;
+                                  });
+        cursor.Seek(time);
+        const auto* record = cursor.Next();
+        ASSERT_NE(record, nullptr);
+        EXPECT_TRUE(*record == *first) << "record " << i;
+    }
+    cursor.Seek(expected.back().time + 1);
+    EXPECT_EQ(cursor.Next(), nullptr);
+    cursor.Seek(0);
+    EXPECT_TRUE(*cursor.Next() == expected.front());
+    std::filesystem::remove(path);
+}
+
+TEST(Capture, ShouldRecoverFileOfCrashedWriter) {
+    for (bool packed : {false, true}) {
+        const auto path = TempPath("crashed");
+        const auto copy = TempPath("crashed-copy");
+        std::vector<backtesting::TickRecord> expected;
+        {
+            backtesting::CaptureWriter writer(
+                {.block_records = 128, .packed = packed});
+            ASSERT_TRUE(writer.Open(path));
+            WriteDay(writer, 500, &expected);
+            ASSERT_TRUE(writer.Flush());
+            // the file as the crash left it: no index, a half of a block
+            std::filesystem::copy_file(
+                path, copy, std::filesystem::copy_options::overwrite_existing);
+            backtesting::CaptureBlockHeader header{
+                .count = 10, .size = 10 * sizeof(backtesting::TickRecord)};
+            std::ofstream file(copy, std::ios::binary | std::ios::app);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(std::string(100, '\0').data(), 100);
+        }
+        backtesting::CaptureReader reader;
+        ASSERT_TRUE(reader.Open(copy));
+        EXPECT_EQ(reader.Instruments().size(), 2);
+        auto records = ReadAll(reader);
+        ASSERT_EQ(records.size(), expected.size());
+        for (size_t i = 0; i < records.size(); ++i)
+            ASSERT_TRUE(records[i] == expected[i]) << "record " << i;
+        reader.Close();
+        std::filesystem::remove(path);
+        std::filesystem::remove(copy);
+    }
+    backtesting::CaptureReader reader;
+    EXPECT_FALSE(reader.Open(TempPath("missing")));
+}
+
+TEST(Capture, ShouldRecordBusEventsAndReplayThem) {
+    const auto path = TempPath("recorder");
+    aot::ExchangeTradingPairs pairs;
+    pairs.AddOrUpdatePair(common::ExchangeId::kBinance, kBtcUsdt,
+                          {.price_precission = 2, .qty_precission = 3});
+    Exchange::BookSnapshot2Pool snapshot_pool(4);
+    Exchange::BookDiff2SnapshotPool diff_pool(4);
+    Exchange::BusEventResponseNewSnapshotPool bus_snapshot_pool(4);
+    Exchange::BusEventBookDiffSnapshotPool bus_diff_pool(4);
+    Trading::NewBBOEnvelopePool bbo_pool(4);
+    {
+        boost::asio::io_context context;
+        backtesting::CaptureWriter writer;
+        ASSERT_TRUE(writer.Open(path));
+        backtesting::CaptureRecorder recorder(context.get_executor(), writer,
+                                              common::MarketType::kSpot,
+                                              &pairs);
+        common::Nanos now = 1'000;
+        common::ScopedVirtualClock clock(now);
+        recorder.AsyncHandleEvent(
+            boost::intrusive_ptr<Exchange::BusEventResponseNewSnapshot>(
+                bus_snapshot_pool.Allocate(
+                    &bus_snapshot_pool,
+                    boost::intrusive_ptr<Exchange::BookSnapshot2>(
+                        snapshot_pool.Allocate(
+                            &snapshot_pool, common::ExchangeId::kBinance,
+                            kBtcUsdt, Exchange::BookLevels{{100, 1}, {99, 2}},
+                            Exchange::BookLevels{{101, 3}}, 10)))));
+        now = 2'000;
+        recorder.AsyncHandleEvent(
+            boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>(
+                bus_diff_pool.Allocate(
+                    &bus_diff_pool,
+                    boost::intrusive_ptr<Exchange::BookDiffSnapshot2>(
+                        diff_pool.Allocate(
+                            &diff_pool, common::ExchangeId::kBinance, kBtcUsdt,
+                            Exchange::BookLevels{{100, 0}},
+                            Exchange::BookLevels{{101, 4}}, 11, 12)))));
+        Trading::BBO bbo;
+        bbo.bid_price = 99;
+        bbo.bid_qty   = 2;
+        bbo.ask_price = 101;
+        bbo.ask_qty   = 4;
+        now           = 3'000;
+        recorder.AsyncHandleEvent(boost::intrusive_ptr<Trading::NewBBOEnvelope>(
+            bbo_pool.Allocate(&bbo_pool, common::ExchangeId::kBinance,
+                              kBtcUsdt, bbo, common::MarketType::kSpot)));
+        // nothing is written until the executor runs
+        EXPECT_EQ(writer.Records(), 0);
+        context.run();
+        EXPECT_EQ(writer.Records(), 3 + 2 + 2);
+        ASSERT_TRUE(writer.Close());
+    }
+    backtesting::CaptureReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    ASSERT_EQ(reader.Instruments().size(), 1);
+    EXPECT_EQ(reader.Instruments()[0].price_precision, 2);
+    EXPECT_EQ(reader.Instruments()[0].qty_precision, 3);
+
+    // BBO are derived from the book and are not replayed
+    backtesting::CaptureReplaySource source(reader, 4);
+    backtesting::ReplayEvent event;
+    ASSERT_TRUE(source.Next(event));
+    EXPECT_EQ(event.time, 1'000);
+    auto* snapshot = std::get_if<boost::intrusive_ptr<Exchange::BookSnapshot2>>(
+        &event.payload);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ((*snapshot)->exchange_id, common::ExchangeId::kBinance);
+    EXPECT_EQ((*snapshot)->trading_pair, kBtcUsdt);
+    ASSERT_EQ((*snapshot)->bids.size(), 2);
+    EXPECT_EQ((*snapshot)->bids[1].price, 99);
+    EXPECT_EQ((*snapshot)->bids[1].qty, 2);
+    ASSERT_EQ((*snapshot)->asks.size(), 1);
+    EXPECT_EQ((*snapshot)->lastUpdateId, 10);
+    ASSERT_TRUE(source.Next(event));
+    EXPECT_EQ(event.time, 2'000);
+    auto* diff = std::get_if<boost::intrusive_ptr<Exchange::BookDiffSnapshot2>>(
+        &event.payload);
+    ASSERT_NE(diff, nullptr);
+    EXPECT_EQ((*diff)->bids[0].qty, 0);
+    EXPECT_EQ((*diff)->asks[0].qty, 4);
+    EXPECT_EQ((*diff)->first_id, 11);
+    EXPECT_EQ((*diff)->last_id, 12);
+    EXPECT_FALSE(source.Next(event));
+    std::filesystem::remove(path);
+}
+
+TEST(Capture, ShouldKeepTimesOfRecorderNonDecreasing) {
+    const auto path = TempPath("recorder_order");
+    Trading::NewBBOEnvelopePool bbo_pool(4);
+    {
+        boost::asio::io_context context;
+        backtesting::CaptureWriter writer;
+        ASSERT_TRUE(writer.Open(path));
+        backtesting::CaptureRecorder recorder(context.get_executor(), writer,
+                                              common::MarketType::kSpot);
+        // a publisher stamped its BBO later but posted it first
+        common::Nanos now = 2'000;
+        common::ScopedVirtualClock clock(now);
+        Trading::BBO bbo;
+        bbo.bid_price = 99;
+        bbo.ask_price = 101;
+        for (common::Nanos time : {2'000, 1'000, 3'000}) {
+            now = time;
+            recorder.AsyncHandleEvent(
+                boost::intrusive_ptr<Trading::NewBBOEnvelope>(bbo_pool.Allocate(
+                    &bbo_pool, common::ExchangeId::kBinance, kBtcUsdt, bbo,
+                    common::MarketType::kSpot)));
+        }
+        context.run();
+        // a BBO is a record per side
+        EXPECT_EQ(writer.Records(), 6);
+        ASSERT_TRUE(writer.Close());
+    }
+    backtesting::CaptureReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    std::vector<common::Nanos> times;
+    for (const auto& record : ReadAll(reader)) times.push_back(record.time);
+    EXPECT_EQ(times, (std::vector<common::Nanos>{2'000, 2'000, 2'000, 2'000,
+                                                 3'000, 3'000}));
+    std::filesystem::remove(path);
+}
+
+TEST(Capture, ShouldFeedKlinesWithoutParsing) {
+    const auto path = TempPath("klines");
+    {
+        backtesting::CaptureWriter writer;
+        ASSERT_TRUE(writer.Open(path));
+        const auto btc = writer.Instrument(common::ExchangeId::kBinance,
+                                           common::MarketType::kSpot, kBtcUsdt);
+        const auto eth = writer.Instrument(common::ExchangeId::kBinance,
+                                           common::MarketType::kSpot, kEthUsdt);
+        for (common::Price i = 0; i < 3; ++i) {
+            writer.WriteKline(i, btc, 100 + i, 110 + i, 90 + i, 105 + i, i);
+            writer.WriteKline(i, eth, 1, 1, 1, 1, 1);
+        }
+    }
+    backtesting::CaptureReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    OHLCVILFQueue queue;
+    backtesting::OHLCVICapture klines(reader, 0);
+    klines.Init(queue);
+    while (klines.LaunchOne()) {
+    }
+    OHLCVExt kline;
+    for (common::Price i = 0; i < 3; ++i) {
+        ASSERT_TRUE(queue.try_dequeue(kline));
+        EXPECT_EQ(kline.trading_pair, kBtcUsdt);
+        EXPECT_EQ(kline.ohlcv.open, 100 + i);
+        EXPECT_EQ(kline.ohlcv.high, 110 + i);
+        EXPECT_EQ(kline.ohlcv.low, 90 + i);
+        EXPECT_EQ(kline.ohlcv.close, 105 + i);
+        EXPECT_EQ(kline.ohlcv.volume, i);
+    }
+    EXPECT_FALSE(queue.try_dequeue(kline));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,142 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "aot/strategy/arbitrage/cycle_batch.h"
+#include "gtest/gtest.h"
+
+namespace {
+struct CycleState {
+    aot::TradeState state;
+    aot::TransactionReport buy;
+    aot::TransactionReport sell;
+};
+
+/// compiled cycles over instruments with their trade states
+class Universe {
+  public:
+    aot::CycleId Add(aot::InstrumentId buy, aot::InstrumentId sell) {
+        auto& state = *states_.emplace_back(std::make_unique<CycleState>());
+        std::vector<aot::InstrumentId> instruments{buy, sell};
+        return index_.Add({.buy              = buy,
+                           .sell             = sell,
+                           .state            = &state.state,
+                           .buy_transaction  = &state.buy,
+                           .sell_transaction = &state.sell},
+                          instruments);
+    }
+    void Open(aot::CycleId id, common::Price entry_buy,
+              common::Price entry_sell) {
+        states_[id]->state.is_open    = true;
+        states_[id]->buy.entry_price  = entry_buy;
+        states_[id]->sell.entry_price = entry_sell;
+    }
+    aot::CycleIndex& Index() { return index_; }
+
+  private:
+    aot::CycleIndex index_;
+    std::vector<std::unique_ptr<CycleState>> states_;
+};
+
+Trading::BBO MakeBBO(common::Price bid, common::Price ask) {
+    Trading::BBO bbo;
+    bbo.bid_price = bid;
+    bbo.ask_price = ask;
+    bbo.bid_qty   = 1;
+    bbo.ask_qty   = 1;
+    return bbo;
+}
+
+std::vector<uint64_t> ToVector(std::span<const uint64_t> mask) {
+    return {mask.begin(), mask.end()};
+}
+}  // namespace
+
+TEST(CycleBatch, ShouldOpenAndCloseByThresholds) {
+    // instrument 0 is the buy leg of every cycle
+    Universe universe;
+    universe.Add(0, 1);
+    universe.Add(0, 2);
+    universe.Add(0, 3);
+    universe.Add(0, 4);
+    universe.Add(0, 5);
+    universe.Open(2, 100, 105);
+    universe.Open(3, 100, 100);
+    aot::CycleBatch batch;
+    batch.Build(universe.Index(), 6);
+    batch.UpdateBBO(1, MakeBBO(100, 101));
+    batch.UpdateBBO(2, MakeBBO(102, 103));
+    batch.UpdateBBO(3, MakeBBO(105, 104));
+    batch.UpdateBBO(4, MakeBBO(100, 101));
+    batch.UpdateBBO(5, MakeBBO(common::kPriceInvalid, 101));
+    EXPECT_FALSE(batch.Ready(0));
+    batch.UpdateBBO(0, MakeBBO(99, 100));
+    EXPECT_TRUE(batch.Ready(0));
+    // cycle 0: spread is not crossed
+    // cycle 1: opens at 100/102, closes at once: (99 - 100) + (102 - 103) = -2
+    // cycle 2: opened before: (99 - 100) + (105 - 104) = 0
+    // cycle 3: opened before: (99 - 100) + (100 - 101) = -2
+    // cycle 4: invalid price of the sell leg
+    for (auto kernel :
+         {aot::CycleBatch::Kernel::kScalar, aot::CycleBatch::Kernel::kAvx2}) {
+        batch.Evaluate(0, {.take_profit_percent = 0, .stop_loss_percent = -1.5},
+                       kernel);
+        ASSERT_EQ(batch.Size(), 5);
+        EXPECT_EQ(batch.Open()[0], 0b00010);
+        EXPECT_EQ(batch.Act()[0], 0b01110);
+        EXPECT_EQ(batch.TakeProfit()[0], 0b00100);
+        EXPECT_EQ(batch.StopLoss()[0], 0b01010);
+        EXPECT_EQ(batch.Lane(3), 3);
+    }
+    // cycles of the sell leg only
+    batch.Evaluate(2, {});
+    ASSERT_EQ(batch.Size(), 1);
+    EXPECT_EQ(batch.Lane(0), 1);
+}
+
+TEST(CycleBatch, ShouldGiveSameMasksForScalarAndAvx2) {
+    if (!aot::CycleBatch::HasAvx2()) GTEST_SKIP() << "no AVX2";
+    constexpr aot::InstrumentId kInstruments = 16;
+    // not a multiple of the group and of a word per instrument
+    constexpr size_t kCycles = 1'001;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<common::Price> price(9'990, 10'010);
+    std::uniform_int_distribution<aot::InstrumentId> instrument(
+        0, kInstruments - 1);
+    std::bernoulli_distribution opened(0.3);
+    Universe universe;
+    for (size_t i = 0; i < kCycles; ++i) {
+        auto id = universe.Add(instrument(generator), instrument(generator));
+        if (opened(generator))
+            universe.Open(id, price(generator), price(generator));
+    }
+    aot::CycleBatch batch;
+    batch.Build(universe.Index(), kInstruments);
+    // the last instrument has no BBO, its cycles are never acted on
+    for (aot::InstrumentId i = 0; i + 1 < kInstruments; ++i) {
+        auto bid = price(generator);
+        batch.UpdateBBO(i, MakeBBO(bid, bid + 2));
+    }
+
+    const aot::CycleThresholds thresholds{.take_profit_percent = 0.01,
+                                          .stop_loss_percent   = -0.01};
+    size_t acted = 0;
+    for (aot::InstrumentId i = 0; i < kInstruments; ++i) {
+        batch.Evaluate(i, thresholds, aot::CycleBatch::Kernel::kScalar);
+        auto open        = ToVector(batch.Open());
+        auto take_profit = ToVector(batch.TakeProfit());
+        auto stop_loss   = ToVector(batch.StopLoss());
+        auto act         = ToVector(batch.Act());
+        for (size_t lane = 0; lane < batch.Size(); ++lane)
+            acted += aot::CycleBatch::Test(act, lane);
+
+        batch.Evaluate(i, thresholds, aot::CycleBatch::Kernel::kAvx2);
+        EXPECT_EQ(ToVector(batch.Open()), open);
+        EXPECT_EQ(ToVector(batch.TakeProfit()), take_profit);
+        EXPECT_EQ(ToVector(batch.StopLoss()), stop_loss);
+        EXPECT_EQ(ToVector(batch.Act()), act);
+        if (i + 1 == kInstruments)
+            for (auto word : act) EXPECT_EQ(word, 0);
+    }
+    EXPECT_GT(acted, 0);
+}
@@ -0,0 +1,396 @@
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "aot/simulator/binance_protocol.h"
+#include "aot/simulator/bybit_protocol.h"
+#include "aot/simulator/faults.h"
+#include "aot/simulator/matching_engine.h"
+#include "aot/simulator/server.h"
+#include "aot/simulator/synthetic_flow.h"
+#include "gtest/gtest.h"
+
+using simulator::MatchingEngine;
+using simulator::OrderStatus;
+using simulator::Side;
+using simulator::TimeInForce;
+
+namespace {
+constexpr int64_t kNowMs = 1700000000000;
+
+simulator::Markets MakeMarkets() {
+    simulator::Markets markets;
+    markets.try_emplace("BTCUSDT",
+                        simulator::Market{MatchingEngine("BTCUSDT"), 2, 5});
+    return markets;
+}
+
+simulator::Request MakeRequest(boost::beast::http::verb verb,
+                               std::string target, std::string body = {}) {
+    simulator::Request request{verb, target, 11};
+    request.body() = std::move(body);
+    request.prepare_payload();
+    return request;
+}
+
+/// signed binance request with the query in the target
+simulator::Request BinanceSigned(boost::beast::http::verb verb,
+                                 std::string query, std::string_view secret,
+                                 std::string_view api_key = "key") {
+    query += "&signature=" + simulator::HmacSha256Hex(secret, query);
+    auto request = MakeRequest(verb, "/api/v3/order?" + query);
+    request.set("X-MBX-APIKEY", std::string(api_key));
+    return request;
+}
+
+simulator::Request BybitSigned(std::string target, std::string body,
+                               std::string_view secret, int64_t timestamp) {
+    auto request = MakeRequest(boost::beast::http::verb::post,
+                               std::move(target), body);
+    request.set("X-BAPI-API-KEY", "key");
+    request.set("X-BAPI-TIMESTAMP", std::to_string(timestamp));
+    request.set("X-BAPI-RECV-WINDOW", "5000");
+    request.set("X-BAPI-SIGN",
+                simulator::HmacSha256Hex(
+                    secret, fmt::format("{}key5000{}", timestamp, body)));
+    return request;
+}
+
+nlohmann::json Json(const simulator::Response& response) {
+    return nlohmann::json::parse(response.body());
+}
+}  // namespace
+
+TEST(MatchingEngine, PriceTimePriority) {
+    MatchingEngine engine("BTCUSDT");
+    auto first  = engine.Place(Side::kSell, 100, 100, "a");
+    auto second = engine.Place(Side::kSell, 100, 100, "b");
+    auto worse  = engine.Place(Side::kSell, 101, 100, "c");
+    EXPECT_EQ(first.status, OrderStatus::kNew);
+
+    auto taker = engine.Place(Side::kBuy, 101, 150, "d");
+    EXPECT_EQ(taker.status, OrderStatus::kFilled);
+    ASSERT_EQ(taker.fills.size(), 2);
+    EXPECT_EQ(taker.fills[0].qty, 100);
+    EXPECT_EQ(taker.fills[1].qty, 50);
+    EXPECT_EQ(taker.quote, 150 * 100);
+    EXPECT_EQ(engine.Find(first.order_id), nullptr);
+    ASSERT_NE(engine.Find(second.order_id), nullptr);
+    EXPECT_EQ(engine.Find(second.order_id)->executed, 50);
+    EXPECT_EQ(engine.Find(second.order_id)->status,
+              OrderStatus::kPartiallyFilled);
+    ASSERT_NE(engine.FindByClientId("c"), nullptr);
+    EXPECT_EQ(engine.FindByClientId("c")->order_id, worse.order_id);
+    EXPECT_EQ(engine.Levels(Side::kSell, 10),
+              (std::vector<simulator::Level>{{100, 50}, {101, 100}}));
+}
+
+TEST(MatchingEngine, IocPostOnlyAndCancel) {
+    MatchingEngine engine("BTCUSDT");
+    engine.Place(Side::kBuy, 99, 10, "bid");
+    auto ioc = engine.Place(Side::kSell, 99, 30, "ioc", TimeInForce::kIoc);
+    EXPECT_EQ(ioc.status, OrderStatus::kExpired);
+    EXPECT_EQ(ioc.executed, 10);
+    EXPECT_FALSE(engine.Best(Side::kBuy));
+    EXPECT_FALSE(engine.Best(Side::kSell));
+
+    engine.Place(Side::kSell, 101, 10, "ask");
+    auto maker = engine.Place(Side::kBuy, 101, 10, "maker",
+                              TimeInForce::kPostOnly);
+    EXPECT_EQ(maker.status, OrderStatus::kExpired);
+    EXPECT_EQ(maker.executed, 0);
+    EXPECT_EQ(engine.Best(Side::kSell), 101);
+
+    auto canceled = engine.CancelByClientId("ask");
+    ASSERT_TRUE(canceled);
+    EXPECT_EQ(canceled->status, OrderStatus::kCanceled);
+    EXPECT_FALSE(engine.CancelByClientId("ask"));
+    EXPECT_EQ(engine.Orders(), 0);
+}
+
+TEST(MatchingEngine, DiffsContinueSnapshot) {
+    MatchingEngine engine("BTCUSDT");
+    engine.Place(Side::kBuy, 99, 10, {});
+    engine.Place(Side::kSell, 101, 10, {});
+    auto first = engine.TakeDiff();
+    EXPECT_EQ(first.first_id, 1);
+    EXPECT_EQ(first.last_id, 2);
+    const auto snapshot_id = engine.UpdateId();
+
+    engine.Place(Side::kBuy, 99, 5, {});
+    engine.Place(Side::kBuy, 101, 4, {});
+    auto second = engine.TakeDiff();
+    EXPECT_EQ(second.first_id, snapshot_id + 1);
+    EXPECT_EQ(second.last_id, engine.UpdateId());
+    EXPECT_EQ(second.seq, first.seq + 1);
+    EXPECT_EQ(second.bids, (std::vector<simulator::Level>{{99, 15}}));
+    EXPECT_EQ(second.asks, (std::vector<simulator::Level>{{101, 6}}));
+    EXPECT_TRUE(engine.TakeDiff().Empty());
+
+    engine.SkipIds(10);
+    engine.Place(Side::kBuy, 98, 1, {});
+    auto after_gap = engine.TakeDiff();
+    EXPECT_EQ(after_gap.first_id, second.last_id + 11);
+}
+
+TEST(SyntheticFlow, SameSeedSameBook) {
+    MatchingEngine a("BTCUSDT");
+    MatchingEngine b("BTCUSDT");
+    const simulator::SyntheticFlow::Options options{
+        .mid = 10000, .tick = 1, .levels = 10, .seed = 7};
+    simulator::SyntheticFlow flow_a(a, options);
+    simulator::SyntheticFlow flow_b(b, options);
+    flow_a.Steps(5000);
+    flow_b.Steps(5000);
+    EXPECT_GT(a.UpdateId(), 1000);
+    EXPECT_EQ(a.UpdateId(), b.UpdateId());
+    EXPECT_EQ(a.Levels(Side::kBuy, 100), b.Levels(Side::kBuy, 100));
+    EXPECT_EQ(a.Levels(Side::kSell, 100), b.Levels(Side::kSell, 100));
+    EXPECT_FALSE(a.Levels(Side::kBuy, 1).empty());
+    EXPECT_LT(*a.Best(Side::kBuy), *a.Best(Side::kSell));
+}
+
+TEST(FaultInjector, SameSeedSameFaults) {
+    const simulator::FaultInjector::Options options{
+        .latency = std::chrono::microseconds(100),
+        .jitter  = std::chrono::microseconds(50),
+        .loss    = 0.2,
+        .gap     = 0.1,
+        .seed    = 3};
+    simulator::FaultInjector a(options);
+    simulator::FaultInjector b(options);
+    size_t lost = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const auto delay = a.Delay();
+        EXPECT_EQ(delay, b.Delay());
+        EXPECT_GE(delay.count(), 100);
+        EXPECT_LE(delay.count(), 150);
+        const auto lose = a.Lose();
+        EXPECT_EQ(lose, b.Lose());
+        lost += lose;
+        EXPECT_EQ(a.Gap(), b.Gap());
+    }
+    EXPECT_GT(lost, 100);
+    EXPECT_LT(lost, 300);
+    EXPECT_FALSE(simulator::FaultInjector().Lose());
+}
+
+TEST(BinanceProtocol, SnapshotAndDiff) {
+    auto markets = MakeMarkets();
+    auto& market = markets.at("BTCUSDT");
+    market.engine.Place(Side::kBuy, 9999, 150000, {});
+    market.engine.Place(Side::kSell, 10001, 5, {});
+    simulator::BinanceProtocol protocol({"key", "secret"});
+
+    auto snapshot = Json(protocol.OnRequest(
+        MakeRequest(boost::beast::http::verb::get,
+                    "/api/v3/depth?symbol=BTCUSDT&limit=5"),
+        markets, kNowMs));
+    EXPECT_EQ(snapshot["lastUpdateId"], 2);
+    EXPECT_EQ(snapshot["bids"][0][0], "99.99");
+    EXPECT_EQ(snapshot["bids"][0][1], "1.50000");
+    EXPECT_EQ(snapshot["asks"][0][1], "0.00005");
+
+    market.engine.TakeDiff();
+    market.engine.Place(Side::kBuy, 10000, 1, {});
+    auto subscriptions = protocol.OnConnect("/ws/btcusdt@depth", markets);
+    ASSERT_EQ(subscriptions.size(), 1);
+    auto diff = nlohmann::json::parse(protocol.RenderDiff(
+        subscriptions[0], market, market.engine.TakeDiff(), kNowMs));
+    EXPECT_EQ(diff["e"], "depthUpdate");
+    EXPECT_EQ(diff["s"], "BTCUSDT");
+    EXPECT_EQ(diff["U"], 3);
+    EXPECT_EQ(diff["u"], 3);
+    EXPECT_EQ(diff["b"][0][0], "100.00");
+
+    auto reply = protocol.OnMessage(
+        R"({"method":"SUBSCRIBE","params":["btcusdt@depth@100ms"],"id":7})",
+        markets);
+    EXPECT_EQ(reply.text, R"({"result":null,"id":7})");
+    ASSERT_EQ(reply.subscribe.size(), 1);
+    EXPECT_EQ(reply.subscribe[0].symbol, "BTCUSDT");
+    reply = protocol.OnMessage(
+        R"({"method":"SUBSCRIBE","params":["ethusdt@depth"],"id":8})",
+        markets);
+    EXPECT_TRUE(reply.subscribe.empty());
+    EXPECT_EQ(nlohmann::json::parse(reply.text)["error"]["code"], 2);
+}
+
+TEST(BinanceProtocol, SignedOrders) {
+    namespace http = boost::beast::http;
+    auto markets   = MakeMarkets();
+    markets.at("BTCUSDT").engine.Place(Side::kSell, 10000, 100000, {});
+    simulator::BinanceProtocol protocol({"key", "secret"});
+    const auto timestamp = fmt::format("&timestamp={}", kNowMs);
+
+    auto response = protocol.OnRequest(
+        BinanceSigned(http::verb::post,
+                      "symbol=BTCUSDT&side=BUY&type=LIMIT&timeInForce=GTC"
+                      "&quantity=1.50000&price=100.00&newClientOrderId=42" +
+                          timestamp,
+                      "secret"),
+        markets, kNowMs);
+    ASSERT_EQ(response.result(), http::status::ok) << response.body();
+    auto order = Json(response);
+    EXPECT_EQ(order["clientOrderId"], "42");
+    EXPECT_EQ(order["status"], "PARTIALLY_FILLED");
+    EXPECT_EQ(order["executedQty"], "1.00000");
+    EXPECT_EQ(order["cummulativeQuoteQty"], "100.00");
+    EXPECT_EQ(order["fills"].size(), 1);
+
+    response = protocol.OnRequest(
+        BinanceSigned(http::verb::delete_,
+                      "symbol=BTCUSDT&origClientOrderId=42" + timestamp,
+                      "secret"),
+        markets, kNowMs);
+    ASSERT_EQ(response.result(), http::status::ok) << response.body();
+    EXPECT_EQ(Json(response)["origClientOrderId"], "42");
+    EXPECT_EQ(Json(response)["status"], "CANCELED");
+
+    auto code = [&](simulator::Request request) {
+        return Json(protocol.OnRequest(request, markets, kNowMs))["code"];
+    };
+    EXPECT_EQ(code(BinanceSigned(http::verb::delete_,
+                                 "symbol=BTCUSDT&origClientOrderId=42" +
+                                     timestamp,
+                                 "secret")),
+              -2011);
+    EXPECT_EQ(code(BinanceSigned(http::verb::delete_,
+                                 "symbol=BTCUSDT&orderId=1" + timestamp,
+                                 "wrong")),
+              -1022);
+    EXPECT_EQ(code(BinanceSigned(http::verb::delete_,
+                                 "symbol=BTCUSDT&orderId=1" + timestamp,
+                                 "secret", "other")),
+              -2015);
+    EXPECT_EQ(code(BinanceSigned(http::verb::delete_,
+                                 "symbol=BTCUSDT&orderId=1&timestamp=1",
+                                 "secret")),
+              -1021);
+}
+
+TEST(BybitProtocol, SignedOrdersAndTopics) {
+    auto markets = MakeMarkets();
+    auto& market = markets.at("BTCUSDT");
+    simulator::BybitProtocol protocol({"key", "secret"});
+
+    auto response = Json(protocol.OnRequest(
+        BybitSigned("/v5/order/create",
+                    R"({"category":"spot","symbol":"BTCUSDT","side":"Buy",)"
+                    R"("orderType":"Limit","qty":"0.10000","price":"99.50",)"
+                    R"("orderLinkId":"7"})",
+                    "secret", kNowMs),
+        markets, kNowMs));
+    EXPECT_EQ(response["retCode"], 0);
+    EXPECT_EQ(response["result"]["orderLinkId"], "7");
+    EXPECT_EQ(market.engine.Best(Side::kBuy), 9950);
+
+    auto reply = protocol.OnMessage(
+        R"({"req_id":"1","op":"subscribe","args":["orderbook.50.BTCUSDT"]})",
+        markets);
+    auto answer = nlohmann::json::parse(reply.text);
+    EXPECT_EQ(answer["success"], true);
+    EXPECT_EQ(answer["op"], "subscribe");
+    ASSERT_EQ(reply.subscribe.size(), 1);
+    auto snapshot = nlohmann::json::parse(
+        protocol.RenderSubscribed(reply.subscribe[0], market, kNowMs));
+    EXPECT_EQ(snapshot["topic"], "orderbook.50.BTCUSDT");
+    EXPECT_EQ(snapshot["type"], "snapshot");
+    EXPECT_EQ(snapshot["data"]["b"][0][0], "99.50");
+
+    market.engine.TakeDiff();
+    auto cancel = Json(protocol.OnRequest(
+        BybitSigned("/v5/order/cancel",
+                    R"({"category":"spot","symbol":"BTCUSDT",)"
+                    R"("orderLinkId":"7"})",
+                    "secret", kNowMs),
+        markets, kNowMs));
+    EXPECT_EQ(cancel["retCode"], 0);
+    auto delta = nlohmann::json::parse(protocol.RenderDiff(
+        reply.subscribe[0], market, market.engine.TakeDiff(), kNowMs));
+    EXPECT_EQ(delta["type"], "delta");
+    EXPECT_EQ(delta["data"]["u"], 2);
+    EXPECT_EQ(delta["data"]["b"][0][1], "0.00000");
+
+    auto code = [&](simulator::Request request) {
+        return Json(protocol.OnRequest(request, markets, kNowMs))["retCode"];
+    };
+    EXPECT_EQ(code(BybitSigned("/v5/order/cancel",
+                               R"({"symbol":"BTCUSDT","orderLinkId":"7"})",
+                               "secret", kNowMs)),
+              170213);
+    EXPECT_EQ(code(BybitSigned("/v5/order/cancel",
+                               R"({"symbol":"BTCUSDT","orderLinkId":"7"})",
+                               "wrong", kNowMs)),
+              10004);
+    EXPECT_EQ(code(BybitSigned("/v5/order/cancel",
+                               R"({"symbol":"BTCUSDT","orderLinkId":"7"})",
+                               "secret", kNowMs - 60000)),
+              10002);
+}
+
+TEST(Server, DepthStreamContinuesSnapshot) {
+    namespace beast = boost::beast;
+    namespace ssl   = boost::asio::ssl;
+    using tcp       = boost::asio::ip::tcp;
+
+    auto markets = MakeMarkets();
+    std::vector<simulator::SyntheticFlow> flows;
+    flows.emplace_back(markets.at("BTCUSDT").engine,
+                       simulator::SyntheticFlow::Options{.mid = 10000});
+    simulator::BinanceProtocol protocol({"key", "secret"});
+    auto server_ssl = simulator::MakeSelfSignedContext();
+    simulator::Server::Options options;
+    options.tick_interval = std::chrono::milliseconds(5);
+    boost::asio::io_context server_ioc;
+    simulator::Server server(server_ioc, server_ssl, protocol, markets, flows,
+                             options);
+    server.Start();
+    std::thread thread([&server_ioc] { server_ioc.run(); });
+
+    boost::asio::io_context ioc;
+    ssl::context client_ssl(ssl::context::tls_client);
+    tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                           server.Port());
+
+    beast::websocket::stream<beast::ssl_stream<tcp::socket>> ws(ioc,
+                                                                client_ssl);
+    beast::get_lowest_layer(ws).connect(endpoint);
+    ws.next_layer().handshake(ssl::stream_base::client);
+    ws.handshake("localhost", "/ws/btcusdt@depth");
+
+    beast::ssl_stream<tcp::socket> https(ioc, client_ssl);
+    beast::get_lowest_layer(https).connect(endpoint);
+    https.handshake(ssl::stream_base::client);
+    auto request = MakeRequest(beast::http::verb::get,
+                               "/api/v3/depth?symbol=BTCUSDT&limit=1000");
+    request.set(beast::http::field::host, "localhost");
+    beast::http::write(https, request);
+    beast::flat_buffer buffer;
+    simulator::Response response;
+    beast::http::read(https, buffer, response);
+    const uint64_t snapshot_id = Json(response)["lastUpdateId"];
+
+    // the first diff to apply has U <= lastUpdateId + 1 <= u, the next ones
+    // continue it
+    uint64_t last_id = 0;
+    for (int applied = 0; applied < 20;) {
+        buffer.clear();
+        ws.read(buffer);
+        auto diff = nlohmann::json::parse(
+            beast::buffers_to_string(buffer.data()));
+        const uint64_t first = diff["U"];
+        const uint64_t last  = diff["u"];
+        if (last <= snapshot_id) continue;
+        if (last_id)
+            EXPECT_EQ(first, last_id + 1);
+        else
+            EXPECT_LE(first, snapshot_id + 1);
+        last_id = last;
+        ++applied;
+    }
+
+    boost::asio::post(server_ioc, [&server] { server.Stop(); });
+    server_ioc.stop();
+    thread.join();
+}
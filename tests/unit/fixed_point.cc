@@ -0,0 +1,125 @@
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "aot/common/fixed_point.h"
+#include "gtest/gtest.h"
+
+TEST(FixedPoint, ShouldParseExchangeStrings) {
+    uint64_t value = 0;
+    EXPECT_TRUE(common::ParseFixedPoint("64730.02000000", 2, value));
+    EXPECT_EQ(value, 6473002);
+    EXPECT_TRUE(common::ParseFixedPoint("4.42991000", 8, value));
+    EXPECT_EQ(value, 442991000);
+    EXPECT_TRUE(common::ParseFixedPoint("123", 3, value));
+    EXPECT_EQ(value, 123000);
+    EXPECT_TRUE(common::ParseFixedPoint("0.00000001", 8, value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(common::ParseFixedPoint("0", 5, value));
+    EXPECT_EQ(value, 0);
+    // digits beyond precision are truncated
+    EXPECT_TRUE(common::ParseFixedPoint("1.999", 2, value));
+    EXPECT_EQ(value, 199);
+}
+
+TEST(FixedPoint, ShouldNotLoosePrecisionLikeDoubleMultiplication) {
+    uint64_t value = 0;
+    EXPECT_TRUE(common::ParseFixedPoint("0.29", 2, value));
+    EXPECT_EQ(value, 29);
+    EXPECT_EQ(static_cast<int>(0.29 * std::pow(10, 2)), 28);
+}
+
+TEST(FixedPoint, ShouldRejectInvalidStrings) {
+    uint64_t value = 42;
+    EXPECT_FALSE(common::ParseFixedPoint("", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint(".5", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("1.", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("-1.5", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("1e-5", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("1.2.3", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("12345678a.1", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("1.123456789x", 2, value));
+    EXPECT_FALSE(common::ParseFixedPoint("100000000000000000000", 0, value));
+    EXPECT_FALSE(common::ParseFixedPoint("18446744073709551616", 0, value));
+    EXPECT_FALSE(common::ParseFixedPoint("1844674407370955.1616", 4, value));
+    EXPECT_EQ(value, 42);
+    EXPECT_TRUE(common::ParseFixedPoint("1844674407370955.1615", 4, value));
+    EXPECT_EQ(value, 18446744073709551615ULL);
+}
+
+/**
+ * @brief random decimal strings are compared with the old double path. If the
+ * string has no more fraction digits than precision, correctly rounded double
+ * result must be equal. Otherwise result must be equal to the double result of
+ * the string truncated to precision
+ *
+ */
+TEST(FixedPoint, ShouldMatchDoublePathOnRandomStrings) {
+    std::mt19937_64 gen(7);
+    // up to 15 significant digits, so the double path is exact after rounding
+    std::uniform_int_distribution<int> int_len(1, 7);
+    std::uniform_int_distribution<int> frac_len(0, 10);
+    std::uniform_int_distribution<int> precision_dist(0, 8);
+    std::uniform_int_distribution<int> digit(0, 9);
+    for (int iteration = 0; iteration < 200000; ++iteration) {
+        std::string str;
+        const int int_digits = int_len(gen);
+        for (int i = 0; i < int_digits; ++i)
+            str.push_back(static_cast<char>('0' + digit(gen)));
+        const int frac_digits = frac_len(gen);
+        if (frac_digits) {
+            str.push_back('.');
+            for (int i = 0; i < frac_digits; ++i)
+                str.push_back(static_cast<char>('0' + digit(gen)));
+        }
+        const auto precision = static_cast<uint8_t>(precision_dist(gen));
+
+        uint64_t value       = 0;
+        ASSERT_TRUE(common::ParseFixedPoint(str, precision, value)) << str;
+
+        if (frac_digits <= precision) {
+            const auto expected = static_cast<uint64_t>(
+                std::llround(std::stod(str) * std::pow(10, precision)));
+            ASSERT_EQ(value, expected) << str << " precision:" << +precision;
+        } else {
+            auto truncated = str.substr(0, int_digits + 1 + precision);
+            if (truncated.back() == '.') truncated.pop_back();
+            ASSERT_EQ(value, static_cast<uint64_t>(std::llround(
+                                 std::stod(truncated) *
+                                 std::pow(10, precision))))
+                << str << " precision:" << +precision;
+        }
+    }
+}
+
+TEST(FixedPoint, ShouldParseQuotedNumberInPaddedBuffer) {
+    // json string content followed by closing quote and padding
+    const std::string buffer = std::string(R"(64730.02000000"],["1.5")") +
+                               std::string(64, '\0');
+    uint64_t value           = 0;
+    EXPECT_TRUE(common::ParseQuotedFixedPoint(buffer.data(), 2, value));
+    EXPECT_EQ(value, 6473002);
+    EXPECT_FALSE(common::ParseQuotedFixedPoint(buffer.data() + 14, 2, value));
+    EXPECT_TRUE(common::ParseQuotedFixedPoint(buffer.data() + 19, 3, value));
+    EXPECT_EQ(value, 1500);
+}
+
+TEST(FixedPoint, ShouldFormatBackToExactString) {
+    EXPECT_EQ(common::FormatFixedPoint(123450, 3), "123.450");
+    EXPECT_EQ(common::FormatFixedPoint(6473002, 2), "64730.02");
+    EXPECT_EQ(common::FormatFixedPoint(1, 8), "0.00000001");
+    EXPECT_EQ(common::FormatFixedPoint(29, 2), "0.29");
+    EXPECT_EQ(common::FormatFixedPoint(0, 2), "0.00");
+    EXPECT_EQ(common::FormatFixedPoint(42, 0), "42");
+    uint64_t value = 0;
+    EXPECT_TRUE(common::ParseFixedPoint(
+        common::FormatFixedPoint(18446744073709551615ULL, 19), 19, value));
+    EXPECT_EQ(value, 18446744073709551615ULL);
+}
+
+TEST(FixedPoint, ShouldScaleLikePow) {
+    for (uint8_t precision = 0; precision <= common::kMaxFixedPointPrecision;
+         ++precision)
+        EXPECT_EQ(common::Pow10Inverse(precision), std::pow(10, -precision));
+    EXPECT_EQ(common::Pow10Inverse(40), std::pow(10, -40));
+}
@@ -0,0 +1,85 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "aot/hot_log.h"
+#include "gtest/gtest.h"
+
+namespace {
+std::atomic<int> logged{0};
+
+void CountLog(int64_t, fmtlog::LogLevel, fmt::string_view, size_t,
+              fmt::string_view, fmt::string_view, size_t, size_t) {
+    logged.fetch_add(1, std::memory_order_relaxed);
+}
+
+int Evaluated(int &counter) { return ++counter; }
+
+class HotLog : public testing::Test {
+  protected:
+    void SetUp() override {
+        fmtlog::setLogFile("/dev/null", false);
+        fmtlog::setLogLevel(fmtlog::DBG);
+        fmtlog::setLogCB(CountLog, fmtlog::DBG);
+        fmtlog::poll(true);
+        logged = 0;
+        aot::log::SetLevel(aot::log::Subsystem::kParser, fmtlog::DBG);
+    }
+};
+}  // namespace
+
+// the levels below are compiled out by the default AOT_HOT_LOG_LEVEL
+static_assert(!aot::log::IsCompiled(aot::log::Subsystem::kOrderBook,
+                                    fmtlog::INF));
+static_assert(aot::log::IsCompiled(aot::log::Subsystem::kOrderBook,
+                                   fmtlog::WRN));
+
+TEST_F(HotLog, ShouldNotEvaluateArgumentsOfCompiledOutSite) {
+    int counter = 0;
+    hlogi(kParser, "{}", Evaluated(counter));
+    hlogd(kOrderBook, "{}", Evaluated(counter));
+    fmtlog::poll(true);
+    EXPECT_EQ(counter, 0);
+    EXPECT_EQ(logged, 0);
+}
+
+TEST_F(HotLog, ShouldGateSiteByRuntimeLevelOfSubsystem) {
+    int counter = 0;
+    aot::log::SetLevel(aot::log::Subsystem::kParser, fmtlog::ERR);
+    hlogw(kParser, "{}", Evaluated(counter));
+    hlogw(kOrderBook, "{}", Evaluated(counter));
+    fmtlog::poll(true);
+    EXPECT_EQ(counter, 1);
+    EXPECT_EQ(logged, 1);
+
+    aot::log::SetLevel(aot::log::Subsystem::kParser, fmtlog::WRN);
+    hlogw(kParser, "{}", Evaluated(counter));
+    fmtlog::poll(true);
+    EXPECT_EQ(counter, 2);
+    EXPECT_EQ(logged, 2);
+}
+
+TEST_F(HotLog, ShouldSampleAndRateLimit) {
+    for (int i = 0; i < 10; ++i) hlogwn(kParser, 4, "sampled {}", i);
+    fmtlog::poll(true);
+    EXPECT_EQ(logged, 3);
+
+    for (int i = 0; i < 10; ++i)
+        hlogwl(kParser, aot::log::kSecondNs, "limited {}", i);
+    fmtlog::poll(true);
+    EXPECT_EQ(logged, 4);
+}
+
+TEST_F(HotLog, ShouldPollOnDedicatedThread) {
+    LogPollingThread poller({.min_interval = std::chrono::microseconds(10),
+                             .max_interval = std::chrono::microseconds(200)});
+    hlogw(kParser, "first");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (logged == 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    EXPECT_EQ(logged, 1);
+
+    hlogw(kParser, "second");
+    poller.Stop();
+    EXPECT_EQ(logged, 2);
+}
@@ -0,0 +1,134 @@
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "aot/python/batch_strategy.h"
+#include "aot/strategy/inference.h"
+#include "gtest/gtest.h"
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+const common::TradingPair kEthUsdt{3, 1};
+
+/// score of a row is its close - 1, records the size of every batch
+class CloseModel : public inference::BatchModel {
+  public:
+    std::vector<size_t> batches;
+    bool Init() override { return true; }
+    bool Predict(std::span<const double> features, size_t rows,
+                 std::span<double> scores) override {
+        batches.push_back(rows);
+        for (size_t i = 0; i < rows; ++i)
+            scores[i] = features[i * Columns() + 3] - 1;
+        return true;
+    }
+};
+
+OHLCVExt Kline(common::TradingPair pair, common::Price close) {
+    OHLCVExt kline;
+    kline.trading_pair = pair;
+    kline.ohlcv.close  = close;
+    return kline;
+}
+
+std::vector<inference::Prediction> Drain(inference::PredictionLFQueue& queue) {
+    std::vector<inference::Prediction> result;
+    inference::Prediction prediction;
+    while (queue.try_dequeue(prediction)) result.push_back(prediction);
+    return result;
+}
+}  // namespace
+
+TEST(Inference, ActionFromScoreMatchesPythonThresholds) {
+    using common::TradeAction;
+    EXPECT_EQ(inference::ActionFromScore(0.02), TradeAction::kEnterLong);
+    EXPECT_EQ(inference::ActionFromScore(-0.02), TradeAction::kEnterShort);
+    EXPECT_EQ(inference::ActionFromScore(-0.005), TradeAction::kExitLong);
+    EXPECT_EQ(inference::ActionFromScore(0.005), TradeAction::kExitShort);
+    EXPECT_EQ(inference::ActionFromScore(0), TradeAction::kNope);
+}
+
+TEST(Inference, BatchesKlinesOfAllPairs) {
+    OHLCVILFQueue klines;
+    inference::PredictionLFQueue predictions;
+    for (int i = 0; i < 6; ++i)
+        klines.enqueue(Kline(i % 2 ? kEthUsdt : kBtcUsdt, i % 3));
+    CloseModel model;
+    {
+        inference::InferenceService service(model, &klines, &predictions,
+                                            {.max_batch = 4});
+        service.Start();
+        service.Stop();
+        EXPECT_FALSE(service.Failed());
+        EXPECT_EQ(service.Klines(), 6);
+        EXPECT_EQ(service.Batches(), model.batches.size());
+    }
+    ASSERT_FALSE(model.batches.empty());
+    for (auto rows : model.batches) EXPECT_LE(rows, 4);
+
+    auto result = Drain(predictions);
+    ASSERT_EQ(result.size(), 6);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(result[i].kline.trading_pair, i % 2 ? kEthUsdt : kBtcUsdt);
+        EXPECT_EQ(result[i].score, i % 3 - 1);
+        EXPECT_EQ(result[i].action,
+                  inference::ActionFromScore(result[i].score));
+    }
+}
+
+TEST(Inference, StopsIfExtractorDoesNotFillAllColumns) {
+    /// a model of indicators, the default extractor gives only OHLCV
+    class WideModel : public CloseModel {
+      public:
+        size_t Columns() const override { return 30; }
+    };
+    OHLCVILFQueue klines;
+    inference::PredictionLFQueue predictions;
+    klines.enqueue(Kline(kBtcUsdt, 2));
+    WideModel model;
+    inference::InferenceService service(model, &klines, &predictions);
+    service.Start();
+    service.Stop();
+    EXPECT_TRUE(service.Failed());
+    EXPECT_TRUE(model.batches.empty());
+    EXPECT_EQ(predictions.size_approx(), 0);
+}
+
+TEST(Inference, PythonModelGetsOneCallPerBatch) {
+    const auto dir = std::filesystem::temp_directory_path() / "aot_inference";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "batch_predictor.py") << R"(import array
+
+class Predictor:
+    calls = 0
+
+    def __init__(self, path_where_models):
+        self.path = path_where_models
+
+    def predict_batch(self, candles):
+        Predictor.calls += 1
+        assert candles.format == 'd' and candles.shape[1] == 5
+        return array.array('d', (row[3] - row[0] for row in candles.tolist()))
+)";
+    OHLCVILFQueue klines;
+    inference::PredictionLFQueue predictions;
+    for (int i = 0; i < 10; ++i) {
+        auto kline       = Kline(kBtcUsdt, i);
+        kline.ohlcv.open = 5;
+        klines.enqueue(kline);
+    }
+    base_strategy::BatchStrategy model(dir.string(), dir.string(),
+                                       "batch_predictor.py", "Predictor");
+    inference::InferenceService service(model, &klines, &predictions,
+                                        {.max_batch = 16});
+    service.Start();
+    service.Stop();
+    ASSERT_FALSE(service.Failed());
+    EXPECT_EQ(service.Klines(), 10);
+    EXPECT_EQ(service.Batches(), 1);
+
+    auto result = Drain(predictions);
+    ASSERT_EQ(result.size(), 10);
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(result[i].score, i - 5);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,192 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "aot/strategy/arbitrage/arbitrage_strategy.h"
+#include "aot/strategy/arbitrage/cycle_index.h"
+#include "aot/strategy/arbitrage/instrument_registry.h"
+#include "boost/asio/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+const common::TradingPair kEthUsdt{3, 1};
+
+class ReportRecorder : public bus::Component {
+  public:
+    std::vector<boost::intrusive_ptr<aot::ArbitrageReportEnvelope>> reports;
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<aot::ArbitrageReportEnvelope> event) override {
+        reports.push_back(std::move(event));
+    }
+};
+
+/// counts reports and notes if two of them were handled at the same time
+class OverlapRecorder : public bus::Component {
+  public:
+    std::atomic<size_t> reports{0};
+    std::atomic<bool> overlapped{false};
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<aot::ArbitrageReportEnvelope>) override {
+        if (inside_.fetch_add(1)) overlapped = true;
+        // lets another handler start if they are not serialized
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+        inside_.fetch_sub(1);
+        reports.fetch_add(1);
+    }
+
+  private:
+    std::atomic<int> inside_{0};
+};
+
+aot::ArbitrageCycle MakeCycle(common::ExchangeId buy, common::ExchangeId sell,
+                              common::TradingPair trading_pair) {
+    aot::ArbitrageCycle cycle;
+    cycle.push_back({trading_pair, buy, common::MarketType::kSpot,
+                     aot::Operation::kBuy});
+    cycle.push_back({trading_pair, sell, common::MarketType::kSpot,
+                     aot::Operation::kSell});
+    return cycle;
+}
+
+void SendBBO(bus::Component& strategy, Trading::NewBBOEnvelopePool& pool,
+             common::ExchangeId exchange_id, common::Price bid,
+             common::Price ask) {
+    Trading::BBO bbo;
+    bbo.bid_price = bid;
+    bbo.ask_price = ask;
+    bbo.bid_qty   = 10;
+    bbo.ask_qty   = 10;
+    strategy.AsyncHandleEvent(boost::intrusive_ptr<Trading::NewBBOEnvelope>(
+        pool.Allocate(&pool, exchange_id, kBtcUsdt, bbo,
+                      common::MarketType::kSpot)));
+}
+}  // namespace
+
+TEST(InstrumentRegistry, ShouldAssignDenseIds) {
+    aot::InstrumentRegistry registry;
+    aot::InstrumentKey btc{common::ExchangeId::kBinance,
+                           common::MarketType::kSpot, kBtcUsdt};
+    aot::InstrumentKey btc_futures{common::ExchangeId::kBinance,
+                                   common::MarketType::kFutures, kBtcUsdt};
+    EXPECT_EQ(registry.Find(btc), aot::kInstrumentIdInvalid);
+    EXPECT_EQ(registry.Register(btc), 0);
+    EXPECT_EQ(registry.Register(btc_futures), 1);
+    EXPECT_EQ(registry.Register(btc), 0);
+    EXPECT_EQ(registry.Find(btc_futures), 1);
+    EXPECT_EQ(registry.Size(), 2);
+    EXPECT_EQ(registry.Key(1), btc_futures);
+}
+
+TEST(CycleIndex, ShouldMapInstrumentToItsCycles) {
+    aot::CycleIndex index;
+    std::vector<aot::InstrumentId> first{0, 2};
+    std::vector<aot::InstrumentId> second{2, 1, 2};
+    std::vector<aot::InstrumentId> third{0, 1};
+    EXPECT_EQ(index.Add({.uid_trade = 10}, first), 0);
+    EXPECT_EQ(index.Add({.uid_trade = 20}, second), 1);
+    EXPECT_EQ(index.Add({.uid_trade = 30}, third), 2);
+
+    auto cycles_of = [&index](aot::InstrumentId id) {
+        auto span = index.CyclesOf(id);
+        return std::vector<aot::CycleId>(span.begin(), span.end());
+    };
+    EXPECT_EQ(cycles_of(0), (std::vector<aot::CycleId>{0, 2}));
+    EXPECT_EQ(cycles_of(1), (std::vector<aot::CycleId>{1, 2}));
+    EXPECT_EQ(cycles_of(2), (std::vector<aot::CycleId>{0, 1}));
+    EXPECT_TRUE(cycles_of(3).empty());
+    // an instrument met twice in a cycle is indexed once
+    EXPECT_EQ(index.Instruments(index.Cycle(1)).size(), 2);
+    EXPECT_EQ(index.Cycle(2).uid_trade, 30);
+}
+
+TEST(ArbitrageStrategyComponent, ShouldCompileCyclesAndReportTrade) {
+    boost::asio::thread_pool thread_pool(1);
+    aot::CoBus bus(thread_pool);
+    aot::ExchangeTradingPairs exchange_trading_pairs;
+    common::TradingPairInfo info{.price_precission = 2, .qty_precission = 3};
+    exchange_trading_pairs.AddOrUpdatePair(common::ExchangeId::kBinance,
+                                           kBtcUsdt, info);
+    exchange_trading_pairs.AddOrUpdatePair(common::ExchangeId::kBybit,
+                                           kBtcUsdt, info);
+    aot::ArbitrageStrategyComponent strategy(thread_pool, bus, 4,
+                                             exchange_trading_pairs);
+    ReportRecorder recorder;
+    bus.Subscribe(&strategy, &recorder);
+
+    auto cycle = MakeCycle(common::ExchangeId::kBinance,
+                           common::ExchangeId::kBybit, kBtcUsdt);
+    auto other = MakeCycle(common::ExchangeId::kBybit,
+                           common::ExchangeId::kBinance, kEthUsdt);
+    strategy.AddArbitrageCycle(cycle);
+    strategy.AddArbitrageCycle(cycle);
+    strategy.AddArbitrageCycle(other);
+    EXPECT_EQ(strategy.GetInstruments().Size(), 4);
+    EXPECT_EQ(strategy.GetCycles().Size(), 2);
+
+    Trading::NewBBOEnvelopePool pool{8};
+    // only one leg is known, nothing is evaluated. The book of the buy leg is
+    // crossed, so closing at once gives a profit
+    SendBBO(strategy, pool, common::ExchangeId::kBinance, 10'010, 10'000);
+    // the sell leg bids above the ask of the buy leg: the trade opens and is
+    // closed by the same BBO
+    SendBBO(strategy, pool, common::ExchangeId::kBybit, 10'100, 10'100);
+    thread_pool.join();
+
+    ASSERT_EQ(recorder.reports.size(), 1);
+    const auto* report = recorder.reports[0]->WrappedEvent();
+    EXPECT_EQ(report->uid_trade, aot::ArbitrageCycleHash{}(cycle));
+    ASSERT_EQ(report->transactions.size(), 2);
+    for (const auto& [hash, transaction] : report->transactions) {
+        EXPECT_EQ(transaction.entry_qty, 10);
+        if (transaction.operation == aot::Operation::kBuy) {
+            EXPECT_EQ(transaction.exchange_id, common::ExchangeId::kBinance);
+            EXPECT_EQ(transaction.entry_price, 10'000);
+            EXPECT_EQ(transaction.exit_price, 10'010);
+        } else {
+            EXPECT_EQ(transaction.exchange_id, common::ExchangeId::kBybit);
+            EXPECT_EQ(transaction.entry_price, 10'100);
+            EXPECT_EQ(transaction.exit_price, 10'100);
+        }
+    }
+    EXPECT_GT(report->pnl, 0);
+}
+
+TEST(ArbitrageStrategyComponent, ShouldHandleBBOsFromSeveralThreadsOneByOne) {
+    constexpr size_t kThreads       = 4;
+    constexpr size_t kBBOsPerThread = 200;
+    constexpr size_t kBBOs          = kThreads * kBBOsPerThread;
+    boost::asio::thread_pool thread_pool(kThreads);
+    aot::CoBus bus(thread_pool);
+    aot::ExchangeTradingPairs exchange_trading_pairs;
+    common::TradingPairInfo info{.price_precission = 2, .qty_precission = 3};
+    exchange_trading_pairs.AddOrUpdatePair(common::ExchangeId::kBinance,
+                                           kBtcUsdt, info);
+    exchange_trading_pairs.AddOrUpdatePair(common::ExchangeId::kBybit,
+                                           kBtcUsdt, info);
+    aot::ArbitrageStrategyComponent strategy(thread_pool, bus, kBBOs,
+                                             exchange_trading_pairs);
+    OverlapRecorder recorder;
+    bus.Subscribe(&strategy, &recorder);
+    auto cycle = MakeCycle(common::ExchangeId::kBinance,
+                           common::ExchangeId::kBybit, kBtcUsdt);
+    strategy.AddArbitrageCycle(cycle);
+
+    Trading::NewBBOEnvelopePool pool{kBBOs + 1};
+    SendBBO(strategy, pool, common::ExchangeId::kBinance, 10'010, 10'000);
+    // every BBO of the sell leg opens and closes the trade, so each one gives
+    // a report whatever order the handlers run in
+    std::vector<std::jthread> senders;
+    for (size_t i = 0; i < kThreads; ++i)
+        senders.emplace_back([&strategy, &pool] {
+            for (size_t j = 0; j < kBBOsPerThread; ++j)
+                SendBBO(strategy, pool, common::ExchangeId::kBybit, 10'100,
+                        10'100);
+        });
+    senders.clear();
+    thread_pool.join();
+
+    EXPECT_EQ(recorder.reports, kBBOs);
+    EXPECT_FALSE(recorder.overlapped);
+}
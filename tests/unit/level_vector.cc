@@ -0,0 +1,93 @@
+#include <cstdint>
+
+#include "aot/common/level_vector.h"
+#include "gtest/gtest.h"
+
+namespace {
+struct Level {
+    uint64_t price;
+    uint64_t qty;
+    Level(uint64_t _price, uint64_t _qty) : price(_price), qty(_qty) {}
+};
+using Levels = common::LevelVector<Level, 4>;
+using Pool   = common::detail::LevelSlabPool<Level>;
+}  // namespace
+
+TEST(LevelVector, ShouldKeepSmallDiffInline) {
+    Levels levels = {{100, 1}, {99, 2}};
+    levels.emplace_back(98, 3);
+    EXPECT_EQ(levels.size(), 3);
+    EXPECT_FALSE(levels.Spilled());
+    EXPECT_EQ(levels[2].price, 98);
+    uint64_t qty = 0;
+    for (const auto &level : levels) qty += level.qty;
+    EXPECT_EQ(qty, 6);
+}
+
+TEST(LevelVector, ShouldSpillIntoSlabAndKeepOrder) {
+    Levels levels;
+    for (uint64_t i = 0; i < 5000; ++i) levels.emplace_back(i, i + 1);
+    EXPECT_TRUE(levels.Spilled());
+    ASSERT_EQ(levels.size(), 5000);
+    for (uint64_t i = 0; i < 5000; ++i) {
+        ASSERT_EQ(levels[i].price, i);
+        ASSERT_EQ(levels[i].qty, i + 1);
+    }
+}
+
+TEST(LevelVector, CopyShouldShareSpilledLevels) {
+    Levels levels;
+    for (uint64_t i = 0; i < 100; ++i) levels.emplace_back(i, 1);
+    Levels copy = levels;
+    EXPECT_EQ(copy.data(), levels.data());
+
+    // writing into the shared vector detaches it, the copy is not changed
+    levels.emplace_back(100, 1);
+    EXPECT_NE(copy.data(), levels.data());
+    EXPECT_EQ(copy.size(), 100);
+    EXPECT_EQ(levels.size(), 101);
+    EXPECT_EQ(levels[99].price, 99);
+}
+
+TEST(LevelVector, MoveShouldStealSlab) {
+    Levels levels;
+    for (uint64_t i = 0; i < 100; ++i) levels.emplace_back(i, 1);
+    const auto *data = levels.data();
+    Levels moved     = std::move(levels);
+    EXPECT_EQ(moved.data(), data);
+    EXPECT_TRUE(levels.empty());
+
+    Levels small = {{1, 1}};
+    Levels moved_small(std::move(small));
+    EXPECT_EQ(moved_small.size(), 1);
+    EXPECT_EQ(moved_small[0].price, 1);
+}
+
+TEST(LevelVector, ReleasedSlabShouldBeReused) {
+    const Level *data = nullptr;
+    {
+        Levels levels;
+        for (uint64_t i = 0; i < 1000; ++i) levels.emplace_back(i, 1);
+        levels.reserve(1024);
+        data = levels.data();
+    }
+    Levels levels;
+    levels.reserve(1000);
+    EXPECT_EQ(levels.data(), data);
+    EXPECT_GT(Pool::Instance().CachedSlabs(), 0);
+}
+
+TEST(LevelVector, ClearShouldKeepOwnSlab) {
+    Levels levels;
+    for (uint64_t i = 0; i < 100; ++i) levels.emplace_back(i, 1);
+    const auto *data = levels.data();
+    levels.clear();
+    EXPECT_TRUE(levels.empty());
+    levels.emplace_back(1, 1);
+    EXPECT_EQ(levels.data(), data);
+
+    Levels copy = levels;
+    levels.clear();
+    EXPECT_FALSE(levels.Spilled());
+    EXPECT_EQ(copy.size(), 1);
+}
@@ -1,4 +1,10 @@
 #include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "aot/common/mem_pool.h"
 
 namespace common {
@@ -235,6 +241,93 @@ TEST(MemoryPoolTest, ShouldCorrectlyHandleAllocationAndDeallocationOfObjectsOfDi
   EXPECT_EQ(large_obj2->GetValue(0), 42);
   large_pool.Deallocate(large_obj2);
 }
+TEST(MemoryPoolTest, ShouldReturnNullWhenCapacityIsExhausted) {
+  common::MemoryPool<common::TestObject> pool(3, PoolOverflow::kReturnNull);
+  std::vector<common::TestObject*> objects;
+  for (int i = 0; i < 3; ++i) objects.push_back(pool.Allocate(i));
+  for (auto* obj : objects) ASSERT_NE(obj, nullptr);
+  EXPECT_EQ(pool.Allocate(3), nullptr);
+
+  pool.Deallocate(objects.back());
+  objects.pop_back();
+  auto* obj = pool.Allocate(4);
+  ASSERT_NE(obj, nullptr);
+  objects.push_back(obj);
+
+  const auto stats = pool.Stats();
+  EXPECT_EQ(stats.capacity, 3);
+  EXPECT_EQ(stats.failed_allocations, 1);
+  EXPECT_EQ(stats.InUse(), 3);
+  for (auto* object : objects) pool.Deallocate(object);
+  EXPECT_EQ(pool.Stats().InUse(), 0);
+}
+
+TEST(MemoryPoolTest, ShouldAllocateFromHeapWhenCapacityIsExhausted) {
+  common::MemoryPool<common::TestObject> pool(2);
+  auto* obj1 = pool.Allocate(1);
+  auto* obj2 = pool.Allocate(2);
+  auto* obj3 = pool.Allocate(3);
+  ASSERT_NE(obj3, nullptr);
+  EXPECT_EQ(obj3->GetValue(), 3);
+  EXPECT_EQ(pool.Stats().heap_allocations, 1);
+  pool.Deallocate(obj3);
+  pool.Deallocate(obj2);
+  pool.Deallocate(obj1);
+  EXPECT_EQ(pool.Stats().InUse(), 0);
+}
+
+TEST(MemoryPoolTest, ShouldFreeObjectsOnOtherThreadsWithoutLosingBlocks) {
+  constexpr size_t kCapacity = 256;
+  constexpr int kRounds      = 20000;
+  common::MemoryPool<common::TestObject> pool(kCapacity,
+                                              PoolOverflow::kReturnNull);
+  // producers allocate, consumers free: blocks always cross threads
+  std::atomic<common::TestObject*> slots[64] = {};
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> freed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kRounds; ++i) {
+        auto* obj = pool.Allocate(i);
+        if (!obj) continue;
+        auto& slot = slots[(t * kRounds + i) % 64];
+        if (auto* old = slot.exchange(obj)) pool.Deallocate(old);
+      }
+    });
+  }
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      while (!stop.load()) {
+        for (auto& slot : slots) {
+          if (auto* obj = slot.exchange(nullptr)) {
+            pool.Deallocate(obj);
+            freed.fetch_add(1);
+          }
+        }
+      }
+    });
+  }
+  for (int t = 0; t < 4; ++t) threads[t].join();
+  stop = true;
+  for (size_t t = 4; t < threads.size(); ++t) threads[t].join();
+  for (auto& slot : slots)
+    if (auto* obj = slot.exchange(nullptr)) pool.Deallocate(obj);
+
+  EXPECT_EQ(pool.Stats().InUse(), 0);
+  EXPECT_GT(freed.load(), 0);
+  // every block came back: the whole capacity can be taken again
+  std::vector<common::TestObject*> objects;
+  for (size_t i = 0; i < kCapacity; ++i) {
+    auto* obj = pool.Allocate(static_cast<int>(i));
+    ASSERT_NE(obj, nullptr) << "block " << i << " was lost";
+    objects.push_back(obj);
+  }
+  std::sort(objects.begin(), objects.end());
+  EXPECT_EQ(std::adjacent_find(objects.begin(), objects.end()), objects.end());
+  EXPECT_EQ(pool.Allocate(0), nullptr);
+  for (auto* obj : objects) pool.Deallocate(obj);
+}
 }  // namespace common
 
 int main(int argc, char **argv) {
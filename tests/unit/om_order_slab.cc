@@ -0,0 +1,134 @@
+#include <vector>
+
+#include "aot/strategy/om_order_slab.h"
+#include "gtest/gtest.h"
+
+using Exchange::ClientResponseType;
+using Trading::OMOrderState;
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+const common::TradingPair kEthUsdt{3, 1};
+
+std::vector<common::OrderId> Ids(Trading::OMOrderSlab& slab,
+                                 common::TradingPair trading_pair,
+                                 common::Side side) {
+    std::vector<common::OrderId> ids;
+    slab.ForEach(trading_pair, side, [&ids](Trading::OMOrder& order) {
+        ids.push_back(order.order_id);
+    });
+    return ids;
+}
+}  // namespace
+
+TEST(OMOrderSlab, KeepsManyOrdersPerSideInOrderOfAdding) {
+    Trading::OMOrderSlab slab(16);
+    std::vector<common::OrderId> bids;
+    for (common::Price price : {100, 99, 98})
+        bids.push_back(
+            slab.Add(kBtcUsdt, common::Side::kBid, price, 5)->order_id);
+    const auto ask = slab.Add(kBtcUsdt, common::Side::kAsk, 101, 5)->order_id;
+    slab.Add(kEthUsdt, common::Side::kBid, 10, 1);
+
+    EXPECT_EQ(slab.Size(), 5);
+    EXPECT_EQ(slab.Count(kBtcUsdt, common::Side::kBid), 3);
+    EXPECT_EQ(slab.Count(kBtcUsdt, common::Side::kAsk), 1);
+    EXPECT_EQ(slab.Count(kEthUsdt, common::Side::kBid), 1);
+    EXPECT_EQ(slab.Count(kEthUsdt, common::Side::kAsk), 0);
+    EXPECT_EQ(Ids(slab, kBtcUsdt, common::Side::kBid), bids);
+    EXPECT_EQ(slab.Find(ask)->price, 101);
+    EXPECT_EQ(slab.Find(ask)->state, OMOrderState::PENDING_NEW);
+
+    slab.OnResponse(ClientResponseType::CANCELED, bids[1], 0);
+    EXPECT_EQ(Ids(slab, kBtcUsdt, common::Side::kBid),
+              (std::vector{bids[0], bids[2]}));
+    EXPECT_EQ(slab.Find(bids[1]), nullptr);
+}
+
+TEST(OMOrderSlab, AcksInReverseOrder) {
+    Trading::OMOrderSlab slab(8);
+    std::vector<common::OrderId> ids;
+    for (int i = 0; i < 4; ++i)
+        ids.push_back(slab.Add(kBtcUsdt, common::Side::kAsk, 100 + i, 1)
+                          ->order_id);
+    for (auto id = ids.rbegin(); id != ids.rend(); ++id) {
+        auto order = slab.OnResponse(ClientResponseType::ACCEPTED, *id, 1);
+        ASSERT_NE(order, nullptr);
+        EXPECT_EQ(order->order_id, *id);
+        EXPECT_EQ(order->state, OMOrderState::LIVE);
+    }
+    EXPECT_EQ(Ids(slab, kBtcUsdt, common::Side::kAsk), ids);
+}
+
+TEST(OMOrderSlab, FillBeforeAck) {
+    Trading::OMOrderSlab slab(8);
+    const auto partly = slab.Add(kBtcUsdt, common::Side::kBid, 100, 10)
+                            ->order_id;
+    const auto fully = slab.Add(kBtcUsdt, common::Side::kBid, 99, 10)
+                           ->order_id;
+
+    auto order = slab.OnResponse(ClientResponseType::FILLED, partly, 4);
+    ASSERT_NE(order, nullptr);
+    EXPECT_EQ(order->state, OMOrderState::LIVE);
+    EXPECT_EQ(order->qty, 4);
+    slab.OnResponse(ClientResponseType::ACCEPTED, partly, 10);
+    EXPECT_EQ(slab.Find(partly)->state, OMOrderState::LIVE);
+    EXPECT_EQ(slab.Find(partly)->qty, 4);
+
+    EXPECT_EQ(slab.OnResponse(ClientResponseType::FILLED, fully, 0), nullptr);
+    EXPECT_EQ(slab.OnResponse(ClientResponseType::ACCEPTED, fully, 10),
+              nullptr);
+    EXPECT_EQ(slab.Size(), 1);
+}
+
+TEST(OMOrderSlab, LateAckDoesNotTouchOrderInReusedSlot) {
+    Trading::OMOrderSlab slab(1);
+    const auto old_id = slab.Add(kBtcUsdt, common::Side::kBid, 100, 1)
+                            ->order_id;
+    EXPECT_EQ(slab.Add(kBtcUsdt, common::Side::kBid, 100, 1), nullptr);
+    slab.OnResponse(ClientResponseType::CANCELED, old_id, 0);
+
+    const auto new_id = slab.Add(kEthUsdt, common::Side::kAsk, 7, 3)->order_id;
+    EXPECT_NE(new_id, old_id);
+    EXPECT_EQ(slab.OnResponse(ClientResponseType::ACCEPTED, old_id, 1),
+              nullptr);
+    EXPECT_EQ(slab.OnResponse(ClientResponseType::FILLED, old_id, 0),
+              nullptr);
+    ASSERT_NE(slab.Find(new_id), nullptr);
+    EXPECT_EQ(slab.Find(new_id)->state, OMOrderState::PENDING_NEW);
+    EXPECT_EQ(slab.Find(new_id)->qty, 3);
+    EXPECT_EQ(slab.Count(kBtcUsdt, common::Side::kBid), 0);
+}
+
+TEST(OMOrderSlab, CancelInFlightBeforeAck) {
+    Trading::OMOrderSlab slab(8);
+    const auto id = slab.Add(kBtcUsdt, common::Side::kAsk, 100, 1)->order_id;
+    ASSERT_NE(slab.RequestCancel(id), nullptr);
+    EXPECT_EQ(slab.RequestCancel(id), nullptr);
+
+    slab.OnResponse(ClientResponseType::ACCEPTED, id, 1);
+    EXPECT_EQ(slab.Find(id)->state, OMOrderState::PENDING_CANCEL);
+    slab.OnResponse(ClientResponseType::CANCELED, id, 0);
+    EXPECT_EQ(slab.Find(id), nullptr);
+    EXPECT_EQ(slab.RequestCancel(id), nullptr);
+}
+
+TEST(OMOrderSlab, RejectedCancelLeavesOrderLive) {
+    Trading::OMOrderSlab slab(8);
+    const auto id = slab.Add(kBtcUsdt, common::Side::kAsk, 100, 1)->order_id;
+    slab.OnResponse(ClientResponseType::ACCEPTED, id, 1);
+    slab.RequestCancel(id);
+    slab.OnResponse(ClientResponseType::CANCEL_REJECTED, id, 1);
+    EXPECT_EQ(slab.Find(id)->state, OMOrderState::LIVE);
+    EXPECT_NE(slab.RequestCancel(id), nullptr);
+}
+
+TEST(OMOrderSlab, RejectedNewOrderFreesItsSlot) {
+    Trading::OMOrderSlab slab(2);
+    const auto id = slab.Add(kBtcUsdt, common::Side::kBid, 100, 1)->order_id;
+    slab.Add(kBtcUsdt, common::Side::kBid, 99, 1);
+    EXPECT_EQ(slab.OnResponse(ClientResponseType::INVALID, id, 0), nullptr);
+    EXPECT_EQ(slab.Size(), 1);
+    EXPECT_NE(slab.Add(kBtcUsdt, common::Side::kBid, 98, 1), nullptr);
+    EXPECT_EQ(slab.Capacity(), 2);
+}
@@ -3,6 +3,9 @@
 #include "aot/strategy/market_order_book.h"
 #include "aot/Binance.h"
 #include "cmath"
+#include <random>
+#include <vector>
+#include "boost/asio/use_future.hpp"
 #include "gtest/gtest.h"
 
 TEST(MarketOrderBookBacktesting, INSERT_EVENT) {
@@ -379,8 +382,363 @@ TEST(OrderBook, ShouldAllocateMemoryFromUpdateBBOPoolAndSendBBOUpdateMessageToOr
 //     //EXPECT_GT(Logger::GetLogCount(), initial_log_count);
 // }
 
+TEST(FlatMarketOrderBook, ShouldUpdateBBOFromDiffAndEmitSignal) {
+    using namespace Trading;
+    FlatMarketOrderBook book(common::ExchangeId::kBinance,
+                             common::TradingPair{2, 1}, 256, 16);
+    int emitted = 0;
+    book.SubscribeToBBO([&emitted](const BBO&) { emitted++; });
+
+    Exchange::BookDiffSnapshot2 diff;
+    diff.bids = {{100, 1}, {99, 2}, {98, 3}};
+    diff.asks = {{101, 4}, {102, 5}};
+    book.OnMarketUpdate(&diff);
+    EXPECT_EQ(book.GetBBO()->bid_price, 100);
+    EXPECT_EQ(book.GetBBO()->bid_qty, 1);
+    EXPECT_EQ(book.GetBBO()->ask_price, 101);
+    EXPECT_EQ(book.GetBBO()->ask_qty, 4);
+    EXPECT_EQ(emitted, 1);
+
+    // diff below the best bid does not change BBO
+    diff.bids = {{98, 7}};
+    diff.asks.clear();
+    book.OnMarketUpdate(&diff);
+    EXPECT_EQ(emitted, 1);
+
+    diff.bids = {{100, 0}};
+    book.OnMarketUpdate(&diff);
+    EXPECT_EQ(book.GetBBO()->bid_price, 99);
+    EXPECT_EQ(book.GetBBO()->bid_qty, 2);
+    EXPECT_EQ(emitted, 2);
+    EXPECT_EQ(book.GetPriceAndQtyAtLevel(common::Side::kBid, 1),
+              std::make_pair(common::Price{98}, common::Qty{7}));
+}
+
+TEST(FlatMarketOrderBook, ShouldKeepFarLevelsWhenWindowRecentres) {
+    using namespace Trading;
+    FlatMarketOrderBook book(common::ExchangeId::kBinance,
+                             common::TradingPair{2, 1}, 64, 16);
+    Exchange::BookDiffSnapshot2 diff;
+    // best ask jumps far below the window, old levels go to far levels
+    diff.asks = {{10000, 1}, {10010, 2}, {5000, 3}};
+    book.OnMarketUpdate(&diff);
+    EXPECT_EQ(book.GetBBO()->ask_price, 5000);
+    EXPECT_EQ(book.GetAsks().Size(), 3);
+    EXPECT_EQ(book.GetAsks().SizeInWindow(), 1);
+
+    // window becomes empty and is moved to the best far level
+    diff.asks = {{5000, 0}};
+    book.OnMarketUpdate(&diff);
+    EXPECT_EQ(book.GetBBO()->ask_price, 10000);
+    EXPECT_EQ(book.GetBBO()->ask_qty, 1);
+    EXPECT_EQ(book.GetPriceAndQtyAtLevel(common::Side::kAsk, 1),
+              std::make_pair(common::Price{10010}, common::Qty{2}));
+    EXPECT_EQ(book.GetPriceAndQtyAtLevel(common::Side::kAsk, 2).first,
+              common::kPriceInvalid);
+}
+
+TEST(FlatMarketOrderBook, ShouldApplyDeepSnapshotAsDiffs) {
+    using namespace Trading;
+    FlatMarketOrderBook snapshot_book(common::ExchangeId::kBinance,
+                                      common::TradingPair{2, 1}, 64, 16);
+    FlatMarketOrderBook diff_book(common::ExchangeId::kBinance,
+                                  common::TradingPair{2, 1}, 64, 16);
+    Exchange::BookSnapshot2 snapshot;
+    std::mt19937_64 generator(7);
+    // best first as exchanges send them, most levels are out of the window
+    for (common::Price price = 10000; price > 5000;
+         price -= 1 + generator() % 3)
+        snapshot.bids.emplace_back(price, generator() % 100 + 1);
+    for (common::Price price = 10001; price < 15000;
+         price += 1 + generator() % 3)
+        snapshot.asks.emplace_back(price, generator() % 100 + 1);
+    snapshot_book.OnMarketUpdate(&snapshot);
+
+    Exchange::BookDiffSnapshot2 diff;
+    diff.bids = snapshot.bids;
+    diff.asks = snapshot.asks;
+    diff_book.OnMarketUpdate(&diff);
+
+    ASSERT_EQ(snapshot_book.GetBids().Size(), snapshot.bids.size());
+    ASSERT_EQ(snapshot_book.GetAsks().Size(), snapshot.asks.size());
+    EXPECT_GT(snapshot_book.GetBids().Size(),
+              snapshot_book.GetBids().SizeInWindow());
+    for (size_t level = 0; level < snapshot.bids.size(); level++)
+        ASSERT_EQ(
+            snapshot_book.GetPriceAndQtyAtLevel(common::Side::kBid, level),
+            diff_book.GetPriceAndQtyAtLevel(common::Side::kBid, level));
+    for (size_t level = 0; level < snapshot.asks.size(); level++)
+        ASSERT_EQ(
+            snapshot_book.GetPriceAndQtyAtLevel(common::Side::kAsk, level),
+            diff_book.GetPriceAndQtyAtLevel(common::Side::kAsk, level));
+    EXPECT_EQ(snapshot_book.GetBBO()->bid_price, 10000);
+    EXPECT_EQ(snapshot_book.GetBBO()->ask_price, 10001);
+}
+
+TEST(FlatMarketOrderBook, ShouldMatchMarketOrderBook2OnRandomDiffs) {
+    using namespace Trading;
+    MarketOrderBook2 tree_book(common::ExchangeId::kBinance,
+                               common::TradingPair{2, 1});
+    FlatMarketOrderBook flat_book(common::ExchangeId::kBinance,
+                                  common::TradingPair{2, 1}, 512, 1024);
+    std::mt19937_64 generator(42);
+    common::Price mid = 100000;
+    for (int i = 0; i < 20000; i++) {
+        if (i % 500 == 0) mid += generator() % 2001 - 1000;
+        Exchange::BookDiffSnapshot2 diff;
+        for (int j = 0; j < 5; j++) {
+            common::Qty qty = (generator() % 3) ? generator() % 100 + 1 : 0;
+            diff.bids.emplace_back(mid - 1 - generator() % 2000, qty);
+            qty = (generator() % 3) ? generator() % 100 + 1 : 0;
+            diff.asks.emplace_back(mid + generator() % 2000, qty);
+        }
+        tree_book.OnMarketUpdate(&diff);
+        flat_book.OnMarketUpdate(&diff);
+        // the tree book does not cross-clean levels, so compare only sides
+        ASSERT_EQ(tree_book.GetPriceAndQtyAtLevel(common::Side::kBid, 0),
+                  flat_book.GetPriceAndQtyAtLevel(common::Side::kBid, 0));
+        ASSERT_EQ(tree_book.GetPriceAndQtyAtLevel(common::Side::kAsk, 0),
+                  flat_book.GetPriceAndQtyAtLevel(common::Side::kAsk, 0));
+        ASSERT_EQ(tree_book.GetBidsatPriceMap().size(),
+                  flat_book.GetBids().Size());
+        ASSERT_EQ(tree_book.GetAsksatPriceMap().size(),
+                  flat_book.GetAsks().Size());
+    }
+    for (size_t level = 0; level < 50; level++) {
+        EXPECT_EQ(tree_book.GetPriceAndQtyAtLevel(common::Side::kBid, level),
+                  flat_book.GetPriceAndQtyAtLevel(common::Side::kBid, level));
+        EXPECT_EQ(tree_book.GetPriceAndQtyAtLevel(common::Side::kAsk, level),
+                  flat_book.GetPriceAndQtyAtLevel(common::Side::kAsk, level));
+    }
+}
+
+TEST(DepthCache, ShouldRebuildOnlyWhenTouchedLevelIsInsideDepth) {
+    using namespace Trading;
+    FlatMarketOrderBook book(common::ExchangeId::kBinance,
+                             common::TradingPair{2, 1}, 256, 16);
+    DepthCache cache;
+    Exchange::BookDiffSnapshot2 diff;
+    for (common::Price price = 100; price > 80; price--)
+        diff.bids.emplace_back(price, 1);
+    book.OnMarketUpdate(&diff);
+
+    const auto& depth = cache.Get(book, 5);
+    ASSERT_EQ(depth.bids_size, 5);
+    EXPECT_EQ(depth.bids[4].price, 96);
+    EXPECT_EQ(depth.bids[4].cumulative_qty, 5);
+    const auto rebuilds = cache.Rebuilds();
+
+    // level below top 5 does not invalidate cache
+    diff.bids = {{90, 3}};
+    book.OnMarketUpdate(&diff);
+    cache.OnLevelTouched(common::Side::kBid, 90);
+    cache.Get(book, 5);
+    EXPECT_EQ(cache.Rebuilds(), rebuilds);
+
+    diff.bids = {{98, 0}};
+    book.OnMarketUpdate(&diff);
+    cache.OnLevelTouched(common::Side::kBid, 98);
+    EXPECT_EQ(cache.Get(book, 5).bids[2].price, 97);
+    EXPECT_EQ(cache.Rebuilds(), rebuilds + 1);
+}
+
+TEST(DepthCache, ShouldComputeVwapToSize) {
+    using namespace Trading;
+    FlatMarketOrderBook book(common::ExchangeId::kBinance,
+                             common::TradingPair{2, 1}, 256, 16);
+    DepthCache cache;
+    Exchange::BookDiffSnapshot2 diff;
+    diff.asks = {{100, 2}, {101, 3}, {105, 5}};
+    book.OnMarketUpdate(&diff);
+
+    auto result = cache.GetVwap(book, common::Side::kAsk, 4);
+    EXPECT_EQ(result.filled_qty, 4);
+    EXPECT_EQ(result.worst_price, 101);
+    EXPECT_DOUBLE_EQ(result.vwap, (100. * 2 + 101. * 2) / 4);
+
+    result = cache.GetVwap(book, common::Side::kAsk, 100);
+    EXPECT_EQ(result.filled_qty, 10);
+    EXPECT_EQ(result.worst_price, 105);
+    EXPECT_DOUBLE_EQ(result.vwap, (100. * 2 + 101. * 3 + 105. * 5) / 10);
+
+    result = cache.GetVwap(book, common::Side::kBid, 1);
+    EXPECT_EQ(result.filled_qty, 0);
+}
+
+namespace {
+using Strand = boost::asio::strand<boost::asio::thread_pool::executor_type>;
+
+boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot> MakeDiff(
+    Exchange::BookDiff2SnapshotPool& diff_pool,
+    Exchange::BusEventBookDiffSnapshotPool& bus_diff_pool,
+    common::TradingPair trading_pair, common::Price bid_price,
+    common::Qty qty) {
+    auto* diff = diff_pool.Allocate(
+        &diff_pool, common::ExchangeId::kBinance, trading_pair,
+        Exchange::BookLevels{{bid_price, qty}}, Exchange::BookLevels{}, 0, 0);
+    return bus_diff_pool.Allocate(
+        &bus_diff_pool, boost::intrusive_ptr<Exchange::BookDiffSnapshot2>(diff));
+}
+
+void SendDiff(Trading::OrderBookComponent<Strand>& component,
+              Exchange::BookDiff2SnapshotPool& diff_pool,
+              Exchange::BusEventBookDiffSnapshotPool& bus_diff_pool,
+              common::TradingPair trading_pair, common::Price bid_price,
+              common::Qty qty) {
+    component.AsyncHandleEvent(
+        MakeDiff(diff_pool, bus_diff_pool, trading_pair, bid_price, qty));
+}
+}  // namespace
+
+TEST(OrderBookComponent, ShouldSpreadBooksOverShards) {
+    using namespace Trading;
+    boost::asio::thread_pool thread_pool(2);
+    aot::CoBus bus(thread_pool);
+    OrderBookComponent component(
+        std::vector<Strand>{boost::asio::make_strand(thread_pool),
+                            boost::asio::make_strand(thread_pool)},
+        bus, 100, common::MarketType::kSpot);
+    component.AddOrderBook(common::ExchangeId::kBinance, {2, 1});
+    component.AddOrderBook(common::ExchangeId::kBinance, {3, 1});
+    component.AddOrderBook(common::ExchangeId::kBybit, {2, 1});
+    component.AddOrderBook(common::ExchangeId::kBybit, {3, 1},
+                           OrderBookEngine::kAvlTree, 1);
+    EXPECT_EQ(component.ShardsCount(), 2);
+    EXPECT_NE(component.ShardOf(common::ExchangeId::kBinance, {2, 1}),
+              component.ShardOf(common::ExchangeId::kBinance, {3, 1}));
+    EXPECT_EQ(component.ShardOf(common::ExchangeId::kBybit, {3, 1}), 1);
+    EXPECT_EQ(component.ShardOf(common::ExchangeId::kBybit, {4, 1}),
+              OrderBookComponent<Strand>::kNoShard);
+    thread_pool.join();
+}
+
+TEST(OrderBookComponent, ShouldMoveBookToAnotherShardWithItsLevels) {
+    using namespace Trading;
+    boost::asio::thread_pool thread_pool(2);
+    aot::CoBus bus(thread_pool);
+    std::vector<Strand> strands{boost::asio::make_strand(thread_pool),
+                                boost::asio::make_strand(thread_pool)};
+    OrderBookComponent component(strands, bus, 100,
+                                 common::MarketType::kSpot);
+    Exchange::BookDiff2SnapshotPool diff_pool(100);
+    Exchange::BusEventBookDiffSnapshotPool bus_diff_pool(100);
+    const common::TradingPair trading_pair{2, 1};
+    component.AddOrderBook(common::ExchangeId::kBinance, trading_pair);
+
+    for (common::Price price = 100; price > 95; price--)
+        SendDiff(component, diff_pool, bus_diff_pool, trading_pair, price, 1);
+    const auto to =
+        1 - component.ShardOf(common::ExchangeId::kBinance, trading_pair);
+    component.AsyncMoveOrderBook(common::ExchangeId::kBinance, trading_pair,
+                                 to);
+    // the move starts in the destination shard
+    boost::asio::post(strands[to], boost::asio::use_future).get();
+    EXPECT_EQ(component.ShardOf(common::ExchangeId::kBinance, trading_pair),
+              to);
+    // these diffs may come before the book and wait for it
+    for (common::Price price = 95; price > 90; price--)
+        SendDiff(component, diff_pool, bus_diff_pool, trading_pair, price, 2);
+
+    auto depth = boost::asio::co_spawn(
+                     thread_pool,
+                     component.AsyncGetDepth(common::ExchangeId::kBinance,
+                                             trading_pair, 20),
+                     boost::asio::use_future)
+                     .get();
+    ASSERT_EQ(depth.bids_size, 10);
+    EXPECT_EQ(depth.bids[0].price, 100);
+    EXPECT_EQ(depth.bids[5].price, 95);
+    EXPECT_EQ(depth.bids[5].qty, 2);
+    EXPECT_EQ(depth.bids[9].price, 91);
+    thread_pool.join();
+}
+
+TEST(OrderBookComponent, ShouldMoveHotBookToIdleShard) {
+    using namespace Trading;
+    boost::asio::thread_pool thread_pool(2);
+    aot::CoBus bus(thread_pool);
+    std::vector<Strand> strands{boost::asio::make_strand(thread_pool),
+                                boost::asio::make_strand(thread_pool)};
+    OrderBookComponent component(strands, bus, 100,
+                                 common::MarketType::kSpot);
+    Exchange::BookDiff2SnapshotPool diff_pool(4096);
+    Exchange::BusEventBookDiffSnapshotPool bus_diff_pool(4096);
+    component.AddOrderBook(common::ExchangeId::kBinance, {2, 1},
+                           OrderBookEngine::kFlatLadder, 0);
+    component.AddOrderBook(common::ExchangeId::kBinance, {3, 1},
+                           OrderBookEngine::kFlatLadder, 0);
+    component.AddOrderBook(common::ExchangeId::kBinance, {4, 1},
+                           OrderBookEngine::kFlatLadder, 1);
+
+    for (int i = 0; i < 1500; i++)
+        SendDiff(component, diff_pool, bus_diff_pool, {2, 1}, 100 + i % 10,
+                 1);
+    for (int i = 0; i < 600; i++)
+        SendDiff(component, diff_pool, bus_diff_pool, {3, 1}, 100 + i % 10,
+                 1);
+    // gap is too small
+    EXPECT_FALSE(component.AsyncRebalance(1'000'000));
+
+    for (int i = 0; i < 1500; i++)
+        SendDiff(component, diff_pool, bus_diff_pool, {2, 1}, 100 + i % 10,
+                 1);
+    for (int i = 0; i < 600; i++)
+        SendDiff(component, diff_pool, bus_diff_pool, {3, 1}, 100 + i % 10,
+                 1);
+    EXPECT_TRUE(component.AsyncRebalance());
+    boost::asio::post(strands[1], boost::asio::use_future).get();
+    EXPECT_EQ(component.ShardOf(common::ExchangeId::kBinance, {2, 1}), 1);
+    EXPECT_EQ(component.ShardOf(common::ExchangeId::kBinance, {3, 1}), 0);
+    // counters are reset by the previous call
+    EXPECT_FALSE(component.AsyncRebalance());
+    thread_pool.join();
+}
+
+TEST(OrderBookComponent, ShouldApplyBatchOfDiffsPerShardInOrder) {
+    using namespace Trading;
+    boost::asio::thread_pool thread_pool(2);
+    aot::CoBus bus(thread_pool);
+    std::vector<Strand> strands{boost::asio::make_strand(thread_pool),
+                                boost::asio::make_strand(thread_pool)};
+    OrderBookComponent component(strands, bus, 100,
+                                 common::MarketType::kSpot);
+    Exchange::BookDiff2SnapshotPool diff_pool(64);
+    Exchange::BusEventBookDiffSnapshotPool bus_diff_pool(64);
+    component.AddOrderBook(common::ExchangeId::kBinance, {2, 1},
+                           OrderBookEngine::kFlatLadder, 0);
+    component.AddOrderBook(common::ExchangeId::kBinance, {3, 1},
+                           OrderBookEngine::kFlatLadder, 1);
+    std::vector<boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>
+        diffs;
+    for (common::Price price = 100; price > 95; price--) {
+        diffs.push_back(MakeDiff(diff_pool, bus_diff_pool, {2, 1}, price, 1));
+        diffs.push_back(MakeDiff(diff_pool, bus_diff_pool, {3, 1}, price, 1));
+    }
+    // the last diff of the level wins
+    diffs.push_back(MakeDiff(diff_pool, bus_diff_pool, {2, 1}, 100, 7));
+    component.AsyncHandleBatch(
+        std::span<const boost::intrusive_ptr<Exchange::BusEventBookDiffSnapshot>>(
+            diffs));
+
+    for (const common::TradingPair trading_pair :
+         {common::TradingPair{2, 1}, common::TradingPair{3, 1}}) {
+        auto depth = boost::asio::co_spawn(
+                         thread_pool,
+                         component.AsyncGetDepth(common::ExchangeId::kBinance,
+                                                 trading_pair, 20),
+                         boost::asio::use_future)
+                         .get();
+        ASSERT_EQ(depth.bids_size, 5);
+        EXPECT_EQ(depth.bids[0].price, 100);
+        const common::Qty expected_qty =
+            trading_pair == common::TradingPair{2, 1} ? 7 : 1;
+        EXPECT_EQ(depth.bids[0].qty, expected_qty);
+    }
+    thread_pool.join();
+}
+
 int main(int argc, char** argv) {
     // fmtlog::setLogLevel(fmtlog::OFF);
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
@@ -0,0 +1,103 @@
+#include <random>
+#include <utility>
+
+#include "aot/pnl/pnl_book.h"
+#include "aot/pnl/pnl_calculator.h"
+#include "gtest/gtest.h"
+
+TEST(PnlBook, ShouldRealiseAverageCostOfClosedLots) {
+    aot::PnlBook book;
+    auto id = book.AddInstrument({.price_precission = 2, .qty_precission = 3});
+    // buy 2.000 at 100.00 and 1.000 at 103.00, average 101.00
+    book.AddFill(id, common::Side::kAsk, 10'000, 2'000);
+    book.AddFill(id, common::Side::kAsk, 10'300, 1'000);
+    EXPECT_EQ(book.Position(id), 3'000);
+    // mark 3.000 at 101.50: 1.50
+    book.UpdateBBO(id, 10'100, 10'200);
+    EXPECT_EQ(book.UnrealPnl(id), 150'000);
+    EXPECT_DOUBLE_EQ(book.UnrealPnlDouble(id), 1.5);
+    EXPECT_EQ(book.RealPnl(id), 0);
+    // sell 1.000 at 102.00: realised 1.00, 2.000 left at 101.00
+    book.AddFill(id, common::Side::kBid, 10'200, 1'000);
+    EXPECT_EQ(book.RealPnl(id), 100'000);
+    EXPECT_EQ(book.UnrealPnl(id), 200'000);
+    // sell 3.000 at 100.00 flips to short 1.000 at 100.00: realised -2.00
+    book.AddFill(id, common::Side::kBid, 10'000, 3'000);
+    EXPECT_EQ(book.Position(id), -1'000);
+    EXPECT_EQ(book.RealPnl(id), -100'000);
+    EXPECT_EQ(book.UnrealPnl(id), 0);
+    // mid 99.995 is a half of the price step, it is kept by the double getter
+    book.UpdateBBO(id, 9'999, 10'000);
+    EXPECT_EQ(book.UnrealPnl(id), 500);
+    EXPECT_DOUBLE_EQ(book.UnrealPnlDouble(id), 0.005);
+    // invalid prices keep the mark
+    book.UpdateBBO(id, common::kPriceInvalid, 10'000);
+    EXPECT_DOUBLE_EQ(book.UnrealPnlDouble(id), 0.005);
+    // buy back at 98.00: realised +2.00
+    book.AddFill(id, common::Side::kAsk, 9'800, 1'000);
+    EXPECT_EQ(book.Position(id), 0);
+    EXPECT_EQ(book.UnrealPnl(id), 0);
+    EXPECT_EQ(book.RealPnl(id), 100'000);
+    EXPECT_DOUBLE_EQ(book.TotalPnlDouble(), 1.0);
+}
+
+TEST(PnlBook, ShouldKeepTotalExactOnRandomFills) {
+    aot::PnlBook book;
+    constexpr aot::PnlBook::Id kInstruments = 4;
+    for (aot::PnlBook::Id i = 0; i < kInstruments; ++i)
+        book.AddInstrument({.price_precission = 8, .qty_precission = 8});
+    // total P&L is the cash of the fills and the marked position
+    common::PnlFixed cash[kInstruments] = {};
+    common::PnlFixed mark[kInstruments] = {};
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<common::Price> price(6'000'000'000'000,
+                                                       6'100'000'000'000);
+    std::uniform_int_distribution<common::Qty> qty(1, 300'000'000);
+    std::uniform_int_distribution<aot::PnlBook::Id> instrument(
+        0, kInstruments - 1);
+    std::bernoulli_distribution buy(0.5);
+    for (int i = 0; i < 100'000; ++i) {
+        auto id = instrument(generator);
+        if (i % 3) {
+            auto side =
+                buy(generator) ? common::Side::kAsk : common::Side::kBid;
+            auto p = static_cast<common::PnlFixed>(price(generator));
+            auto q = qty(generator);
+            book.AddFill(id, side, static_cast<common::Price>(p), q);
+            cash[id] -= common::sideToValue(side) * p * q;
+            mark[id]  = 2 * p;
+        } else {
+            auto bid = price(generator);
+            book.UpdateBBO(id, bid, bid + 3);
+            mark[id] = 2 * static_cast<common::PnlFixed>(bid) + 3;
+        }
+        // only the half unit of the mid may be truncated
+        const common::PnlFixed error =
+            book.Position(id) * mark[id] -
+            2 * (book.RealPnl(id) + book.UnrealPnl(id) - cash[id]);
+        ASSERT_TRUE(error >= -1 && error <= 1);
+        if (book.Position(id) == 0) ASSERT_TRUE(book.RealPnl(id) == cash[id]);
+    }
+}
+
+TEST(PnlCalculator, ShouldConvertIntegerPnlOnce) {
+    aot::ExchangeTradingPairs pairs;
+    common::TradingPair pair{2, 1};
+    pairs.AddOrUpdatePair(common::ExchangeId::kBinance, pair,
+                          {.price_precission = 2, .qty_precission = 3});
+    aot::PnlCalculator calculator(pairs);
+    aot::TransactionReport sell(common::ExchangeId::kBinance, pair,
+                                aot::Operation::kSell);
+    sell.entry_price = 10'050;
+    sell.exit_price  = 10'000;
+    sell.entry_qty   = 1'500;
+    sell.exit_qty    = 2'000;
+    auto [status, pnl] = calculator.CalculatePnl(sell);
+    EXPECT_TRUE(status);
+    // (100.50 - 100.00) * 1.500
+    EXPECT_DOUBLE_EQ(pnl, 0.75);
+    EXPECT_DOUBLE_EQ(sell.pnl, 0.75);
+    aot::TransactionReport unknown(common::ExchangeId::kBybit, pair,
+                                   aot::Operation::kBuy);
+    EXPECT_FALSE(calculator.CalculatePnl(unknown).first);
+}
@@ -307,6 +307,46 @@ TEST(PositionKeeperTest, ShouldHandleNullBBOPointerWithoutThrowingException) {
     EXPECT_NO_THROW(positionKeeper.UpdateBBO(common::ExchangeId::kBinance, common::TradingPair{2, 1}, nullptr));
 }
 
+TEST(PositionKeeperTest, ShouldReportFixedPointPnlInUnitsOfPair) {
+    common::TradingPairInfo info{};
+    info.price_precission = 2;
+    info.qty_precission   = 3;
+    common::TradingPairHashMap pairs;
+    pairs[common::TradingPair{2, 1}] = info;
+    Trading::PositionKeeper keeper(&pairs);
+
+    // buy 2.000 at 100.00, sell 1.000 at 110.00
+    MockClientResponse buy;
+    EXPECT_CALL(buy, GetTradingPair())
+        .WillOnce(testing::Return(common::TradingPair{2, 1}));
+    EXPECT_CALL(buy, GetSide()).WillOnce(testing::Return(common::Side::kAsk));
+    EXPECT_CALL(buy, GetExecQty()).WillOnce(testing::Return(2000));
+    EXPECT_CALL(buy, GetPrice()).WillOnce(testing::Return(10000));
+    EXPECT_CALL(buy, ToString()).WillRepeatedly(testing::Return(""));
+    keeper.AddFill(&buy);
+    MockClientResponse sell;
+    EXPECT_CALL(sell, GetTradingPair())
+        .WillOnce(testing::Return(common::TradingPair{2, 1}));
+    EXPECT_CALL(sell, GetSide()).WillOnce(testing::Return(common::Side::kBid));
+    EXPECT_CALL(sell, GetExecQty()).WillOnce(testing::Return(1000));
+    EXPECT_CALL(sell, GetPrice()).WillOnce(testing::Return(11000));
+    EXPECT_CALL(sell, ToString()).WillRepeatedly(testing::Return(""));
+    keeper.AddFill(&sell);
+
+    Trading::BBO bbo;
+    bbo.bid_price = 11900;
+    bbo.ask_price = 12100;
+    keeper.UpdateBBO(common::TradingPair{2, 1}, &bbo);
+
+    auto positionInfo = keeper.GetPositionInfo(common::TradingPair{2, 1});
+    EXPECT_EQ(positionInfo->position, 1000);
+    EXPECT_DOUBLE_EQ(positionInfo->real_pnl, 10.0);
+    // marked to the mid 120.00
+    EXPECT_DOUBLE_EQ(positionInfo->unreal_pnl, 20.0);
+    EXPECT_DOUBLE_EQ(positionInfo->total_pnl, 30.0);
+    EXPECT_NE(keeper.ToString().find("Total PnL:30"), std::string::npos);
+}
+
 // TEST(PositionKeeperServiceTest, ShouldCallOnNewSignalForEachEventInRun) {
 //     using ::testing::_;
 //     using ::testing::Invoke;
@@ -0,0 +1,146 @@
+#include <vector>
+
+#include "aot/backtesting/replay.h"
+#include "aot/strategy/arbitrage/arbitrage_strategy.h"
+#include "aot/strategy/market_order_book.h"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+const common::TradingPair kBtcUsdt{2, 1};
+using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+struct Trade {
+    size_t uid_trade;
+    common::Nanos time_open;
+    common::Nanos time_close;
+    double pnl;
+    bool operator==(const Trade&) const = default;
+};
+
+class TradeRecorder : public bus::Component {
+  public:
+    std::vector<Trade> trades;
+    void AsyncHandleEvent(
+        boost::intrusive_ptr<aot::ArbitrageReportEnvelope> event) override {
+        const auto* report = event->WrappedEvent();
+        trades.push_back({report->uid_trade, report->time_open,
+                          report->time_close, report->pnl});
+    }
+};
+
+/// depth of one exchange: one bid and one ask level per diff
+class DepthTape {
+  public:
+    explicit DepthTape(common::ExchangeId exchange_id)
+        : exchange_id_(exchange_id) {}
+    void Add(common::Nanos time, common::Price bid, common::Price ask) {
+        tape_.Add(time, boost::intrusive_ptr<Exchange::BookDiffSnapshot2>(
+                            pool_.Allocate(&pool_, exchange_id_, kBtcUsdt,
+                                           Exchange::BookLevels{{bid, 10}},
+                                           Exchange::BookLevels{{ask, 10}},
+                                           0, 0)));
+    }
+    backtesting::ReplayTape& Tape() { return tape_; }
+
+  private:
+    common::ExchangeId exchange_id_;
+    Exchange::BookDiff2SnapshotPool pool_{16};
+    backtesting::ReplayTape tape_;
+};
+
+/**
+ * @brief order books of two exchanges and the arbitrage strategy between them
+ * fed by recorded diffs, as a day of a backtest
+ *
+ */
+std::vector<Trade> ReplayDay(common::Nanos step,
+                             backtesting::ReplayOptions options = {},
+                             backtesting::ReplayStats* stats = nullptr) {
+    boost::asio::io_context context;
+    boost::asio::thread_pool bus_pool(1);
+    aot::CoBus bus(bus_pool);
+    aot::ExchangeTradingPairs exchange_trading_pairs;
+    common::TradingPairInfo info{.price_precission = 2, .qty_precission = 3};
+    exchange_trading_pairs.AddOrUpdatePair(common::ExchangeId::kBinance,
+                                           kBtcUsdt, info);
+    exchange_trading_pairs.AddOrUpdatePair(common::ExchangeId::kBybit,
+                                           kBtcUsdt, info);
+    Trading::OrderBookComponent<Strand> books(boost::asio::make_strand(context),
+                                              bus, 64,
+                                              common::MarketType::kSpot);
+    books.AddOrderBook(common::ExchangeId::kBinance, kBtcUsdt);
+    books.AddOrderBook(common::ExchangeId::kBybit, kBtcUsdt);
+    aot::ArbitrageStrategyComponent strategy(context, bus, 8,
+                                             exchange_trading_pairs);
+    aot::ArbitrageCycle cycle;
+    cycle.push_back({kBtcUsdt, common::ExchangeId::kBinance,
+                     common::MarketType::kSpot, aot::Operation::kBuy});
+    cycle.push_back({kBtcUsdt, common::ExchangeId::kBybit,
+                     common::MarketType::kSpot, aot::Operation::kSell});
+    strategy.AddArbitrageCycle(cycle);
+    TradeRecorder recorder;
+    bus.Subscribe(&books, &strategy);
+    bus.Subscribe(&strategy, &recorder);
+
+    // bybit bids above the binance ask from the second step, diffs add levels
+    DepthTape binance(common::ExchangeId::kBinance);
+    DepthTape bybit(common::ExchangeId::kBybit);
+    binance.Add(1 * step, 9'990, 10'000);
+    bybit.Add(2 * step, 10'100, 10'110);
+    bybit.Add(3 * step, 9'900, 9'910);
+    binance.Add(4 * step, 9'800, 9'810);
+
+    backtesting::ReplayEngine engine(context, bus, options);
+    bus.Subscribe(&engine.AddFeed(binance.Tape()), &books);
+    bus.Subscribe(&engine.AddFeed(bybit.Tape()), &books);
+    auto result = engine.Run();
+    if (stats) *stats = result;
+    bus_pool.join();
+    return recorder.trades;
+}
+}  // namespace
+
+TEST(ReplayEngine, ShouldReplayDepthIntoStrategyOnVirtualClock) {
+    constexpr common::Nanos kStep = 1'000'000'000;
+    backtesting::ReplayStats stats;
+    auto trades = ReplayDay(kStep, {}, &stats);
+    EXPECT_EQ(stats.events, 4);
+    EXPECT_EQ(stats.first_time, kStep);
+    EXPECT_EQ(stats.last_time, 4 * kStep);
+    // as fast as possible: 3 seconds of the recording take much less
+    EXPECT_LT(stats.wall_time, kStep);
+    ASSERT_EQ(trades.size(), 2);
+    // trades are stamped with the times of the replayed BBOs, the crossed
+    // bybit book of the third step and the binance book of the fourth one
+    // take the profit
+    EXPECT_EQ(trades[0].time_close, 3 * kStep);
+    EXPECT_EQ(trades[1].time_close, 4 * kStep);
+    for (const auto& trade : trades) {
+        EXPECT_GE(trade.time_open, 2 * kStep);
+        EXPECT_LE(trade.time_open, trade.time_close);
+        EXPECT_GT(trade.pnl, 0);
+    }
+    // the clock of the thread is the system clock again
+    EXPECT_GT(common::getCurrentNanoS(), 4 * kStep);
+}
+
+TEST(ReplayEngine, ShouldGiveSameTradesInParallelRuns) {
+    constexpr common::Nanos kStep = 1'000;
+    const auto expected           = ReplayDay(kStep);
+    constexpr size_t kRuns        = 8;
+    std::vector<std::vector<Trade>> days(kRuns);
+    backtesting::RunReplays(
+        kRuns, 4, [&days](size_t run) { days[run] = ReplayDay(kStep); });
+    for (const auto& day : days) EXPECT_EQ(day, expected);
+}
+
+TEST(ReplayEngine, ShouldScaleTime) {
+    // 30 ms of the recording ten times faster
+    constexpr common::Nanos kStep = 10'000'000;
+    backtesting::ReplayStats stats;
+    ReplayDay(kStep, {.speed = 10}, &stats);
+    EXPECT_GE(stats.wall_time, 3 * kStep / 10);
+    EXPECT_LT(stats.wall_time, 3 * kStep);
+}
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "aot/common/rolling_stats.h"
+#include "aot/strategy/arbitrage/spread_monitor.h"
+#include "gtest/gtest.h"
+
+namespace {
+/// samples of the window kept as is, statistics by full loops
+class BruteForce {
+  public:
+    BruteForce(size_t capacity, common::Nanos window)
+        : capacity_(capacity), window_(window) {}
+    void Add(common::Nanos time, double value) {
+        while (!samples_.empty() && samples_.front().first < time - window_)
+            samples_.pop_front();
+        if (samples_.size() == capacity_) samples_.pop_front();
+        samples_.emplace_back(time, value);
+    }
+    size_t Count() const { return samples_.size(); }
+    double Mean() const {
+        double sum = 0;
+        for (const auto& [time, value] : samples_) sum += value;
+        return sum / samples_.size();
+    }
+    double Variance() const {
+        if (samples_.size() < 2) return 0;
+        const double mean = Mean();
+        double sum        = 0;
+        for (const auto& [time, value] : samples_)
+            sum += (value - mean) * (value - mean);
+        return sum / (samples_.size() - 1);
+    }
+
+  private:
+    size_t capacity_;
+    common::Nanos window_;
+    std::deque<std::pair<common::Nanos, double>> samples_;
+};
+}  // namespace
+
+TEST(RollingStats, ShouldMatchFullRecomputeOverTimeWindow) {
+    constexpr size_t kCapacity      = 64;
+    constexpr common::Nanos kWindow = 1'000;
+    common::RollingStats stats({.capacity   = kCapacity,
+                                .window     = kWindow,
+                                .ewma_alpha = 0.5});
+    auto first  = stats.AddSeries();
+    auto second = stats.AddSeries();
+    BruteForce reference(kCapacity, kWindow);
+    std::mt19937 generator(7);
+    // large offset checks cancellation of the running sums
+    std::normal_distribution<double> spread(25'000'000.0, 3.0);
+    std::uniform_int_distribution<common::Nanos> step(1, 40);
+    common::Nanos time = 0;
+    for (int i = 0; i < 10'000; ++i) {
+        time += step(generator);
+        auto value = spread(generator);
+        stats.Add(first, time, value);
+        stats.Add(second, time, -value);
+        reference.Add(time, value);
+        ASSERT_EQ(stats.Count(first), reference.Count());
+        ASSERT_NEAR(stats.Mean(first), reference.Mean(), 1e-6);
+        ASSERT_NEAR(stats.Variance(first), reference.Variance(), 1e-4);
+    }
+    EXPECT_NEAR(stats.Mean(second), -reference.Mean(), 1e-6);
+    // a gap longer than the window leaves only the new sample
+    stats.Add(first, time + 2 * kWindow, 1.0);
+    EXPECT_EQ(stats.Count(first), 1);
+    EXPECT_EQ(stats.Mean(first), 1.0);
+    EXPECT_EQ(stats.Variance(first), 0.0);
+}
+
+TEST(RollingStats, ShouldKeepEwmaAndScoreBeforeAdding) {
+    common::RollingStats stats({.capacity = 4, .window = 0, .ewma_alpha = 0.5});
+    auto id = stats.AddSeries();
+    EXPECT_EQ(stats.ZScore(id, 10.0), 0.0);
+    for (double value : {1.0, 2.0, 3.0, 4.0, 5.0}) stats.Add(id, 0, value);
+    // the window is full: 2 3 4 5
+    EXPECT_EQ(stats.Count(id), 4);
+    EXPECT_DOUBLE_EQ(stats.Mean(id), 3.5);
+    EXPECT_DOUBLE_EQ(stats.Variance(id), 5.0 / 3.0);
+    // 1, 1.5, 2.25, 3.125, 4.0625
+    EXPECT_DOUBLE_EQ(stats.Ewma(id), 4.0625);
+
+    std::vector<common::RollingStats::SeriesId> ids{id, id};
+    std::vector<double> values{3.5 + std::sqrt(5.0 / 3.0), 3.5};
+    std::vector<double> z_scores(2);
+    stats.AddBatch(ids, values, 0, z_scores);
+    EXPECT_DOUBLE_EQ(z_scores[0], 1.0);
+    EXPECT_EQ(stats.Count(id), 4);
+}
+
+TEST(SpreadMonitor, ShouldAverageSpreadOfStrategy) {
+    Trading::ExchangeBBOMap bbos;
+    aot::TradesState trades_state;
+    aot::SpreadMonitor monitor(bbos, trades_state,
+                               {.capacity = 8, .window = 100});
+    EXPECT_EQ(monitor.CalculateAverageSpread(1), 0.0);
+    monitor.AddSpreadToHistory(1, 10, 0);
+    monitor.AddSpreadToHistory(1, 20, 50);
+    monitor.AddSpreadToHistory(2, 100, 50);
+    EXPECT_DOUBLE_EQ(monitor.CalculateAverageSpread(1), 15.0);
+    EXPECT_DOUBLE_EQ(monitor.CalculatePercentageDeviation(1, 30), 100.0);
+    EXPECT_TRUE(monitor.IsSpreadOutOfBounds(1, 30, 50));
+    // the spread at 0 leaves the window
+    monitor.AddSpreadToHistory(1, 30, 120);
+    EXPECT_DOUBLE_EQ(monitor.CalculateAverageSpread(1), 25.0);
+    EXPECT_EQ(monitor.Register(2), 1);
+    EXPECT_DOUBLE_EQ(monitor.CalculateAverageSpread(2), 100.0);
+}
@@ -0,0 +1,155 @@
+#include <string>
+#include <string_view>
+
+#include "aot/Binance.h"
+#include "aot/Bybit.h"
+#include "aot/order_gw/signed_request.h"
+#include "gtest/gtest.h"
+
+namespace {
+constexpr std::string_view kApiKey    = "api-key-for-tests";
+constexpr std::string_view kSecretKey = "secret-key-for-tests";
+const common::TradingPair kBtcUsdt{2, 1};
+
+class BybitExchange : public https::ExchangeI {
+  public:
+    std::string_view Host() const override { return "api-testnet.bybit.com"; }
+    std::string_view Port() const override { return "443"; }
+    std::uint64_t RecvWindow() const override { return 5000; }
+};
+
+struct Order {
+    common::Side side;
+    common::Price price;
+    common::Qty qty;
+    common::OrderId order_id;
+};
+/// prices and quantities with short and long fractions and integer parts
+const Order kOrders[] = {{common::Side::kAsk, 6'543'210, 123'456, 7},
+                         {common::Side::kBid, 6'543'200, 100'000, 1'234'567},
+                         {common::Side::kAsk, 5, 1, 42},
+                         {common::Side::kBid, 10'000'000'000, 99'999'999, 0}};
+
+/// value of the request after name and before any of stop
+std::string_view Value(std::string_view request, std::string_view name,
+                       std::string_view stop) {
+    const auto start = request.find(name);
+    if (start == std::string_view::npos) return {};
+    request.remove_prefix(start + name.size());
+    return request.substr(0, request.find_first_of(stop));
+}
+
+class SignedRequestTest : public ::testing::Test {
+  protected:
+    common::TradingPairHashMap pairs;
+    hmac_sha256::Signer signer{hmac_sha256::Keys{kApiKey, kSecretKey}};
+    hmac_sha256::KeyedHmac hmac{kSecretKey};
+
+    void SetUp() override {
+        pairs[kBtcUsdt] = common::TradingPairInfo{
+            .price_precission     = 2,
+            .qty_precission       = 5,
+            .https_json_request   = "BTCUSDT",
+            .https_query_request  = "BTCUSDT",
+            .ws_query_request     = "btcusdt",
+            .https_query_response = "BTCUSDT"};
+    }
+    Exchange::RequestNewOrder Request(const Order& order) {
+        Exchange::RequestNewOrder request;
+        request.trading_pair = kBtcUsdt;
+        request.side         = order.side;
+        request.price        = order.price;
+        request.qty          = order.qty;
+        request.order_id     = order.order_id;
+        return request;
+    }
+    void ExpectBinanceParity(const Endpoint& endpoint) {
+        for (const auto& order : kOrders) {
+            auto request_template = binance::detail::MakeNewLimitOrderTemplate(
+                endpoint, kBtcUsdt, order.side, pairs, kApiKey, hmac);
+            ASSERT_TRUE(request_template.Valid());
+            auto request = Request(order);
+            binance::detail::FamilyLimitOrder::ArgsOrder args(&request, pairs);
+            binance::detail::FactoryRequest factory{
+                endpoint,
+                binance::detail::FamilyLimitOrder::end_point,
+                args,
+                boost::beast::http::verb::post,
+                &signer,
+                true};
+            const auto expected  = aot::SerializeRequest(factory());
+            const auto timestamp = Value(expected, "timestamp=", "& ");
+            EXPECT_EQ(request_template.Render(order.price, order.qty,
+                                              order.order_id,
+                                              std::stoull(std::string(
+                                                  timestamp))),
+                      expected);
+        }
+    }
+    void ExpectBybitParity(common::MarketType market_type) {
+        BybitExchange exchange;
+        for (const auto& order : kOrders) {
+            auto request_template = bybit::detail::MakeNewLimitOrderTemplate(
+                &exchange, market_type, kBtcUsdt, order.side, pairs, kApiKey,
+                hmac);
+            ASSERT_TRUE(request_template.Valid());
+            auto request = Request(order);
+            bybit::detail::FamilyLimitOrder::ArgsOrder args(&request, pairs,
+                                                            market_type);
+            bybit::detail::FactoryRequestJson factory{
+                &exchange,
+                bybit::detail::FamilyLimitOrder::end_point,
+                args,
+                boost::beast::http::verb::post,
+                &signer,
+                true};
+            const auto expected  = aot::SerializeRequest(factory());
+            const auto timestamp = Value(expected, "X-BAPI-TIMESTAMP: ", "\r");
+            EXPECT_EQ(request_template.Render(order.price, order.qty,
+                                              order.order_id,
+                                              std::stoull(std::string(
+                                                  timestamp))),
+                      expected);
+        }
+    }
+};
+}  // namespace
+
+TEST_F(SignedRequestTest, KeyedHmacMatchesSigner) {
+    std::array<char, hmac_sha256::kHexDigestSize> digest;
+    const std::string long_data(4096, 'a');
+    for (std::string_view data :
+         {std::string_view(), std::string_view("symbol=BTCUSDT&side=BUY"),
+          std::string_view(long_data)}) {
+        ASSERT_TRUE(hmac.Sign(data, digest));
+        EXPECT_EQ(std::string_view(digest.data(), digest.size()),
+                  signer.Sign(data));
+    }
+}
+
+TEST_F(SignedRequestTest, BinanceSpotIsByteIdentical) {
+    ExpectBinanceParity(Endpoint("testnet.binance.vision", 443, 5000, 60000));
+}
+
+TEST_F(SignedRequestTest, BinanceFuturesIsByteIdentical) {
+    ExpectBinanceParity(Endpoint("testnet.binancefuture.com", 443, 5000,
+                                 60000));
+}
+
+TEST_F(SignedRequestTest, BybitSpotIsByteIdentical) {
+    ExpectBybitParity(common::MarketType::kSpot);
+}
+
+TEST_F(SignedRequestTest, BybitFuturesIsByteIdentical) {
+    ExpectBybitParity(common::MarketType::kFutures);
+}
+
+TEST_F(SignedRequestTest, RejectsInvalidOrderId) {
+    auto request_template = binance::detail::MakeNewLimitOrderTemplate(
+        Endpoint("testnet.binance.vision", 443, 5000, 60000), kBtcUsdt,
+        common::Side::kAsk, pairs, kApiKey, hmac);
+    EXPECT_TRUE(
+        request_template
+            .Render(100, 100, common::kOrderIdInvalid, 1'700'000'000'000)
+            .empty());
+}
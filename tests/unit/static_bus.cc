@@ -0,0 +1,105 @@
+#include <atomic>
+#include <span>
+#include <vector>
+
+#include "aot/bus/static_bus.h"
+#include "gtest/gtest.h"
+
+namespace {
+struct Diff {
+    int id = 0;
+    std::atomic<int> ref_count{0};
+    explicit Diff(int _id) : id(_id) {}
+    friend void intrusive_ptr_add_ref(Diff *diff) { ++diff->ref_count; }
+    friend void intrusive_ptr_release(Diff *diff) {
+        if (--diff->ref_count == 0) delete diff;
+    }
+};
+struct Trade {
+    std::atomic<int> ref_count{0};
+    friend void intrusive_ptr_add_ref(Trade *trade) { ++trade->ref_count; }
+    friend void intrusive_ptr_release(Trade *trade) {
+        if (--trade->ref_count == 0) delete trade;
+    }
+};
+
+struct Getter {};
+
+struct Book {
+    std::vector<int> ids;
+    virtual ~Book() = default;
+    virtual void AsyncHandleEvent(boost::intrusive_ptr<Diff> diff) {
+        ids.push_back(diff->id);
+    }
+};
+
+/// must not be called by the bus, the route is wired to Book
+struct DerivedBook : Book {
+    void AsyncHandleEvent(boost::intrusive_ptr<Diff>) override {
+        ids.push_back(-1);
+    }
+};
+
+struct BatchBook {
+    std::vector<size_t> batches;
+    std::vector<int> ids;
+    void AsyncHandleEvent(boost::intrusive_ptr<Diff> diff) {
+        ids.push_back(diff->id);
+    }
+    void AsyncHandleBatch(std::span<const boost::intrusive_ptr<Diff>> diffs) {
+        batches.push_back(diffs.size());
+        for (const auto &diff : diffs) ids.push_back(diff->id);
+    }
+};
+
+using DiffRoute = aot::Route<Getter, Diff, Book, BatchBook>;
+using Bus       = aot::StaticBus<DiffRoute>;
+}  // namespace
+
+TEST(StaticBus, ShouldDeliverEventToAllSubscribers) {
+    Book book;
+    BatchBook batch_book;
+    Bus bus{DiffRoute{book, batch_book}};
+    Getter getter;
+    bus.AsyncSend(&getter, boost::intrusive_ptr<Diff>(new Diff(1)));
+    bus.AsyncSend(&getter, boost::intrusive_ptr<Diff>(new Diff(2)));
+    EXPECT_EQ(book.ids, (std::vector<int>{1, 2}));
+    EXPECT_EQ(batch_book.ids, (std::vector<int>{1, 2}));
+    EXPECT_TRUE(batch_book.batches.empty());
+}
+
+TEST(StaticBus, ShouldDeliverBatchInOneCallIfSubscriberSupportsIt) {
+    Book book;
+    BatchBook batch_book;
+    Bus bus{DiffRoute{book, batch_book}};
+    Getter getter;
+    std::vector<boost::intrusive_ptr<Diff>> diffs;
+    for (int i = 0; i < 5; ++i) diffs.emplace_back(new Diff(i));
+    bus.AsyncSendBatch(&getter, diffs);
+    EXPECT_EQ(batch_book.batches, (std::vector<size_t>{5}));
+    EXPECT_EQ(batch_book.ids, (std::vector<int>{0, 1, 2, 3, 4}));
+    // Book has no batch handler, it gets events one by one
+    EXPECT_EQ(book.ids, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST(StaticBus, ShouldCallHandlerOfRouteTypeWithoutVirtualDispatch) {
+    DerivedBook book;
+    BatchBook batch_book;
+    Bus bus{DiffRoute{book, batch_book}};
+    Getter getter;
+    bus.AsyncSend(&getter, boost::intrusive_ptr<Diff>(new Diff(7)));
+    EXPECT_EQ(book.ids, (std::vector<int>{7}));
+}
+
+TEST(StaticBus, ShouldDropEventWithoutRoute) {
+    Book book;
+    BatchBook batch_book;
+    Bus bus{DiffRoute{book, batch_book}};
+    Getter getter;
+    static_assert(Bus::HasRoute<Getter, Diff>());
+    static_assert(!Bus::HasRoute<Getter, Trade>());
+    bus.AsyncSend(&getter, boost::intrusive_ptr<Trade>(new Trade));
+    bus.AsyncSend(&getter, boost::intrusive_ptr<Diff>());
+    EXPECT_TRUE(book.ids.empty());
+    EXPECT_TRUE(batch_book.ids.empty());
+}
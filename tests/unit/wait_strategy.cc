@@ -0,0 +1,114 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "aot/common/wait_strategy.h"
+#include "aot/config/config.h"
+#include "gtest/gtest.h"
+
+using namespace std::literals::chrono_literals;
+using common::WaitPolicy;
+
+namespace {
+common::WaitStrategy::Options Park(std::chrono::microseconds timeout) {
+    return {.policy       = WaitPolicy::kSpinPark,
+            .spins        = 4,
+            .park_timeout = timeout};
+}
+}  // namespace
+
+TEST(WaitStrategy, PolicyFromString) {
+    EXPECT_EQ(common::WaitPolicyFromString("busy_spin"), WaitPolicy::kBusySpin);
+    EXPECT_EQ(common::WaitPolicyFromString("spin_pause"),
+              WaitPolicy::kSpinPause);
+    EXPECT_EQ(common::WaitPolicyFromString("spin_yield"),
+              WaitPolicy::kSpinYield);
+    EXPECT_EQ(common::WaitPolicyFromString("spin_park"), WaitPolicy::kSpinPark);
+    EXPECT_EQ(common::WaitPolicyFromString("sleep"), std::nullopt);
+}
+
+TEST(WaitStrategy, NotifyWakesParkedConsumer) {
+    common::WaitStrategy wait(Park(10s));
+    std::atomic<bool> item{false};
+    std::atomic<bool> parking{false};
+    std::thread consumer([&] {
+        while (!item.load()) {
+            parking = true;
+            wait.Idle([&] { return item.load(); });
+        }
+    });
+    while (!parking) std::this_thread::yield();
+    std::this_thread::sleep_for(20ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    item             = true;
+    wait.Notify();
+    consumer.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+    EXPECT_GE(wait.Parks(), 1);
+}
+
+TEST(WaitStrategy, ParkEndsByTimeoutWithoutNotify) {
+    common::WaitStrategy wait(Park(5ms));
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5; ++i) wait.Idle([] { return false; });
+    EXPECT_EQ(wait.Parks(), 1);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 4ms);
+}
+
+TEST(WaitStrategy, DoesNotParkIfWorkArrivedBeforeSleep) {
+    common::WaitStrategy wait(Park(10s));
+    for (int i = 0; i < 10; ++i) wait.Idle([] { return true; });
+    EXPECT_EQ(wait.Parks(), 0);
+}
+
+TEST(WaitStrategy, BusyResetsSpins) {
+    common::WaitStrategy wait(Park(1ms));
+    for (int i = 0; i < 4; ++i) wait.Idle([] { return false; });
+    wait.Busy();
+    for (int i = 0; i < 4; ++i) wait.Idle([] { return false; });
+    EXPECT_EQ(wait.Parks(), 0);
+}
+
+TEST(WaitStrategy, BusySpinNeverParks) {
+    common::WaitStrategy wait;
+    for (int i = 0; i < 10'000; ++i) wait.Idle([] { return false; });
+    wait.Notify();
+    EXPECT_EQ(wait.Parks(), 0);
+}
+
+TEST(ConfigWaitStrategies, ReadsSectionOfService) {
+    std::ofstream outfile("wait_strategy.toml");
+    outfile << "[wait_strategy.order_gateway]\npolicy = \"spin_park\"\n"
+               "spins = 64\npark_timeout_us = 250\n"
+               "[wait_strategy.order_book_service]\npolicy = \"spin_yield\"\n";
+    outfile.close();
+    config::WaitStrategies config("wait_strategy.toml");
+
+    auto gateway = config.WaitStrategy("order_gateway");
+    EXPECT_EQ(gateway.policy, WaitPolicy::kSpinPark);
+    EXPECT_EQ(gateway.spins, 64);
+    EXPECT_EQ(gateway.park_timeout, 250us);
+
+    auto book = config.WaitStrategy("order_book_service");
+    EXPECT_EQ(book.policy, WaitPolicy::kSpinYield);
+    EXPECT_EQ(book.spins, common::WaitStrategy::Options{}.spins);
+    fmtlog::poll();
+    std::remove("wait_strategy.toml");
+}
+
+TEST(ConfigWaitStrategies, BusySpinWithoutSectionOrForUnknownPolicy) {
+    std::ofstream outfile("wait_strategy.toml");
+    outfile << "[wait_strategy.order_gateway]\npolicy = \"sleep\"\n";
+    outfile.close();
+    config::WaitStrategies config("wait_strategy.toml");
+
+    EXPECT_EQ(config.WaitStrategy("order_gateway").policy,
+              WaitPolicy::kBusySpin);
+    EXPECT_EQ(config.WaitStrategy("order_book_service").policy,
+              WaitPolicy::kBusySpin);
+    fmtlog::poll();
+    std::remove("wait_strategy.toml");
+}
@@ -0,0 +1,126 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aot/ws_read_pipeline.h"
+#include "boost/beast/core/buffers_to_string.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+/// Collects parsed frames, what a parser callback does with the buffer.
+struct Collector {
+    std::mutex mutex;
+    std::vector<std::string> frames;
+    std::atomic<bool> gate{true};
+    void operator()(boost::beast::flat_buffer &frame) {
+        while (!gate.load()) std::this_thread::yield();
+        std::lock_guard lock(mutex);
+        frames.push_back(boost::beast::buffers_to_string(frame.data()));
+    }
+};
+
+void Write(boost::beast::flat_buffer &frame, const std::string &message) {
+    auto buffer = frame.prepare(message.size());
+    boost::asio::buffer_copy(buffer, boost::asio::buffer(message));
+    frame.commit(message.size());
+}
+
+/// Publishes messages in order, waits if the ring is full as the reader does.
+void Publish(aot::WsReadPipeline &pipeline,
+             const std::vector<std::string> &messages) {
+    for (const auto &message : messages) {
+        boost::beast::flat_buffer *frame;
+        while (!(frame = pipeline.AcquireWrite())) std::this_thread::yield();
+        Write(*frame, message);
+        pipeline.Publish();
+    }
+}
+
+bool WaitFrames(const aot::WsReadPipeline &pipeline, uint64_t frames) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pipeline.Stats().frames < frames) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+std::vector<std::string> MakeMessages(size_t count) {
+    std::vector<std::string> messages;
+    for (size_t i = 0; i < count; ++i)
+        messages.push_back(R"({"u":)" + std::to_string(i) + "}");
+    return messages;
+}
+}  // namespace
+
+TEST(WsReadPipeline, ShouldParseFramesInOrderOnPinnedThread) {
+    Collector collector;
+    aot::WsReadPipeline pipeline(
+        {.mode = aot::WsParseMode::kPinnedThread, .capacity = 8},
+        [&collector](auto &frame) { collector(frame); });
+    auto messages = MakeMessages(1000);
+    Publish(pipeline, messages);
+    ASSERT_TRUE(WaitFrames(pipeline, messages.size()));
+    EXPECT_EQ(collector.frames, messages);
+    EXPECT_EQ(pipeline.Stats().depth, 0);
+}
+
+TEST(WsReadPipeline, ShouldParseFramesInOrderOnThreadPool) {
+    boost::asio::thread_pool pool(2);
+    Collector collector;
+    aot::WsReadPipeline pipeline(
+        {.mode = aot::WsParseMode::kThreadPool, .capacity = 8, .pool = &pool},
+        [&collector](auto &frame) { collector(frame); });
+    auto messages = MakeMessages(1000);
+    Publish(pipeline, messages);
+    ASSERT_TRUE(WaitFrames(pipeline, messages.size()));
+    EXPECT_EQ(collector.frames, messages);
+    pipeline.Stop();
+    pool.join();
+}
+
+TEST(WsReadPipeline, ShouldStopIfPoolDroppedDrainTask) {
+    boost::asio::thread_pool pool(1);
+    pool.stop();
+    pool.join();
+    Collector collector;
+    {
+        aot::WsReadPipeline pipeline(
+            {.mode     = aot::WsParseMode::kThreadPool,
+             .capacity = 4,
+             .pool     = &pool},
+            [&collector](auto &frame) { collector(frame); });
+        Publish(pipeline, MakeMessages(1));
+        // the pool never runs the drain task, Stop must not wait for it
+        pipeline.Stop();
+    }
+    EXPECT_TRUE(collector.frames.empty());
+}
+
+TEST(WsReadPipeline, ShouldRefuseFrameIfParserIsWholeRingBehind) {
+    Collector collector;
+    collector.gate = false;
+    aot::WsReadPipeline pipeline(
+        {.mode = aot::WsParseMode::kPinnedThread, .capacity = 4},
+        [&collector](auto &frame) { collector(frame); });
+    ASSERT_EQ(pipeline.Capacity(), 4);
+    auto messages = MakeMessages(4);
+    Publish(pipeline, messages);
+    EXPECT_EQ(pipeline.AcquireWrite(), nullptr);
+
+    auto stats = pipeline.Stats();
+    EXPECT_EQ(stats.full_waits, 1);
+    EXPECT_EQ(stats.max_depth, 4);
+
+    collector.gate = true;
+    ASSERT_TRUE(WaitFrames(pipeline, messages.size()));
+    EXPECT_EQ(collector.frames, messages);
+    // buffers are recycled
+    EXPECT_NE(pipeline.AcquireWrite(), nullptr);
+    stats = pipeline.Stats();
+    EXPECT_GT(stats.queue_ns_max, 0);
+    EXPECT_GE(stats.queue_ns_total, stats.queue_ns_max);
+}